@@ -10,15 +10,28 @@
 #include <immintrin.h>
 #include <x86intrin.h>
 #include <zlib.h>
+#include <atomic>
+#include <thread>
+#include <memory>
 
 #include "graphLoad.hpp"
 #include "csr_char.hpp"
 #include "graph_iter.hpp"
 #include "base_types.hpp"
 #include "utils.hpp"
+#include "shard.hpp"
+#include "profile.hpp"
+#include "plan.hpp"
+#include "checkpoint.hpp"
+#include "reorder.hpp"
+#include "sort.hpp"
+#include "coverage.hpp"
+#include "project.hpp"
+#include "paired.hpp"
 
 #if defined(PASGAL_ENABLE_AVX512) || defined(PASGAL_ENABLE_AVX2)
 #include "align_vectorized.hpp"
+#include "align_streaming.hpp"
 #endif
 
 //External includes
@@ -38,15 +51,29 @@ namespace psgl
    * @param[in]   parameters        input parameters
    * @param[out]  bestScoreVector   vector to keep value and location of best scores,
    *                                vector size is same as count of the reads
+   * @param[in]   windows           range of columns [begin, end) to align each read to, 
+   *                                ignoring edges from outside it. All columns if null
    * @note                          reverse complement of the read is not handled here
    */
+  template <typename Graph>
   void alignToDAGLocal_Phase1_scalar( const std::vector<std::string> &readSet,
-                                      const CSR_char_container &graph,
+                                      const Graph &graph,
                                       const Parameters &parameters, 
-                                      std::vector< BestScoreInfo > &bestScoreVector)
+                                      std::vector< BestScoreInfo > &bestScoreVector,
+                                      const std::vector< std::pair<int64_t, int64_t> > *windows = nullptr)
   {
     assert (bestScoreVector.size() == readSet.size());
 
+    //DP rows span the widest window
+    int64_t width = graph.numVertices;
+
+    if (windows)
+    {
+      width = 0;
+      for (auto &w : *windows)
+        width = std::max (width, w.second - w.first);
+    }
+
 #ifdef VTUNE_SUPPORT
     __itt_resume();
 #endif
@@ -58,24 +85,31 @@ namespace psgl
 
       //initialize matrix of size 2 x width, init with zero
       //we will keep re-using rows to keep memory-usage low
-      std::vector< std::vector<int32_t> > matrix(2, std::vector<int32_t>(graph.numVertices, 0));
+      std::vector< std::vector<int32_t> > matrix(2, std::vector<int32_t>(width, 0));
 
 #pragma omp for schedule(dynamic)
       for (size_t readno = 0; readno < readSet.size(); readno++)
       {
+        auto time1 = omp_get_wtime();
+
+        //columns to align to, matrix is indexed by offset from colBegin
+        const int64_t colBegin = windows ? (*windows)[readno].first : 0;
+        const int64_t colEnd = windows ? (*windows)[readno].second : graph.numVertices;
+
         //reset buffer
-        std::fill(matrix[1].begin(), matrix[1].end(), 0);
+        std::fill(matrix[1].begin(), matrix[1].begin() + (colEnd - colBegin), 0);
 
         auto readLength = readSet[readno].length();
 
         int32_t bestScore = 0;
-        int32_t bestRow = 0, bestCol = 0;
+        int32_t bestRow = 0;
+        int64_t bestCol = 0;
 
         //iterate over characters in read
         for (int32_t i = 0; i < readLength; i++)
         {
           //iterate over characters in reference graph
-          for (int32_t j = 0; j < graph.numVertices; j++)
+          for (int64_t j = colBegin; j < colEnd; j++)
           {
             //current reference character
             char curChar = graph.vertex_label[j];
@@ -90,18 +124,22 @@ namespace psgl
 
             for(auto k = graph.offsets_in[j]; k < graph.offsets_in[j+1]; k++)
             {
+              //ignore edges from outside the window
+              if (graph.adjcny_in[k] > j - colBegin)
+                continue;
+
               //paths with match mismatch edit
-              currentMax = psgl_max (currentMax, matrix[(i-1) & 1][ graph.adjcny_in[k] ] + matchScore);
+              currentMax = psgl_max (currentMax, matrix[(i-1) & 1][ j - colBegin - graph.adjcny_in[k] ] + matchScore);
               //'& 1' is same as doing modulo 2
 
               //paths with deletion edit
-              currentMax = psgl_max (currentMax, matrix[i & 1][ graph.adjcny_in[k] ] - parameters.del);
+              currentMax = psgl_max (currentMax, matrix[i & 1][ j - colBegin - graph.adjcny_in[k] ] - parameters.del);
             }
 
             //insertion edit
-            currentMax = psgl_max( currentMax, matrix[(i-1) & 1][j] - parameters.ins );
+            currentMax = psgl_max( currentMax, matrix[(i-1) & 1][j - colBegin] - parameters.ins );
 
-            matrix[i & 1][j] = currentMax;
+            matrix[i & 1][j - colBegin] = currentMax;
 
             bestScore = psgl_max (bestScore, currentMax);
 
@@ -117,6 +155,9 @@ namespace psgl
         bestScoreVector[readno].refColumnEnd = bestCol;
         bestScoreVector[readno].qryRowEnd = bestRow;
 
+        bestScoreVector[readno].cost.p1Cells = readLength * (colEnd - colBegin);
+        bestScoreVector[readno].cost.p1Time = omp_get_wtime() - time1;
+
       } // all reads done
     } //end of omp parallel
 
@@ -141,15 +182,29 @@ namespace psgl
    * @param[in]   parameters        input parameters
    * @param[out]  bestScoreVector   vector to keep value and location of best scores,
    *                                vector size is same as count of the reads
+   * @param[in]   windows           range of columns [begin, end) to align each read to, 
+   *                                ignoring edges to outside it. All columns if null
    * @note                          reverse complement of the read is not handled here
    */
+  template <typename Graph>
   void alignToDAGLocal_Phase1_rev_scalar( const std::vector<std::string> &readSet,
-                                          const CSR_char_container &graph,
+                                          const Graph &graph,
                                           const Parameters &parameters, 
-                                          std::vector< BestScoreInfo > &bestScoreVector)
+                                          std::vector< BestScoreInfo > &bestScoreVector,
+                                          const std::vector< std::pair<int64_t, int64_t> > *windows = nullptr)
   {
     assert (bestScoreVector.size() == readSet.size());
 
+    //DP rows span the widest window
+    int64_t width = graph.numVertices;
+
+    if (windows)
+    {
+      width = 0;
+      for (auto &w : *windows)
+        width = std::max (width, w.second - w.first);
+    }
+
 #ifdef VTUNE_SUPPORT
     __itt_resume();
 #endif
@@ -161,24 +216,51 @@ namespace psgl
 
       //initialize matrix of size 2 x width, init with zero
       //we will keep re-using rows to keep memory-usage low
-      std::vector< std::vector<int32_t> > matrix(2, std::vector<int32_t>(graph.numVertices, 0));
+      std::vector< std::vector<int32_t> > matrix(2, std::vector<int32_t>(width, 0));
 
 #pragma omp for schedule(dynamic)
       for (size_t readno = 0; readno < readSet.size(); readno++)
       {
+        auto time1 = omp_get_wtime();
+        bestScoreVector[readno].cost.p1rStart = time1;
+
+        //columns to align to, matrix is indexed by offset from colBegin
+        const int64_t colBegin = windows ? (*windows)[readno].first : 0;
+        const int64_t colEnd = windows ? (*windows)[readno].second : graph.numVertices;
+
         //reset buffer
-        std::fill(matrix[1].begin(), matrix[1].end(), 0);
+        std::fill(matrix[1].begin(), matrix[1].begin() + (colEnd - colBegin), 0);
 
         auto readLength = readSet[readno].length();
 
         int32_t bestScore = 0;
-        int32_t bestRow = 0, bestCol = 0;
+        int32_t bestRow = 0;
+        int64_t bestCol = 0;
+
+        const bool validate = parameters.validateRead (readno);
+
+        //reads exceeding cell budget are not aligned further
+        if (bestScoreVector[readno].score > 0 && parameters.overBudget ((int64_t) readLength * (colEnd - colBegin)))
+        {
+          bestScoreVector[readno].overrun = "cell budget exceeded in phase 1-R";
+          bestScoreVector[readno].refColumnStart = -1;
+          bestScoreVector[readno].qryRowStart = -1;
+          continue;
+        }
 
         //iterate over characters in read
         for (int32_t i = 0; i < readLength; i++)
         {
+          //check deadline once per row
+          if (bestScoreVector[readno].score > 0 && parameters.pastDeadline (omp_get_wtime() - time1))
+          {
+            bestScoreVector[readno].overrun = "deadline passed in phase 1-R";
+            bestScoreVector[readno].cost.p1rCells = (int64_t) i * (colEnd - colBegin);
+            break;
+          }
+
           //iterate over characters in reference graph
-          for (int32_t j = graph.numVertices - 1; j >= 0; j--)
+          for (int64_t j = colEnd - 1; j >= colBegin; j--)
           {
             //current reference character
             char curChar = graph.vertex_label[j];
@@ -193,18 +275,22 @@ namespace psgl
 
             for(auto k = graph.offsets_out[j]; k < graph.offsets_out[j+1]; k++)
             {
+              //ignore edges to outside the window
+              if (graph.adjcny_out[k] >= colEnd - j)
+                continue;
+
               //paths with match mismatch edit
-              currentMax = psgl_max (currentMax, matrix[(i-1) & 1][ graph.adjcny_out[k] ] + matchScore);
+              currentMax = psgl_max (currentMax, matrix[(i-1) & 1][ j - colBegin + graph.adjcny_out[k] ] + matchScore);
               //'& 1' is same as doing modulo 2
 
               //paths with deletion edit
-              currentMax = psgl_max (currentMax, matrix[i & 1][ graph.adjcny_out[k] ] - parameters.del);
+              currentMax = psgl_max (currentMax, matrix[i & 1][ j - colBegin + graph.adjcny_out[k] ] - parameters.del);
             }
 
             //insertion edit
-            currentMax = psgl_max( currentMax, matrix[(i-1) & 1][j] - parameters.ins );
+            currentMax = psgl_max( currentMax, matrix[(i-1) & 1][j - colBegin] - parameters.ins );
 
-            matrix[i & 1][j] = currentMax;
+            matrix[i & 1][j - colBegin] = currentMax;
 
             bestScore = psgl_max (bestScore, currentMax);
 
@@ -218,18 +304,33 @@ namespace psgl
             if (j == bestScoreVector[readno].refColumnEnd && (readLength - 1 - i) == bestScoreVector[readno].qryRowEnd)
             {
               //local alignment needs to end with a match
-              assert (currentMax == parameters.match);
+              if (validate && currentMax != parameters.match)
+                bestScoreVector[readno].invalid = "phase 1 alignment does not end with a match";
 
               //add one so that the other end of the optimal alignment can be located without ambuiguity
-              matrix[i & 1][j] = parameters.match + 1;
+              matrix[i & 1][j - colBegin] = parameters.match + 1;
             }
           } // end of row computation
         } // end of DP
 
-        assert (bestScoreVector[readno].score == bestScore - 1);    //offset by 1
+        if (bestScoreVector[readno].overrun)
+        {
+          bestScoreVector[readno].refColumnStart = -1;
+          bestScoreVector[readno].qryRowStart = -1;
+          bestScoreVector[readno].cost.p1rTime = omp_get_wtime() - time1;
+          continue;
+        }
+
+        //reverse DP should reproduce the best score, offset by 1
+        if (validate && bestScoreVector[readno].score != bestScore - 1 && !bestScoreVector[readno].invalid)
+          bestScoreVector[readno].invalid = "best score of phase 1-R differs from phase 1";
+
         bestScoreVector[readno].refColumnStart = bestCol;
         bestScoreVector[readno].qryRowStart = bestRow;
 
+        bestScoreVector[readno].cost.p1rCells = readLength * (colEnd - colBegin);
+        bestScoreVector[readno].cost.p1rTime = omp_get_wtime() - time1;
+
       } // all reads done
     } //end of omp parallel
 
@@ -250,13 +351,16 @@ namespace psgl
    * @param[in]   graph
    * @param[in]   parameters        input parameters
    * @param[in]   bestScoreVector   best score and alignment location for each read
+   * @param[in]   coverage          counts aligned bases per column during traceback, if not null
    * @note                          we assume that query sequences are oriented properly
    *                                after executing the alignment phase 1
    */
+  template <typename Graph>
   void alignToDAGLocal_Phase2(  const std::vector<std::string> &readSet,
-                                const CSR_char_container &graph,
+                                const Graph &graph,
                                 const Parameters &parameters, 
-                                std::vector< BestScoreInfo > &bestScoreVector)
+                                std::vector< BestScoreInfo > &bestScoreVector,
+                                CoverageCounter *coverage = nullptr)
   {
     assert (bestScoreVector.size() == readSet.size());
 
@@ -266,9 +370,36 @@ namespace psgl
     {
       threadTimings[omp_get_thread_num()] = omp_get_wtime();
 
+      //columns of each operation of current read
+      std::vector<int64_t> pathColumns;
+
+      const bool keepColumns = coverage || parameters.keepColumns || !parameters.samFile.empty();
+
 #pragma omp for schedule(dynamic) nowait
       for (size_t readno = 0; readno < readSet.size(); readno++)
       {
+        //nothing to trace back for unaligned reads, or if phase 1-R did not locate the begin
+        if (bestScoreVector[readno].score == 0 || bestScoreVector[readno].invalid || bestScoreVector[readno].overrun)
+          continue;
+
+        const bool validate = parameters.validateRead (readno);
+
+        auto time1 = omp_get_wtime();
+
+        //save the first failed check
+        auto markInvalid = [&](const char *check) {
+          if (!bestScoreVector[readno].invalid)
+            bestScoreVector[readno].invalid = check;
+        };
+
+        //deadline covers phase 1-R and 2 of the read, including the wait between them
+        auto pastDeadline = [&]() {
+          if (parameters.pastDeadline (omp_get_wtime() - bestScoreVector[readno].cost.p1rStart))
+            bestScoreVector[readno].overrun = "deadline passed in phase 2";
+
+          return bestScoreVector[readno].overrun != nullptr;
+        };
+
         //for time profiling within phase 2
         uint64_t time_p2_1, time_p2_2;
 
@@ -302,8 +433,17 @@ namespace psgl
         std::cout << "INFO, psgl::alignToDAGLocal_Phase2, aligning read #" << readno + 1 << ", memory requested= " << reducedWidth * reducedHeight << " bytes" << std::endl;
 #endif
 
+        //reads exceeding cell budget keep their score and locations, without cigar
+        if (parameters.overBudget (bestScoreVector[readno].cost.p1rCells + (int64_t) (reducedWidth * reducedHeight)))
+        {
+          bestScoreVector[readno].overrun = "cell budget exceeded in phase 2";
+          continue;
+        }
+
         std::vector< std::vector<int8_t> > completeMatrixLog(reducedHeight, std::vector<int8_t>(reducedWidth, 0));
 
+        bestScoreVector[readno].cost.p2Cells = reducedWidth * reducedHeight;
+
         {
           auto tick1 = __rdtsc();
 
@@ -313,6 +453,13 @@ namespace psgl
           //iterate over characters in read
           for (std::size_t i = 0; i < reducedHeight; i++)
           {
+            //check deadline once per row
+            if (pastDeadline())
+            {
+              bestScoreVector[readno].cost.p2Cells = i * reducedWidth;
+              break;
+            }
+
             //iterate over characters in reference graph
             for (std::size_t j = 0; j < reducedWidth; j++)
             {
@@ -333,10 +480,10 @@ namespace psgl
               for(auto k = graph.offsets_in[j + j0]; k < graph.offsets_in[j + j0 + 1]; k++)
               {
                 //ignore edges outside the range 
-                if ( graph.adjcny_in[k] >= j0)
+                if ( graph.adjcny_in[k] <= j)
                 {
-                  fromMatch = psgl_max (fromMatch, matrix[(i-1) & 1][ graph.adjcny_in[k] - j0] + matchScore);
-                  fromDeletion = psgl_max (fromDeletion, matrix[i & 1][ graph.adjcny_in[k] - j0] - parameters.del);
+                  fromMatch = psgl_max (fromMatch, matrix[(i-1) & 1][ j - graph.adjcny_in[k] ] + matchScore);
+                  fromDeletion = psgl_max (fromDeletion, matrix[i & 1][ j - graph.adjcny_in[k] ] - parameters.del);
                 }
               }
 
@@ -352,11 +499,15 @@ namespace psgl
               finalRow = matrix[i & 1];
           }
 
-          int32_t bestScoreReComputed = *std::max_element(finalRow.begin(), finalRow.end());
-
           //the recomputed score and its location should match our original calculation
-          assert( bestScoreReComputed == bestScoreVector[readno].score );
-          assert( bestScoreReComputed == finalRow[ bestScoreVector[readno].refColumnEnd - j0 ] );
+          if (validate && !bestScoreVector[readno].overrun)
+          {
+            int32_t bestScoreReComputed = *std::max_element(finalRow.begin(), finalRow.end());
+
+            if (bestScoreReComputed != bestScoreVector[readno].score || 
+                bestScoreReComputed != finalRow[ bestScoreVector[readno].refColumnEnd - j0 ])
+              markInvalid ("recomputed best score differs from phase 1");
+          }
 
           auto tick2 = __rdtsc();
           time_p2_1 = tick2 - tick1;
@@ -374,14 +525,20 @@ namespace psgl
           std::vector<int32_t> currentRowScores = finalRow; 
           std::vector<int32_t> aboveRowScores (reducedWidth);
 
-          int col = reducedWidth - 1;
+          int64_t col = reducedWidth - 1;
           int row = reducedHeight - 1;
 
-          while (col >= 0 && row >= 0)
+          pathColumns.clear();
+
+          while (col >= 0 && row >= 0 && !bestScoreVector[readno].overrun)
           {
             if (currentRowScores[col] <= 0)
               break;
 
+            //check deadline once per traceback step, each step restores a row
+            if (pastDeadline())
+              break;
+
             //retrieve score values from vertical score differences
             for(std::size_t i = 0; i < reducedWidth; i++)
               aboveRowScores[i] = currentRowScores[i] - completeMatrixLog[row][i]; 
@@ -404,9 +561,9 @@ namespace psgl
 
             for(auto k = graph.offsets_in[col + j0]; k < graph.offsets_in[col + j0 + 1]; k++)
             {
-              if ( graph.adjcny_in[k] >= j0)
+              if ( graph.adjcny_in[k] <= col)
               {
-                auto fromCol = graph.adjcny_in[k] - j0;
+                auto fromCol = col - graph.adjcny_in[k];
 
                 if (fromMatch < aboveRowScores[fromCol] + matchScore)
                 {
@@ -431,6 +588,9 @@ namespace psgl
                 else
                   cigar.push_back('X');
 
+                if (keepColumns)
+                  pathColumns.push_back (col + j0);
+
                 //if alignment starts from this column, stop
                 if (fromMatchPos == col)
                   break;
@@ -445,15 +605,22 @@ namespace psgl
               {
                 cigar.push_back('D');
 
+                if (keepColumns)
+                  pathColumns.push_back (col + j0);
+
                 //shift to preceeding column
                 col = fromDeletionPos;
               }
               else 
               {
-                assert(currentRowScores[col] == fromInsertion);
+                if (validate && currentRowScores[col] != fromInsertion)
+                  markInvalid ("traceback found no edit yielding the cell score");
 
                 cigar.push_back('I');
 
+                if (keepColumns)
+                  pathColumns.push_back (col + j0);
+
                 //shift to above row
                 row--; currentRowScores = aboveRowScores;
               }
@@ -462,12 +629,26 @@ namespace psgl
 
           //string reverse 
           std::reverse (cigar.begin(), cigar.end());  
+          std::reverse (pathColumns.begin(), pathColumns.end());  
+
+          //count matches and mismatches of a complete alignment
+          if (coverage && !bestScoreVector[readno].overrun)
+            for (std::size_t k = 0; k < cigar.size(); k++)
+              if (cigar[k] == '=' || cigar[k] == 'X')
+                coverage->add (pathColumns[k]);
 
           //shorten the cigar string
           psgl::seqUtils::cigarCompact(cigar);
 
+          //cigar is incomplete if deadline has passed
+          if (bestScoreVector[readno].overrun)
+            cigar.clear();
+          else if (parameters.keepColumns || !parameters.samFile.empty())
+            bestScoreVector[readno].columns = pathColumns;
+
           //validate if cigar yields best score
-          assert ( psgl::seqUtils::cigarScore (cigar, parameters) ==  bestScoreVector[readno].score );
+          if (validate && !bestScoreVector[readno].overrun && psgl::seqUtils::cigarScore (cigar, parameters) != bestScoreVector[readno].score)
+            markInvalid ("score of cigar differs from best score");
 
           bestScoreVector[readno].cigar = cigar;
 
@@ -475,6 +656,8 @@ namespace psgl
           time_p2_2 = tick2 - tick1;
         }
 
+        bestScoreVector[readno].cost.p2Time = omp_get_wtime() - time1;
+
 #ifdef DEBUG
         std::cout << "INFO, psgl::alignToDAGLocal_Phase2, aligning read #" << readno + 1 << ", len = " << readLength << ", score " << bestScoreVector[readno].score << ", strand " << bestScoreVector[readno].strand << "\n";
         std::cout << "INFO, psgl::alignToDAGLocal_Phase2, cigar: " << bestScoreVector[readno].cigar << "\n";
@@ -496,11 +679,19 @@ namespace psgl
    * @param[in]   graph                   node-labeled directed graph 
    * @param[in]   parameters              input parameters
    * @param[out]  outputBestScoreVector
+   * @param[in]   coverage                counts aligned bases per column, if not null
+   * @param[in]   windows                 range of columns [begin, end) to align each read to, if not null.
+   *                                      Phase 1 and 1-R of windows run in scalar mode, as each read has its 
+   *                                      own range. Alignments scoring below the confidence threshold of 
+   *                                      paired reads are reported unaligned, see alignPairsToDAG
    */
+  template <typename Graph>
   void alignToDAGLocal( const std::vector<std::string> &readSet,
-      const CSR_char_container &graph,
+      const Graph &graph,
       const Parameters &parameters, 
-      std::vector< BestScoreInfo > &outputBestScoreVector)
+      std::vector< BestScoreInfo > &outputBestScoreVector,
+      CoverageCounter *coverage = nullptr,
+      const std::vector< std::pair<int64_t, int64_t> > *windows = nullptr)
   {
     //create buffer to save best score info for each read and its rev. complement
     std::vector< BestScoreInfo > bestScoreVector_P1 (2 * readSet.size() );
@@ -536,33 +727,39 @@ namespace psgl
       assert (bestScoreVector_P1.size() == 2 * readSet.size() );
       assert (readSet_P1.size() == 2 * readSet.size() );
 
-      //align read to ref.
-#if defined(PASGAL_ENABLE_AVX512) || defined(PASGAL_ENABLE_AVX2)
+      //both strands of a read share its window
+      std::vector< std::pair<int64_t, int64_t> > windows_P1;
 
-      //there would be few padded characters at the end of qry seq
-      //take that into account when computing max. read length
-      auto blockHeight = Phase1_Vectorized< SimdInst<int8_t> >::blockHeight;
-      maxReadLength += blockHeight - 1 - (maxReadLength - 1) % blockHeight; 
+      if (windows)
+        for (auto &w : *windows)
+          windows_P1.insert (windows_P1.end(), 2, w);
 
-      //decide precision by looking at maximum score possible
-      if (maxReadLength * parameters.match <= INT8_MAX) 
-      {
-        Phase1_Vectorized< SimdInst<int8_t> > obj (readSet_P1, graph, parameters); 
-        obj.alignToDAGLocal_Phase1_vectorized_wrapper(bestScoreVector_P1);
-      }
-      else if (maxReadLength * parameters.match <= INT16_MAX) 
-      {
-        Phase1_Vectorized< SimdInst<int16_t> > obj (readSet_P1, graph, parameters); 
-        obj.alignToDAGLocal_Phase1_vectorized_wrapper(bestScoreVector_P1);
-      }
-      else 
+      //align read to ref.
+#if defined(PASGAL_ENABLE_AVX512) || defined(PASGAL_ENABLE_AVX2)
+      if (!windows)
       {
-        Phase1_Vectorized< SimdInst<int32_t> > obj (readSet_P1, graph, parameters); 
-        obj.alignToDAGLocal_Phase1_vectorized_wrapper(bestScoreVector_P1);
+        //there would be few padded characters at the end of qry seq
+        //take that into account when computing max. read length
+        auto blockHeight = Phase1_Vectorized< SimdInst<int8_t> >::blockHeight;
+        maxReadLength += blockHeight - 1 - (maxReadLength - 1) % blockHeight; 
+
+        //decide precision by looking at maximum score possible
+        if (maxReadLength * parameters.match <= INT8_MAX) 
+        {
+          alignToDAGLocal_Phase1_vectorized< SimdInst<int8_t> > (readSet_P1, graph, parameters, bestScoreVector_P1);
+        }
+        else if (maxReadLength * parameters.match <= INT16_MAX) 
+        {
+          alignToDAGLocal_Phase1_vectorized< SimdInst<int16_t> > (readSet_P1, graph, parameters, bestScoreVector_P1);
+        }
+        else 
+        {
+          alignToDAGLocal_Phase1_vectorized< SimdInst<int32_t> > (readSet_P1, graph, parameters, bestScoreVector_P1);
+        }
       }
-#else
-      alignToDAGLocal_Phase1_scalar (readSet_P1, graph, parameters, bestScoreVector_P1);
+      else
 #endif
+        alignToDAGLocal_Phase1_scalar (readSet_P1, graph, parameters, bestScoreVector_P1, windows ? &windows_P1 : nullptr);
 
       auto tick2 = __rdtsc();
       std::cout << "TIMER, psgl::alignToDAG, CPU cycles spent in phase 1  = " << tick2 - tick1
@@ -592,6 +789,11 @@ namespace psgl
 
       for (size_t readno = 0; readno < readSet.size(); readno++)
       {
+        //phase 1 cost includes both strands
+        ReadCost cost;
+        cost.p1Cells = bestScoreVector_P1[2 * readno].cost.p1Cells + bestScoreVector_P1[2 * readno + 1].cost.p1Cells;
+        cost.p1Time = bestScoreVector_P1[2 * readno].cost.p1Time + bestScoreVector_P1[2 * readno + 1].cost.p1Time;
+
         if (bestScoreVector_P1[2 * readno].score > bestScoreVector_P1[2 * readno + 1].score)
         {
           outputBestScoreVector.push_back (bestScoreVector_P1[2 * readno]);
@@ -612,6 +814,11 @@ namespace psgl
         }
 
         outputBestScoreVector[readno].qryId = readno;
+        outputBestScoreVector[readno].cost = cost;
+
+        //alignments within a window should be confident, or are left to the caller
+        if (windows && !parameters.confidentScore (outputBestScoreVector[readno].score, readSet[readno].length()))
+          outputBestScoreVector[readno].score = 0;
 
         if (readSet[readno].length() > maxReadLength)
           maxReadLength = readSet[readno].length();
@@ -622,32 +829,31 @@ namespace psgl
 
       //align reverse read to ref.
 #if defined(PASGAL_ENABLE_AVX512) || defined(PASGAL_ENABLE_AVX2)
-
-      //there would be few padded characters at the end of qry seq
-      //take that into account when computing max. read length
-      auto blockHeight = Phase1_Rev_Vectorized< SimdInst<int8_t> >::blockHeight;
-      maxReadLength += blockHeight - 1 - (maxReadLength - 1) % blockHeight; 
-
-      //decide precision by looking at maximum score possible
-      //offset by 1 because we augment the score by 1 during rev. DP
-      if (maxReadLength * parameters.match <= INT8_MAX - 1) 
-      {
-        Phase1_Rev_Vectorized< SimdInst<int8_t> > obj (readSet_P1_R, graph, parameters); 
-        obj.alignToDAGLocal_Phase1_rev_vectorized_wrapper(outputBestScoreVector);
-      }
-      else if (maxReadLength * parameters.match <= INT16_MAX - 1) 
-      {
-        Phase1_Rev_Vectorized< SimdInst<int16_t> > obj (readSet_P1_R, graph, parameters); 
-        obj.alignToDAGLocal_Phase1_rev_vectorized_wrapper(outputBestScoreVector);
-      }
-      else 
+      if (!windows)
       {
-        Phase1_Rev_Vectorized< SimdInst<int32_t> > obj (readSet_P1_R, graph, parameters); 
-        obj.alignToDAGLocal_Phase1_rev_vectorized_wrapper(outputBestScoreVector);
+        //there would be few padded characters at the end of qry seq
+        //take that into account when computing max. read length
+        auto blockHeight = Phase1_Rev_Vectorized< SimdInst<int8_t> >::blockHeight;
+        maxReadLength += blockHeight - 1 - (maxReadLength - 1) % blockHeight; 
+
+        //decide precision by looking at maximum score possible
+        //offset by 1 because we augment the score by 1 during rev. DP
+        if (maxReadLength * parameters.match <= INT8_MAX - 1) 
+        {
+          alignToDAGLocal_Phase1_rev_vectorized< SimdInst<int8_t> > (readSet_P1_R, graph, parameters, outputBestScoreVector);
+        }
+        else if (maxReadLength * parameters.match <= INT16_MAX - 1) 
+        {
+          alignToDAGLocal_Phase1_rev_vectorized< SimdInst<int16_t> > (readSet_P1_R, graph, parameters, outputBestScoreVector);
+        }
+        else 
+        {
+          alignToDAGLocal_Phase1_rev_vectorized< SimdInst<int32_t> > (readSet_P1_R, graph, parameters, outputBestScoreVector);
+        }
       }
-#else
-      alignToDAGLocal_Phase1_rev_scalar (readSet_P1_R, graph, parameters, outputBestScoreVector);
+      else
 #endif
+        alignToDAGLocal_Phase1_rev_scalar (readSet_P1_R, graph, parameters, outputBestScoreVector, windows);
 
       auto tick2 = __rdtsc();
       std::cout << "TIMER, psgl::alignToDAG, CPU cycles spent in phase 1-R  = " << tick2 - tick1
@@ -685,12 +891,27 @@ namespace psgl
 
       assert (readSet_P2.size() == readSet.size() );
 
-      alignToDAGLocal_Phase2 (readSet_P2, graph, parameters, outputBestScoreVector);
+      alignToDAGLocal_Phase2 (readSet_P2, graph, parameters, outputBestScoreVector, coverage);
 
       auto tick2 = __rdtsc();
       std::cout << "TIMER, psgl::alignToDAG, CPU cycles spent in phase 2  = " << tick2 - tick1
         << ", estimated time (s) = " << (tick2 - tick1) * 1.0 / ASSUMED_CPU_FREQ << "\n";
     }
+
+    //reads exceeding cell budget or deadline are reported as timed out, without alignment
+    if (parameters.overrun == OVERRUN_TIMEOUT)
+    {
+      for (auto &e : outputBestScoreVector)
+      {
+        if (e.overrun)
+        {
+          e.score = 0;
+          e.qryRowStart = e.qryRowEnd = -1;
+          e.refColumnStart = e.refColumnEnd = -1;
+          e.cigar.clear();
+        }
+      }
+    }
   }
 
   /**
@@ -700,24 +921,352 @@ namespace psgl
    * @param[in]   parameters                input parameters
    * @param[in]   mode                      alignment mode
    * @param[out]  outputBestScoreVector
+   * @param[in]   coverage                  counts aligned bases per column, if not null
+   * @param[in]   windows                   range of columns to align each read to, if not null
    */
+  template <typename Graph>
     void alignToDAG(  const std::vector<std::string> &reads, 
-                      const CSR_char_container &graph,
+                      const Graph &graph,
                       const Parameters &parameters, 
                       const MODE mode,
-                      std::vector< BestScoreInfo > &outputBestScoreVector)
+                      std::vector< BestScoreInfo > &outputBestScoreVector,
+                      CoverageCounter *coverage = nullptr,
+                      const std::vector< std::pair<int64_t, int64_t> > *windows = nullptr)
     {
       //TODO: Support other alignment modes: global and semi-global
       switch(mode)
       {
-        case LOCAL : alignToDAGLocal (reads, graph, parameters, outputBestScoreVector); break;
+        case LOCAL : alignToDAGLocal (reads, graph, parameters, outputBestScoreVector, coverage, windows); break;
         default: std::cerr << "ERROR, psgl::alignToDAG, Invalid alignment mode"; exit(1);
       }
     }
 
+  /**
+   * @brief                                 alignment routine for paired reads
+   * @details                               first mates are aligned to the complete graph. The second
+   *                                        mate of a confidently aligned first mate is aligned only 
+   *                                        within the columns implied by the insert size (see mateWindow), 
+   *                                        and to the complete graph if it does not align concordantly 
+   *                                        there. Other second mates are aligned to the complete graph, 
+   *                                        and are charged with the cost of a failed rescue. Confident
+   *                                        first mates discordant with a confident second mate are then
+   *                                        rescued within the window of the second mate. Columns of both
+   *                                        strands of a bi-directed graph are not in genomic order, so 
+   *                                        all mates are aligned to the complete graph there
+   * @param[in]   reads                     mates of each pair one after another
+   * @param[in]   graph
+   * @param[in]   parameters                input parameters
+   * @param[in]   mode                      alignment mode
+   * @param[in/out] insert                  insert size, mates are not rescued if unknown
+   * @param[out]  outputBestScoreVector     results of all mates, in input order
+   * @param[in]   coverage                  counts aligned bases of the final alignment of each mate, 
+   *                                        rather than of each attempt, if not null
+   * @param[in]   estimate                  if insert size is unknown, estimate it from the first 
+   *                                        pairs (see insertSamplePairs), whose second mates are 
+   *                                        aligned to the complete graph, and rescue mates of the
+   *                                        remaining pairs with it
+   * @return                                count of mates rescued within windows
+   */
+  template <typename Graph>
+    std::size_t alignPairsToDAG( const std::vector<std::string> &reads, 
+                                 const Graph &graph,
+                                 const Parameters &parameters, 
+                                 const MODE mode,
+                                 InsertSize &insert,
+                                 std::vector< BestScoreInfo > &outputBestScoreVector,
+                                 CoverageCounter *coverage = nullptr,
+                                 bool estimate = false)
+    {
+      if (reads.size() % 2 != 0)
+      {
+        std::cerr << "ERROR, psgl::alignPairsToDAG, odd count of mates " << reads.size() << std::endl;
+        exit(1);
+      }
+
+      assert (outputBestScoreVector.empty());
+
+      const std::size_t pairs = reads.size() / 2;
+      const bool windowed = graph.strandVertices == 0;
+
+      //a mate may be aligned more than once, so coverage is counted from the traced
+      //columns of its final alignment
+      Parameters mateParameters (parameters);
+      mateParameters.keepColumns = coverage != nullptr;
+
+      std::vector<std::string> mates;
+      std::vector< BestScoreInfo > first, second (pairs);
+
+      for (std::size_t k = 0; k < pairs; k++)
+        mates.push_back (reads[2 * k]);
+
+      alignToDAG (mates, graph, mateParameters, mode, first);
+
+      //align first (mate = 0) or second (mate = 1) mates of the given pairs
+      std::vector< BestScoreInfo > mateBestScoreVector;
+
+      auto alignMates = [&](const std::vector<std::size_t> &ids, int mate, const std::vector< std::pair<int64_t, int64_t> > *w) {
+        mates.clear();
+        mateBestScoreVector.clear();
+
+        for (auto k : ids)
+          mates.push_back (reads[2 * k + mate]);
+
+        if (!mates.empty())
+          alignToDAG (mates, graph, mateParameters, mode, mateBestScoreVector, nullptr, w);
+      };
+
+      //add cost of a failed rescue
+      auto charge = [](BestScoreInfo &e, const ReadCost &failed) {
+        e.cost.p1Cells += failed.p1Cells;
+        e.cost.p1Time += failed.p1Time;
+        e.cost.p1rCells += failed.p1rCells;
+        e.cost.p1rTime += failed.p1rTime;
+      };
+
+      //pairs whose second mate is rescued within a window, or aligned to complete graph
+      std::vector<std::size_t> rescue, sweep;
+      std::vector< std::pair<int64_t, int64_t> > windows;
+
+      //second mates of the pairs sampled for insert size are aligned to complete graph
+      std::size_t sampled = 0;
+
+      if (estimate && windowed && !insert.known())
+      {
+        sampled = std::min (insertSamplePairs, pairs);
+
+        for (std::size_t k = 0; k < sampled; k++)
+          sweep.push_back (k);
+
+        alignMates (sweep, 1, nullptr);
+
+        std::vector<int64_t> spans;
+
+        for (std::size_t k = 0; k < sampled; k++)
+        {
+          second[k] = std::move (mateBestScoreVector[k]);
+
+          auto span = pairSpan (parameters, first[k], reads[2 * k].length(), second[k], reads[2 * k + 1].length());
+
+          if (span > 0)
+            spans.push_back (span);
+        }
+
+        insert = estimateInsertSize (spans);
+
+        if (insert.known())
+          std::cout << "INFO, psgl::alignPairsToDAG, insert size mean = " << insert.mean << ", std. dev. = " << insert.stdDev 
+            << ", estimated from pairs = " << insert.pairs << ", widest span = " << insert.maxSpan() << std::endl;
+        else
+          std::cerr << "WARNING, psgl::alignPairsToDAG, too few concordant pairs to estimate insert size, second mates are aligned to complete graph" << std::endl;
+
+        sweep.clear();
+      }
+
+      for (std::size_t k = sampled; k < pairs; k++)
+      {
+        if (windowed && insert.known() && first[k].refColumnStart >= 0 && parameters.confidentScore (first[k].score, reads[2 * k].length()))
+        {
+          rescue.push_back (k);
+          windows.push_back (mateWindow (first[k], reads[2 * k + 1].length(), insert, graph.numVertices));
+        }
+        else
+          sweep.push_back (k);
+      }
+
+      alignMates (rescue, 1, &windows);
+
+      std::size_t rescuedSecond = 0, rescuedFirst = 0;
+
+      for (std::size_t i = 0; i < rescue.size(); i++)
+      {
+        auto k = rescue[i];
+        second[k] = std::move (mateBestScoreVector[i]);
+
+        if (concordant (parameters, insert, first[k], reads[2 * k].length(), second[k], reads[2 * k + 1].length()))
+          rescuedSecond++;
+        else
+          sweep.push_back (k);
+      }
+
+      std::sort (sweep.begin(), sweep.end());
+
+      alignMates (sweep, 1, nullptr);
+
+      for (std::size_t i = 0; i < sweep.size(); i++)
+      {
+        auto failed = second[sweep[i]].cost;
+
+        second[sweep[i]] = std::move (mateBestScoreVector[i]);
+        charge (second[sweep[i]], failed);
+      }
+
+      //first mates are rescued within the window of a confident second mate if not concordant 
+      //with it. Unconfident first mates are not, as their score on the complete graph bounds
+      //their score within a window
+      rescue.clear();
+      windows.clear();
+
+      for (std::size_t k = 0; k < pairs && windowed && insert.known(); k++)
+      {
+        auto len1 = reads[2 * k].length(), len2 = reads[2 * k + 1].length();
+
+        if (second[k].refColumnStart >= 0 && parameters.confidentScore (first[k].score, len1) && parameters.confidentScore (second[k].score, len2)
+            && !concordant (parameters, insert, first[k], len1, second[k], len2))
+        {
+          rescue.push_back (k);
+          windows.push_back (mateWindow (second[k], len1, insert, graph.numVertices));
+        }
+      }
+
+      alignMates (rescue, 0, &windows);
+
+      for (std::size_t i = 0; i < rescue.size(); i++)
+      {
+        auto k = rescue[i];
+        auto &e = mateBestScoreVector[i];
+
+        if (concordant (parameters, insert, e, reads[2 * k].length(), second[k], reads[2 * k + 1].length()))
+        {
+          charge (e, first[k].cost);
+          first[k] = std::move (e);
+          rescuedFirst++;
+        }
+        else
+          charge (first[k], e.cost);
+      }
+
+      if (coverage)
+      {
+        for (std::size_t k = 0; k < pairs; k++)
+          for (auto e : {&first[k], &second[k]})
+          {
+            coverage->add (*e);
+
+            if (parameters.samFile.empty())
+              std::vector<int64_t>().swap (e->columns);
+          }
+      }
+
+      for (std::size_t k = 0; k < pairs; k++)
+      {
+        outputBestScoreVector.push_back (std::move (first[k]));
+        outputBestScoreVector.back().qryId = 2 * k;
+
+        outputBestScoreVector.push_back (std::move (second[k]));
+        outputBestScoreVector.back().qryId = 2 * k + 1;
+      }
+
+      std::cout << "INFO, psgl::alignPairsToDAG, pairs = " << pairs << ", second mates rescued within windows = " << rescuedSecond 
+        << ", aligned to complete graph = " << sweep.size() << ", first mates rescued within windows = " << rescuedFirst << std::endl;
+
+      return rescuedSecond + rescuedFirst;
+    }
+
+  /**
+   * @brief                                 print input vertex and offset of a column, e.g., "(s1+, 3)"
+   * @details                               vertices of GFA input are printed with their segment names
+   */
+  template <typename Graph>
+    std::ostream& printVertex ( std::ostream &outstrm, const Graph &graph, int64_t col)
+    {
+      auto v = graph.outputVertexId (col);
+
+      outstrm << "(" << graph.outputVertexName (v.id);
+      if (v.orientation)
+        outstrm << v.orientation;
+      outstrm << ", " << v.offset << ")";
+
+      return outstrm;
+    }
+
+  /**
+   * @brief                                 print alignment results of reads in range [from, to) to stream
+   * @param[in]   outstrm                   output stream
+   * @param[in]   qmetadata                 query sequence names and lengths
+   * @param[in]   graph
+   * @param[in]   outputBestScoreVector
+   * @param[in]   from
+   * @param[in]   to
+   * @param[in]   printCosts                append DP cells and time of each phase
+   * @details                               unknown locations and cigar of reads exceeding cell 
+   *                                        budget or deadline are printed as '*'
+   */
+  template <typename Graph>
+    void printResultsToFile ( std::ostream &outstrm,
+        const std::vector<ContigInfo> &qmetadata,
+        const Graph &graph,
+        const std::vector< BestScoreInfo > &outputBestScoreVector,
+        std::size_t from, std::size_t to,
+        bool printCosts = false)
+    {
+      assert(from <= to && to <= outputBestScoreVector.size());
+
+      for(auto i = from; i < to; i++)
+      {
+        auto &e = outputBestScoreVector[i];
+        assert(e.qryId < qmetadata.size());
+
+        outstrm << qmetadata[e.qryId].name << "\t" 
+          << qmetadata[e.qryId].len << "\t";
+
+        if (e.qryRowStart >= 0)
+          outstrm << e.qryRowStart << "\t";
+        else
+          outstrm << "*\t";
+
+        if (e.qryRowEnd >= 0)
+          outstrm << e.qryRowEnd << "\t";
+        else
+          outstrm << "*\t";
+
+        outstrm << e.strand << "\t";
+
+        if (e.refColumnStart >= 0)
+          printVertex (outstrm, graph, e.refColumnStart) << "\t";
+        else
+          outstrm << "*\t";
+
+        if (e.refColumnEnd >= 0)
+          printVertex (outstrm, graph, e.refColumnEnd) << "\t";
+        else
+          outstrm << "*\t";
+
+        outstrm << e.score << "\t"
+          << (e.overrun ? "*" : e.cigar);
+
+        if (printCosts)
+          outstrm << "\t" << e.cost;
+
+        outstrm << "\n";
+      }
+    }
+
+  /**
+   * @brief                                 print alignment results of reads in range [from, to) to file
+   * @param[in]   ofile                     output file
+   * @param[in]   qmetadata                 query sequence names and lengths
+   * @param[in]   graph
+   * @param[in]   outputBestScoreVector
+   * @param[in]   from
+   * @param[in]   to
+   * @param[in]   printCosts                append DP cells and time of each phase
+   */
+  template <typename Graph>
+    void printResultsToFile ( const std::string &ofile,
+        const std::vector<ContigInfo> &qmetadata,
+        const Graph &graph,
+        const std::vector< BestScoreInfo > &outputBestScoreVector,
+        std::size_t from, std::size_t to,
+        bool printCosts = false)
+    {
+      std::ofstream outstrm(ofile);
+      printResultsToFile (outstrm, qmetadata, graph, outputBestScoreVector, from, to, printCosts);
+    }
+
     /**
-     * @brief                                 print alignment results to file
+     * @brief                                 print alignment results of all reads
      * @param[in]   parameters                input parameters
+     * @param[in]   qmetadata                 query sequence names and lengths
      * @param[in]   graph
      * @param[in]   outputBestScoreVector
      */
@@ -726,93 +1275,787 @@ namespace psgl
         const CSR_char_container &graph,
         const std::vector< BestScoreInfo > &outputBestScoreVector)
     {
-      std::ofstream outstrm(parameters.ofile);
+      printResultsToFile (parameters.ofile, qmetadata, graph, outputBestScoreVector, 0, outputBestScoreVector.size(), parameters.printCosts);
+    }
+
+    /**
+     * @brief                                 append query sequences from a fasta/fastq file
+     * @param[in]   qfile                     query file
+     * @param[out]  reads
+     * @param[out]  qmetadata                 query sequence names and lengths
+     * @param[in]   shardIndex                only read i with (i / groupSize % shardCount == shardIndex)
+     * @param[in]   shardCount                is appended
+     * @param[in]   groupSize                 count of consecutive reads kept in the same shard
+     */
+    void readQueryFile( const std::string &qfile,
+                        std::vector<std::string> &reads,
+                        std::vector<ContigInfo> &qmetadata,
+                        int shardIndex = 0, int shardCount = 1,
+                        int groupSize = 1)
+    {
+      if( !fileExists(qfile) )
+      {
+        std::cerr << qfile << " not accessible." << std::endl;
+        exit(1);
+      }
 
-      assert(qmetadata.size() == outputBestScoreVector.size());
+      //Open the file using kseq
+      FILE *file = fopen (qfile.c_str(), "r");
 
-      for(auto &e : outputBestScoreVector)
+      if (file == NULL)
       {
-        outstrm << qmetadata[e.qryId].name << "\t" 
-          << qmetadata[e.qryId].len << "\t"
-          << e.qryRowStart << "\t" 
-          << e.qryRowEnd << "\t"
-          << e.strand << "\t"
-          << graph.originalVertexId[e.refColumnStart] << "\t"
-          << graph.originalVertexId[e.refColumnEnd] << "\t"
-          << e.score << "\t"
-          << e.cigar << "\n";
+        std::cerr << "ERROR, psgl::readQueryFile, could not open " << qfile << std::endl;
+        exit(1);
       }
-    }
 
-  /**
-   * @brief                                 alignment routine
-   * @param[in]   parameters                input parameters
-   * @param[in]   mode                      alignment mode
-   * @param[out]  outputBestScoreVector
-   */
-    int alignToDAG( const Parameters &parameters, 
-                    const MODE mode,  
-                    std::vector< BestScoreInfo > &outputBestScoreVector)
-    {
-      psgl::graphLoader g;
+      gzFile fp = gzdopen (fileno(file), "r");
+      kseq_t *seq = kseq_init(fp);
 
-      //Parse all reads into a vector
-      std::vector<std::string> reads;
-      assert (outputBestScoreVector.empty());
+      //size of sequence
+      int len;
 
-      //read metadata
-      std::vector<ContigInfo> qmetadata; 
+      //index of current read in the file
+      std::size_t readIndex = 0;
 
+      while ((len = kseq_read(seq)) >= 0) 
       {
-        if (parameters.mode.compare("vg") == 0)
-          g.loadFromVG(parameters.rfile);
-        else if(parameters.mode.compare("txt") == 0)
-          g.loadFromTxt(parameters.rfile);
-        else 
+        if (readIndex++ / groupSize % shardCount != shardIndex)
+          continue;
+
+        psgl::seqUtils::makeUpperCase(seq->seq.s, len);
+        reads.push_back(seq->seq.s);
+
+        //record query name and length
+        qmetadata.push_back( ContigInfo{seq->name.s, (int32_t) seq->seq.l} );
+      }
+
+      //Close the input file
+      kseq_destroy(seq);  
+      gzclose(fp);
+      fclose(file);
+    }
+
+    /**
+     * @brief                                 append pairs of query sequences, with mates of each pair
+     *                                        one after another
+     * @param[in]   qfile                     query file of first mates, or of both mates if interleaved
+     * @param[in]   mateFile                  query file of second mates, empty if interleaved
+     * @param[out]  reads
+     * @param[out]  qmetadata                 query sequence names and lengths
+     * @param[in]   shardIndex                only pair i with (i % shardCount == shardIndex)
+     * @param[in]   shardCount                is appended
+     */
+    void readPairedQueryFiles( const std::string &qfile,
+                               const std::string &mateFile,
+                               std::vector<std::string> &reads,
+                               std::vector<ContigInfo> &qmetadata,
+                               int shardIndex = 0, int shardCount = 1)
+    {
+      auto from = reads.size();
+
+      if (mateFile.empty())
+      {
+        readQueryFile (qfile, reads, qmetadata, shardIndex, shardCount, 2);
+
+        if ((reads.size() - from) % 2 != 0)
         {
-          std::cerr << "Invalid format " << parameters.mode << std::endl;
+          std::cerr << "ERROR, psgl::readPairedQueryFiles, odd count of reads in interleaved file " << qfile << std::endl;
           exit(1);
         }
+
+        return;
+      }
+
+      std::vector<std::string> reads1, reads2;
+      std::vector<ContigInfo> qmetadata1, qmetadata2;
+
+      readQueryFile (qfile, reads1, qmetadata1, shardIndex, shardCount);
+      readQueryFile (mateFile, reads2, qmetadata2, shardIndex, shardCount);
+
+      if (reads1.size() != reads2.size())
+      {
+        std::cerr << "ERROR, psgl::readPairedQueryFiles, count of reads differs between " << qfile << " and " << mateFile << std::endl;
+        exit(1);
+      }
+
+      for (std::size_t i = 0; i < reads1.size(); i++)
+      {
+        reads.push_back (std::move (reads1[i]));
+        reads.push_back (std::move (reads2[i]));
+        qmetadata.push_back (qmetadata1[i]);
+        qmetadata.push_back (qmetadata2[i]);
       }
+    }
+
+    /**
+     * @brief                                 sample read lengths of all query files for the run planner
+     * @details                               used by dry runs, which do not load the reads
+     * @param[in]   parameters                input parameters
+     * @param[out]  sample                    lengths of all reads, and the first reads
+     * @param[in]   count                     count of first reads to save
+     */
+    void sampleReads( const Parameters &parameters, 
+                      ReadSample &sample,
+                      std::size_t count)
+    {
+      std::vector<std::string> files;
+
+      for (auto &s : parameters.sampleFiles())
+        files.push_back (s.first);
+
+      //second mates are aligned as reads too
+      if (!parameters.mateFile.empty())
+        files.push_back (parameters.mateFile);
 
+      for (auto &f : files)
       {
-        //TODO: Read query sequences in batches rather than all at once
-        if( !fileExists(parameters.qfile) )
+        if( !fileExists(f) )
+        {
+          std::cerr << f << " not accessible." << std::endl;
+          exit(1);
+        }
+
+        FILE *file = fopen (f.c_str(), "r");
+
+        if (file == NULL)
         {
-          std::cerr << parameters.qfile << " not accessible." << std::endl;
+          std::cerr << "ERROR, psgl::sampleReads, could not open " << f << std::endl;
           exit(1);
         }
 
-        //Open the file using kseq
-        FILE *file = fopen (parameters.qfile.c_str(), "r");
-        assert(file != NULL);
         gzFile fp = gzdopen (fileno(file), "r");
         kseq_t *seq = kseq_init(fp);
 
-        //size of sequence
         int len;
+        std::size_t readIndex = 0;
+
+        //mates of an interleaved pair are kept in the same shard, as in readPairedQueryFiles
+        const std::size_t groupSize = parameters.interleaved ? 2 : 1;
 
         while ((len = kseq_read(seq)) >= 0) 
         {
-          psgl::seqUtils::makeUpperCase(seq->seq.s, len);
-          reads.push_back(seq->seq.s);
+          if (readIndex++ / groupSize % parameters.shardCount != parameters.shardIndex)
+            continue;
 
-          //record query name and length
-          qmetadata.push_back( ContigInfo{seq->name.s, (int32_t) seq->seq.l} );
+          sample.lengths.push_back (len);
+
+          if (sample.reads.size() < count)
+          {
+            psgl::seqUtils::makeUpperCase(seq->seq.s, len);
+            sample.reads.push_back (seq->seq.s);
+          }
         }
 
-        //Close the input file
         kseq_destroy(seq);  
         gzclose(fp);
         fclose(file);
       }
+    }
+
+    /**
+     * @brief                                 sample read lengths of already loaded reads for the run planner
+     * @param[in]   reads
+     * @param[out]  sample                    lengths of all reads, and the first reads
+     * @param[in]   count                     count of first reads to save
+     */
+    void sampleReads( const std::vector<std::string> &reads,
+                      ReadSample &sample,
+                      std::size_t count)
+    {
+      sample.lengths.reserve (reads.size());
+
+      for (auto &r : reads)
+        sample.lengths.push_back (r.length());
+
+      sample.reads.assign (reads.begin(), reads.begin() + std::min (count, reads.size()));
+    }
+
+    /**
+     * @brief                                 read query files of all samples into a combined read set
+     * @param[in]   parameters                input parameters
+     * @param[out]  reads
+     * @param[out]  qmetadata
+     * @param[out]  sampleOffsets             offsets of each sample's reads in the combined read set
+     */
+    void readSamples( const Parameters &parameters,
+                      std::vector<std::string> &reads,
+                      std::vector<ContigInfo> &qmetadata,
+                      std::vector<std::size_t> &sampleOffsets)
+    {
+      sampleOffsets.assign (1, 0);
+
+      //TODO: Read query sequences in batches rather than all at once
+      for (auto &s : parameters.sampleFiles())
+      {
+        if (parameters.pairedInput())
+          readPairedQueryFiles (s.first, parameters.mateFile, reads, qmetadata, parameters.shardIndex, parameters.shardCount);
+        else
+          readQueryFile (s.first, reads, qmetadata, parameters.shardIndex, parameters.shardCount);
+
+        sampleOffsets.push_back (reads.size());
+      }
 
       std::cout << "INFO, psgl::alignToDAG, total count of reads = " << reads.size() << std::endl;
+    }
+
+    /**
+     * @brief                                 measure DP cells per second of a single thread
+     * @details                               first reads are truncated so that their scores fit
+     *                                        in int8, and aligned to the first graph columns. Phase 1 
+     *                                        is timed in each precision, and phase 1-R and 2 in the
+     *                                        precision chosen for the truncated reads
+     * @param[in]   parameters                input parameters
+     * @param[in]   graph
+     * @param[in]   sample                    first reads of the query files
+     * @return                                calibrated cell rates
+     */
+    CellRates calibrateCellRates( const Parameters &parameters, 
+                                  const CSR_char_container &graph,
+                                  const ReadSample &sample)
+    {
+      constexpr int64_t windowWidth = 1 << 14;
+      constexpr std::size_t readLength = 112;
+
+      CellRates rates;
+
+      if (sample.reads.empty())
+        return rates;
+
+      CSR_char_container window;
+      windowGraph (graph, windowWidth, window);
+
+      //fill all lanes of int8 SIMD batch
+      std::vector<std::string> reads;
+      for (std::size_t i = 0; reads.size() < (std::size_t) planRegBytes; i++)
+        reads.push_back (sample.reads[i % sample.reads.size()].substr (0, readLength));
+
+      Parameters p (parameters);
+      p.validation = VALIDATE_OFF;
+      p.componentKmer = 0;
+
+      auto rate = [](const std::vector<BestScoreInfo> &v, int64_t ReadCost::*cells, double ReadCost::*time) {
+        double c = 0, t = 0;
+
+        for (auto &e : v)
+        {
+          c += e.cost.*cells;
+          t += e.cost.*time;
+        }
+
+        return t > 0 ? c / t : 0;
+      };
+
+      omp_set_num_threads(1);
+
+#if defined(PASGAL_ENABLE_AVX512) || defined(PASGAL_ENABLE_AVX2)
+      {
+        std::vector<BestScoreInfo> v (reads.size());
+        alignToDAGLocal_Phase1_vectorized< SimdInst<int8_t> > (reads, window, p, v);
+        rates.p1[0] = rate (v, &ReadCost::p1Cells, &ReadCost::p1Time);
+      }
+      {
+        std::vector<BestScoreInfo> v (reads.size());
+        alignToDAGLocal_Phase1_vectorized< SimdInst<int16_t> > (reads, window, p, v);
+        rates.p1[1] = rate (v, &ReadCost::p1Cells, &ReadCost::p1Time);
+      }
+      {
+        std::vector<BestScoreInfo> v (reads.size());
+        alignToDAGLocal_Phase1_vectorized< SimdInst<int32_t> > (reads, window, p, v);
+        rates.p1[2] = rate (v, &ReadCost::p1Cells, &ReadCost::p1Time);
+      }
+#endif
+
+      {
+        std::vector<BestScoreInfo> v;
+        alignToDAGLocal (reads, window, p, v);
+
+#if !defined(PASGAL_ENABLE_AVX512) && !defined(PASGAL_ENABLE_AVX2)
+        rates.p1[0] = rates.p1[1] = rates.p1[2] = rate (v, &ReadCost::p1Cells, &ReadCost::p1Time);
+#endif
+        rates.p1r = rate (v, &ReadCost::p1rCells, &ReadCost::p1rTime);
+        rates.p2 = rate (v, &ReadCost::p2Cells, &ReadCost::p2Time);
+      }
+
+      omp_set_num_threads(parameters.threads);
+
+      std::cout << "INFO, psgl::calibrateCellRates, cells per second per thread, phase 1 (int8/int16/int32) = " 
+        << rates.p1[0] << "/" << rates.p1[1] << "/" << rates.p1[2] 
+        << ", phase 1-R = " << rates.p1r << ", phase 2 = " << rates.p2 << std::endl;
+
+      return rates;
+    }
+
+  /**
+   * @brief                                 align reads of all samples and print results
+   * @details                               reads of all samples are aligned together so
+   *                                        that their batches share the same parallel 
+   *                                        schedule. Results of each sample are written
+   *                                        to its own output file. A run resumed from a
+   *                                        journal aligns only reads of incomplete batches.
+   *                                        Paired reads are aligned with mate rescue, see
+   *                                        alignPairsToDAG
+   * @param[in]   parameters                input parameters
+   * @param[in]   reads                     reads of all samples, see readSamples
+   * @param[in]   qmetadata
+   * @param[in]   sampleOffsets             offsets of each sample's reads in the combined read set
+   * @param[in]   graph
+   * @param[in]   mode                      alignment mode
+   * @param[in/out]  metrics
+   * @param[out]  outputBestScoreVector     results of all samples aligned in this run, in input order,
+   *                                        empty unless parameters.keepResults is set
+   * @param[in]   pathIndex                 reference path for SAM/BAM output, if not null
+   */
+  template <typename Graph>
+    void alignSamples( const Parameters &parameters, 
+                       const std::vector<std::string> &reads,
+                       const std::vector<ContigInfo> &qmetadata,
+                       const std::vector<std::size_t> &sampleOffsets,
+                       const Graph &graph,
+                       const MODE mode,  
+                       RunMetrics &metrics,
+                       std::vector< BestScoreInfo > &outputBestScoreVector,
+                       const PathIndex *pathIndex = nullptr)
+    {
+      assert (outputBestScoreVector.empty());
+
+      //(query file, output file) pair of each sample
+      auto samples = parameters.sampleFiles();
+
+      //insert size of pairs, estimated while aligning the first batch if not given
+      InsertSize insert;
+      bool estimate = false;
+
+      if (parameters.pairedInput())
+      {
+        if (graph.strandVertices > 0)
+          std::cerr << "WARNING, psgl::alignSamples, columns of both strands are not in genomic order, second mates are aligned to complete graph" << std::endl;
+        else if (parameters.insertMean > 0)
+        {
+          insert.mean = parameters.insertMean;
+          insert.stdDev = parameters.insertStdDev;
+        }
+        else
+          estimate = true;
+      }
+
+      //reads are aligned in batches, and results of each batch are appended 
+      //to the output files. With a journal, completed batches of an 
+      //interrupted run are skipped
+      Journal journal;
+      openJournal (parameters, samples, reads.size(), journal);
+
+      const std::size_t batchCount = (reads.size() + journal.batchReads - 1) / journal.batchReads;
+      const std::size_t firstBatch = journal.batches;
+
+      //a resumed run uses the insert size estimated in the first batch, as an uninterrupted one
+      if (estimate && firstBatch > 0)
+      {
+        estimate = false;
+        insert.mean = journal.insertMean;
+        insert.stdDev = journal.insertStdDev;
+
+        std::cout << "INFO, psgl::alignSamples, insert size mean = " << insert.mean << ", std. dev. = " << insert.stdDev 
+          << ", saved in journal" << std::endl;
+      }
+
+      std::size_t checked = 0, failed = 0, overrun = 0;
+
+      //slowest reads of the batches written so far, see writeSlowReadLog
+      std::vector< BestScoreInfo > slowestBestScoreVector;
+
+      //aligned bases per graph column
+      std::unique_ptr<CoverageCounter> coverage;
+
+      if (!parameters.coverageFile.empty())
+        coverage.reset (new CoverageCounter (graph.numVertices));
+
+      //alignments of all samples projected onto reference path
+      std::unique_ptr<SamWriter> samWriter;
+
+      if (pathIndex)
+        samWriter.reset (new SamWriter (parameters.samFile, *pathIndex, omp_get_max_threads()));
+
+      //sorted output of each sample, memory is divided among samples
+      std::vector<PositionSorter> sorters;
+
+      if (parameters.sortOutput)
+        for (auto &s : samples)
+          sorters.emplace_back (s.second, (parameters.sortMemory << 20) / samples.size());
+
+      //align reads of batch b
+      auto alignBatch = [&](std::size_t b, const Parameters &p, std::vector< BestScoreInfo > &batchBestScoreVector) {
+        auto begin = b * journal.batchReads;
+        auto end = std::min<std::size_t> (begin + journal.batchReads, reads.size());
+
+        //avoid copy of the reads in a single batch
+        std::vector<std::string> batch;
+        if (batchCount > 1)
+          batch.assign (reads.begin() + begin, reads.begin() + end);
+
+        if (parameters.pairedInput())
+          alignPairsToDAG (batchCount > 1 ? batch : reads, graph, p, mode, insert, batchBestScoreVector, coverage.get(), estimate && b == firstBatch);
+        else
+          alignToDAG (batchCount > 1 ? batch : reads, graph, p, mode, batchBestScoreVector, coverage.get());
+      };
+
+      //report, print and record results of batch b
+      auto writeBatch = [&](std::size_t b, std::vector< BestScoreInfo > &batchBestScoreVector) {
+        auto begin = b * journal.batchReads;
+        auto end = begin + batchBestScoreVector.size();
+
+        for (auto &e : batchBestScoreVector)
+        {
+          //report reads which failed validation checks
+          if (parameters.validation != VALIDATE_OFF)
+            checked += parameters.validateRead (e.qryId);
+
+          //ids within batch to ids in the combined read set
+          e.qryId += begin;
+
+          if (e.invalid)
+          {
+            failed++;
+            std::cerr << "WARNING, psgl::alignSamples, validation failed for read " << qmetadata[e.qryId].name << ", " << e.invalid << std::endl;
+          }
+
+          //report reads which exceeded cell budget or deadline
+          if (e.overrun)
+          {
+            overrun++;
+            std::cerr << "WARNING, psgl::alignSamples, read " << qmetadata[e.qryId].name << " " 
+              << (parameters.overrun == OVERRUN_SCORE ? "reported score-only" : "timed out") << ", " << e.overrun << std::endl;
+          }
+        }
+
+        //append results of each sample within batch
+        for (std::size_t i = 0; i < samples.size(); i++)
+        {
+          auto from = std::max (begin, sampleOffsets[i]);
+          auto to = std::min (end, sampleOffsets[i+1]);
+
+          if (from < to && sorters.empty())
+          {
+            std::ofstream outstrm (samples[i].second, std::ios::app);
+            printResultsToFile (outstrm, qmetadata, graph, batchBestScoreVector, from - begin, to - begin, parameters.printCosts);
+          }
+
+          //a single stream formats all records of the sample
+          std::ostringstream record;
+
+          for (auto j = from; j < to && !sorters.empty(); j++)
+          {
+            record.str (std::string());
+            printResultsToFile (record, qmetadata, graph, batchBestScoreVector, j - begin, j - begin + 1, parameters.printCosts);
+            sorters[i].add (positionKey (graph, batchBestScoreVector[j - begin]), record.str());
+          }
+        }
+
+        //project alignments onto reference path in parallel, and write them in order
+        if (samWriter)
+        {
+          std::vector<SamRecord> records (batchBestScoreVector.size());
+
+#pragma omp parallel for schedule(dynamic, 64)
+          for (std::size_t k = 0; k < records.size(); k++)
+          {
+            auto &e = batchBestScoreVector[k];
+            records[k] = projectAlignment (*pathIndex, qmetadata[e.qryId], reads[e.qryId], e);
+            std::vector<int64_t>().swap (e.columns);
+          }
+
+          samWriter->write (records);
+        }
+
+        if (!parameters.journalFile.empty())
+        {
+          journal.batches++;
+          journal.readsDone = end;
+
+          for (std::size_t i = 0; i < samples.size(); i++)
+          {
+            syncFile (samples[i].second);
+            journal.outputSizes[i] = fileSize (samples[i].second);
+          }
+
+          //insert size estimated in this batch is saved along with its record
+          if (estimate && b == firstBatch)
+          {
+            journal.insertMean = insert.mean;
+            journal.insertStdDev = insert.stdDev;
+            writeJournal (parameters.journalFile, journal);
+          }
+          else
+            appendJournal (parameters.journalFile, journal);
+        }
+
+        metrics.reads += batchBestScoreVector.size();
+
+        for (auto &e : batchBestScoreVector)
+        {
+          metrics.alignedReads += (e.score > 0);
+          metrics.totalScore += e.score;
+        }
+
+        //slowest reads so far, among the slowest of this batch and earlier ones
+        if (!parameters.slowLog.empty() || !parameters.reproPrefix.empty())
+        {
+          for (auto i : slowestReads (batchBestScoreVector, parameters.slowReads))
+            slowestBestScoreVector.push_back (batchBestScoreVector[i]);
+
+          std::vector<BestScoreInfo> kept;
+          for (auto i : slowestReads (slowestBestScoreVector, parameters.slowReads))
+            kept.push_back (std::move (slowestBestScoreVector[i]));
+
+          slowestBestScoreVector.swap (kept);
+        }
+
+        //results are released once written, unless the caller keeps them
+        if (parameters.keepResults)
+          outputBestScoreVector.insert (outputBestScoreVector.end(), 
+              std::make_move_iterator (batchBestScoreVector.begin()), std::make_move_iterator (batchBestScoreVector.end()));
+      };
+
+      auto time2 = omp_get_wtime();
+
+      //batch estimating the insert size completes before other batches use it
+      std::size_t startBatch = firstBatch;
+
+      if (estimate && startBatch < batchCount)
+      {
+        std::vector< BestScoreInfo > batchBestScoreVector;
+        alignBatch (startBatch, parameters, batchBestScoreVector);
+        writeBatch (startBatch, batchBestScoreVector);
+        startBatch++;
+      }
+
+      const int workers = std::max<int> (1, std::min<std::size_t> (parameters.batchWorkers, batchCount - startBatch));
+
+      if (workers == 1)
+      {
+        for (std::size_t b = startBatch; b < batchCount; b++)
+        {
+          std::vector< BestScoreInfo > batchBestScoreVector;
+          alignBatch (b, parameters, batchBestScoreVector);
+          writeBatch (b, batchBestScoreVector);
+        }
+      }
+      else
+      {
+        //concurrent workers, each with an equal share of threads, align batches in any 
+        //order. Completed batches are released to the output stage by a reorder buffer
+        const int share = std::max (1, omp_get_max_threads() / workers);
+        const std::size_t window = parameters.reorderWindow > 0 ? parameters.reorderWindow : 2 * workers;
+
+        ReorderBuffer< std::vector<BestScoreInfo> > buffer (startBatch, batchCount, window, !parameters.unorderedOutput);
+        std::atomic<std::size_t> nextBatch (startBatch);
+
+        std::vector<std::thread> pool;
+
+        for (int w = 0; w < workers; w++)
+        {
+          pool.emplace_back ([&]() {
+              Parameters p (parameters);
+              p.threads = share;
+              omp_set_num_threads (share);
+
+              for (std::size_t b; (b = nextBatch++) < batchCount; )
+              {
+                buffer.acquire (b);
+
+                std::vector< BestScoreInfo > batchBestScoreVector;
+                alignBatch (b, p, batchBestScoreVector);
+                buffer.push (b, std::move (batchBestScoreVector));
+              }
+          });
+        }
+
+        std::size_t b;
+        std::vector< BestScoreInfo > batchBestScoreVector;
+
+        while (buffer.pop (b, batchBestScoreVector))
+          writeBatch (b, batchBestScoreVector);
+
+        for (auto &t : pool)
+          t.join();
+
+        //keep returned results in input order
+        if (parameters.unorderedOutput)
+          std::sort (outputBestScoreVector.begin(), outputBestScoreVector.end(), 
+              [](const BestScoreInfo &x, const BestScoreInfo &y) { return x.qryId < y.qryId; });
+      }
+
+      metrics.alignTime = omp_get_wtime() - time2;
+
+      for (std::size_t i = 0; i < sorters.size(); i++)
+      {
+        auto runs = sorters[i].finish();
+        std::cout << "INFO, psgl::alignSamples, sorted output " << samples[i].second << ", spilled runs = " << runs << std::endl;
+      }
+
+      if (coverage)
+      {
+        writeCoverage (parameters.coverageFile, graph, coverage->reduce(), parameters.coverageBinary, parameters.coveragePerBase);
+        std::cout << "INFO, psgl::alignSamples, coverage saved to " << parameters.coverageFile << std::endl;
+      }
+
+      if (parameters.validation != VALIDATE_OFF)
+        std::cout << "INFO, psgl::alignSamples, validated reads = " << checked << ", failed = " << failed << std::endl;
+
+      if (parameters.cellBudget > 0 || parameters.readDeadline > 0)
+        std::cout << "INFO, psgl::alignSamples, reads exceeding cell budget or deadline = " << overrun << std::endl;
 
-      alignToDAG (reads, g.diCharGraph, parameters, mode, outputBestScoreVector);
+      //log the slowest reads, and save them for replay
+      if (!parameters.slowLog.empty() || !parameters.reproPrefix.empty())
+      {
+        auto slowest = slowestReads (slowestBestScoreVector, parameters.slowReads);
+
+        if (!parameters.slowLog.empty())
+          writeSlowReadLog (parameters.slowLog, slowest, qmetadata, slowestBestScoreVector);
+
+        if (!parameters.reproPrefix.empty())
+        {
+          for (std::size_t i = 0; i < slowest.size(); i++)
+          {
+            auto &e = slowestBestScoreVector[slowest[i]];
+
+            //unaligned reads, and reads whose begin is unknown have no graph window
+            if (e.score > 0 && e.refColumnStart >= 0)
+              writeReproFile (parameters.reproPrefix + "." + std::to_string(i) + ".txt", parameters, qmetadata[e.qryId], reads[e.qryId], e, graph);
+          }
+        }
+      }
+    }
+
+  /**
+   * @brief                                 alignment routine
+   * @details                               graph is loaded once, either into memory or 
+   *                                        mapped from a streaming file (see csr_stream.hpp)
+   * @param[in]   parameters                input parameters
+   * @param[in]   mode                      alignment mode
+   * @param[out]  outputBestScoreVector     results of all samples, in input order
+   */
+    int alignToDAG( const Parameters &parameters, 
+                    const MODE mode,  
+                    std::vector< BestScoreInfo > &outputBestScoreVector)
+    {
+      RunMetrics metrics;
+      metrics.shardIndex = parameters.shardIndex;
+      metrics.shardCount = parameters.shardCount;
+      metrics.shardGroup = parameters.pairedInput() ? 2 : 1;
+
+      auto time1 = omp_get_wtime();
+
+      auto loadGraph = [&](psgl::graphLoader &g) {
+        g.verifyGraph = parameters.validation == VALIDATE_FULL;
+        g.load(parameters.mode, parameters.rfile);
+      };
+
+#if defined(PASGAL_ENABLE_AVX512) || defined(PASGAL_ENABLE_AVX2)
+      if (!parameters.streamFile.empty())
+      {
+        //graph is converted once, and later runs map the saved file, unless it
+        //was saved from another graph or in an older format
+        const uint64_t sourceHash = fnv1a (parameters.mode.data(), parameters.mode.size(), graphHash (parameters.rfile));
+
+        if (!CSR_char_stream::current (parameters.streamFile, sourceHash))
+        {
+          if (fileExists(parameters.streamFile))
+            std::cerr << "WARNING, psgl::alignToDAG, " << parameters.streamFile << " does not match the reference graph, re-creating it" << std::endl;
+
+          psgl::graphLoader g;
+          loadGraph (g);
+          CSR_char_stream::write (g.diCharGraph, parameters.streamFile, sourceHash);
+        }
+
+        CSR_char_stream graph;
+        graph.open (parameters.streamFile);
+
+        metrics.loadTime = omp_get_wtime() - time1;
+
+        std::vector<std::string> reads;
+        std::vector<ContigInfo> qmetadata;
+        std::vector<std::size_t> sampleOffsets;
+        readSamples (parameters, reads, qmetadata, sampleOffsets);
+
+        alignSamples (parameters, reads, qmetadata, sampleOffsets, graph, mode, metrics, outputBestScoreVector);
+      }
+      else
+#endif
+      {
+        psgl::graphLoader g;
+        loadGraph (g);
+
+        //index k-mers of graph components to skip unrelated components during alignment
+        if (parameters.componentKmer > 0)
+          g.diCharGraph.indexComponentKmers(parameters.componentKmer);
+
+        metrics.loadTime = omp_get_wtime() - time1;
+
+        //predict memory and time of the run without loading the reads
+        if (parameters.dryRun)
+        {
+          ReadSample sample;
+          sampleReads (parameters, sample, planRegBytes);
+
+          //memory of graph and its loading
+          double baseBytes = peakRSS();
+
+          planRun (parameters, g.diCharGraph, sample, calibrateCellRates (parameters, g.diCharGraph, sample), baseBytes);
+
+          return PSGL_STATUS_OK;
+        }
+
+        //memory of graph and its loading
+        double baseBytes = peakRSS();
+
+        std::vector<std::string> reads;
+        std::vector<ContigInfo> qmetadata;
+        std::vector<std::size_t> sampleOffsets;
+        readSamples (parameters, reads, qmetadata, sampleOffsets);
+
+        //predict memory of the run from the loaded reads, lower thread count under memory limit
+        if (parameters.maxMemory > 0)
+        {
+          ReadSample sample;
+          sampleReads (reads, sample, planRegBytes);
+
+          auto plan = planRun (parameters, g.diCharGraph, sample, CellRates(), baseBytes);
+
+          if (plan.threads < parameters.threads)
+          {
+            std::cerr << "WARNING, psgl::alignToDAG, lowering thread count to " << plan.threads << " to stay within memory limit" << std::endl;
+            omp_set_num_threads(plan.threads);
+          }
+
+          if (plan.shards > 1)
+            std::cerr << "WARNING, psgl::alignToDAG, predicted peak memory exceeds limit, consider " << plan.shards << " read shards (-shard)" << std::endl;
+        }
+
+        //index of reference path to project alignments onto
+        PathIndex pathIndex;
+
+        if (!parameters.samFile.empty())
+        {
+          auto path = std::find_if (g.paths.begin(), g.paths.end(), [&](const GraphPath &p) {
+              return parameters.referencePath.empty() || p.name == parameters.referencePath; });
+
+          if (path == g.paths.end())
+          {
+            std::cerr << "ERROR, psgl::alignToDAG, " << (parameters.referencePath.empty() ? "no paths" : "reference path " + parameters.referencePath + " not")
+              << " found in " << parameters.rfile << std::endl;
+            exit(1);
+          }
+
+          pathIndex.build (g.diCharGraph, *path);
+        }
+
+        alignSamples (parameters, reads, qmetadata, sampleOffsets, g.diCharGraph, mode, metrics, outputBestScoreVector, 
+            parameters.samFile.empty() ? nullptr : &pathIndex);
+      }
 
-      //print results
-      printResultsToFile (parameters, qmetadata, g.diCharGraph, outputBestScoreVector);
+      //save metrics
+      if (!parameters.metricsFile.empty())
+        writeMetricsJSON (parameters.metricsFile, metrics);
 
       return PSGL_STATUS_OK;
     }
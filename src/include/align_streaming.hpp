@@ -0,0 +1,817 @@
+/**
+ * @file    align_streaming.hpp
+ * @brief   vectorized phase 1 routines which stream graph columns from a
+ *          memory-mapped file (see csr_stream.hpp)
+ * @author  Chirag Jain <cjain7@gatech.edu>
+ */
+
+
+#ifndef GRAPH_ALIGN_STREAMING_HPP
+#define GRAPH_ALIGN_STREAMING_HPP
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "align_vectorized.hpp"
+#include "csr_stream.hpp"
+
+namespace psgl
+{
+  /**
+   * @brief   zero-initialized buffer of DP columns, mapped from anonymous memory,
+   *          or from an unlinked temporary file if it is spilled, so that the
+   *          kernel can write its pages out rather than hold them in memory
+   */
+  class ColumnBuffer
+  {
+    private:
+
+      __mxxxi *base = nullptr;
+      std::size_t bytes = 0;
+
+    public:
+
+      ColumnBuffer() = default;
+      ColumnBuffer(const ColumnBuffer&) = delete;
+      ColumnBuffer& operator=(const ColumnBuffer&) = delete;
+
+      ColumnBuffer(ColumnBuffer &&other) : base (other.base), bytes (other.bytes)
+      {
+        other.base = nullptr;
+        other.bytes = 0;
+      }
+
+      ~ColumnBuffer()
+      {
+        if (base != nullptr)
+          munmap (base, bytes);
+      }
+
+      /**
+       * @brief                 map a zero-initialized buffer
+       * @param[in]   size      bytes
+       * @param[in]   spillFile temporary file is created next to this file, 
+       *                        anonymous memory is used if empty
+       */
+      void allocate (std::size_t size, const std::string &spillFile)
+      {
+        assert (base == nullptr);
+
+        bytes = std::max<std::size_t> (size, 1);
+        int fd = -1;
+
+        if (!spillFile.empty())
+        {
+          std::string pattern = spillFile + ".spill.XXXXXX";
+          std::vector<char> name (pattern.begin(), pattern.end());
+          name.push_back ('\0');
+
+          fd = mkstemp (name.data());
+
+          if (fd < 0 || unlink (name.data()) != 0 || ftruncate (fd, bytes) != 0)
+          {
+            std::cerr << "ERROR, psgl::ColumnBuffer::allocate, could not create spill file " << pattern << std::endl;
+            exit(1);
+          }
+        }
+
+        void *p = fd < 0 ? mmap (nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)
+                         : mmap (nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+        if (fd >= 0)
+          close (fd);
+
+        if (p == MAP_FAILED)
+        {
+          std::cerr << "ERROR, psgl::ColumnBuffer::allocate, mmap of " << bytes << " bytes failed" << std::endl;
+          exit(1);
+        }
+
+        base = (__mxxxi *) p;
+      }
+
+      __mxxxi *data() const
+      {
+        return base;
+      }
+  };
+
+  /**
+   * @brief   Supports phase 1 DP in forward and reverse direction over a
+   *          graph which is not resident in memory
+   * @details Unlike Phase1_Vectorized, which sweeps the complete graph once per
+   *          block of 'blockHeight' rows, DP of a read batch is computed column by
+   *          column over all rows, and all in-flight read batches share one sweep,
+   *          so each column record of the graph is read once per group of batches,
+   *          in file order. Only the last 'blockWidth' columns and columns awaiting
+   *          their long hop consumers are kept for each batch. Ties among equal
+   *          scores are resolved in the same order as the in-memory routines, so
+   *          that results are identical
+   */
+  template <typename SIMD>
+    class Phase1_Streaming
+    {
+      private:
+
+        //reference graph
+        const CSR_char_stream &graph;
+
+        //for converting input reads into SOA to enable vectorization
+        std::vector<char> readSetSOA;
+
+        //cumulative read batch sizes
+        std::vector<size_t> readSetSOAPrefixSum;
+
+        //input reads
+        const std::vector<std::string> &readSet;
+
+        //sorted permutation order of input reads
+        std::vector<size_t> sortedReadOrder;
+
+        //input parameters (e.g., scoring scheme)
+        const Parameters &parameters;
+
+      public:
+
+        //columns reachable without long hop buffer
+        static constexpr size_t blockWidth = Phase1_Vectorized<SIMD>::blockWidth;
+
+        //read lengths are padded to a multiple of these many rows,
+        //also the granularity of tie-breaking among equal scores
+        static constexpr size_t blockHeight = Phase1_Vectorized<SIMD>::blockHeight;
+
+        //count of columns to read ahead of the sweep
+        static constexpr int32_t readaheadColumns = 1 << 16;
+
+        //count of columns computed for all in-flight read batches before the sweep moves on
+        static constexpr int32_t chunkColumns = 1 << 12;
+
+        //memory (bytes) for DP columns of in-flight read batches, beyond which 
+        //long hop buffers are spilled to a temporary file
+        static constexpr std::size_t inFlightBytes = std::size_t(1) << 30;
+
+        //columns are swept in tiles of these many columns, so that column
+        //locations are tracked as int32_t offsets within a tile
+        static constexpr int32_t tileColumns = 1 << 30;
+
+        static_assert (blockWidth == CSR_char_stream::hopThreshold, "long hop slots of graph file assume this width");
+
+        /**
+         * @brief                   public constructor
+         * @param[in]   readSet     vector of input query sequences to align
+         * @param[in]   g           input reference graph
+         */
+        Phase1_Streaming(const std::vector<std::string> &readSet,
+            const CSR_char_stream &g,
+            const Parameters &p) :
+          readSet (readSet), graph (g), parameters (p)
+        {
+          this->sortReadsForLoadBalance();
+          this->convertToSOA();
+        };
+
+        /**
+         * @brief                                 wrapper function for phase 1 routine
+         * @param[out]  outputBestScoreVector     vector to keep value and location of best scores,
+         *                                        vector size is same as count of the reads
+         */
+        template <typename Vec>
+          void alignToDAGLocal_Phase1_vectorized_wrapper(Vec &outputBestScoreVector) const
+          {
+            assert (outputBestScoreVector.size() == readSet.size());
+
+            std::size_t countReadBatches = std::ceil (readSet.size() * 1.0 / SIMD::numSeqs);
+
+            std::vector<int32_t> bestScores (countReadBatches * SIMD::numSeqs, 0);
+            std::vector<int64_t> bestCols   (countReadBatches * SIMD::numSeqs, 0);
+            std::vector<int32_t> bestRows   (countReadBatches * SIMD::numSeqs, 0);
+
+            //DP cells and time charged to each lane
+            std::vector<int64_t> laneCells (countReadBatches * SIMD::numSeqs, 0);
+            std::vector<double>  laneTime  (countReadBatches * SIMD::numSeqs, 0);
+
+            //not used in forward DP
+            std::vector<double> laneStart (countReadBatches * SIMD::numSeqs, 0);
+            std::vector<const char*> laneOverrun (countReadBatches * SIMD::numSeqs, nullptr);
+
+            this->alignToDAGLocal_Phase1_streaming<true> (outputBestScoreVector, bestScores, bestCols, bestRows, laneCells, laneTime, laneStart, laneOverrun);
+
+            for (size_t i = 0; i < readSet.size(); i++)
+            {
+              auto originalReadId = sortedReadOrder[i];
+
+              outputBestScoreVector[originalReadId].score         = bestScores[i];
+              outputBestScoreVector[originalReadId].refColumnEnd  = bestCols[i];
+              outputBestScoreVector[originalReadId].qryRowEnd     = bestRows[i];
+              outputBestScoreVector[originalReadId].cost.p1Cells  = laneCells[i];
+              outputBestScoreVector[originalReadId].cost.p1Time   = laneTime[i];
+            }
+          }
+
+        /**
+         * @brief                                 wrapper function for phase 1 reverse DP routine
+         * @param[out]  outputBestScoreVector     vector to keep value and begin location of best scores,
+         *                                        vector size is same as count of the reads
+         */
+        template <typename Vec>
+          void alignToDAGLocal_Phase1_rev_vectorized_wrapper(Vec &outputBestScoreVector) const
+          {
+            assert (outputBestScoreVector.size() == readSet.size());
+
+            std::size_t countReadBatches = std::ceil (readSet.size() * 1.0 / SIMD::numSeqs);
+
+            std::vector<int32_t> bestScores (countReadBatches * SIMD::numSeqs, 0);
+            std::vector<int64_t> bestCols   (countReadBatches * SIMD::numSeqs, 0);
+            std::vector<int32_t> bestRows   (countReadBatches * SIMD::numSeqs, 0);
+
+            //DP cells and time charged to each lane
+            std::vector<int64_t> laneCells (countReadBatches * SIMD::numSeqs, 0);
+            std::vector<double>  laneTime  (countReadBatches * SIMD::numSeqs, 0);
+
+            //wall-clock time when reverse DP of each lane began
+            std::vector<double>  laneStart (countReadBatches * SIMD::numSeqs, 0);
+
+            //lanes exceeding cell budget or deadline
+            std::vector<const char*> laneOverrun (countReadBatches * SIMD::numSeqs, nullptr);
+
+            this->alignToDAGLocal_Phase1_streaming<false> (outputBestScoreVector, bestScores, bestCols, bestRows, laneCells, laneTime, laneStart, laneOverrun);
+
+            for (size_t i = 0; i < readSet.size(); i++)
+            {
+              auto originalReadId = sortedReadOrder[i];
+
+              //unaligned reads are skipped during reverse DP
+              if (outputBestScoreVector[originalReadId].score == 0)
+              {
+                outputBestScoreVector[originalReadId].refColumnStart  = outputBestScoreVector[originalReadId].refColumnEnd;
+                outputBestScoreVector[originalReadId].qryRowStart     = outputBestScoreVector[originalReadId].qryRowEnd;
+                continue;
+              }
+
+              outputBestScoreVector[originalReadId].cost.p1rCells   = laneCells[i];
+              outputBestScoreVector[originalReadId].cost.p1rTime    = laneTime[i];
+              outputBestScoreVector[originalReadId].cost.p1rStart   = laneStart[i];
+
+              //begin location is unknown if budget or deadline was exceeded
+              if (laneOverrun[i])
+              {
+                outputBestScoreVector[originalReadId].overrun         = laneOverrun[i];
+                outputBestScoreVector[originalReadId].refColumnStart  = -1;
+                outputBestScoreVector[originalReadId].qryRowStart     = -1;
+                continue;
+              }
+
+              //reverse DP should reproduce the best score, offset by 1
+              if (parameters.validateRead (originalReadId) && outputBestScoreVector[originalReadId].score != bestScores[i] - 1)
+                outputBestScoreVector[originalReadId].invalid = "best score of phase 1-R differs from phase 1";
+
+              outputBestScoreVector[originalReadId].refColumnStart  = bestCols[i];
+              outputBestScoreVector[originalReadId].qryRowStart     = readSet[originalReadId].length() - 1 - bestRows[i];
+            }
+          }
+
+      private:
+
+        /**
+         * @brief       compute the sorted order of sequences for load balancing
+         * @details     sorting is done in decreasing length order
+         */
+        void sortReadsForLoadBalance()
+        {
+          typedef std::pair<size_t, size_t> pair_t;
+
+          //vector of tuples of length and index of reads
+          std::vector<pair_t> lengthTuples;
+
+          for(size_t i = 0; i < this->readSet.size(); i++)
+            lengthTuples.emplace_back (readSet[i].length(), i);
+
+          //sort in descending order, longer reads first
+          std::sort (lengthTuples.begin(), lengthTuples.end(), [](const pair_t &left, const pair_t &right) {
+              return left.first > right.first || (left.first == right.first && left.second < right.second);
+              });
+
+          for(auto &e : lengthTuples)
+            this->sortedReadOrder.push_back (e.second);
+        }
+
+        /**
+         * @brief       convert input reads characters into SOA to enable vectorization
+         * @details     padding is same as in Phase1_Vectorized
+         */
+        void convertToSOA()
+        {
+          assert (readSet.size() > 0);
+          assert (sortedReadOrder.size() == readSet.size());
+          assert (readSetSOA.size() == 0);
+
+          auto readCount = readSet.size();
+
+          readSetSOAPrefixSum.push_back(0);
+
+          for (size_t i = 0; i < readCount; i += SIMD::numSeqs)
+          {
+            auto batchLength = readSet[sortedReadOrder[i]].length();  //longest read in this batch
+            batchLength += blockHeight - 1 - (batchLength - 1) % blockHeight; //round-up
+
+            for (size_t j = 0; j < batchLength; j++)
+              for (size_t k = 0; k < SIMD::numSeqs; k++)
+                if ( i + k < readCount && j < readSet[sortedReadOrder[i+k]].length() )
+                  readSetSOA.push_back ( readSet[sortedReadOrder[i + k]][j] );
+                else
+                  readSetSOA.push_back (DUMMY);
+
+            readSetSOAPrefixSum.push_back (readSetSOA.size());
+          }
+        }
+
+        /**
+         * @brief                               sweep graph columns in forward or reverse order and find
+         *                                      the best alignment of each read
+         * @details                             read batches are aligned in groups of in-flight batches,
+         *                                      which share a single sweep over the graph. The sweep 
+         *                                      advances 'chunkColumns' columns at a time, and threads 
+         *                                      compute these columns for all batches of the group before
+         *                                      moving on, so each column record is read from the file
+         *                                      once per group while it is still cached. DP state of 
+         *                                      a batch is carried across chunks in its BatchState
+         * @tparam      forward                 if false, execute reverse DP to find begin locations
+         * @param[in]   outputBestScoreVector   best scores and end locations, used during reverse DP
+         * @param[out]  bestScores              best DP scores of reads (vector lanes)
+         * @param[out]  bestCols                global columns where best alignment ends (begins if reverse)
+         * @param[out]  bestRows                rows where best alignment ends (begins if reverse)
+         * @param[out]  laneCells               DP cells computed for each lane
+         * @param[out]  laneTime                time (s) of each read batch, divided among its reads
+         * @param[out]  laneStart               wall-clock time when the first chunk of each read batch began
+         * @param[out]  laneOverrun             reason a lane was not aligned completely during reverse DP, 
+         *                                      i.e., cell budget or deadline
+         */
+        template <bool forward, typename Vec1, typename Vec2>
+          void alignToDAGLocal_Phase1_streaming (const Vec1 &outputBestScoreVector,
+                                                 Vec2 &bestScores, std::vector<int64_t> &bestCols, Vec2 &bestRows,
+                                                 std::vector<int64_t> &laneCells, std::vector<double> &laneTime,
+                                                 std::vector<double> &laneStart, std::vector<const char*> &laneOverrun) const
+          {
+            std::size_t readCount = readSet.size();
+            std::size_t countReadBatches = std::ceil (readCount * 1.0 / SIMD::numSeqs);
+
+            //column location value within a tile requires int32_t type, so may need >1 register per read batch
+            constexpr size_t colValuesPerRegister = SIMD_REG_SIZE / (8 * sizeof(int32_t));
+            constexpr size_t colRegistersCountPerBatch = SIMD::numSeqs / colValuesPerRegister;
+
+            static_assert ( colRegistersCountPerBatch == 1 ||
+                            colRegistersCountPerBatch == 2 ||
+                            colRegistersCountPerBatch == 4, "has to be either 1, 2 or 4");
+
+            static_assert (tileColumns % chunkColumns == 0, "chunks should not cross tiles");
+
+            //init score simd vectors
+            const __mxxxi match512    = SIMD::set1 ((typename SIMD::type) parameters.match);
+            const __mxxxi mismatch512 = SIMD::set1 ((typename SIMD::type) -1 * parameters.mismatch);
+            const __mxxxi del512      = SIMD::set1 ((typename SIMD::type) -1 * parameters.del);
+            const __mxxxi ins512      = SIMD::set1 ((typename SIMD::type) -1 * parameters.ins);
+
+            std::vector<double> threadTimings (omp_get_max_threads(), 0);
+
+            const int64_t n = graph.numVertices;
+
+            //graph arrays used by this sweep direction
+            const int64_t *offsets            = forward ? graph.offsets_in : graph.offsets_out;
+            const int32_t *adjcny             = forward ? graph.adjcny_in : graph.adjcny_out;
+            const int32_t *longHopSlot        = forward ? graph.fwdLongHopSlot : graph.revLongHopSlot;
+            const int32_t longHopSlotsCount   = forward ? graph.fwdLongHopSlots : graph.revLongHopSlots;
+
+            //type def. for memory-aligned vector allocation for SIMD instructions
+            using AlignedVecType = std::vector <__mxxxi, aligned_alloc<__mxxxi, 64> >;
+
+            //registers of a read batch saved between chunks
+            enum { BEST_SCORES, BEST_ROWS, BEST_ROW_BLOCKS, BEST_COLS, FWD_BEST_ROWS = BEST_COLS + 4, FWD_BEST_COLS, REGISTERS = FWD_BEST_COLS + 4 };
+
+            //DP state of a read batch carried across chunks of the shared sweep
+            struct BatchState
+            {
+              std::size_t batch;
+              int32_t qryBatchLength;
+              int32_t columnHeight;
+
+              //columns of DP matrix, each with a leading zero cell to represent row -1
+              AlignedVecType nearbyColumnsBuffer;
+              ColumnBuffer fartherColumnsBuffer;
+
+              //read characters of the batch
+              std::vector<typename SIMD::type, aligned_alloc<typename SIMD::type, 64> > readCharsInt;
+
+              AlignedVecType registers;
+
+              //global columns of best scores
+              std::vector<int64_t> laneBestCols;
+
+              //reason the batch was not aligned completely during reverse DP
+              const char *overrun = nullptr;
+
+              //columns computed, time (s) spent, and wall-clock time of the first chunk
+              int64_t columnsComputed = 0;
+              double time = 0;
+              double start = 0;
+            };
+
+            //read batches to align, reverse DP is needed only if some read of a batch is aligned
+            std::vector<std::size_t> batches;
+
+            for (size_t i = 0; i < countReadBatches; i++)
+            {
+              bool aligned = forward;
+
+              for (size_t j = i * SIMD::numSeqs; j < std::min ((i+1) * SIMD::numSeqs, readCount); j++)
+                aligned = aligned || outputBestScoreVector[sortedReadOrder[j]].score > 0;
+
+              if (aligned)
+                batches.push_back (i);
+            }
+
+            auto batchLength = [&](std::size_t i) {
+              int32_t qryBatchLength = readSet[sortedReadOrder[i * SIMD::numSeqs]].length();  //longest read in this batch
+              return qryBatchLength + this->blockHeight - 1 - (qryBatchLength - 1) % this->blockHeight; //round-up
+            };
+
+            //bytes of DP columns held by a batch
+            auto stateBytes = [&](std::size_t i) {
+              return (blockWidth + longHopSlotsCount) * (batchLength (i) + 1) * sizeof(__mxxxi);
+            };
+
+            std::size_t groups = 0, spilledGroups = 0;
+
+            for (std::size_t groupBegin = 0; groupBegin < batches.size(); )
+            {
+              //at least one batch per thread is in flight, more while their state fits in memory budget
+              std::size_t groupEnd = groupBegin, groupBytes = 0;
+
+              while (groupEnd < batches.size() && 
+                  (groupEnd - groupBegin < (std::size_t) omp_get_max_threads() || groupBytes + stateBytes (batches[groupEnd]) <= inFlightBytes))
+                groupBytes += stateBytes (batches[groupEnd++]);
+
+              //long hop buffers beyond the budget are backed by a temporary file, which the kernel can page out
+              const bool spill = groupBytes > inFlightBytes;
+
+              groups++;
+              spilledGroups += spill;
+
+              std::vector<BatchState> states (groupEnd - groupBegin);
+
+#pragma omp parallel for schedule(dynamic)
+              for (std::size_t g = 0; g < states.size(); g++)
+              {
+                auto &st = states[g];
+                const std::size_t i = batches[groupBegin + g];
+
+                st.batch = i;
+                st.qryBatchLength = batchLength (i);
+                st.columnHeight = st.qryBatchLength + 1;
+
+                st.nearbyColumnsBuffer.assign (blockWidth * st.columnHeight, SIMD::zero());
+                st.fartherColumnsBuffer.allocate ((std::size_t) longHopSlotsCount * st.columnHeight * sizeof(__mxxxi), spill ? parameters.streamFile : "");
+
+                st.readCharsInt.resize (SIMD::numSeqs * st.qryBatchLength);
+
+                for (int32_t k = 0; k < SIMD::numSeqs * st.qryBatchLength; k++)
+                  st.readCharsInt[k] = readSetSOA [readSetSOAPrefixSum[i] + k];
+
+                st.registers.assign (REGISTERS, SIMD::zero());
+                st.laneBestCols.assign (SIMD::numSeqs, 0);
+
+                //location of forward alignments, used during reverse DP
+                if (!forward)
+                {
+                  std::vector<typename SIMD::type, aligned_alloc<typename SIMD::type, 64> > fwdBestRows (SIMD::numSeqs, 0);
+
+                  for (size_t j = 0; j < SIMD::numSeqs; j++)
+                  {
+                    if (i * SIMD::numSeqs + j < readCount)
+                    {
+                      auto &e = outputBestScoreVector[sortedReadOrder[i * SIMD::numSeqs + j]];
+
+                      if (e.score > 0)
+                        fwdBestRows[j] = readSet[sortedReadOrder[i * SIMD::numSeqs + j]].length() - 1 - e.qryRowEnd;
+                    }
+                  }
+
+                  st.registers[FWD_BEST_ROWS] = SIMD::load ((const __mxxxi*) fwdBestRows.data() );
+
+                  //reads exceeding cell budget are not aligned further during reverse DP
+                  if (parameters.overBudget ((int64_t) st.qryBatchLength * n))
+                    st.overrun = "cell budget exceeded in phase 1-R";
+                }
+              }
+
+              //sweep graph columns once for the group, one chunk at a time
+              for (int64_t chunkBegin = 0; chunkBegin < n; chunkBegin += chunkColumns)
+              {
+                const int64_t chunkEnd = std::min (n, chunkBegin + chunkColumns);
+                const int64_t tileBegin = chunkBegin / tileColumns * tileColumns;
+                const int32_t tileWidth = std::min (n - tileBegin, (int64_t) tileColumns);
+
+                //hint the kernel to read columns of the next chunks
+                if (chunkBegin % readaheadColumns == 0)
+                {
+                  if (forward)
+                    graph.readahead (chunkBegin, chunkBegin + readaheadColumns);
+                  else
+                    graph.readahead (n - chunkBegin - readaheadColumns, n - chunkBegin);
+                }
+
+#pragma omp parallel
+                {
+                  auto threadTime = omp_get_wtime();
+
+                  //buffers to parse vector registers
+                  std::vector<int32_t, aligned_alloc<int32_t, 64> > storeCols (SIMD::numSeqs);
+
+                  //column offset of forward alignment end within current tile, used during reverse DP
+                  std::vector<int32_t, aligned_alloc<int32_t, 64> > fwdBestCols (SIMD::numSeqs);
+
+                  //predecessor columns (in sweep order) of current column
+                  std::vector<const __mxxxi*> preds;
+
+#pragma omp for schedule(dynamic) nowait
+                  for (std::size_t g = 0; g < states.size(); g++)
+                  {
+                    auto &st = states[g];
+                    const std::size_t i = st.batch;
+
+                    if (st.overrun)
+                      continue;
+
+                    auto time1 = omp_get_wtime();
+
+                    if (st.start == 0)
+                      st.start = time1;
+
+                    //check deadline of reverse DP once per chunk, in wall-clock time since the
+                    //first chunk of the batch as in memory, including waits between chunks
+                    if (!forward && parameters.pastDeadline (time1 - st.start))
+                    {
+                      st.overrun = "deadline passed in phase 1-R";
+                      continue;
+                    }
+
+                    const int32_t qryBatchLength = st.qryBatchLength;
+                    const int32_t columnHeight = st.columnHeight;
+                    const typename SIMD::type *readCharsInt = st.readCharsInt.data();
+                    __mxxxi *nearbyColumnsBuffer = st.nearbyColumnsBuffer.data();
+                    __mxxxi *fartherColumnsBuffer = st.fartherColumnsBuffer.data();
+
+                    __mxxxi bestScores512    = st.registers[BEST_SCORES];
+                    __mxxxi bestRows512      = st.registers[BEST_ROWS];
+                    __mxxxi bestRowBlocks512 = st.registers[BEST_ROW_BLOCKS];
+                    __mxxxi bestCols512_0    = st.registers[BEST_COLS + 0];
+                    __mxxxi bestCols512_1    = st.registers[BEST_COLS + 1];
+                    __mxxxi bestCols512_2    = st.registers[BEST_COLS + 2];
+                    __mxxxi bestCols512_3    = st.registers[BEST_COLS + 3];
+                    __mxxxi fwdBestRows512   = st.registers[FWD_BEST_ROWS];
+                    __mxxxi fwdBestCols512_0 = st.registers[FWD_BEST_COLS + 0];
+                    __mxxxi fwdBestCols512_1 = st.registers[FWD_BEST_COLS + 1];
+                    __mxxxi fwdBestCols512_2 = st.registers[FWD_BEST_COLS + 2];
+                    __mxxxi fwdBestCols512_3 = st.registers[FWD_BEST_COLS + 3];
+
+                    //beginning of a tile
+                    if (chunkBegin == tileBegin)
+                    {
+                      //tile offset -1 marks lanes whose best score is not updated within tile
+                      bestCols512_0 = bestCols512_1 = bestCols512_2 = bestCols512_3 = SIMD::set1_32 (-1);
+
+                      //column offset -1 is never matched, used for unaligned lanes and ends outside tile
+                      if (!forward)
+                      {
+                        std::fill (fwdBestCols.begin(), fwdBestCols.end(), -1);
+
+                        for (size_t j = 0; j < SIMD::numSeqs; j++)
+                        {
+                          if (i * SIMD::numSeqs + j < readCount)
+                          {
+                            auto &e = outputBestScoreVector[sortedReadOrder[i * SIMD::numSeqs + j]];
+                            auto c = n - 1 - e.refColumnEnd;
+
+                            if (e.score > 0 && c >= tileBegin && c < tileBegin + tileWidth)
+                              fwdBestCols[j] = c - tileBegin;
+                          }
+                        }
+
+                        fwdBestCols512_0 = SIMD::load ((const __mxxxi*) &fwdBestCols [0] );
+
+                        if (colRegistersCountPerBatch >= 2)
+                          fwdBestCols512_1 = SIMD::load ((const __mxxxi*) &fwdBestCols [1*colValuesPerRegister]);
+
+                        if (colRegistersCountPerBatch == 4)
+                        {
+                          fwdBestCols512_2 = SIMD::load ((const __mxxxi*) &fwdBestCols [2*colValuesPerRegister]);
+                          fwdBestCols512_3 = SIMD::load ((const __mxxxi*) &fwdBestCols [3*colValuesPerRegister]);
+                        }
+                      }
+                    }
+
+                    for (int64_t c = chunkBegin; c < chunkEnd; c++)
+                    {
+                      const int32_t t = c - tileBegin;
+                      const int64_t k = forward ? c : n - 1 - c;
+
+                      //current reference character
+                      __mxxxi graphChar = SIMD::set1 ((typename SIMD::type) graph.vertex_label[k] );
+
+                      __mxxxi* currentColumn = &nearbyColumnsBuffer[(k & (blockWidth-1)) * columnHeight];
+
+                      preds.clear();
+
+                      for(auto m = offsets[k]; m < offsets[k+1]; m++)
+                      {
+                        auto p = forward ? k - adjcny[m] : k + adjcny[m];
+
+                        if (adjcny[m] < this->blockWidth)
+                          preds.push_back (&nearbyColumnsBuffer[(p & (blockWidth-1)) * columnHeight]);
+                        else
+                          preds.push_back (&fartherColumnsBuffer[longHopSlot[p] * columnHeight]);
+                      }
+
+                      //iterate over read characters, cell l+1 of a column buffer is row l
+                      for (int32_t l = 0; l < qryBatchLength; l++)
+                      {
+                        //load read characters
+                        __mxxxi readChars = SIMD::load ((const __mxxxi*) &readCharsInt[l * SIMD::numSeqs] );
+
+                        //see if query and reference character match
+                        auto compareChar = SIMD::cmpeq (readChars, graphChar);
+                        __mxxxi sub512 = SIMD::blend (compareChar, mismatch512, match512);
+
+                        //match-mismatch edit, local alignment can also start with a match at this char
+                        __mxxxi currentMax512 = SIMD::max (SIMD::zero(), sub512);
+
+                        for (auto pred : preds)
+                        {
+                          //paths with match mismatch edit
+                          currentMax512 = SIMD::max (currentMax512, SIMD::add (pred[l], sub512));
+
+                          //paths with deletion edit
+                          currentMax512 = SIMD::max (currentMax512, SIMD::add (pred[l+1], del512));
+                        }
+
+                        //insertion edit
+                        currentMax512 = SIMD::max (currentMax512, SIMD::add (currentColumn[l], ins512));
+
+                        //update best score, on ties prefer the cell visited later by the in-memory sweep
+                        //i.e., the cell in same or later row block
+                        {
+                          __mxxxi newBestScores512 = SIMD::max (currentMax512, bestScores512);
+                          __mxxxi currentRowBlock = SIMD::set1 ((typename SIMD::type) (l / blockHeight));
+
+                          auto notWorse   = SIMD::cmpeq (currentMax512, newBestScores512);
+                          auto tie        = SIMD::cmpeq (currentMax512, bestScores512);
+                          auto laterBlock = SIMD::cmpeq (SIMD::max (currentRowBlock, bestRowBlocks512), currentRowBlock);
+
+                          auto updated = notWorse & (~tie | laterBlock);
+
+                          bestScores512 = newBestScores512;
+                          bestRows512 = SIMD::mask_set1 (bestRows512, updated, (typename SIMD::type) l);
+                          bestRowBlocks512 = SIMD::mask_set1 (bestRowBlocks512, updated, (typename SIMD::type) (l / blockHeight));
+                          SIMD::update_cols (bestCols512_0, bestCols512_1, bestCols512_2, bestCols512_3, t, updated);
+                        }
+
+                        //mark the end cell of forward alignment, same as Phase1_Rev_Vectorized
+                        if (!forward)
+                        {
+                          __mxxxi currentRow = SIMD::set1 ( (typename SIMD::type) l);
+                          __mxxxi currentCol = SIMD::set1_32 (t);
+
+                          auto compareCell = SIMD::cmpeq (fwdBestRows512, currentRow);
+
+                          auto compareCellByCol_0 = SIMD::cmpeq_32 (fwdBestCols512_0, currentCol);
+                          auto compareCellByCol_1 = SIMD::cmpeq_32 (fwdBestCols512_1, currentCol);
+                          auto compareCellByCol_2 = SIMD::cmpeq_32 (fwdBestCols512_2, currentCol);
+                          auto compareCellByCol_3 = SIMD::cmpeq_32 (fwdBestCols512_3, currentCol);
+
+                          compareCell = compareCell &
+                            SIMD::combine_mask (compareCellByCol_0, compareCellByCol_1, compareCellByCol_2, compareCellByCol_3);
+
+                          currentMax512 = SIMD::mask_set1 (currentMax512, compareCell, (typename SIMD::type) (parameters.match + 1));
+                        }
+
+                        currentColumn[l+1] = currentMax512;
+                      }
+
+                      //save column in long hop buffer until its last consumer is computed
+                      if (longHopSlot[k] >= 0)
+                        std::copy (currentColumn, currentColumn + columnHeight, &fartherColumnsBuffer[longHopSlot[k] * columnHeight]);
+                    }
+
+                    //end of a tile, convert column offsets of lanes updated within tile to global columns
+                    if (chunkEnd == tileBegin + tileWidth)
+                    {
+                      SIMD::store ((__mxxxi*) &storeCols [0], bestCols512_0);
+
+                      if (colRegistersCountPerBatch >= 2)
+                        SIMD::store ((__mxxxi*) &storeCols [1*colValuesPerRegister], bestCols512_1);
+
+                      if (colRegistersCountPerBatch == 4)
+                      {
+                        SIMD::store ((__mxxxi*) &storeCols [2*colValuesPerRegister], bestCols512_2);
+                        SIMD::store ((__mxxxi*) &storeCols [3*colValuesPerRegister], bestCols512_3);
+                      }
+
+                      for (size_t j = 0; j < SIMD::numSeqs; j++)
+                        if (storeCols[j] >= 0)
+                          st.laneBestCols[j] = forward ? tileBegin + storeCols[j] : n - 1 - (tileBegin + storeCols[j]);
+                    }
+
+                    st.registers[BEST_SCORES]       = bestScores512;
+                    st.registers[BEST_ROWS]         = bestRows512;
+                    st.registers[BEST_ROW_BLOCKS]   = bestRowBlocks512;
+                    st.registers[BEST_COLS + 0]     = bestCols512_0;
+                    st.registers[BEST_COLS + 1]     = bestCols512_1;
+                    st.registers[BEST_COLS + 2]     = bestCols512_2;
+                    st.registers[BEST_COLS + 3]     = bestCols512_3;
+                    st.registers[FWD_BEST_COLS + 0] = fwdBestCols512_0;
+                    st.registers[FWD_BEST_COLS + 1] = fwdBestCols512_1;
+                    st.registers[FWD_BEST_COLS + 2] = fwdBestCols512_2;
+                    st.registers[FWD_BEST_COLS + 3] = fwdBestCols512_3;
+
+                    st.columnsComputed = chunkEnd;
+                    st.time += omp_get_wtime() - time1;
+                  }
+
+                  threadTimings[omp_get_thread_num()] += omp_get_wtime() - threadTime;
+                } //end of omp parallel
+              } //end of sweep
+
+              //parse best scores from vector registers
+              for (auto &st : states)
+              {
+                std::vector<typename SIMD::type, aligned_alloc<typename SIMD::type, 64> > storeScores (SIMD::numSeqs), storeRows (SIMD::numSeqs);
+
+                SIMD::store ((__mxxxi*) storeScores.data(), st.registers[BEST_SCORES]);
+                SIMD::store ((__mxxxi*) storeRows.data(),   st.registers[BEST_ROWS]);
+
+                const std::size_t i = st.batch;
+
+                //time of the batch is divided among its reads
+                const std::size_t batchReads = std::min<std::size_t> (SIMD::numSeqs, readCount - i * SIMD::numSeqs);
+                const double laneShare = st.time / batchReads;
+
+                //read batches write to disjoint lanes
+                for (size_t j = 0; j < SIMD::numSeqs; j++)
+                {
+                  bestScores[i * SIMD::numSeqs + j] = storeScores[j];
+                  bestRows[i * SIMD::numSeqs + j]   = storeRows[j];
+                  bestCols[i * SIMD::numSeqs + j]   = st.laneBestCols[j];
+                  laneCells[i * SIMD::numSeqs + j]  = (int64_t) st.qryBatchLength * st.columnsComputed;
+                  laneTime[i * SIMD::numSeqs + j]   = laneShare;
+                  laneStart[i * SIMD::numSeqs + j]  = st.start;
+                  laneOverrun[i * SIMD::numSeqs + j] = st.overrun;
+                }
+              }
+
+              groupBegin = groupEnd;
+            } // all reads done
+
+            std::cout << "TIMER, psgl::Phase1_Streaming::alignToDAGLocal_Phase1_streaming"
+                      << " (" << (forward ? "fwd" : "rev") << ", precision= " << sizeof(typename SIMD::type) << " bytes)"
+                      << ", sweeps = " << groups << ", spilled = " << spilledGroups
+                      << ", individual thread timings (s) : "
+                      << printStats(threadTimings) << "\n";
+          }
+    };
+
+  /**
+   * @brief                                 run phase 1 forward DP over a memory-mapped graph
+   * @param[in]   readSet                   vector of input query sequences to align
+   * @param[in]   graph                     input reference graph
+   * @param[in]   parameters                input parameters
+   * @param[out]  outputBestScoreVector     vector to keep value and location of best scores
+   */
+  template <typename SIMD, typename Vec>
+    void alignToDAGLocal_Phase1_vectorized (const std::vector<std::string> &readSet,
+        const CSR_char_stream &graph,
+        const Parameters &parameters,
+        Vec &outputBestScoreVector)
+    {
+      Phase1_Streaming<SIMD> obj (readSet, graph, parameters);
+      obj.alignToDAGLocal_Phase1_vectorized_wrapper(outputBestScoreVector);
+    }
+
+  /**
+   * @brief                                 run phase 1 reverse DP over a memory-mapped graph
+   * @param[in]   readSet                   vector of reversed query sequences
+   * @param[in]   graph                     input reference graph
+   * @param[in]   parameters                input parameters
+   * @param[in/out]  outputBestScoreVector  best scores and end locations from forward DP,
+   *                                        begin locations are updated
+   */
+  template <typename SIMD, typename Vec>
+    void alignToDAGLocal_Phase1_rev_vectorized (const std::vector<std::string> &readSet,
+        const CSR_char_stream &graph,
+        const Parameters &parameters,
+        Vec &outputBestScoreVector)
+    {
+      Phase1_Streaming<SIMD> obj (readSet, graph, parameters);
+      obj.alignToDAGLocal_Phase1_rev_vectorized_wrapper(outputBestScoreVector);
+    }
+}
+
+#endif
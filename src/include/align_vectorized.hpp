@@ -16,6 +16,7 @@
 #include "graph_iter.hpp"
 #include "base_types.hpp"
 #include "utils.hpp"
+#include "partition.hpp"
 
 //External includes
 
@@ -59,6 +60,9 @@ namespace psgl
       static inline __mxxxi mask_set1_32 (const __mxxxi& a, mmask_t k, int32_t b) { return _mm512_mask_set1_epi32(a, k, b); } 
       static inline mmask_t combine_mask (mmask_t k0, mmask_t k1, mmask_t k2, mmask_t k3) {return k0;}
       static inline void update_cols (__mxxxi& c0, __mxxxi& c1, __mxxxi& c2, __mxxxi& c3, int32_t val, mmask_t k) {c0 = mask_set1_32 (c0, k, val);}
+      static inline __mxxxi sub (const __mxxxi& a, const __mxxxi& b) { return _mm512_sub_epi32(a, b); }
+      static inline void store_delta8 (int8_t *mem_addr, const __mxxxi &a) { _mm_storeu_si128((__m128i*) mem_addr, _mm512_cvtepi32_epi8(a)); }
+      static inline __mxxxi load_delta8 (const int8_t *mem_addr) { return _mm512_cvtepi8_epi32(_mm_loadu_si128((const __m128i*) mem_addr)); }
 
 #elif defined(PASGAL_ENABLE_AVX2)
       static constexpr int numSeqs = SIMD_REG_SIZE / (8 * sizeof(type));
@@ -76,6 +80,13 @@ namespace psgl
       static inline __mxxxi mask_set1_32 (const __mxxxi& a, const __mxxxi& k, int32_t b) { return blend(k, a, set1_32 (b)); }
       static inline __mxxxi combine_mask (const __mxxxi& k0, const __mxxxi& k1, const __mxxxi& k2, const __mxxxi& k3) {return k0;}
       static inline void update_cols (__mxxxi& c0, __mxxxi& c1, __mxxxi& c2, __mxxxi& c3, int32_t val, const __mxxxi& k){c0 = mask_set1_32 (c0, k, val);}
+      static inline __mxxxi sub (const __mxxxi& a, const __mxxxi& b) { return _mm256_sub_epi32(a, b); }
+      static inline void store_delta8 (int8_t *mem_addr, const __mxxxi &a) { 
+        __mxxxi packed = _mm256_packs_epi32 (a, a);
+        packed = _mm256_permutevar8x32_epi32 (_mm256_packs_epi16 (packed, packed), _mm256_setr_epi32(0, 4, 0, 0, 0, 0, 0, 0));
+        _mm_storel_epi64((__m128i*) mem_addr, _mm256_castsi256_si128 (packed)); 
+      }
+      static inline __mxxxi load_delta8 (const int8_t *mem_addr) { return _mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i*) mem_addr)); }
 #endif
 
     };
@@ -108,6 +119,9 @@ namespace psgl
         c0 = mask_set1_32 (c0, k      ,  val);
         c1 = mask_set1_32 (c1, k >> 16,  val);
       }
+      static inline __mxxxi sub (const __mxxxi& a, const __mxxxi& b) { return _mm512_sub_epi16(a, b); }
+      static inline void store_delta8 (int8_t *mem_addr, const __mxxxi &a) { _mm256_storeu_si256((__m256i*) mem_addr, _mm512_cvtepi16_epi8(a)); }
+      static inline __mxxxi load_delta8 (const int8_t *mem_addr) { return _mm512_cvtepi8_epi16(_mm256_loadu_si256((const __m256i*) mem_addr)); }
 
 #elif defined(PASGAL_ENABLE_AVX2)
       static constexpr int numSeqs = SIMD_REG_SIZE / (8 * sizeof(type));
@@ -130,6 +144,11 @@ namespace psgl
         c0 = mask_set1_32 (c0, _mm256_cvtepi16_epi32 (_mm256_castsi256_si128 (k)),     val);
         c1 = mask_set1_32 (c1, _mm256_cvtepi16_epi32 (_mm256_extracti128_si256 (k, 1)), val);
       }
+      static inline __mxxxi sub (const __mxxxi& a, const __mxxxi& b) { return _mm256_sub_epi16(a, b); }
+      static inline void store_delta8 (int8_t *mem_addr, const __mxxxi &a) { 
+        _mm_storeu_si128((__m128i*) mem_addr, _mm256_castsi256_si128 (_mm256_permute4x64_epi64 (_mm256_packs_epi16 (a, a), 0xd8))); 
+      }
+      static inline __mxxxi load_delta8 (const int8_t *mem_addr) { return _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*) mem_addr)); }
 #endif
 
 
@@ -165,6 +184,9 @@ namespace psgl
         c2 = mask_set1_32 (c2, k >> 32,  val);
         c3 = mask_set1_32 (c3, k >> 48,  val);
       }
+      static inline __mxxxi sub (const __mxxxi& a, const __mxxxi& b) { return _mm512_sub_epi8(a, b); }
+      static inline void store_delta8 (int8_t *mem_addr, const __mxxxi &a) { _mm512_storeu_si512(mem_addr, a); }
+      static inline __mxxxi load_delta8 (const int8_t *mem_addr) { return _mm512_loadu_si512(mem_addr); }
 
 #elif defined(PASGAL_ENABLE_AVX2)
       static constexpr int numSeqs = SIMD_REG_SIZE / (8 * sizeof(type));
@@ -190,11 +212,19 @@ namespace psgl
         c2 = mask_set1_32 (c2, _mm256_cvtepi8_epi32 (_mm256_extracti128_si256 (k, 1)),  val);
         c3 = mask_set1_32 (c3, _mm256_cvtepi8_epi32 ( _mm_set1_epi64x (_mm256_extract_epi64 (k, 3))),  val);
       }
+      static inline __mxxxi sub (const __mxxxi& a, const __mxxxi& b) { return _mm256_sub_epi8(a, b); }
+      static inline void store_delta8 (int8_t *mem_addr, const __mxxxi &a) { _mm256_storeu_si256((__m256i*) mem_addr, a); }
+      static inline __mxxxi load_delta8 (const int8_t *mem_addr) { return _mm256_loadu_si256((const __m256i*) mem_addr); }
 #endif
     };
 
   /**
    * @brief   Supports phase 1 DP in forward direction
+   * @details Work is scheduled as (read batch, graph component) pairs. 
+   *          Components are contiguous ranges of columns without edges
+   *          between them, so each pair is computed independently using
+   *          buffers sized to the component, and the best scores of a read 
+   *          batch are reduced across its pairs
    */
   template <typename SIMD>
     class Phase1_Vectorized
@@ -205,8 +235,16 @@ namespace psgl
         const CSR_char_container &graph;
 
         // pre-compute which graph vertices are connected with hop longer
-        // than 'blockWidth'
-        std::vector<bool> withLongHop;
+        // than 'blockWidth', and assign them a slot in long hop buffer
+        // slots are numbered within each component, -1 if not required
+        std::vector<int32_t> longHopSlot;
+
+        //count of long hop slots required by each component
+        std::vector<int32_t> componentLongHops;
+
+        //flags to indicate which components should be aligned with a read batch
+        //size = count of read batches x count of components
+        std::vector<bool> batchComponentHits;
 
         //for converting input reads into SOA to enable vectorization
         std::vector<char> readSetSOA;
@@ -226,6 +264,9 @@ namespace psgl
         //input parameters (e.g., scoring scheme)
         const Parameters &parameters;
 
+        //boundary state if graph is a partition of a larger graph, see partition.hpp
+        PartitionBoundary *partition;
+
       public:
 
         //small temporary storage buffer for DP scores
@@ -240,17 +281,34 @@ namespace psgl
          * @brief                   public constructor
          * @param[in]   readSet     vector of input query sequences to align
          * @param[in]   g           input reference graph
+         * @param[in]   partition   boundary state if 'g' is a graph partition
          */
         Phase1_Vectorized(const std::vector<std::string> &readSet, 
             const CSR_char_container &g,
-            const Parameters &p) :
-          readSet (readSet), graph (g), parameters (p)
+            const Parameters &p,
+            PartitionBoundary *partition = nullptr) :
+          readSet (readSet), graph (g), parameters (p), partition (partition)
         {
           this->sortReadsForLoadBalance();
           this->convertToSOA();
           this->computeLongHops();
+          this->filterComponents();
         };
 
+        /**
+         * @brief                   check if DP state should be saved as int8 differences
+         * @details                 a cell's score exceeds the score of the cell above it by at most
+         *                          (match + del), plus 1 due to the cell marked during reverse DP, and
+         *                          falls short by at most ins. Differences within 'blockHeight' rows fit
+         *                          in int8 if penalties are small. Not useful for int8 precision
+         * @param[in]   p           input parameters
+         */
+        static bool deltaCompressible (const Parameters &p)
+        {
+          return p.compressRowState && sizeof(typename SIMD::type) > 1 &&
+            blockHeight * (p.match + p.del) + 1 <= INT8_MAX && blockHeight * p.ins <= -INT8_MIN;
+        }
+
         /**
          * @brief                                 wrapper function for phase 1 routine 
          * @param[out]  outputBestScoreVector     vector to keep value and location of best scores,
@@ -264,68 +322,46 @@ namespace psgl
 
             std::size_t countReadBatches = std::ceil (readSet.size() * 1.0 / SIMD::numSeqs);
 
-            //column location value requires int32_t type, so may need >1 register per read batch
-            constexpr size_t colValuesPerRegister = SIMD_REG_SIZE / (8 * sizeof(int32_t));
-            constexpr size_t colRegistersCountPerBatch = SIMD::numSeqs / colValuesPerRegister;
-
-            static_assert ( colRegistersCountPerBatch == 1 || 
-                            colRegistersCountPerBatch == 2 || 
-                            colRegistersCountPerBatch == 4, "has to be either 1, 2 or 4"); 
+            //best score info of each vector lane, i.e., reads in their sorted order
+            //score is set to -1 until a component is aligned to the lane
+            std::vector<int32_t> bestScores (countReadBatches * SIMD::numSeqs, -1);
+            std::vector<int64_t> bestCols   (countReadBatches * SIMD::numSeqs, 0);
+            std::vector<int32_t> bestRows   (countReadBatches * SIMD::numSeqs, 0);
 
-            // modified containers to hold best-score info
-            // vector elements aligned to 64 byte boundaries
-            std::vector <__mxxxi, aligned_alloc<__mxxxi, 64> > _bestScoreVector (countReadBatches);
-            std::vector <__mxxxi, aligned_alloc<__mxxxi, 64> > 
-                  _bestScoreColVector (countReadBatches * colRegistersCountPerBatch);
-            std::vector <__mxxxi, aligned_alloc<__mxxxi, 64> > _bestScoreRowVector (countReadBatches);
+            //DP cells and time charged to each lane
+            std::vector<int64_t> laneCells (countReadBatches * SIMD::numSeqs, 0);
+            std::vector<double>  laneTime  (countReadBatches * SIMD::numSeqs, 0);
 
             // execute the alignment routine
-            this->alignToDAGLocal_Phase1_vectorized (_bestScoreVector, _bestScoreColVector, _bestScoreRowVector); 
-
-            //when debugging for low-precision
-#ifdef DEBUG
-            for (auto &e : _bestScoreVector)
-              simdUtils<typename SIMD::type>::print_avx_num (e);
+            if (deltaCompressible (parameters))
+              this->alignToDAGLocal_Phase1_vectorized<true> (bestScores, bestCols, bestRows, laneCells, laneTime); 
+            else
+              this->alignToDAGLocal_Phase1_vectorized<false> (bestScores, bestCols, bestRows, laneCells, laneTime); 
 
-            for (auto &e : _bestScoreRowVector)
-              simdUtils<typename SIMD::type>::print_avx_num (e);
-
-            for (auto &e : _bestScoreColVector)
-              simdUtils<int32_t>::print_avx_num (e);
-#endif
-
-
-            //parse best scores from vector registers
-            std::vector<typename SIMD::type, aligned_alloc<typename SIMD::type, 64> > storeScores (SIMD::numSeqs);
-            std::vector<typename SIMD::type, aligned_alloc<typename SIMD::type, 64> > storeRows   (SIMD::numSeqs);
-            std::vector<int32_t,             aligned_alloc<int32_t,             64> > storeCols   (SIMD::numSeqs);
-
-            for (size_t i = 0; i < countReadBatches; i++)
+            //reduce results of all graph partitions at partition 0
+            if (partition != nullptr)
             {
-              SIMD::store ((__mxxxi*) storeScores.data(), _bestScoreVector[i]);
-              SIMD::store ((__mxxxi*) storeRows.data()  , _bestScoreRowVector[i]);
+              for (auto &col : bestCols)
+                col = partition->toGlobal (col);
 
-              for (size_t j = 0; j < colRegistersCountPerBatch; j++) 
-              {
-                SIMD::store ( (__mxxxi*) &storeCols [j*colValuesPerRegister], 
-                              _bestScoreColVector[i * colRegistersCountPerBatch + j]);
-              }
+              if (!partition->gatherBestScores (bestScores, bestCols, bestRows, blockHeight))
+                return;
+            }
 
-              for (size_t j = 0; j < SIMD::numSeqs; j++)
-              {
-                if (i * SIMD::numSeqs + j < readSet.size())
-                {
-                  auto originalReadId = sortedReadOrder[i * SIMD::numSeqs + j];
+            for (size_t i = 0; i < readSet.size(); i++)
+            {
+              auto originalReadId = sortedReadOrder[i];
 
-                  outputBestScoreVector[originalReadId].score         = storeScores[j];
-                  outputBestScoreVector[originalReadId].refColumnEnd  = storeCols[j];
-                  outputBestScoreVector[originalReadId].qryRowEnd     = storeRows[j];
+              //reads without any aligned component get zero score
+              outputBestScoreVector[originalReadId].score         = std::max (bestScores[i], 0);
+              outputBestScoreVector[originalReadId].refColumnEnd  = bestCols[i];
+              outputBestScoreVector[originalReadId].qryRowEnd     = bestRows[i];
+              outputBestScoreVector[originalReadId].cost.p1Cells  = laneCells[i];
+              outputBestScoreVector[originalReadId].cost.p1Time   = laneTime[i];
 
 #ifdef DEBUG
-                  std::cout << "INFO, psgl::Phase1_Vectorized::alignToDAGLocal_Phase1_vectorized_wrapper, read # " << originalReadId << ",  score = " << (int) storeScores[j] << ", qryRowEnd = " << (int) storeRows[j] << ", refColumnEnd = " << (int) storeCols[j] << "\n";
+              std::cout << "INFO, psgl::Phase1_Vectorized::alignToDAGLocal_Phase1_vectorized_wrapper, read # " << originalReadId << ",  score = " << bestScores[i] << ", qryRowEnd = " << bestRows[i] << ", refColumnEnd = " << bestCols[i] << "\n";
 #endif
-                }
-              }
             }
           }
 
@@ -405,60 +441,126 @@ namespace psgl
          */
         void computeLongHops()
         {
-          assert (withLongHop.size() == 0);
+          assert (longHopSlot.size() == 0);
 
-          this->withLongHop.resize(graph.numVertices, false);
+          this->longHopSlot.resize(graph.numVertices, -1);
+          this->componentLongHops.resize(graph.numComponents(), 0);
 
-          for(int32_t i = 0; i < graph.numVertices; i++)
+          for(int64_t i = 0; i < graph.numVertices; i++)
           {
             for(auto j = graph.offsets_in[i]; j < graph.offsets_in[i+1]; j++)
             {
-              auto from_pos = graph.adjcny_in[j];
-              auto to_pos = i;
-
               //compare hop distance to 'blockWidth'
-              if (to_pos - from_pos >= this->blockWidth)
-                this->withLongHop[from_pos] = true;
+              if (graph.adjcny_in[j] >= this->blockWidth)
+                this->longHopSlot[i - graph.adjcny_in[j]] = 0;
             }
           }
 
+          //number the slots within each component
+          for(std::size_t c = 0; c < graph.numComponents(); c++)
+            for(int64_t i = graph.componentOffsets[c]; i < graph.componentOffsets[c+1]; i++)
+              if (longHopSlot[i] == 0)
+                longHopSlot[i] = componentLongHops[c]++;
+
 #ifdef DEBUG
-          auto trueCount = std::count(withLongHop.begin(), withLongHop.end(), true);
+          auto trueCount = std::accumulate(componentLongHops.begin(), componentLongHops.end(), (std::size_t) 0);
           std::cout << "INFO, psgl::Phase1_Vectorized::computeLongHops, fraction of hops that are long: " << trueCount * 1.0 / graph.numVertices << "\n";
 #endif
         }
 
+        /**
+         * @brief     decide which graph components to align with each read batch
+         * @details   if the graph is indexed with k-mers, components which share no 
+         *            exact k-mer with any read of a batch are skipped, otherwise all
+         *            components are aligned
+         */
+        void filterComponents()
+        {
+          std::size_t countReadBatches = std::ceil (readSet.size() * 1.0 / SIMD::numSeqs);
+          std::size_t countComponents = graph.numComponents();
+
+          if (graph.componentKmerLength == 0 || countComponents == 1)
+          {
+            batchComponentHits.assign (countReadBatches * countComponents, true);
+            return;
+          }
+
+          batchComponentHits.assign (countReadBatches * countComponents, false);
+
+#pragma omp parallel for schedule(dynamic)
+          for (size_t i = 0; i < countReadBatches; i++)
+          {
+            std::vector<bool> hits (countComponents, false);
+
+            for (size_t j = i * SIMD::numSeqs; j < std::min ((i+1) * SIMD::numSeqs, readSet.size()); j++)
+              graph.markComponentKmerHits (readSet[sortedReadOrder[j]], hits);
+
+            //bits of vector<bool> are packed, so serialize the writes
+#pragma omp critical
+            {
+              for (size_t c = 0; c < countComponents; c++)
+                batchComponentHits[i * countComponents + c] = hits[c];
+            }
+          }
+
+          auto countHits = std::count (batchComponentHits.begin(), batchComponentHits.end(), true);
+          std::cout << "INFO, psgl::Phase1_Vectorized::filterComponents, aligning " << countHits << " out of " 
+            << batchComponentHits.size() << " (read batch, component) pairs" << std::endl;
+        }
+
+        /**
+         * @brief                         check whether DP cell A is visited after cell B 
+         *                                during the forward DP sweep
+         * @details                       useful to break ties among equal scores the same
+         *                                way as a sweep over the complete graph would
+         */
+        static bool visitedLater (int32_t rowA, int64_t colA, int32_t rowB, int64_t colB)
+        {
+          if (rowA / blockHeight != rowB / blockHeight)
+            return rowA / blockHeight > rowB / blockHeight;
+
+          if (colA != colB)
+            return colA > colB;
+
+          return rowA > rowB;
+        }
+
         /**
          * @brief                         execute first phase of alignment i.e. compute DP and 
          *                                find locations of the best alignment of each read
-         * @param[out]  bestScores        best DP scores of reads
-         * @param[out]  bestCols          columns where best alignment ends (for traceback later)
+         * @param[out]  bestScores        best DP scores of reads (vector lanes)
+         * @param[out]  bestCols          global columns where best alignment ends (for traceback later)
          * @param[out]  bestRows          rows where best alignment ends
+         * @param[out]  laneCells         DP cells computed for each lane
+         * @param[out]  laneTime          time (s) of work items, divided among reads of their batch
+         * @tparam      compressed        save scores of last row of each iteration and long hop
+         *                                columns as int8 differences (see deltaCompressible)
          */
-        template <typename Vec>
-          void alignToDAGLocal_Phase1_vectorized (Vec &bestScores, Vec &bestCols, Vec &bestRows) const
+        template <bool compressed, typename Vec>
+          void alignToDAGLocal_Phase1_vectorized (Vec &bestScores, std::vector<int64_t> &bestCols, Vec &bestRows,
+                                                  std::vector<int64_t> &laneCells, std::vector<double> &laneTime) const
           {
             std::size_t readCount = readSet.size();
             std::size_t countReadBatches = std::ceil (readCount * 1.0 / SIMD::numSeqs);
+            std::size_t countComponents = graph.numComponents();
 
-            //column location value requires int32_t type, so may need >1 register per read batch
+            //column location value within a component requires int32_t type, so may need >1 register per read batch
             constexpr size_t colValuesPerRegister = SIMD_REG_SIZE / (8 * sizeof(int32_t));
             constexpr size_t colRegistersCountPerBatch = SIMD::numSeqs / colValuesPerRegister;
 
+            static_assert ( colRegistersCountPerBatch == 1 || 
+                            colRegistersCountPerBatch == 2 || 
+                            colRegistersCountPerBatch == 4, "has to be either 1, 2 or 4"); 
+
             //few checks
-            assert (bestScores.size() == countReadBatches);
-            assert (bestCols.size() == countReadBatches * colRegistersCountPerBatch);
-            assert (bestRows.size() == countReadBatches);
+            assert (bestScores.size() == countReadBatches * SIMD::numSeqs);
+            assert (bestCols.size() == countReadBatches * SIMD::numSeqs);
+            assert (bestRows.size() == countReadBatches * SIMD::numSeqs);
 
 #ifdef VTUNE_SUPPORT
             __itt_resume();
 #endif
 
-            //init best score vector to zero bits
-            std::fill (bestScores.begin(), bestScores.end(), SIMD::zero() );
-            std::fill (bestCols.begin(), bestCols.end(), SIMD::zero() );
-            std::fill (bestRows.begin(), bestRows.end(), SIMD::zero() );
-
             //init score simd vectors
             __mxxxi match512    = SIMD::set1 ((typename SIMD::type) parameters.match);
             __mxxxi mismatch512 = SIMD::set1 ((typename SIMD::type) -1 * parameters.mismatch);
@@ -469,7 +571,26 @@ namespace psgl
 
             //copy graph as function variable for faster access
             const CSR_char_container graphLocal = this->graph;
-            const std::vector<bool> withLongHopLocal = withLongHop;
+            const std::vector<int32_t> longHopSlotLocal = longHopSlot;
+
+            //buffers are sized for the largest component
+            //columns are addressed with int32_t offsets within a component
+            if (graphLocal.maxComponentWidth() > INT32_MAX)
+            {
+              std::cerr << "ERROR, psgl::Phase1_Vectorized::alignToDAGLocal_Phase1_vectorized, component width " << graphLocal.maxComponentWidth() << " exceeds int32_t range" << std::endl;
+              exit(1);
+            }
+
+            const int32_t maxComponentWidth = graphLocal.maxComponentWidth();
+            const int32_t maxComponentLongHops = *std::max_element (componentLongHops.begin(), componentLongHops.end());
+
+            //halo columns of a graph partition are the first columns, their scores are 
+            //received from previous partition rather than computed
+            const int32_t haloCount = partition ? partition->haloCount : 0;
+            const int32_t sendCount = partition ? partition->sendCount : 0;
+
+            //count of columns to look ahead for prefetching scores of predecessors, 0 if disabled
+            const int32_t prefetchDistance = parameters.prefetchDistance;
 
 #pragma omp parallel
             {
@@ -479,19 +600,15 @@ namespace psgl
               //type def. for memory-aligned vector allocation for SIMD instructions
               using AlignedVecType = std::vector <__mxxxi, aligned_alloc<__mxxxi, 64> >;
 
+              //type def. for int8 score differences
+              using DeltaVecType = std::vector <int8_t, aligned_alloc<int8_t, 64> >;
+
               //2D buffer to save selected columns (associated with long hops) of DP matrix
-              std::size_t countLongHops = std::count (withLongHopLocal.begin(), withLongHopLocal.end(), true);
-              AlignedVecType fartherColumnsBuffer (countLongHops * this->blockHeight);
+              //if compressed, only first row of the columns is saved here
+              AlignedVecType fartherColumnsBuffer (maxComponentLongHops * (compressed ? 1 : this->blockHeight));
 
-              //pointer array for convenient data access in 2D buffer
-              std::vector<__mxxxi*> fartherColumns(graphLocal.numVertices);
-              {
-                size_t j = 0;
-
-                for(int32_t i = 0; i < graphLocal.numVertices; i++)
-                  if ( withLongHopLocal[i] )
-                    fartherColumns[i] = &fartherColumnsBuffer[ (j++) * this->blockHeight ];
-              }
+              //if compressed, differences of each row of the long hop columns from their first row
+              DeltaVecType fartherColumnsDelta (compressed ? maxComponentLongHops * this->blockHeight * SIMD::numSeqs : 0);
 
               //buffer to save neighboring column scores
               AlignedVecType nearbyColumnsBuffer (this->blockWidth * this->blockHeight);
@@ -505,22 +622,98 @@ namespace psgl
 
               //buffer to save scores of last row in each iteration
               //one row for writing and one for reading
-              AlignedVecType lastBatchRowBuffer (2 * graphLocal.numVertices);
+              //indexed by column offset within component
+              //if compressed, a single row is read, and its differences from
+              //the new row are written to 'lastBatchRowDelta'
+              AlignedVecType lastBatchRowBuffer ((compressed ? 1 : 2) * maxComponentWidth);
 
               //for convenient access to 2D buffer
               std::vector<__mxxxi*> lastBatchRow (2);
               {
                 lastBatchRow[0] = &lastBatchRowBuffer[0];
-                lastBatchRow[1] = &lastBatchRowBuffer[graphLocal.numVertices];
+                lastBatchRow[1] = &lastBatchRowBuffer[compressed ? 0 : maxComponentWidth];
               }
 
+              DeltaVecType lastBatchRowDelta (compressed ? maxComponentWidth * SIMD::numSeqs : 0);
+
+              //save score of a long hop column
+              auto saveFartherColumn = [&](int32_t slot, size_t l, const __mxxxi &score) {
+                if (compressed)
+                {
+                  if (l == 0)
+                    fartherColumnsBuffer[slot] = score;
+
+                  SIMD::store_delta8 (&fartherColumnsDelta[(slot * blockHeight + l) * SIMD::numSeqs], SIMD::sub (score, fartherColumnsBuffer[slot]));
+                }
+                else
+                  fartherColumnsBuffer[slot * blockHeight + l] = score;
+              };
+
+              //load score of a long hop column
+              auto loadFartherColumn = [&](int32_t slot, size_t l) -> __mxxxi {
+                if (compressed)
+                  return SIMD::add (fartherColumnsBuffer[slot], SIMD::load_delta8 (&fartherColumnsDelta[(slot * blockHeight + l) * SIMD::numSeqs]));
+                else
+                  return fartherColumnsBuffer[slot * blockHeight + l];
+              };
+
+              //prefetch scores of a long hop column
+              auto prefetchFartherColumn = [&](int32_t slot) {
+                if (compressed)
+                {
+                  _mm_prefetch ((const char*) &fartherColumnsBuffer[slot], _MM_HINT_T0);
+
+                  for (size_t b = 0; b < blockHeight * SIMD::numSeqs; b += 64)
+                    _mm_prefetch ((const char*) &fartherColumnsDelta[slot * blockHeight * SIMD::numSeqs + b], _MM_HINT_T0);
+                }
+                else
+                {
+                  for (size_t l = 0; l < blockHeight; l++)
+                    _mm_prefetch ((const char*) &fartherColumnsBuffer[slot * blockHeight + l], _MM_HINT_T0);
+                }
+              };
+
+              //save score of last row of current iteration
+              auto saveLastBatchRow = [&](size_t loopJ, int32_t offset, const __mxxxi &score) {
+                if (compressed)
+                  SIMD::store_delta8 (&lastBatchRowDelta[offset * SIMD::numSeqs], SIMD::sub (score, lastBatchRow[0][offset]));
+                else
+                  lastBatchRow[loopJ & 1][offset] = score;
+              };
+
               //buffer to save read charactes for innermost loop
               std::vector<typename SIMD::type, aligned_alloc<typename SIMD::type, 64> > readCharsInt (SIMD::numSeqs * this->blockHeight);
 
-              //process SIMD::numSeqs reads in a single iteration
+              //buffers to parse best scores from vector registers
+              std::vector<typename SIMD::type, aligned_alloc<typename SIMD::type, 64> > storeScores (SIMD::numSeqs);
+              std::vector<typename SIMD::type, aligned_alloc<typename SIMD::type, 64> > storeRows   (SIMD::numSeqs);
+              std::vector<int32_t,             aligned_alloc<int32_t,             64> > storeCols   (SIMD::numSeqs);
+
+              //scores of halo and boundary columns of a graph partition, for all rows of a work item
+              AlignedVecType haloStrip, sendStrip;
+
+              //process SIMD::numSeqs reads against one graph component in a single iteration
 #pragma omp for schedule(dynamic) nowait
-              for (size_t i = 0; i < countReadBatches; i++)
+              for (size_t w = 0; w < countReadBatches * countComponents; w++)
               {
+                if (!batchComponentHits[w])
+                  continue;
+
+                auto time1 = omp_get_wtime();
+
+                //read batch and graph component for this work item
+                size_t i = w / countComponents;
+                size_t c = w % countComponents;
+
+                const int64_t colBegin = graphLocal.componentOffsets[c];
+                const int32_t width = graphLocal.componentOffsets[c+1] - colBegin;
+
+                //graph arrays of the component, indexed by column offset within component
+                const char *vertexLabel = graphLocal.vertex_label.data() + colBegin;
+                const int64_t *offsetsIn = graphLocal.offsets_in.data() + colBegin;
+                const int32_t *hopSlot = longHopSlotLocal.data() + colBegin;
+                const int32_t *sendSlot = sendCount > 0 ? partition->sendSlot.data() + colBegin : nullptr;
+
                 __mxxxi bestScores512 = SIMD::zero();
                 __mxxxi bestRows512   = SIMD::zero();
 
@@ -531,11 +724,21 @@ namespace psgl
                 __mxxxi bestCols512_3   = SIMD::zero();
 
                 //reset DP 'lastBatchRow' buffer
-                std::fill (lastBatchRowBuffer.begin(), lastBatchRowBuffer.end(), SIMD::zero());
+                std::fill (lastBatchRow[0], lastBatchRow[0] + width, SIMD::zero());
+                std::fill (lastBatchRow[1], lastBatchRow[1] + width, SIMD::zero());
 
                 int32_t qryBatchLength = readSet[sortedReadOrder[i * SIMD::numSeqs]].length();  //longest read in this batch
                 qryBatchLength += this->blockHeight - 1 - (qryBatchLength - 1) % this->blockHeight; //round-up
 
+                if (haloCount > 0)
+                {
+                  haloStrip.resize (qryBatchLength * haloCount);
+                  partition->receiveStrip (w, haloStrip.data(), haloStrip.size() * sizeof(__mxxxi));
+                }
+
+                if (sendCount > 0)
+                  sendStrip.resize (qryBatchLength * sendCount);
+
                 //iterate over read length (process more than 1 characters in batch)
                 for (int32_t j = 0; j < qryBatchLength; j += this->blockHeight)
                 {
@@ -548,11 +751,42 @@ namespace psgl
                     readCharsInt [k] = readSetSOA [readSetSOAPrefixSum[i] + j*SIMD::numSeqs + k];
                   }
 
-                  //iterate over characters in reference graph
-                  for (int32_t k = 0; k < graphLocal.numVertices; k++)
+                  //load halo columns into DP buffers
+                  for (int32_t k = 0; k < haloCount; k++)
                   {
+                    for (size_t l = 0; l < this->blockHeight; l++)
+                    {
+                      nearbyColumns[k & (blockWidth-1)][l] = haloStrip[(j + l) * haloCount + k];
+
+                      if ( hopSlot[k] >= 0 )
+                        saveFartherColumn (hopSlot[k], l, nearbyColumns[k & (blockWidth-1)][l]);
+
+                      if (sendCount > 0 && sendSlot[k] >= 0)
+                        sendStrip[(j + l) * sendCount + sendSlot[k]] = nearbyColumns[k & (blockWidth-1)][l];
+                    }
+
+                    saveLastBatchRow (loopJ, k, nearbyColumns[k & (blockWidth-1)][blockHeight - 1]);
+                  }
+
+                  //iterate over characters in reference graph component
+                  for (int32_t k = haloCount; k < width; k++)
+                  {
+                    //predecessors of a column ahead are not predictable by hardware prefetcher
+                    if (prefetchDistance > 0 && k + prefetchDistance < width)
+                    {
+                      auto ahead = k + prefetchDistance;
+
+                      for(auto m = offsetsIn[ahead]; m < offsetsIn[ahead+1]; m++)
+                      {
+                        _mm_prefetch ((const char*) &lastBatchRow[(loopJ - 1) & 1][ ahead - graphLocal.adjcny_in[m] ], _MM_HINT_T0);
+
+                        if (graphLocal.adjcny_in[m] >= this->blockWidth)
+                          prefetchFartherColumn (hopSlot[ahead - graphLocal.adjcny_in[m]]);
+                      }
+                    }
+
                     //current reference character
-                    __mxxxi graphChar = SIMD::set1 ((typename SIMD::type) graphLocal.vertex_label[k] );
+                    __mxxxi graphChar = SIMD::set1 ((typename SIMD::type) vertexLabel[k] );
 
                     //current best score, init to 0
                     __mxxxi currentMax512;
@@ -577,19 +811,21 @@ namespace psgl
                       //which buffers to access depends on the value of 'l'
                       if (l == 0)
                       {
-                        for(size_t m = graphLocal.offsets_in[k]; m < graphLocal.offsets_in[k+1]; m++)
+                        for(auto m = offsetsIn[k]; m < offsetsIn[k+1]; m++)
                         {
+                          int32_t from = k - graphLocal.adjcny_in[m];
+
                           //paths with match mismatch edit
-                          __mxxxi substEdit = SIMD::add ( lastBatchRow[(loopJ - 1) & 1][ graphLocal.adjcny_in[m] ], sub512);
+                          __mxxxi substEdit = SIMD::add ( lastBatchRow[(loopJ - 1) & 1][from], sub512);
                           currentMax512 = SIMD::max (currentMax512, substEdit); 
 
                           //paths with deletion edit
                           __mxxxi delEdit;
 
-                          if (k - graphLocal.adjcny_in[m] < this->blockWidth)
-                            delEdit = SIMD::add ( nearbyColumns[graphLocal.adjcny_in[m] & (blockWidth-1)][l], del512);
+                          if (graphLocal.adjcny_in[m] < this->blockWidth)
+                            delEdit = SIMD::add ( nearbyColumns[from & (blockWidth-1)][l], del512);
                           else
-                            delEdit = SIMD::add ( fartherColumns[graphLocal.adjcny_in[m]][l], del512);
+                            delEdit = SIMD::add ( loadFartherColumn (hopSlot[from], l), del512);
 
                           currentMax512 = SIMD::max (currentMax512, delEdit); 
                         }
@@ -600,23 +836,26 @@ namespace psgl
                       }
                       else
                       {
-                        for(size_t m = graphLocal.offsets_in[k]; m < graphLocal.offsets_in[k+1]; m++)
+                        for(auto m = offsetsIn[k]; m < offsetsIn[k+1]; m++)
                         {
+                          int32_t from = k - graphLocal.adjcny_in[m];
+
                           //paths with match mismatch edit
                           __mxxxi substEdit;
 
                           //paths with deletion edit
                           __mxxxi delEdit;
 
-                          if (k - graphLocal.adjcny_in[m] < this->blockWidth)
+                          if (graphLocal.adjcny_in[m] < this->blockWidth)
                           {
-                            substEdit = SIMD::add ( nearbyColumns[graphLocal.adjcny_in[m] & (blockWidth-1)][l-1], sub512);
-                            delEdit = SIMD::add ( nearbyColumns[graphLocal.adjcny_in[m] & (blockWidth-1)][l], del512);
+                            substEdit = SIMD::add ( nearbyColumns[from & (blockWidth-1)][l-1], sub512);
+                            delEdit = SIMD::add ( nearbyColumns[from & (blockWidth-1)][l], del512);
                           }
                           else
                           {
-                            substEdit = SIMD::add ( fartherColumns[graphLocal.adjcny_in[m]][l-1], sub512);
-                            delEdit = SIMD::add ( fartherColumns[graphLocal.adjcny_in[m]][l], del512);
+                            auto slot = hopSlot[from];
+                            substEdit = SIMD::add ( loadFartherColumn (slot, l-1), sub512);
+                            delEdit = SIMD::add ( loadFartherColumn (slot, l), del512);
                           }
 
                           currentMax512 = SIMD::max (currentMax512, substEdit); 
@@ -636,41 +875,80 @@ namespace psgl
 
                       //update row and column values accordingly
                       bestRows512 = SIMD::mask_set1 (bestRows512, updated, (typename SIMD::type) (j + l));
-                      SIMD::update_cols (bestCols512_0, bestCols512_1, bestCols512_2, bestCols512_3, (int32_t) k, updated);
+                      SIMD::update_cols (bestCols512_0, bestCols512_1, bestCols512_2, bestCols512_3, k, updated);
 
                       //save current score in small buffer
                       nearbyColumns[k & (blockWidth-1)][l] = currentMax512;
 
                       //save current score in large buffer if connected thru long hop
-                      if ( withLongHopLocal[k] )
-                        fartherColumns[k][l] = currentMax512;
+                      if ( hopSlot[k] >= 0 )
+                        saveFartherColumn (hopSlot[k], l, currentMax512);
                     }
 
                     //save last score for next row-wise iteration
-                    lastBatchRow[loopJ & 1][k] = currentMax512; 
+                    saveLastBatchRow (loopJ, k, currentMax512);
+
+                    //save scores of boundary column for next graph partition
+                    if (sendCount > 0 && sendSlot[k] >= 0)
+                      for (size_t l = 0; l < this->blockHeight; l++)
+                        sendStrip[(j + l) * sendCount + sendSlot[k]] = nearbyColumns[k & (blockWidth-1)][l];
 
                   } // end of row computation
+
+                  //apply differences to get last row of current iteration
+                  if (compressed)
+                  {
+                    for (int32_t k = 0; k < width; k++)
+                      lastBatchRow[0][k] = SIMD::add (lastBatchRow[0][k], SIMD::load_delta8 (&lastBatchRowDelta[k * SIMD::numSeqs]));
+                  }
                 } // end of DP
 
-                bestScores[i] = bestScores512;
-                bestRows[i]   = bestRows512; 
+                if (sendCount > 0)
+                  partition->sendStrip (w, sendStrip.data(), sendStrip.size() * sizeof(__mxxxi));
+
+                //parse best scores from vector registers
                 {
+                  SIMD::store ((__mxxxi*) storeScores.data(), bestScores512);
+                  SIMD::store ((__mxxxi*) storeRows.data()  , bestRows512);
+
                   //storing best columns requires extra work
-                  if (colRegistersCountPerBatch == 1)
-                  {
-                    bestCols[1*i + 0]   = bestCols512_0; 
-                  }
-                  else if (colRegistersCountPerBatch == 2)
+                  SIMD::store ((__mxxxi*) &storeCols [0], bestCols512_0); 
+
+                  if (colRegistersCountPerBatch >= 2)
+                    SIMD::store ((__mxxxi*) &storeCols [1*colValuesPerRegister], bestCols512_1); 
+
+                  if (colRegistersCountPerBatch == 4)
                   {
-                    bestCols[2*i + 0]   = bestCols512_0;
-                    bestCols[2*i + 1]   = bestCols512_1;
+                    SIMD::store ((__mxxxi*) &storeCols [2*colValuesPerRegister], bestCols512_2); 
+                    SIMD::store ((__mxxxi*) &storeCols [3*colValuesPerRegister], bestCols512_3); 
                   }
-                  else if (colRegistersCountPerBatch == 4)
+                }
+
+                //time of this work item is divided among reads of the batch
+                const std::size_t batchReads = std::min<std::size_t> (SIMD::numSeqs, readCount - i * SIMD::numSeqs);
+                const double laneShare = (omp_get_wtime() - time1) / batchReads;
+
+                //reduce with results of other components aligned to this read batch
+#pragma omp critical
+                {
+                  for (size_t j = 0; j < SIMD::numSeqs; j++)
                   {
-                    bestCols[4*i + 0]   = bestCols512_0;
-                    bestCols[4*i + 1]   = bestCols512_1;
-                    bestCols[4*i + 2]   = bestCols512_2;
-                    bestCols[4*i + 3]   = bestCols512_3;
+                    auto lane = i * SIMD::numSeqs + j;
+
+                    laneCells[lane] += (int64_t) qryBatchLength * (width - haloCount);
+                    laneTime[lane]  += laneShare;
+
+                    int32_t score = storeScores[j];
+                    int32_t row = storeRows[j];
+                    int64_t col = colBegin + storeCols[j];
+
+                    if (score > bestScores[lane] || 
+                        (score == bestScores[lane] && visitedLater (row, col, bestRows[lane], bestCols[lane])))
+                    {
+                      bestScores[lane] = score;
+                      bestRows[lane]   = row;
+                      bestCols[lane]   = col;
+                    }
                   }
                 }
 
@@ -693,6 +971,10 @@ namespace psgl
 
   /**
    * @brief   Supports phase 1 DP in reverse direction
+   * @details Similar to forward DP, work is scheduled as (read batch, graph 
+   *          component) pairs. Only the component containing the end location 
+   *          of a read's forward alignment is relevant for the read, so components 
+   *          without any such end location in a read batch are skipped
    */
   template <typename SIMD>
     class Phase1_Rev_Vectorized
@@ -703,8 +985,12 @@ namespace psgl
         const CSR_char_container &graph;
 
         // pre-compute which graph vertices are connected with hop longer
-        // than 'blockWidth'
-        std::vector<bool> withLongHop;
+        // than 'blockWidth', and assign them a slot in long hop buffer
+        // slots are numbered within each component, -1 if not required
+        std::vector<int32_t> longHopSlot;
+
+        //count of long hop slots required by each component
+        std::vector<int32_t> componentLongHops;
 
         //for converting input reads into SOA to enable vectorization
         std::vector<char> readSetSOA;
@@ -724,6 +1010,9 @@ namespace psgl
         //input parameters (e.g., scoring scheme)
         const Parameters &parameters;
 
+        //boundary state if graph is a partition of a larger graph, see partition.hpp
+        PartitionBoundary *partition;
+
       public:
 
         //small temporary storage buffer for DP scores
@@ -738,11 +1027,13 @@ namespace psgl
          * @brief                   public constructor
          * @param[in]   readSet     vector of input query sequences to align
          * @param[in]   g           input reference graph
+         * @param[in]   partition   boundary state if 'g' is a graph partition
          */
         Phase1_Rev_Vectorized(const std::vector<std::string> &readSet, 
             const CSR_char_container &g,
-            const Parameters &p) :
-          readSet (readSet), graph (g), parameters (p)
+            const Parameters &p,
+            PartitionBoundary *partition = nullptr) :
+          readSet (readSet), graph (g), parameters (p), partition (partition)
         {
           this->sortReadsForLoadBalance();
           this->convertToSOA();
@@ -762,67 +1053,71 @@ namespace psgl
 
             std::size_t countReadBatches = std::ceil (readSet.size() * 1.0 / SIMD::numSeqs);
 
-            //column location value requires int32_t type, so may need >1 register per read batch
-            constexpr size_t colValuesPerRegister = SIMD_REG_SIZE / (8 * sizeof(int32_t));
-            constexpr size_t colRegistersCountPerBatch = SIMD::numSeqs / colValuesPerRegister;
+            //best score info of each vector lane, i.e., reads in their sorted order
+            std::vector<int32_t> bestScores (countReadBatches * SIMD::numSeqs, 0);
+            std::vector<int64_t> bestCols   (countReadBatches * SIMD::numSeqs, 0);
+            std::vector<int32_t> bestRows   (countReadBatches * SIMD::numSeqs, 0);
 
-            static_assert ( colRegistersCountPerBatch == 1 || 
-                            colRegistersCountPerBatch == 2 || 
-                            colRegistersCountPerBatch == 4, "has to be either 1, 2 or 4"); 
+            //DP cells and time charged to each lane
+            std::vector<int64_t> laneCells (countReadBatches * SIMD::numSeqs, 0);
+            std::vector<double>  laneTime  (countReadBatches * SIMD::numSeqs, 0);
 
-            // modified containers to hold best-score info
-            // vector elements aligned to 64 byte boundaries
-            std::vector <__mxxxi, aligned_alloc<__mxxxi, 64> > _bestScoreVector (countReadBatches);
-            std::vector <__mxxxi, aligned_alloc<__mxxxi, 64> > _bestScoreRowVector (countReadBatches);
-            std::vector <__mxxxi, aligned_alloc<__mxxxi, 64> > 
-                  _bestScoreColVector (countReadBatches * colRegistersCountPerBatch);
+            //wall-clock time when reverse DP of each lane began
+            std::vector<double>  laneStart (countReadBatches * SIMD::numSeqs, 0);
 
-            this->alignToDAGLocal_Phase1_rev_vectorized (outputBestScoreVector, _bestScoreVector, _bestScoreColVector, _bestScoreRowVector); 
-
-            //when debugging for low-precision
-#ifdef DEBUG
-            for (auto &e : _bestScoreVector)
-              simdUtils<typename SIMD::type>::print_avx_num (e);
+            //lanes exceeding cell budget or deadline
+            std::vector<const char*> laneOverrun (countReadBatches * SIMD::numSeqs, nullptr);
 
-            for (auto &e : _bestScoreRowVector)
-              simdUtils<typename SIMD::type>::print_avx_num (e);
+            if (Phase1_Vectorized<SIMD>::deltaCompressible (parameters))
+              this->alignToDAGLocal_Phase1_rev_vectorized<true> (outputBestScoreVector, bestScores, bestCols, bestRows, laneCells, laneTime, laneStart, laneOverrun); 
+            else
+              this->alignToDAGLocal_Phase1_rev_vectorized<false> (outputBestScoreVector, bestScores, bestCols, bestRows, laneCells, laneTime, laneStart, laneOverrun); 
 
-            for (auto &e : _bestScoreColVector)
-              simdUtils<int32_t>::print_avx_num (e);
-#endif
+            //reduce results of all graph partitions at partition 0
+            if (partition != nullptr)
+            {
+              for (auto &col : bestCols)
+                col = partition->toGlobal (col);
 
-            //parse best scores from vector registers
-            std::vector<typename SIMD::type, aligned_alloc<typename SIMD::type, 64> > storeScores (SIMD::numSeqs);
-            std::vector<typename SIMD::type, aligned_alloc<typename SIMD::type, 64> > storeRows   (SIMD::numSeqs);
-            std::vector<int32_t,             aligned_alloc<int32_t,             64> > storeCols   (SIMD::numSeqs);
+              if (!partition->gatherBestScores (bestScores, bestCols, bestRows, blockHeight))
+                return;
+            }
 
-            for (size_t i = 0; i < countReadBatches; i++)
+            for (size_t i = 0; i < readSet.size(); i++)
             {
-              SIMD::store ((__mxxxi*) storeScores.data(), _bestScoreVector[i]);
-              SIMD::store ((__mxxxi*) storeRows.data()  , _bestScoreRowVector[i]);
+              auto originalReadId = sortedReadOrder[i];
+
+#ifdef DEBUG
+              std::cout << "INFO, psgl::Phase1_Vectorized::alignToDAGLocal_Phase1_rev_vectorized_wrapper, read # " << originalReadId << ",  score = " << bestScores[i] << ", refColumnStart = " << bestCols[i] << ", qryRowStart = " << (int) (readSet[originalReadId].length() - 1 - bestRows[i]) << "\n";
+#endif
 
-              for (size_t j = 0; j < colRegistersCountPerBatch; j++) 
+              //unaligned reads are skipped during reverse DP
+              if (outputBestScoreVector[originalReadId].score == 0)
               {
-                SIMD::store ((__mxxxi*) &storeCols [j*colValuesPerRegister], 
-                            _bestScoreColVector[i * colRegistersCountPerBatch + j]);
+                outputBestScoreVector[originalReadId].refColumnStart  = outputBestScoreVector[originalReadId].refColumnEnd;
+                outputBestScoreVector[originalReadId].qryRowStart     = outputBestScoreVector[originalReadId].qryRowEnd;
+                continue;
               }
 
-              for (size_t j = 0; j < SIMD::numSeqs; j++)
-              {
-                if (i * SIMD::numSeqs + j < readSet.size())
-                {
-                  auto originalReadId = sortedReadOrder[i * SIMD::numSeqs + j];
+              outputBestScoreVector[originalReadId].cost.p1rCells   = laneCells[i];
+              outputBestScoreVector[originalReadId].cost.p1rTime    = laneTime[i];
+              outputBestScoreVector[originalReadId].cost.p1rStart   = laneStart[i];
 
-#ifdef DEBUG
-                  std::cout << "INFO, psgl::Phase1_Vectorized::alignToDAGLocal_Phase1_rev_vectorized_wrapper, read # " << originalReadId << ",  score = " << (int) storeScores[j] << ", refColumnStart = " << (int) storeCols[j] << ", qryRowStart = " << (int) (readSet[originalReadId].length() - 1 - storeRows[j]) << "\n";
-#endif
+              //begin location is unknown if budget or deadline was exceeded
+              if (laneOverrun[i])
+              {
+                outputBestScoreVector[originalReadId].overrun         = laneOverrun[i];
+                outputBestScoreVector[originalReadId].refColumnStart  = -1;
+                outputBestScoreVector[originalReadId].qryRowStart     = -1;
+                continue;
+              }
 
-                  assert (outputBestScoreVector[originalReadId].score == storeScores[j] - 1);  //offset by 1
-                  outputBestScoreVector[originalReadId].refColumnStart  = storeCols[j];
-                  outputBestScoreVector[originalReadId].qryRowStart     = readSet[originalReadId].length() - 1 - storeRows[j];
+              //reverse DP should reproduce the best score, offset by 1
+              if (parameters.validateRead (originalReadId) && outputBestScoreVector[originalReadId].score != bestScores[i] - 1)
+                outputBestScoreVector[originalReadId].invalid = "best score of phase 1-R differs from phase 1";
 
-                }
-              }
+              outputBestScoreVector[originalReadId].refColumnStart  = bestCols[i];
+              outputBestScoreVector[originalReadId].qryRowStart     = readSet[originalReadId].length() - 1 - bestRows[i];
             }
           }
 
@@ -902,25 +1197,29 @@ namespace psgl
          */
         void computeLongHops()
         {
-          assert (withLongHop.size() == 0);
+          assert (longHopSlot.size() == 0);
 
-          this->withLongHop.resize(graph.numVertices, false);
+          this->longHopSlot.resize(graph.numVertices, -1);
+          this->componentLongHops.resize(graph.numComponents(), 0);
 
-          for(int32_t i = 0; i < graph.numVertices; i++)
+          for(int64_t i = 0; i < graph.numVertices; i++)
           {
             for(auto j = graph.offsets_in[i]; j < graph.offsets_in[i+1]; j++)
             {
-              auto from_pos = graph.adjcny_in[j];
-              auto to_pos = i;
-
               //compare hop distance to 'blockWidth'
-              if (to_pos - from_pos >= this->blockWidth)
-                this->withLongHop[to_pos] = true;
+              if (graph.adjcny_in[j] >= this->blockWidth)
+                this->longHopSlot[i] = 0;
             }
           }
 
+          //number the slots within each component
+          for(std::size_t c = 0; c < graph.numComponents(); c++)
+            for(int64_t i = graph.componentOffsets[c]; i < graph.componentOffsets[c+1]; i++)
+              if (longHopSlot[i] == 0)
+                longHopSlot[i] = componentLongHops[c]++;
+
 #ifdef DEBUG
-          auto trueCount = std::count(withLongHop.begin(), withLongHop.end(), true);
+          auto trueCount = std::accumulate(componentLongHops.begin(), componentLongHops.end(), (std::size_t) 0);
           std::cout << "INFO, psgl::Phase1_Rev_Vectorized::computeLongHops, fraction of hops that are long: " << trueCount * 1.0 / graph.numVertices << "\n";
 #endif
         }
@@ -930,34 +1229,60 @@ namespace psgl
          *                                      compute reverse DP and find begin locations of the best 
          *                                      alignment of each read
          * @param[in]   outputBestScoreVector   best scores and end locations computed during forward DP
-         * @param[out]  bestScores              best DP scores of reads
-         * @param[out]  bestCols                columns where best alignment starts
+         * @param[out]  bestScores              best DP scores of reads (vector lanes)
+         * @param[out]  bestCols                global columns where best alignment starts
          * @param[out]  bestRows                rows where best alignment starts
+         * @param[out]  laneCells               DP cells computed for each lane
+         * @param[out]  laneTime                time (s) of work items, divided among reads aligned to their component
+         * @param[out]  laneStart               wall-clock time when the work item of each lane began
+         * @param[out]  laneOverrun             reason a lane was not aligned completely, i.e., cell budget or deadline
+         * @tparam      compressed              save scores of last row of each iteration and long hop
+         *                                      columns as int8 differences (see deltaCompressible)
          */
-        template <typename Vec1, typename Vec2>
+        template <bool compressed, typename Vec1, typename Vec2>
           void alignToDAGLocal_Phase1_rev_vectorized (const Vec1 &outputBestScoreVector,
-                                                      Vec2 &bestScores, Vec2 &bestCols, Vec2 &bestRows) const
+                                                      Vec2 &bestScores, std::vector<int64_t> &bestCols, Vec2 &bestRows,
+                                                      std::vector<int64_t> &laneCells, std::vector<double> &laneTime,
+                                                      std::vector<double> &laneStart, std::vector<const char*> &laneOverrun) const
           {
             std::size_t readCount = readSet.size();
             std::size_t countReadBatches = std::ceil (readCount * 1.0 / SIMD::numSeqs);
+            std::size_t countComponents = graph.numComponents();
 
-            //column location value requires int32_t type, so may need >1 register per read batch
+            //column location value within a component requires int32_t type, so may need >1 register per read batch
             constexpr size_t colValuesPerRegister = SIMD_REG_SIZE / (8 * sizeof(int32_t));
             constexpr size_t colRegistersCountPerBatch = SIMD::numSeqs / colValuesPerRegister;
 
+            static_assert ( colRegistersCountPerBatch == 1 || 
+                            colRegistersCountPerBatch == 2 || 
+                            colRegistersCountPerBatch == 4, "has to be either 1, 2 or 4"); 
+
             //few checks
-            assert (bestScores.size() == countReadBatches);
-            assert (bestRows.size()   == countReadBatches);
-            assert (bestCols.size()   == countReadBatches * colRegistersCountPerBatch);
+            assert (bestScores.size() == countReadBatches * SIMD::numSeqs);
+            assert (bestRows.size()   == countReadBatches * SIMD::numSeqs);
+            assert (bestCols.size()   == countReadBatches * SIMD::numSeqs);
 
 //#ifdef VTUNE_SUPPORT
             //__itt_resume();
 //#endif
 
-            //init best score vector to zero bits
-            std::fill (bestScores.begin(), bestScores.end(), SIMD::zero() );
-            std::fill (bestCols.begin(),   bestCols.end(),   SIMD::zero() );
-            std::fill (bestRows.begin(),   bestRows.end(),   SIMD::zero() );
+            //component of each vector lane's forward alignment, -1 if unaligned
+            std::vector<int32_t> laneComponent (countReadBatches * SIMD::numSeqs, -1);
+
+            //which components should be aligned with each read batch
+            std::vector<bool> batchComponentHits (countReadBatches * countComponents, false);
+
+            for (size_t i = 0; i < readCount; i++)
+            {
+              auto originalReadId = sortedReadOrder[i];
+
+              if (outputBestScoreVector[originalReadId].score > 0)
+              {
+                //a graph partition is aligned as a single component, irrespective of end location
+                laneComponent[i] = partition ? 0 : graph.componentOf (outputBestScoreVector[originalReadId].refColumnEnd);
+                batchComponentHits[(i / SIMD::numSeqs) * countComponents + laneComponent[i]] = true;
+              }
+            }
 
             //init score simd vectors
             __mxxxi match512    = SIMD::set1 ((typename SIMD::type) parameters.match);
@@ -969,7 +1294,26 @@ namespace psgl
 
             //copy graph as function variable for faster access
             const CSR_char_container graphLocal = this->graph;
-            const std::vector<bool> withLongHopLocal = withLongHop;
+            const std::vector<int32_t> longHopSlotLocal = longHopSlot;
+
+            //buffers are sized for the largest component
+            //columns are addressed with int32_t offsets within a component
+            if (graphLocal.maxComponentWidth() > INT32_MAX)
+            {
+              std::cerr << "ERROR, psgl::Phase1_Rev_Vectorized::alignToDAGLocal_Phase1_rev_vectorized, component width " << graphLocal.maxComponentWidth() << " exceeds int32_t range" << std::endl;
+              exit(1);
+            }
+
+            const int32_t maxComponentWidth = graphLocal.maxComponentWidth();
+            const int32_t maxComponentLongHops = *std::max_element (componentLongHops.begin(), componentLongHops.end());
+
+            //halo columns of a graph partition are the last columns, their scores are 
+            //received from previous partition rather than computed
+            const int32_t haloCount = partition ? partition->haloCount : 0;
+            const int32_t sendCount = partition ? partition->sendCount : 0;
+
+            //count of columns to look ahead for prefetching scores of predecessors, 0 if disabled
+            const int32_t prefetchDistance = parameters.prefetchDistance;
 
 #pragma omp parallel
             {
@@ -979,19 +1323,15 @@ namespace psgl
               //type def. for memory-aligned vector allocation for SIMD instructions
               using AlignedVecType = std::vector <__mxxxi, aligned_alloc<__mxxxi, 64> >;
 
-              //2D buffer to save selected columns (associated with long hops) of DP matrix
-              std::size_t countLongHops = std::count (withLongHopLocal.begin(), withLongHopLocal.end(), true);
-              AlignedVecType fartherColumnsBuffer (countLongHops * this->blockHeight);
+              //type def. for int8 score differences
+              using DeltaVecType = std::vector <int8_t, aligned_alloc<int8_t, 64> >;
 
-              //pointer array for convenient data access in 2D buffer
-              std::vector<__mxxxi*> fartherColumns(graphLocal.numVertices);
-              {
-                size_t j = 0;
+              //2D buffer to save selected columns (associated with long hops) of DP matrix
+              //if compressed, only first row of the columns is saved here
+              AlignedVecType fartherColumnsBuffer (maxComponentLongHops * (compressed ? 1 : this->blockHeight));
 
-                for(int32_t i = 0; i < graphLocal.numVertices; i++)
-                  if ( this->withLongHop[i] )
-                    fartherColumns[i] = &fartherColumnsBuffer[ (j++) * this->blockHeight ];
-              }
+              //if compressed, differences of each row of the long hop columns from their first row
+              DeltaVecType fartherColumnsDelta (compressed ? maxComponentLongHops * this->blockHeight * SIMD::numSeqs : 0);
 
               //buffer to save neighboring column scores
               AlignedVecType nearbyColumnsBuffer (this->blockWidth * this->blockHeight);
@@ -1005,22 +1345,98 @@ namespace psgl
 
               //buffer to save scores of last row in each iteration
               //one row for writing and one for reading
-              AlignedVecType lastBatchRowBuffer (2 * graphLocal.numVertices);
+              //indexed by column offset within component
+              //if compressed, a single row is read, and its differences from
+              //the new row are written to 'lastBatchRowDelta'
+              AlignedVecType lastBatchRowBuffer ((compressed ? 1 : 2) * maxComponentWidth);
 
               //for convenient access to 2D buffer
               std::vector<__mxxxi*> lastBatchRow (2);
               {
                 lastBatchRow[0] = &lastBatchRowBuffer[0];
-                lastBatchRow[1] = &lastBatchRowBuffer[graphLocal.numVertices];
+                lastBatchRow[1] = &lastBatchRowBuffer[compressed ? 0 : maxComponentWidth];
               }
 
+              DeltaVecType lastBatchRowDelta (compressed ? maxComponentWidth * SIMD::numSeqs : 0);
+
+              //save score of a long hop column
+              auto saveFartherColumn = [&](int32_t slot, size_t l, const __mxxxi &score) {
+                if (compressed)
+                {
+                  if (l == 0)
+                    fartherColumnsBuffer[slot] = score;
+
+                  SIMD::store_delta8 (&fartherColumnsDelta[(slot * blockHeight + l) * SIMD::numSeqs], SIMD::sub (score, fartherColumnsBuffer[slot]));
+                }
+                else
+                  fartherColumnsBuffer[slot * blockHeight + l] = score;
+              };
+
+              //load score of a long hop column
+              auto loadFartherColumn = [&](int32_t slot, size_t l) -> __mxxxi {
+                if (compressed)
+                  return SIMD::add (fartherColumnsBuffer[slot], SIMD::load_delta8 (&fartherColumnsDelta[(slot * blockHeight + l) * SIMD::numSeqs]));
+                else
+                  return fartherColumnsBuffer[slot * blockHeight + l];
+              };
+
+              //prefetch scores of a long hop column
+              auto prefetchFartherColumn = [&](int32_t slot) {
+                if (compressed)
+                {
+                  _mm_prefetch ((const char*) &fartherColumnsBuffer[slot], _MM_HINT_T0);
+
+                  for (size_t b = 0; b < blockHeight * SIMD::numSeqs; b += 64)
+                    _mm_prefetch ((const char*) &fartherColumnsDelta[slot * blockHeight * SIMD::numSeqs + b], _MM_HINT_T0);
+                }
+                else
+                {
+                  for (size_t l = 0; l < blockHeight; l++)
+                    _mm_prefetch ((const char*) &fartherColumnsBuffer[slot * blockHeight + l], _MM_HINT_T0);
+                }
+              };
+
+              //save score of last row of current iteration
+              auto saveLastBatchRow = [&](size_t loopJ, int32_t offset, const __mxxxi &score) {
+                if (compressed)
+                  SIMD::store_delta8 (&lastBatchRowDelta[offset * SIMD::numSeqs], SIMD::sub (score, lastBatchRow[0][offset]));
+                else
+                  lastBatchRow[loopJ & 1][offset] = score;
+              };
+
               //buffer to save read charactes for innermost loop
               std::vector<typename SIMD::type, aligned_alloc<typename SIMD::type, 64> > readCharsInt (SIMD::numSeqs * this->blockHeight);
 
-              //process SIMD::numSeqs reads in a single iteration
+              //buffers to parse best scores from vector registers
+              std::vector<typename SIMD::type, aligned_alloc<typename SIMD::type, 64> > storeScores (SIMD::numSeqs);
+              std::vector<typename SIMD::type, aligned_alloc<typename SIMD::type, 64> > storeRows   (SIMD::numSeqs);
+              std::vector<int32_t,             aligned_alloc<int32_t,             64> > storeCols   (SIMD::numSeqs);
+
+              //scores of halo and boundary columns of a graph partition, for all rows of a work item
+              AlignedVecType haloStrip, sendStrip;
+
+              //process SIMD::numSeqs reads against one graph component in a single iteration
 #pragma omp for schedule(dynamic) nowait
-              for (size_t i = 0; i < countReadBatches; i++)
+              for (size_t w = 0; w < countReadBatches * countComponents; w++)
               {
+                if (!batchComponentHits[w])
+                  continue;
+
+                auto time1 = omp_get_wtime();
+
+                //read batch and graph component for this work item
+                size_t i = w / countComponents;
+                size_t c = w % countComponents;
+
+                const int64_t colBegin = graphLocal.componentOffsets[c];
+                const int32_t width = graphLocal.componentOffsets[c+1] - colBegin;
+
+                //graph arrays of the component, indexed by column offset within component
+                const char *vertexLabel = graphLocal.vertex_label.data() + colBegin;
+                const int64_t *offsetsOut = graphLocal.offsets_out.data() + colBegin;
+                const int32_t *hopSlot = longHopSlotLocal.data() + colBegin;
+                const int32_t *sendSlot = sendCount > 0 ? partition->sendSlot.data() + colBegin : nullptr;
+
                 //first parse alignment locations of forward DP
                 __mxxxi fwdBestRows512;
 
@@ -1033,14 +1449,17 @@ namespace psgl
                 //begin reading fwd DP results
                 {
                   std::vector<typename SIMD::type, aligned_alloc<typename SIMD::type, 64> > fwdBestRows (SIMD::numSeqs);
-                  std::vector<int32_t, aligned_alloc<int32_t, 64> > fwdBestCols (SIMD::numSeqs);
+
+                  //column offset -1 is never matched, used for lanes aligned to other components
+                  std::vector<int32_t, aligned_alloc<int32_t, 64> > fwdBestCols (SIMD::numSeqs, -1);
 
                   for (size_t j = 0; j < SIMD::numSeqs; j++)
                   {
-                    if (i * SIMD::numSeqs + j < readSet.size())
+                    if (i * SIMD::numSeqs + j < readSet.size() && laneComponent[i * SIMD::numSeqs + j] == c)
                     {
                       auto originalReadId = sortedReadOrder[i * SIMD::numSeqs + j];
-                      fwdBestCols[j] = outputBestScoreVector[originalReadId].refColumnEnd;
+                      auto fwdCol = outputBestScoreVector[originalReadId].refColumnEnd;
+                      fwdBestCols[j] = (partition ? partition->toLocal (fwdCol) : fwdCol) - colBegin;
                       fwdBestRows[j] = readSet[originalReadId].length() - 1 - outputBestScoreVector[originalReadId].qryRowEnd;
                     }
                   }
@@ -1072,14 +1491,39 @@ namespace psgl
                 __mxxxi bestCols512_3   = SIMD::zero();
 
                 //reset DP 'lastBatchRow' buffer
-                std::fill (lastBatchRowBuffer.begin(), lastBatchRowBuffer.end(), SIMD::zero() );
+                std::fill (lastBatchRow[0], lastBatchRow[0] + width, SIMD::zero());
+                std::fill (lastBatchRow[1], lastBatchRow[1] + width, SIMD::zero());
 
                 int32_t qryBatchLength = readSet[sortedReadOrder[i * SIMD::numSeqs]].length();  //longest read in this batch
                 qryBatchLength += this->blockHeight - 1 - (qryBatchLength - 1) % this->blockHeight; //round-up
 
+                if (haloCount > 0)
+                {
+                  haloStrip.resize (qryBatchLength * haloCount);
+                  partition->receiveStrip (w, haloStrip.data(), haloStrip.size() * sizeof(__mxxxi));
+                }
+
+                if (sendCount > 0)
+                  sendStrip.resize (qryBatchLength * sendCount);
+
+                //lanes exceeding cell budget are not aligned further
+                //note: budget and deadline are not checked with graph partitions
+                const char *overrun = parameters.overBudget ((int64_t) qryBatchLength * (width - haloCount)) ? "cell budget exceeded in phase 1-R" : nullptr;
+
+                //rows computed before budget or deadline was exceeded
+                int32_t rowsComputed = overrun ? 0 : qryBatchLength;
+
                 //iterate over read length (process more than 1 characters in batch)
-                for (int32_t j = 0; j < qryBatchLength; j += this->blockHeight)
+                for (int32_t j = 0; j < qryBatchLength && !overrun; j += this->blockHeight)
                 {
+                  //check deadline once per row block
+                  if (parameters.pastDeadline (omp_get_wtime() - time1))
+                  {
+                    overrun = "deadline passed in phase 1-R";
+                    rowsComputed = j;
+                    break;
+                  }
+
                   //loop counter 
                   size_t loopJ = j / (this->blockHeight);
 
@@ -1089,11 +1533,42 @@ namespace psgl
                     readCharsInt [k] = readSetSOA [readSetSOAPrefixSum[i] + j * SIMD::numSeqs + k];
                   }
 
-                  //iterate over characters in reference graph
-                  for (int32_t k = graphLocal.numVertices - 1; k >= 0; k--)
+                  //load halo columns into DP buffers
+                  for (int32_t k = width - 1; k >= width - haloCount; k--)
+                  {
+                    for (size_t l = 0; l < this->blockHeight; l++)
+                    {
+                      nearbyColumns[k & (blockWidth-1)][l] = haloStrip[(j + l) * haloCount + k - (width - haloCount)];
+
+                      if ( hopSlot[k] >= 0 )
+                        saveFartherColumn (hopSlot[k], l, nearbyColumns[k & (blockWidth-1)][l]);
+
+                      if (sendCount > 0 && sendSlot[k] >= 0)
+                        sendStrip[(j + l) * sendCount + sendSlot[k]] = nearbyColumns[k & (blockWidth-1)][l];
+                    }
+
+                    saveLastBatchRow (loopJ, k, nearbyColumns[k & (blockWidth-1)][blockHeight - 1]);
+                  }
+
+                  //iterate over characters in reference graph component
+                  for (int32_t k = width - haloCount - 1; k >= 0; k--)
                   {
+                    //successors of a column ahead are not predictable by hardware prefetcher
+                    if (prefetchDistance > 0 && k - prefetchDistance >= 0)
+                    {
+                      auto ahead = k - prefetchDistance;
+
+                      for(auto m = offsetsOut[ahead]; m < offsetsOut[ahead+1]; m++)
+                      {
+                        _mm_prefetch ((const char*) &lastBatchRow[(loopJ - 1) & 1][ ahead + graphLocal.adjcny_out[m] ], _MM_HINT_T0);
+
+                        if (graphLocal.adjcny_out[m] >= this->blockWidth)
+                          prefetchFartherColumn (hopSlot[ahead + graphLocal.adjcny_out[m]]);
+                      }
+                    }
+
                     //current reference character
-                    __mxxxi graphChar = SIMD::set1 ((typename SIMD::type) graphLocal.vertex_label[k] );
+                    __mxxxi graphChar = SIMD::set1 ((typename SIMD::type) vertexLabel[k] );
 
                     //current best score, init to 0
                     __mxxxi currentMax512;
@@ -1118,19 +1593,21 @@ namespace psgl
                       //which buffers to access depends on the value of 'l'
                       if (l == 0)
                       {
-                        for(size_t m = graphLocal.offsets_out[k]; m < graphLocal.offsets_out[k+1]; m++)
+                        for(auto m = offsetsOut[k]; m < offsetsOut[k+1]; m++)
                         {
+                          int32_t to = k + graphLocal.adjcny_out[m];
+
                           //paths with match mismatch edit
-                          __mxxxi substEdit = SIMD::add ( lastBatchRow[(loopJ - 1) & 1][ graphLocal.adjcny_out[m] ], sub512);
+                          __mxxxi substEdit = SIMD::add ( lastBatchRow[(loopJ - 1) & 1][to], sub512);
                           currentMax512 = SIMD::max (currentMax512, substEdit); 
 
                           //paths with deletion edit
                           __mxxxi delEdit;
 
-                          if (graphLocal.adjcny_out[m] - k < this->blockWidth)
-                            delEdit = SIMD::add ( nearbyColumns[graphLocal.adjcny_out[m] & (blockWidth-1)][l], del512);
+                          if (graphLocal.adjcny_out[m] < this->blockWidth)
+                            delEdit = SIMD::add ( nearbyColumns[to & (blockWidth-1)][l], del512);
                           else
-                            delEdit = SIMD::add ( fartherColumns[graphLocal.adjcny_out[m]][l], del512);
+                            delEdit = SIMD::add ( loadFartherColumn (hopSlot[to], l), del512);
 
                           currentMax512 = SIMD::max (currentMax512, delEdit); 
                         }
@@ -1141,23 +1618,26 @@ namespace psgl
                       }
                       else
                       {
-                        for(size_t m = graphLocal.offsets_out[k]; m < graphLocal.offsets_out[k+1]; m++)
+                        for(auto m = offsetsOut[k]; m < offsetsOut[k+1]; m++)
                         {
+                          int32_t to = k + graphLocal.adjcny_out[m];
+
                           //paths with match mismatch edit
                           __mxxxi substEdit;
 
                           //paths with deletion edit
                           __mxxxi delEdit;
 
-                          if (graphLocal.adjcny_out[m] - k < this->blockWidth)
+                          if (graphLocal.adjcny_out[m] < this->blockWidth)
                           {
-                            substEdit = SIMD::add ( nearbyColumns[graphLocal.adjcny_out[m] & (blockWidth-1)][l-1], sub512);
-                            delEdit = SIMD::add ( nearbyColumns[graphLocal.adjcny_out[m] & (blockWidth-1)][l], del512);
+                            substEdit = SIMD::add ( nearbyColumns[to & (blockWidth-1)][l-1], sub512);
+                            delEdit = SIMD::add ( nearbyColumns[to & (blockWidth-1)][l], del512);
                           }
                           else
                           {
-                            substEdit = SIMD::add ( fartherColumns[graphLocal.adjcny_out[m]][l-1], sub512);
-                            delEdit = SIMD::add ( fartherColumns[graphLocal.adjcny_out[m]][l], del512);
+                            auto slot = hopSlot[to];
+                            substEdit = SIMD::add ( loadFartherColumn (slot, l-1), sub512);
+                            delEdit = SIMD::add ( loadFartherColumn (slot, l), del512);
                           }
 
                           currentMax512 = SIMD::max (currentMax512, substEdit); 
@@ -1177,13 +1657,13 @@ namespace psgl
 
                       //update row and column values accordingly
                       bestRows512 = SIMD::mask_set1 (bestRows512, updated, (typename SIMD::type) (j + l));
-                      SIMD::update_cols (bestCols512_0, bestCols512_1, bestCols512_2, bestCols512_3, (int32_t) k, updated);
+                      SIMD::update_cols (bestCols512_0, bestCols512_1, bestCols512_2, bestCols512_3, k, updated);
 
                       //detect and manipulate the score of the specific optimal alignment we want
                       //this is required to make sure reverse DP reports same alignment as fwd DP
                       {
                         __mxxxi currentRow = SIMD::set1 ( (typename SIMD::type) (j + l));
-                        __mxxxi currentCol = SIMD::set1_32 ( (int32_t) k ); 
+                        __mxxxi currentCol = SIMD::set1_32 (k); 
                         
                         auto compareCell = SIMD::cmpeq (fwdBestRows512, currentRow);
 
@@ -1202,35 +1682,68 @@ namespace psgl
                       nearbyColumns[k & (blockWidth-1)][l] = currentMax512;
 
                       //save current score in large buffer if connected thru long hop
-                      if ( withLongHopLocal[k] )
-                        fartherColumns[k][l] = currentMax512;
+                      if ( hopSlot[k] >= 0 )
+                        saveFartherColumn (hopSlot[k], l, currentMax512);
                     }
 
                     //save last score for next row-wise iteration
-                    lastBatchRow[loopJ & 1][k] = currentMax512; 
+                    saveLastBatchRow (loopJ, k, currentMax512);
+
+                    //save scores of boundary column for next graph partition
+                    if (sendCount > 0 && sendSlot[k] >= 0)
+                      for (size_t l = 0; l < this->blockHeight; l++)
+                        sendStrip[(j + l) * sendCount + sendSlot[k]] = nearbyColumns[k & (blockWidth-1)][l];
 
                   } // end of row computation
+
+                  //apply differences to get last row of current iteration
+                  if (compressed)
+                  {
+                    for (int32_t k = 0; k < width; k++)
+                      lastBatchRow[0][k] = SIMD::add (lastBatchRow[0][k], SIMD::load_delta8 (&lastBatchRowDelta[k * SIMD::numSeqs]));
+                  }
                 } // end of DP
 
-                bestScores[i] = bestScores512;
-                bestRows[i]   = bestRows512; 
+                if (sendCount > 0)
+                  partition->sendStrip (w, sendStrip.data(), sendStrip.size() * sizeof(__mxxxi));
+
+                //parse best scores from vector registers
                 {
+                  SIMD::store ((__mxxxi*) storeScores.data(), bestScores512);
+                  SIMD::store ((__mxxxi*) storeRows.data()  , bestRows512);
+
                   //storing best columns requires extra work
-                  if (colRegistersCountPerBatch == 1)
-                  {
-                    bestCols[1*i + 0]   = bestCols512_0; 
-                  }
-                  else if (colRegistersCountPerBatch == 2)
+                  SIMD::store ((__mxxxi*) &storeCols [0], bestCols512_0); 
+
+                  if (colRegistersCountPerBatch >= 2)
+                    SIMD::store ((__mxxxi*) &storeCols [1*colValuesPerRegister], bestCols512_1); 
+
+                  if (colRegistersCountPerBatch == 4)
                   {
-                    bestCols[2*i + 0]   = bestCols512_0;
-                    bestCols[2*i + 1]   = bestCols512_1;
+                    SIMD::store ((__mxxxi*) &storeCols [2*colValuesPerRegister], bestCols512_2); 
+                    SIMD::store ((__mxxxi*) &storeCols [3*colValuesPerRegister], bestCols512_3); 
                   }
-                  else if (colRegistersCountPerBatch == 4)
+                }
+
+                //time of this work item is divided among reads aligned to the component
+                const std::size_t componentReads = std::count (laneComponent.begin() + i * SIMD::numSeqs, laneComponent.begin() + (i+1) * SIMD::numSeqs, (int32_t) c);
+                const double laneShare = (omp_get_wtime() - time1) / std::max<std::size_t> (componentReads, 1);
+
+                //each lane takes results only from the component of its forward alignment
+                //so different work items write to disjoint lanes
+                for (size_t j = 0; j < SIMD::numSeqs; j++)
+                {
+                  auto lane = i * SIMD::numSeqs + j;
+
+                  if (laneComponent[lane] == c)
                   {
-                    bestCols[4*i + 0]   = bestCols512_0;
-                    bestCols[4*i + 1]   = bestCols512_1;
-                    bestCols[4*i + 2]   = bestCols512_2;
-                    bestCols[4*i + 3]   = bestCols512_3;
+                    bestScores[lane] = storeScores[j];
+                    bestRows[lane]   = storeRows[j];
+                    bestCols[lane]   = colBegin + storeCols[j];
+                    laneCells[lane]  = (int64_t) rowsComputed * (width - haloCount);
+                    laneTime[lane]   = laneShare;
+                    laneStart[lane]  = time1;
+                    laneOverrun[lane] = overrun;
                   }
                 }
               } // all reads done
@@ -1250,6 +1763,219 @@ namespace psgl
 //#endif
           }
     };
+
+  /**
+   * @brief                                 send phase 1 job of a graph partition worker, see partitionWorkerMain
+   * @param[in]   fd                        job pipe of the worker
+   * @param[in]   threads                   thread count of the worker
+   * @param[in]   readSet                   query sequences
+   * @param[in]   parameters                input parameters
+   * @param[in]   forwardResults            best scores and end locations from forward DP 
+   *                                        for reverse DP, null for forward DP
+   */
+  template <typename SIMD, typename Vec>
+    void writePartitionJob (int fd, int threads,
+        const std::vector<std::string> &readSet, 
+        const Parameters &parameters,
+        const Vec *forwardResults)
+    {
+      int64_t header[] = {sizeof(typename SIMD::type), threads, parameters.match, parameters.mismatch, parameters.ins, parameters.del, 
+                          parameters.prefetchDistance, parameters.compressRowState, (int64_t) readSet.size()};
+      writeFully (fd, header, sizeof(header));
+
+      for (auto &read : readSet)
+      {
+        uint64_t length = read.length();
+        writeFully (fd, &length, sizeof(length));
+        writeFully (fd, read.data(), length);
+      }
+
+      if (forwardResults)
+      {
+        std::vector<int32_t> scores, rowEnds;
+        std::vector<int64_t> columnEnds;
+
+        for (auto &e : *forwardResults)
+        {
+          scores.push_back (e.score);
+          columnEnds.push_back (e.refColumnEnd);
+          rowEnds.push_back (e.qryRowEnd);
+        }
+
+        writeVector (fd, scores);
+        writeVector (fd, columnEnds);
+        writeVector (fd, rowEnds);
+      }
+    }
+
+  /**
+   * @brief                                 run phase 1 forward DP, possibly over graph partitions 
+   *                                        in separate processes (see partition.hpp)
+   * @param[in]   readSet                   vector of input query sequences to align
+   * @param[in]   graph                     input reference graph
+   * @param[in]   parameters                input parameters
+   * @param[out]  outputBestScoreVector     vector to keep value and location of best scores
+   */
+  template <typename SIMD, typename Vec>
+    void alignToDAGLocal_Phase1_vectorized (const std::vector<std::string> &readSet, 
+        const CSR_char_container &graph,
+        const Parameters &parameters,
+        Vec &outputBestScoreVector)
+    {
+      if (parameters.partitions > 1)
+      {
+        auto writeJob = [&](int fd, int threads) {
+          writePartitionJob<SIMD> (fd, threads, readSet, parameters, (const Vec *) nullptr);
+        };
+
+        runGraphPartitions (graph, parameters.partitions, true, parameters.threads, writeJob, [&](const CSR_char_container &g, PartitionBoundary &b) {
+            Phase1_Vectorized<SIMD> obj (readSet, g, parameters, &b); 
+            obj.alignToDAGLocal_Phase1_vectorized_wrapper(outputBestScoreVector);
+            });
+      }
+      else
+      {
+        Phase1_Vectorized<SIMD> obj (readSet, graph, parameters); 
+        obj.alignToDAGLocal_Phase1_vectorized_wrapper(outputBestScoreVector);
+      }
+    }
+
+  /**
+   * @brief                                 run phase 1 reverse DP, possibly over graph partitions 
+   *                                        in separate processes (see partition.hpp)
+   * @param[in]   readSet                   vector of reversed query sequences
+   * @param[in]   graph                     input reference graph
+   * @param[in]   parameters                input parameters
+   * @param[in/out]  outputBestScoreVector  best scores and end locations from forward DP,
+   *                                        begin locations are updated
+   */
+  template <typename SIMD, typename Vec>
+    void alignToDAGLocal_Phase1_rev_vectorized (const std::vector<std::string> &readSet, 
+        const CSR_char_container &graph,
+        const Parameters &parameters,
+        Vec &outputBestScoreVector)
+    {
+      if (parameters.partitions > 1)
+      {
+        auto writeJob = [&](int fd, int threads) {
+          writePartitionJob<SIMD> (fd, threads, readSet, parameters, &outputBestScoreVector);
+        };
+
+        runGraphPartitions (graph, parameters.partitions, false, parameters.threads, writeJob, [&](const CSR_char_container &g, PartitionBoundary &b) {
+            Phase1_Rev_Vectorized<SIMD> obj (readSet, g, parameters, &b); 
+            obj.alignToDAGLocal_Phase1_rev_vectorized_wrapper(outputBestScoreVector);
+            });
+      }
+      else
+      {
+        Phase1_Rev_Vectorized<SIMD> obj (readSet, graph, parameters); 
+        obj.alignToDAGLocal_Phase1_rev_vectorized_wrapper(outputBestScoreVector);
+      }
+    }
+  /**
+   * @brief                                 run phase 1 DP of a graph partition worker
+   * @param[in]   fd                        job pipe
+   * @param[in]   local                     local graph of the partition
+   * @param[in]   b                         partition boundary
+   * @param[in]   parameters
+   * @param[in]   readSet
+   */
+  template <typename SIMD>
+    void alignPartitionJob (int fd,
+        const CSR_char_container &local,
+        PartitionBoundary &b,
+        const Parameters &parameters,
+        const std::vector<std::string> &readSet)
+    {
+      std::vector<BestScoreInfo> results (readSet.size());
+
+      if (b.forward)
+      {
+        Phase1_Vectorized<SIMD> obj (readSet, local, parameters, &b); 
+        obj.alignToDAGLocal_Phase1_vectorized_wrapper(results);
+      }
+      else
+      {
+        std::vector<int32_t> scores, rowEnds;
+        std::vector<int64_t> columnEnds;
+
+        readVector (fd, scores);
+        readVector (fd, columnEnds);
+        readVector (fd, rowEnds);
+
+        for (std::size_t i = 0; i < results.size(); i++)
+        {
+          results[i].score = scores[i];
+          results[i].refColumnEnd = columnEnds[i];
+          results[i].qryRowEnd = rowEnds[i];
+        }
+
+        Phase1_Rev_Vectorized<SIMD> obj (readSet, local, parameters, &b); 
+        obj.alignToDAGLocal_Phase1_rev_vectorized_wrapper(results);
+      }
+    }
+
+  /**
+   * @brief                                 serve this process as a graph partition worker,
+   *                                        if it was started by runGraphPartitions
+   * @details                               the worker receives its partition and job, runs
+   *                                        phase 1 DP over its partition with its thread share,
+   *                                        and exits without returning
+   * @return                                false if this process is not a partition worker
+   */
+  bool partitionWorkerMain()
+  {
+    PartitionBoundary b;
+    CSR_char_container local;
+
+    int fd = partitionWorker (b, local);
+
+    if (fd < 0)
+      return false;
+
+    int64_t header[9];
+    readFully (fd, header, sizeof(header));
+
+    Parameters parameters;
+    parameters.threads          = header[1];
+    parameters.match            = header[2];
+    parameters.mismatch         = header[3];
+    parameters.ins              = header[4];
+    parameters.del              = header[5];
+    parameters.prefetchDistance = header[6];
+    parameters.compressRowState = header[7];
+    parameters.partitions       = b.count;
+
+    std::vector<std::string> readSet (header[8]);
+
+    for (auto &read : readSet)
+    {
+      uint64_t length;
+      readFully (fd, &length, sizeof(length));
+      read.resize (length);
+      readFully (fd, &read[0], length);
+    }
+
+    omp_set_num_threads (parameters.threads);
+
+    switch (header[0])
+    {
+      case 1: alignPartitionJob< SimdInst<int8_t> > (fd, local, b, parameters, readSet); break;
+      case 2: alignPartitionJob< SimdInst<int16_t> > (fd, local, b, parameters, readSet); break;
+      default: alignPartitionJob< SimdInst<int32_t> > (fd, local, b, parameters, readSet); break;
+    }
+
+    close (fd);
+    close (b.resultFd);
+    if (b.recvFd >= 0) close (b.recvFd);
+    if (b.sendFd >= 0) close (b.sendFd);
+
+    std::cout.flush();
+    _exit(0);
+  }
+
+  //partition workers are served during static initialization, before main() parses arguments
+  static const bool partitionWorkerServed = partitionWorkerMain();
 }
 
 #endif
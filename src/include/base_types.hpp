@@ -8,6 +8,10 @@
 #define PSGL_BASETYPES_HPP
 
 #include <immintrin.h>
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstdint>
 
 #define psgl_max(a,b) (((a)>(b))?(a):(b))
 #define ASSUMED_CPU_FREQ 2100000000
@@ -16,6 +20,25 @@
 namespace psgl
 {
 
+  /**
+   * @brief     levels of runtime validation of graphs and alignments
+   */
+  enum VALIDATION
+  {
+    VALIDATE_OFF,
+    VALIDATE_SAMPLED,   //check 1 in N reads
+    VALIDATE_FULL       //check all reads, and the loaded graph
+  };
+
+  /**
+   * @brief     reporting of reads which exceed their cell budget or deadline
+   */
+  enum OVERRUN
+  {
+    OVERRUN_SCORE,            //report score and locations found so far, without cigar
+    OVERRUN_TIMEOUT           //report as timed out, without alignment
+  };
+
   /**
    * @brief     input parameters that are expected 
    *            as command line arguments
@@ -26,12 +49,219 @@ namespace psgl
     std::string mode;         //reference graph format
     std::string qfile;        //query sequence file
     std::string ofile;        //output file
+    std::string manifest;     //file listing query and output file of each sample
+
+    //(query file, output file) pair of each sample listed in the manifest
+    std::vector< std::pair<std::string, std::string> > samples;
+
     int threads;              //thread count
 
     int match;                //match score 
     int mismatch;             //mismatch penalty (abs. value) 
     int ins;                  //insertion penalty (abs. value) 
     int del;                  //deletion penalty (abs. value)
+
+    int componentKmer;        //k-mer length for skipping graph components (0 to disable)
+
+    int shardIndex;           //0-based shard of reads to align
+    int shardCount;           //count of shards, read (or pair) i belongs to shard (i % shardCount)
+    std::string metricsFile;  //output file for run metrics in JSON format
+
+    int partitions;           //count of processes to split graph columns across during phase 1
+
+    std::string streamFile;   //graph file to map and stream columns from during phase 1
+
+    bool compressRowState;    //save DP state across row blocks as int8 differences in int16/int32 precision
+
+    int prefetchDistance;     //count of columns to look ahead for prefetching DP scores (0 to disable)
+
+    VALIDATION validation;    //runtime validation level
+    int validationSample;     //read i is checked if (i % validationSample == 0) in sampled validation
+
+    bool printCosts;          //append per-read DP cells and time of each phase to the output
+    std::string slowLog;      //output file listing the slowest reads
+    int slowReads;            //count of slowest reads to log
+    std::string reproPrefix;  //prefix of repro files saved for the slowest reads
+
+    bool dryRun;              //predict memory and time of the run without aligning, see plan.hpp
+    double maxMemory;         //memory limit (GB) to lower thread count under (0 to disable)
+
+    int64_t cellBudget;       //DP cells of phase 1-R and 2 allowed per read (0 to disable)
+    double readDeadline;      //wall-clock time (s) allowed per read in phase 1-R and 2 (0 to disable)
+    OVERRUN overrun;          //reporting of reads exceeding budget or deadline
+
+    std::string journalFile;  //progress journal to resume an interrupted run from, see checkpoint.hpp
+    int64_t batchReads;       //count of reads aligned per batch, with a journal or concurrent batches
+    int batchWorkers;         //count of batches aligned concurrently, each with a share of threads
+    int reorderWindow;        //maximum count of batches aligned or held for output at a time (0 for twice the workers)
+    bool unorderedOutput;     //print batches as they complete, rather than in input order
+    bool keepResults;         //return results of all reads from alignToDAG, otherwise results are released once written
+    bool keepColumns;         //return graph columns of each alignment from phase 2, as kept for SAM output
+
+    bool sortOutput;          //sort output by graph position of alignment start, see sort.hpp
+    int64_t sortMemory;       //memory (MB) to buffer output records in before spilling sorted runs
+
+    std::string coverageFile; //output file for coverage of graph vertices, see coverage.hpp
+    bool coverageBinary;      //save coverage in binary rather than tsv format
+    bool coveragePerBase;     //save coverage of each vertex offset as well
+
+    std::string samFile;      //SAM/BAM output of alignments projected onto a reference path, see project.hpp
+    std::string referencePath;//name of reference path, first path of the graph if empty
+
+    std::string mateFile;     //query file of second mates, paired with reads of the query file, see paired.hpp
+    bool interleaved;         //query file holds mates of each pair one after another
+    double insertMean;        //mean span (columns) of a pair along the graph, estimated from first pairs if 0
+    double insertStdDev;      //standard deviation of the span
+    double mateMinScore;      //fraction of maximum score for an alignment to anchor its mate, or be rescued
+
+    std::string gafFile;      //alignments to rescore in GAF format by rescore subcommand, see rescore.hpp
+
+    /**
+     * @brief   constructor, sets default values of optional parameters
+     */
+    Parameters()
+    {
+      this->match = this->mismatch = this->ins = this->del = 1;
+      this->threads = 1;
+      this->componentKmer = 0;
+      this->shardIndex = 0;
+      this->shardCount = 1;
+      this->partitions = 1;
+      this->compressRowState = false;
+      this->prefetchDistance = 0;
+      this->validation = VALIDATE_SAMPLED;
+      this->validationSample = 100;
+      this->printCosts = false;
+      this->slowReads = 10;
+      this->dryRun = false;
+      this->maxMemory = 0;
+      this->cellBudget = 0;
+      this->readDeadline = 0;
+      this->overrun = OVERRUN_SCORE;
+      this->batchReads = 100000;
+      this->batchWorkers = 1;
+      this->reorderWindow = 0;
+      this->unorderedOutput = false;
+      this->keepResults = true;
+      this->keepColumns = false;
+      this->sortOutput = false;
+      this->sortMemory = 1024;
+      this->coverageBinary = false;
+      this->coveragePerBase = false;
+      this->interleaved = false;
+      this->insertMean = 0;
+      this->insertStdDev = 0;
+      this->mateMinScore = 0.5;
+    }
+
+    /**
+     * @brief               whether alignment of a read should be validated
+     * @param[in]   readId  0-based index of the read
+     */
+    bool validateRead (std::size_t readId) const
+    {
+      return validation == VALIDATE_FULL || 
+        (validation == VALIDATE_SAMPLED && readId % validationSample == 0);
+    }
+
+    /**
+     * @brief               whether DP cells of a read exceed the budget
+     * @param[in]   cells   cells of phase 1-R and 2 of the read
+     */
+    bool overBudget (int64_t cells) const
+    {
+      return cellBudget > 0 && cells > cellBudget;
+    }
+
+    /**
+     * @brief               whether a read has run past its deadline
+     * @param[in]   elapsed time (s) of phase 1-R and 2 of the read
+     */
+    bool pastDeadline (double elapsed) const
+    {
+      return readDeadline > 0 && elapsed > readDeadline;
+    }
+
+    /**
+     * @brief               (query file, output file) pair of each sample to align,
+     *                      the single pair of -q/-o if no manifest is given
+     */
+    std::vector< std::pair<std::string, std::string> > sampleFiles () const
+    {
+      if (samples.empty())
+        return { std::make_pair (qfile, ofile) };
+
+      return samples;
+    }
+
+    /**
+     * @brief               whether reads are aligned in pairs
+     */
+    bool pairedInput () const
+    {
+      return !mateFile.empty() || interleaved;
+    }
+
+    /**
+     * @brief               whether an alignment is confident enough to anchor 
+     *                      the window of its mate, or to be kept after rescue
+     * @param[in]   score
+     * @param[in]   length  read length
+     */
+    bool confidentScore (int32_t score, std::size_t length) const
+    {
+      return score > 0 && score >= mateMinScore * match * length;
+    }
+  };
+
+  /**
+   * @brief     input parameters of merge subcommand
+   **/
+  struct MergeParameters
+  {
+    std::vector<std::string> shardFiles;    //shard output files in shard order
+    std::vector<std::string> metricsFiles;  //shard metrics files
+    std::string ofile;                      //merged output file
+    std::string metricsFile;                //merged metrics file
+    int groupSize;                          //count of consecutive lines kept in the same shard, from metrics files if 0
+  };
+
+  /**
+   * @brief     input parameters of replay subcommand
+   **/
+  struct ReplayParameters
+  {
+    std::string reproFile;    //repro file saved during an alignment run
+    int repeats;              //count of times to align the read
+  };
+
+  /**
+   * @brief     metrics of an alignment run (or of merged shards)
+   **/
+  struct RunMetrics
+  {
+    int shardIndex;
+    int shardCount;
+    int shardGroup;               //count of consecutive reads kept in the same shard, i.e., 2 for paired reads
+
+    int64_t reads;                //count of reads processed
+    int64_t alignedReads;         //count of reads with non-zero score
+    int64_t totalScore;           //sum of alignment scores
+
+    double loadTime;              //graph loading time (s)
+    double alignTime;             //alignment time (s)
+
+    /**
+     * @brief   constructor
+     */
+    RunMetrics()
+    {
+      this->shardIndex = 0;
+      this->shardCount = 1;
+      this->shardGroup = 1;
+      this->reads = this->alignedReads = this->totalScore = 0;
+      this->loadTime = this->alignTime = 0;
+    }
   };
 
   /**
@@ -44,6 +274,19 @@ namespace psgl
     SEMIGLOBAL  //TODO
   };  
 
+  /**
+   * @brief     vertex of the input graph and character offset in its label,
+   *            as reported in the output
+   * @details   vertices of bi-directed graphs are reported with their orientation, 
+   *            offsets in '-' oriented vertices are in the reverse complemented label
+   */
+  struct VertexOffset
+  {
+    int32_t id;
+    int32_t offset;
+    char orientation;     //'+' or '-', 0 for directed graphs
+  };
+
   //Metadata of query sequences
   struct ContigInfo
   {
@@ -51,6 +294,38 @@ namespace psgl
     int32_t len;            //Length of the sequence
   };
 
+  /**
+   * @brief     DP cells computed and time (s) spent for a read in each phase
+   * @details   a SIMD batch of phase 1 (or 1-R) computes the cells of all its 
+   *            lanes together, so each lane is charged with the cells of its own 
+   *            DP matrix (including padded rows), and the batch time is divided 
+   *            among its lanes
+   */
+  struct ReadCost
+  {
+    int64_t p1Cells, p1rCells, p2Cells;
+    double p1Time, p1rTime, p2Time;
+
+    //wall-clock time (omp_get_wtime) when phase 1-R of the read began,
+    //deadline of phase 1-R and 2 is measured from it
+    double p1rStart;
+
+    /**
+     * @brief   constructor
+     */
+    ReadCost()
+    {
+      this->p1Cells = this->p1rCells = this->p2Cells = 0;
+      this->p1Time = this->p1rTime = this->p2Time = 0;
+      this->p1rStart = 0;
+    }
+
+    double totalTime() const
+    {
+      return p1Time + p1rTime + p2Time;
+    }
+  };
+
   /**
    * @brief                   container to save info about best score
    */
@@ -58,8 +333,8 @@ namespace psgl
   {
     //coordinates in complete DP matrix where optimal alignment begins and ends (both inclusive)
     //these are 0-based offsets
-    int32_t refColumnStart;
-    int32_t refColumnEnd;
+    int64_t refColumnStart;
+    int64_t refColumnEnd;
 
     int32_t qryRowStart;
     int32_t qryRowEnd;
@@ -74,12 +349,27 @@ namespace psgl
     //TODO: Storing cigar may be expensive, consider removing later
     std::string cigar;
 
+    //graph column of each operation of the expanded cigar, kept for path projection (see project.hpp)
+    //and coverage of paired reads (see alignPairsToDAG)
+    std::vector<int64_t> columns;
+
+    //first failed validation check of the alignment, nullptr if none failed
+    const char *invalid;
+
+    //reason the read was not aligned completely, i.e., cell budget or deadline, nullptr if aligned
+    const char *overrun;
+
+    //cost of both strands of the read in phase 1, and of the chosen strand afterwards
+    ReadCost cost;
+
     /**
      * @brief   constructor
      */
     BestScoreInfo()
     {
       this->score = 0;
+      this->invalid = nullptr;
+      this->overrun = nullptr;
     }
   };
 }
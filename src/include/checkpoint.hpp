@@ -0,0 +1,353 @@
+/**
+ * @file    checkpoint.hpp
+ * @brief   routines to log progress of a run in a journal, and to
+ *          resume an interrupted run from its last completed batch
+ * @author  Chirag Jain <cjain7@gatech.edu>
+ */
+
+#ifndef PSGL_CHECKPOINT_HPP
+#define PSGL_CHECKPOINT_HPP
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstdio>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "base_types.hpp"
+#include "utils.hpp"
+
+namespace psgl
+{
+  /**
+   * @brief   progress of a run, saved in its journal file
+   * @details journal starts with header lines beginning with '#', which
+   *          save hashes of the arguments and graph, the batch size, and
+   *          the insert size of paired reads estimated by the run.
+   *          Each following line records a completed batch as its id,
+   *          count of reads done and sizes of all output files, ending
+   *          with "ok" once fully written
+   */
+  struct Journal
+  {
+    uint64_t configHash = 0;
+    uint64_t graphHash = 0;
+    int64_t batchReads = 0;
+
+    //insert size estimated in the first batch, reused on resume (0 if not estimated)
+    double insertMean = 0;
+    double insertStdDev = 0;
+
+    std::size_t batches = 0;              //count of completed batches
+    std::size_t readsDone = 0;            //count of reads in completed batches
+    std::vector<int64_t> outputSizes;     //output file sizes (bytes) after last completed batch
+  };
+
+  /**
+   * @brief                   FNV-1a hash of a byte range
+   */
+  uint64_t fnv1a(const char *p, std::size_t len, uint64_t h = 14695981039346656037ULL)
+  {
+    for (std::size_t i = 0; i < len; i++)
+      h = (h ^ (unsigned char) p[i]) * 1099511628211ULL;
+
+    return h;
+  }
+
+  /**
+   * @brief                   size of a file in bytes, -1 if not accessible
+   */
+  int64_t fileSize(const std::string &filename)
+  {
+    struct stat st;
+    return stat (filename.c_str(), &st) == 0 ? st.st_size : -1;
+  }
+
+  /**
+   * @brief                   hash of arguments which affect the output
+   * @details                 thread count is left out, so an interrupted
+   *                          run can be resumed with a different one
+   * @param[in]   parameters
+   * @param[in]   samples     (query file, output file) pair of each sample
+   */
+  uint64_t configHash(const Parameters &parameters,
+      const std::vector< std::pair<std::string, std::string> > &samples)
+  {
+    std::ostringstream config;
+
+    config << parameters.mode << "\n";
+
+    for (auto &s : samples)
+      config << s.first << "\t" << s.second << "\n";
+
+    config << parameters.match << " " << parameters.mismatch << " " << parameters.ins << " " << parameters.del << " "
+      << parameters.componentKmer << " " << parameters.shardIndex << " " << parameters.shardCount << " "
+      << parameters.printCosts << " " << parameters.cellBudget << " " << parameters.readDeadline << " "
+      << parameters.overrun << " " << parameters.batchReads << "\n"
+      << parameters.mateFile << "\t" << parameters.interleaved << " " << parameters.insertMean << " " 
+      << parameters.insertStdDev << " " << parameters.mateMinScore;
+
+    auto s = config.str();
+    return fnv1a (s.data(), s.size());
+  }
+
+  /**
+   * @brief                   hash of a graph file
+   * @details                 entire file is hashed, so that an edit anywhere in
+   *                          the graph is detected. Blocks of 1 MB are hashed in
+   *                          parallel, and their hashes are combined in file order
+   * @param[in]   filename
+   */
+  uint64_t graphHash(const std::string &filename)
+  {
+    constexpr int64_t blockSize = 1 << 20;
+
+    int64_t size = fileSize (filename);
+    uint64_t h = fnv1a ((const char*) &size, sizeof(size));
+
+    if (size <= 0)
+      return h;
+
+    int fd = open (filename.c_str(), O_RDONLY);
+    void *base = fd < 0 ? MAP_FAILED : mmap (nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    if (fd >= 0)
+      close (fd);
+
+    if (base == MAP_FAILED)
+    {
+      std::cerr << "ERROR, psgl::graphHash, could not map " << filename << std::endl;
+      exit(1);
+    }
+
+    madvise (base, size, MADV_SEQUENTIAL);
+
+    std::vector<uint64_t> blockHashes ((size + blockSize - 1) / blockSize);
+
+#pragma omp parallel for schedule(dynamic)
+    for (std::size_t i = 0; i < blockHashes.size(); i++)
+    {
+      auto from = i * blockSize;
+      blockHashes[i] = fnv1a ((const char*) base + from, std::min (blockSize, size - (int64_t) from));
+    }
+
+    munmap (base, size);
+
+    return fnv1a ((const char*) blockHashes.data(), blockHashes.size() * sizeof(uint64_t), h);
+  }
+
+  /**
+   * @brief                   flush a written file to the storage device
+   * @param[in]   filename
+   */
+  void syncFile(const std::string &filename)
+  {
+    int fd = open (filename.c_str(), O_RDONLY);
+
+    if (fd < 0 || fsync (fd) != 0)
+    {
+      std::cerr << "ERROR, psgl::syncFile, could not sync " << filename << std::endl;
+      exit(1);
+    }
+
+    close (fd);
+  }
+
+  /**
+   * @brief                   parse a journal saved by appendJournal
+   * @details                 a partially written last line is ignored
+   * @param[in]   filename
+   * @param[in]   outputs     count of output files
+   * @param[out]  j
+   * @return                  false if the journal holds no completed batch
+   */
+  bool readJournal(const std::string &filename, std::size_t outputs, Journal &j)
+  {
+    std::ifstream infile(filename);
+    std::string line;
+
+    while (std::getline (infile, line))
+    {
+      std::istringstream inputString (line);
+
+      if (!line.empty() && line[0] == '#')
+      {
+        std::string key;
+        inputString >> key;
+
+        if (key == "#config")
+          inputString >> std::hex >> j.configHash;
+        else if (key == "#graph")
+          inputString >> std::hex >> j.graphHash;
+        else if (key == "#batch")
+          inputString >> j.batchReads;
+        else if (key == "#insert")
+          inputString >> j.insertMean >> j.insertStdDev;
+
+        continue;
+      }
+
+      std::size_t batch, readsDone;
+      std::vector<int64_t> sizes (outputs);
+      std::string ok;
+
+      inputString >> batch >> readsDone;
+      for (auto &s : sizes)
+        inputString >> s;
+      inputString >> ok;
+
+      if (!inputString || ok != "ok")
+        break;
+
+      j.batches = batch + 1;
+      j.readsDone = readsDone;
+      j.outputSizes = sizes;
+    }
+
+    return j.batches > 0;
+  }
+
+  /**
+   * @brief                   print record of the last completed batch
+   */
+  void printJournalRecord(std::ostream &outstrm, const Journal &j)
+  {
+    outstrm << j.batches - 1 << "\t" << j.readsDone;
+    for (auto s : j.outputSizes)
+      outstrm << "\t" << s;
+    outstrm << "\tok\n";
+  }
+
+  /**
+   * @brief                   write a journal with its header lines, and the record of
+   *                          its last completed batch if any
+   * @details                 journal is written to a temporary file, synced, and renamed
+   *                          over the previous journal, so that a crash leaves either
+   *                          journal complete
+   * @param[in]   filename
+   * @param[in]   j
+   */
+  void writeJournal(const std::string &filename, const Journal &j)
+  {
+    std::string tmpFile = filename + ".tmp";
+
+    {
+      std::ofstream outstrm(tmpFile);
+
+      outstrm << "#PaSGAL journal\n"
+        << "#config\t" << std::hex << j.configHash << "\n"
+        << "#graph\t" << j.graphHash << std::dec << "\n"
+        << "#batch\t" << j.batchReads << "\n"
+        << "#insert\t" << std::setprecision(17) << j.insertMean << "\t" << j.insertStdDev << "\n";
+
+      if (j.batches > 0)
+        printJournalRecord (outstrm, j);
+    }
+
+    syncFile (tmpFile);
+
+    if (std::rename (tmpFile.c_str(), filename.c_str()) != 0)
+    {
+      std::cerr << "ERROR, psgl::writeJournal, could not rename " << tmpFile << " to " << filename << std::endl;
+      exit(1);
+    }
+  }
+
+  /**
+   * @brief                   record the last completed batch
+   * @details                 outputs should be synced before (see syncFile), so 
+   *                          that the journal never refers to results which are
+   *                          not on disk. The journal is synced after the record
+   * @param[in]   filename
+   * @param[in]   j
+   */
+  void appendJournal(const std::string &filename, const Journal &j)
+  {
+    {
+      std::ofstream outstrm(filename, std::ios::app);
+      printJournalRecord (outstrm, j);
+    }
+
+    syncFile (filename);
+  }
+
+  /**
+   * @brief                   resume progress of an interrupted run, or start a new one
+   * @details                 with a journal of matching arguments and graph, output
+   *                          files are truncated to their sizes after the last completed
+   *                          batch, dropping results of an interrupted batch, and the
+   *                          journal is replaced by one with its last completed batch, 
+   *                          keeping the saved insert size. Otherwise
+   *                          output files are emptied and a new journal is started.
+   *                          Without a journal, all reads form a single batch, unless
+   *                          batches are aligned concurrently
+   * @param[in]   parameters
+   * @param[in]   samples     (query file, output file) pair of each sample
+   * @param[in]   readCount   count of reads of all samples
+   * @param[out]  j
+   */
+  void openJournal(const Parameters &parameters, 
+      const std::vector< std::pair<std::string, std::string> > &samples,
+      std::size_t readCount,
+      Journal &j)
+  {
+    j.outputSizes.assign (samples.size(), 0);
+
+    if (parameters.journalFile.empty())
+    {
+      j.batchReads = parameters.batchWorkers > 1 ? parameters.batchReads : std::max<std::size_t> (readCount, 1);
+
+      for (auto &s : samples)
+        std::ofstream outstrm(s.second);
+
+      return;
+    }
+
+    j.configHash = configHash (parameters, samples);
+    j.graphHash = graphHash (parameters.rfile);
+    j.batchReads = parameters.batchReads;
+
+    Journal saved;
+
+    if (readJournal (parameters.journalFile, samples.size(), saved))
+    {
+      if (saved.configHash != j.configHash || saved.graphHash != j.graphHash || saved.batchReads != j.batchReads)
+      {
+        std::cerr << "ERROR, psgl::openJournal, journal " << parameters.journalFile
+          << " was written by a run with different arguments or graph, remove it to start a new run" << std::endl;
+        exit(1);
+      }
+
+      for (std::size_t i = 0; i < samples.size(); i++)
+      {
+        if (fileSize (samples[i].second) < saved.outputSizes[i] || truncate (samples[i].second.c_str(), saved.outputSizes[i]) != 0)
+        {
+          std::cerr << "ERROR, psgl::openJournal, output file " << samples[i].second << " is shorter than recorded in journal" << std::endl;
+          exit(1);
+        }
+      }
+
+      j.batches = saved.batches;
+      j.readsDone = saved.readsDone;
+      j.outputSizes = saved.outputSizes;
+      j.insertMean = saved.insertMean;
+      j.insertStdDev = saved.insertStdDev;
+
+      //drop a partially written last line
+      writeJournal (parameters.journalFile, j);
+
+      std::cout << "INFO, psgl::openJournal, resuming after " << j.batches << " completed batches, " << j.readsDone << " reads" << std::endl;
+      return;
+    }
+
+    for (auto &s : samples)
+      std::ofstream outstrm(s.second);
+
+    writeJournal (parameters.journalFile, j);
+  }
+}
+
+#endif
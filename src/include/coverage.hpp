@@ -0,0 +1,203 @@
+/**
+ * @file    coverage.hpp
+ * @brief   per-node and per-base read coverage, accumulated during
+ *          traceback of phase 2
+ * @author  Chirag Jain <cjain7@gatech.edu>
+ */
+
+#ifndef PSGL_COVERAGE_HPP
+#define PSGL_COVERAGE_HPP
+
+#include <fstream>
+#include <map>
+#include <atomic>
+
+#include "base_types.hpp"
+#include "utils.hpp"
+
+namespace psgl
+{
+  /**
+   * @brief     counts of aligned read bases (matches and mismatches) per graph column
+   * @details   all threads count into a single array with relaxed atomic increments,
+   *            including threads of concurrent batches, which run separate OpenMP
+   *            teams (see alignSamples). Traceback visits a column at most once per
+   *            read, so contention is limited to reads aligned at the same location.
+   *            Memory is 4 bytes per column, irrespective of the thread count
+   */
+  class CoverageCounter
+  {
+    private:
+
+      std::vector< std::atomic<uint32_t> > counts;
+
+    public:
+
+      CoverageCounter (int64_t columns) : counts (columns)
+      {
+        for (auto &c : counts)
+          c.store (0, std::memory_order_relaxed);
+      }
+
+      /**
+       * @brief               count an aligned base at a column
+       */
+      void add (int64_t column)
+      {
+        counts[column].fetch_add (1, std::memory_order_relaxed);
+      }
+
+      /**
+       * @brief               count aligned bases of a complete alignment
+       * @param[in]   e       alignment with graph columns of its operations, see BestScoreInfo::columns
+       */
+      void add (const BestScoreInfo &e)
+      {
+        if (e.overrun)
+          return;
+
+        std::size_t k = 0, count = 0;
+
+        for (auto c : e.cigar)
+        {
+          if (isdigit(c))
+            count = count * 10 + (c - '0');
+          else
+          {
+            assert(k + count <= e.columns.size());
+
+            for (; count > 0; count--, k++)
+              if (c == '=' || c == 'X')
+                add (e.columns[k]);
+          }
+        }
+      }
+
+      /**
+       * @brief               counts of all threads, once alignment is done
+       * @return              aligned bases per graph column
+       */
+      std::vector<uint64_t> reduce () const
+      {
+        std::vector<uint64_t> total (counts.size());
+
+#pragma omp parallel for
+        for (int64_t j = 0; j < (int64_t) counts.size(); j++)
+          total[j] = counts[j].load (std::memory_order_relaxed);
+
+        return total;
+      }
+  };
+
+  /**
+   * @brief                       save coverage of input graph vertices
+   * @details                     tsv output lists vertex name, length, aligned bases and mean depth
+   *                              per line, followed by depth at each offset if per-base. Vertex names
+   *                              are GFA segment names, or ids for other formats, as in the alignment
+   *                              output. Binary output starts with magic "PSGLCOV", per-base flag (int8)
+   *                              and count of vertices (int64), followed by id (int32), length (int32)
+   *                              and aligned bases (uint64) of each vertex, and if per-base, its depths
+   *                              (uint32). A name table follows, with name length (int32) and name
+   *                              characters of each vertex, in the same order as the vertex records.
+   *                              Both strands of a bi-directed graph count towards the same vertex,
+   *                              with offsets of '-' oriented columns mapped to the forward label
+   * @param[in]   filename
+   * @param[in]   graph
+   * @param[in]   columnBases     aligned bases per graph column, see CoverageCounter
+   * @param[in]   binary
+   * @param[in]   perBase
+   */
+  template <typename Graph>
+    void writeCoverage (const std::string &filename,
+        const Graph &graph,
+        const std::vector<uint64_t> &columnBases,
+        bool binary, bool perBase)
+    {
+      struct VertexCoverage
+      {
+        int32_t len = 0;
+        uint64_t bases = 0;
+        std::vector<uint32_t> depths;
+      };
+
+      //coverage of each input graph vertex, by id
+      std::map<int32_t, VertexCoverage> vertices;
+
+      //sequence graph vertex v spans columns [vertexStart[v], vertexStart[v+1])
+      for (int64_t v = 0; graph.vertexStart[v] < graph.numVertices; v++)
+      {
+        auto begin = graph.vertexStart[v];
+        int32_t len = graph.vertexStart[v + 1] - begin;
+        auto id = graph.outputVertexId (begin);
+
+        auto &r = vertices[id.id];
+        r.len = len;
+
+        if (perBase)
+          r.depths.resize (len, 0);
+
+        for (int32_t o = 0; o < len; o++)
+        {
+          r.bases += columnBases[begin + o];
+
+          if (perBase)
+            r.depths[id.orientation == '-' ? len - 1 - o : o] += columnBases[begin + o];
+        }
+      }
+
+      std::ofstream outstrm (filename, binary ? std::ios::binary : std::ios::out);
+
+      if (binary)
+      {
+        int8_t flag = perBase;
+        int64_t count = vertices.size();
+
+        outstrm.write ("PSGLCOV", 7);
+        outstrm.write ((const char*) &flag, sizeof(flag));
+        outstrm.write ((const char*) &count, sizeof(count));
+      }
+      else
+        outstrm << "#vertex\tlength\tbases\tmean_depth" << (perBase ? "\tdepths" : "") << "\n";
+
+      for (auto &v : vertices)
+      {
+        auto &r = v.second;
+
+        if (binary)
+        {
+          outstrm.write ((const char*) &v.first, sizeof(int32_t));
+          outstrm.write ((const char*) &r.len, sizeof(int32_t));
+          outstrm.write ((const char*) &r.bases, sizeof(uint64_t));
+          outstrm.write ((const char*) r.depths.data(), r.depths.size() * sizeof(uint32_t));
+        }
+        else
+        {
+          outstrm << graph.outputVertexName (v.first) << "\t" << r.len << "\t" << r.bases << "\t" << r.bases * 1.0 / r.len;
+
+          if (perBase)
+          {
+            outstrm << "\t";
+            for (int32_t o = 0; o < r.len; o++)
+              outstrm << (o ? "," : "") << r.depths[o];
+          }
+
+          outstrm << "\n";
+        }
+      }
+
+      //name table of binary output, ids index segment names of GFA input
+      if (binary)
+      {
+        for (auto &v : vertices)
+        {
+          auto name = graph.outputVertexName (v.first);
+          int32_t len = name.size();
+
+          outstrm.write ((const char*) &len, sizeof(len));
+          outstrm.write (name.data(), len);
+        }
+      }
+    }
+}
+
+#endif
@@ -35,7 +35,8 @@ namespace psgl
    *              verify() : verify correctness of graph
    *
    *            - Assumption: count of vertices and edges < 2B because we are
-   *              using int32_t type everywhere
+   *              using int32_t type for them, total sequence length can be
+   *              larger and is addressed with int64_t type
    */
   class CSR_container
   {
@@ -50,18 +51,32 @@ namespace psgl
       std::vector<int32_t> adjcny_out;  
 
       //cumulative prefix sequence length till any vertex, size = numVertices
-      std::vector<int32_t> cumulativeSeqLength;
+      std::vector<int64_t> cumulativeSeqLength;
 
       //offsets in adjacency list for each vertex, size = numVertices + 1
       std::vector<int32_t> offsets_in;
       std::vector<int32_t> offsets_out;
 
-      //Container to hold metadata (e.g., DNA sequence) of all vertices in graph
-      std::vector<std::string> vertex_metadata;
+      //DNA sequences of all vertices concatenated in a single buffer
+      //after sort(), sequences are stored in the sorted vertex order, i.e.,
+      //sequence of vertex i ends at (but does not include) cumulativeSeqLength[i]
+      std::string vertex_seq;
+
+      //start offset and length of each vertex sequence in vertex_seq, size = numVertices
+      std::vector<int64_t> vertexSeqStart;
+      std::vector<int32_t> vertexSeqLength;
 
       //Container to preserve original vertex ids after relabeling 
       std::vector<int32_t> originalVertexId;
 
+      //weakly connected components occupy contiguous ranges in the sorted order,
+      //component i spans vertices [componentOffsets[i], componentOffsets[i+1])
+      std::vector<int32_t> componentOffsets;
+
+      //count of vertices per strand if both strands of a bi-directed graph 
+      //are represented (see addReverseStrand()), 0 otherwise
+      int32_t strandVertices;
+
       /**
        * @brief     constructor
        */
@@ -69,78 +84,102 @@ namespace psgl
       {
         numVertices = 0;
         numEdges = 0;
+        strandVertices = 0;
       }
 
       /**
        * @brief     sanity check for correctness of graph storage in CSR format
+       * @return    false if a check fails, the failed check is reported
        */
-      void verify() const
+      bool verify() const
       {
-        assert(this->numVertices > 0);
-        assert(this->numEdges > 0);
+        const char *caller = "psgl::CSR_container::verify";
+
+        psgl_verify (this->numVertices > 0, caller);
+        psgl_verify (this->numEdges > 0, caller);
 
         //sequences
         {
-          assert(vertex_metadata.size() == this->numVertices);
-          assert(originalVertexId.size() == this->numVertices);
+          psgl_verify (vertexSeqStart.size() == this->numVertices, caller);
+          psgl_verify (vertexSeqLength.size() == this->numVertices, caller);
+          psgl_verify (originalVertexId.size() == this->numVertices, caller);
+          psgl_verify (vertex_seq.length() == this->totalRefLength(), caller);
 
-          for(auto &seq : vertex_metadata)
+          for(int32_t i = 0; i < this->numVertices; i++)
           {
             //should be non-empty
-            assert(seq.length() > 0);
+            psgl_verify (vertexSeqLength[i] > 0, caller);
 
-            //all characters should be upper case
-            for(auto &c : seq)
-            {
-              assert(std::isupper(c));
-              assert(c == 'A' || c == 'T' || c == 'G' || c == 'C' || c == 'N');
-            }
+            //should be stored in the sorted order
+            psgl_verify (vertexSeqStart[i] + vertexSeqLength[i] == cumulativeSeqLength[i], caller);
+          }
+
+          //all characters should be upper case
+          for(auto &c : vertex_seq)
+          {
+            psgl_verify (std::isupper(c), caller);
+            psgl_verify (c == 'A' || c == 'T' || c == 'G' || c == 'C' || c == 'N', caller);
           }
         }
 
         //adjacency list
         {
-          assert(adjcny_in.size() == this->numEdges);
-          assert(adjcny_out.size() == this->numEdges);
+          psgl_verify (adjcny_in.size() == this->numEdges, caller);
+          psgl_verify (adjcny_out.size() == this->numEdges, caller);
 
           for(auto vId : adjcny_in)
-            assert(vId >=0 && vId < this->numVertices);
+            psgl_verify (vId >=0 && vId < this->numVertices, caller);
 
           for(auto vId : adjcny_out)
-            assert(vId >=0 && vId < this->numVertices);
+            psgl_verify (vId >=0 && vId < this->numVertices, caller);
         }
 
         //offset array
         {
-          assert(offsets_in.size() == this->numVertices + 1);
-          assert(offsets_out.size() == this->numVertices + 1);
+          psgl_verify (offsets_in.size() == this->numVertices + 1, caller);
+          psgl_verify (offsets_out.size() == this->numVertices + 1, caller);
 
           for(auto off : offsets_in)
-            assert(off >=0 && off <= this->numEdges); 
+            psgl_verify (off >=0 && off <= this->numEdges, caller); 
 
           for(auto off : offsets_out)
-            assert(off >=0 && off <= this->numEdges); 
+            psgl_verify (off >=0 && off <= this->numEdges, caller); 
 
-          assert(std::is_sorted(offsets_in.begin(), offsets_in.end()));
-          assert(std::is_sorted(offsets_out.begin(), offsets_out.end()));
+          psgl_verify (std::is_sorted(offsets_in.begin(), offsets_in.end()), caller);
+          psgl_verify (std::is_sorted(offsets_out.begin(), offsets_out.end()), caller);
 
-          assert(offsets_in.front() == 0 && offsets_in.back() == this->numEdges);
-          assert(offsets_out.front() == 0 && offsets_out.back() == this->numEdges);
+          psgl_verify (offsets_in.front() == 0 && offsets_in.back() == this->numEdges, caller);
+          psgl_verify (offsets_out.front() == 0 && offsets_out.back() == this->numEdges, caller);
         }
 
         //topologically sorted order
         {
           for(int32_t i = 0; i < this->numVertices; i++)
             for(auto j = offsets_out[i]; j < offsets_out[i+1]; j++)
-              assert( i < adjcny_out[j] );
+              psgl_verify (i < adjcny_out[j], caller);
         }
 
         //prefix sequence lengths
         {
           for(int32_t i = 1; i < this->numVertices; i++)
-            assert( cumulativeSeqLength[i] > cumulativeSeqLength[i-1] );
-          assert( cumulativeSeqLength[ this->numVertices - 1 ] == this->totalRefLength() );
+            psgl_verify (cumulativeSeqLength[i] > cumulativeSeqLength[i-1], caller);
+          psgl_verify (cumulativeSeqLength[ this->numVertices - 1 ] == this->totalRefLength(), caller);
+        }
+
+        //components
+        {
+          psgl_verify (componentOffsets.size() >= 2, caller);
+          psgl_verify (componentOffsets.front() == 0 && componentOffsets.back() == this->numVertices, caller);
+          psgl_verify (std::is_sorted(componentOffsets.begin(), componentOffsets.end()), caller);
+
+          //no edge should cross a component boundary
+          for(std::size_t c = 0; c + 1 < componentOffsets.size(); c++)
+            for(int32_t i = componentOffsets[c]; i < componentOffsets[c+1]; i++)
+              for(auto j = offsets_out[i]; j < offsets_out[i+1]; j++)
+                psgl_verify (adjcny_out[j] < componentOffsets[c+1], caller);
         }
+
+        return true;
       }
 
       /**
@@ -152,7 +191,8 @@ namespace psgl
         assert(n > 0);  
 
         this->numVertices += n;
-        this->vertex_metadata.resize(this->numVertices);
+        this->vertexSeqStart.resize(this->numVertices);
+        this->vertexSeqLength.resize(this->numVertices);
         this->originalVertexId.resize(this->numVertices);
         this->cumulativeSeqLength.resize(this->numVertices);
       }
@@ -164,10 +204,104 @@ namespace psgl
        */
       void initVertexSequence(int32_t id, const std::string &seq)
       {
-        assert(id >= 0 && id < vertex_metadata.size());  
-        assert(vertex_metadata[id].length() == 0);
+        assert(id >= 0 && id < vertexSeqLength.size());  
+        assert(vertexSeqLength[id] == 0);
+
+        //sequences may arrive in any order of vertex ids,
+        //they are appended here and arranged later during sort()
+        vertexSeqStart[id] = vertex_seq.length();
+        vertexSeqLength[id] = seq.length();
+        vertex_seq.append(seq);
+      }
+
+      /**
+       * @brief                 allocate the sequence buffer at once, so that vertex
+       *                        sequences can be saved in parallel with setVertexSequence()
+       * @param[in]   length    total sequence length of all vertices
+       * @details               not to be combined with initVertexSequence()
+       */
+      void allocVertexSequences(int64_t length)
+      {
+        assert(vertex_seq.empty());
+
+        vertex_seq.resize(length);
+      }
+
+      /**
+       * @brief                 save vertex sequence at a given offset of the allocated buffer
+       * @param[in]   id        vertex id
+       * @param[in]   start     offset in the sequence buffer
+       * @param[in]   seq       sequence, need not be null-terminated
+       * @param[in]   len       sequence length
+       * @details               thread-safe for distinct vertices with disjoint buffer ranges,
+       *                        lower case characters are converted to upper case, and
+       *                        characters other than A/C/G/T are saved as N
+       */
+      void setVertexSequence(int32_t id, int64_t start, const char *seq, int32_t len)
+      {
+        assert(id >= 0 && id < vertexSeqLength.size());
+        assert(vertexSeqLength[id] == 0);
+        assert(start >= 0 && start + len <= vertex_seq.length());
+
+        vertexSeqStart[id] = start;
+        vertexSeqLength[id] = len;
+
+        for (int32_t i = 0; i < len; i++)
+        {
+          char c = std::toupper(seq[i]);
+          vertex_seq[start + i] = (c == 'A' || c == 'C' || c == 'G' || c == 'T') ? c : 'N';
+        }
+      }
+
+      /**
+       * @brief     add reverse complement of all vertices, so that both strands of
+       *            a bi-directed graph can be represented in a directed graph
+       * @details   vertex i + n is the reverse complement of vertex i, where n is
+       *            the count of vertices before the call. Edges should be added later
+       */
+      void addReverseStrand()
+      {
+        assert(this->strandVertices == 0 && this->numEdges == 0);
+
+        const int32_t n = this->numVertices;
+        const int64_t length = vertex_seq.length();
+
+        //vertex ids of both strands are saved as int32_t
+        if (n > INT32_MAX / 2)
+        {
+          std::cerr << "ERROR, psgl::CSR_container::addReverseStrand, " << n << " vertices per strand exceed int32_t range" << std::endl;
+          exit(1);
+        }
+
+        addVertexCount(n);
+        vertex_seq.resize(2 * length);
+
+#pragma omp parallel for schedule(dynamic, 1024)
+        for (int32_t i = 0; i < n; i++)
+        {
+          vertexSeqStart[i + n] = length + vertexSeqStart[i];
+          vertexSeqLength[i + n] = vertexSeqLength[i];
+
+          const char *seq = vertexSeq(i);
+          char *rcSeq = &vertex_seq[vertexSeqStart[i + n]];
+
+          for (int32_t k = 0; k < vertexSeqLength[i]; k++)
+            rcSeq[vertexSeqLength[i] - 1 - k] = seqUtils::complement(seq[k]);
+        }
+
+        this->strandVertices = n;
+      }
+
+      /**
+       * @brief             sequence of a vertex
+       * @param[in]   v     vertex id
+       * @return            pointer to the first character, sequence is not null-terminated
+       */
+      const char* vertexSeq(int32_t v) const
+      {
+        assert(v >= 0 && v < this->numVertices);
 
-        vertex_metadata[id] = seq;
+        return vertex_seq.data() + vertexSeqStart[v];
       }
 
       /**
@@ -242,6 +376,54 @@ namespace psgl
 
       }
 
+      /**
+       * @brief                   add edges from out-adjacency lists
+       * @param[in] offsets       out-neighbors of vertex i are saved in adjcny starting at
+       *                          index offsets[i] and ending at offsets[i+1], size = numVertices + 1
+       * @param[in] adjcny        out-neighbors of all vertices
+       * @details                 same result as initEdges() with an edge vector, but in-edges
+       *                          are gathered with prefix sums of in-degrees instead of sorting
+       */
+      void initEdges(std::vector<int32_t> &&offsets, std::vector<int32_t> &&adjcny)
+      {
+        assert(offsets.size() == this->numVertices + 1);
+        assert(offsets.front() == 0 && offsets.back() == adjcny.size());
+
+        for(auto vId : adjcny)
+          assert(vId >= 0 && vId < this->numVertices);
+
+        this->numEdges = adjcny.size();
+
+        //out-edges, adjacency lists are sorted
+        {
+          offsets_out = std::move(offsets);
+          adjcny_out = std::move(adjcny);
+
+#pragma omp parallel for schedule(dynamic, 1024)
+          for(int32_t i = 0; i < this->numVertices; i++)
+            std::sort(adjcny_out.begin() + offsets_out[i], adjcny_out.begin() + offsets_out[i+1]);
+        }
+
+        //for in-edges
+        {
+          offsets_in.assign(this->numVertices + 1, 0);
+          adjcny_in.resize(this->numEdges);
+
+          for(auto vId : adjcny_out)
+            offsets_in[vId + 1]++;
+
+          for(int32_t i = 0; i < this->numVertices; i++)
+            offsets_in[i + 1] += offsets_in[i];
+
+          //in-neighbors are visited in increasing order of ids, so lists are sorted
+          std::vector<int32_t> next(offsets_in.begin(), offsets_in.end() - 1);
+
+          for(int32_t i = 0; i < this->numVertices; i++)
+            for(auto j = offsets_out[i]; j < offsets_out[i+1]; j++)
+              adjcny_in[ next[adjcny_out[j]]++ ] = i;
+        }
+      }
+
       /**
        * @brief             check existence of edge from vertex u to v
        * @param[in]   u     vertex id
@@ -283,7 +465,7 @@ namespace psgl
           for (int32_t j = offsets_out[i]; j < offsets_out[i+1]; j++)
             std::cerr << adjcny_out[j] << " ";
 
-          std::cerr << vertex_metadata[i] << "\n";
+          std::cerr << vertex_seq.substr(vertexSeqStart[i], vertexSeqLength[i]) << "\n";
         }
 
         std::cerr << "DEBUG, psgl::CSR_container::printGraph, Printing done" << std::endl;
@@ -297,11 +479,11 @@ namespace psgl
       {
         std::size_t totalLen = 0;
 
-        for (auto &i : vertex_metadata)
+        for (auto &len : vertexSeqLength)
         {
-          assert(i.length() > 0);
+          assert(len > 0);
 
-          totalLen += i.length();
+          totalLen += len;
         }
 
         return totalLen;
@@ -322,9 +504,9 @@ namespace psgl
 
         for (auto i = v1; i <= v2; i++)
         {
-          assert(vertex_metadata[i].length() > 0);
+          assert(vertexSeqLength[i] > 0);
 
-          totalLen += vertex_metadata[i].length();
+          totalLen += vertexSeqLength[i];
         }
 
         return totalLen;
@@ -339,6 +521,9 @@ namespace psgl
 
         topologicalSort(order); 
 
+        //keep each weakly connected component contiguous in the order
+        groupComponents(order);
+
         std::cout << "INFO, psgl::CSR_container::sort, topological sort computed, bandwidth = " << directedBandwidth(order) << std::endl;
         std::cout << "INFO, psgl::CSR_container::sort, relabeling graph based on the computed order" << std::endl;
 
@@ -349,14 +534,29 @@ namespace psgl
 
         //Relabel the graph completely in this order
         {
-          //meta-data
+          //sequences, permute offsets and lay out the buffer in the new order
           {
-            std::vector<std::string> vertex_metadata_new(this->numVertices);
+            std::vector<int64_t> vertexSeqStart_new(this->numVertices);
+            std::vector<int32_t> vertexSeqLength_new(this->numVertices);
+
+            for (int32_t i = 0; i < this->numVertices; i++)
+            {
+              vertexSeqStart_new[i] = vertexSeqStart[ originalVertexId[i] ];
+              vertexSeqLength_new[i] = vertexSeqLength[ originalVertexId[i] ];
+            }
+
+            std::string vertex_seq_new;
+            vertex_seq_new.reserve(vertex_seq.length());
 
             for (int32_t i = 0; i < this->numVertices; i++)
-              vertex_metadata_new[i] = vertex_metadata[ originalVertexId[i] ];
+            {
+              vertex_seq_new.append(vertex_seq, vertexSeqStart_new[i], vertexSeqLength_new[i]);
+              vertexSeqStart_new[i] = vertex_seq_new.length() - vertexSeqLength_new[i];
+            }
 
-            vertex_metadata = vertex_metadata_new;
+            vertex_seq.swap(vertex_seq_new);
+            vertexSeqStart.swap(vertexSeqStart_new);
+            vertexSeqLength.swap(vertexSeqLength_new);
           }
 
           //adjacency lists
@@ -413,11 +613,11 @@ namespace psgl
         }
 
         //compute prefix sequence length
-        this->cumulativeSeqLength[0] = vertex_metadata[0].length();
+        this->cumulativeSeqLength[0] = vertexSeqLength[0];
 
         for(int32_t i = 1; i < this->numVertices; i++)
         {
-          cumulativeSeqLength[i] = cumulativeSeqLength[i-1] + vertex_metadata[i].length();
+          cumulativeSeqLength[i] = cumulativeSeqLength[i-1] + vertexSeqLength[i];
         }
       }
 
@@ -456,7 +656,7 @@ namespace psgl
        * @details                 useful during DP execution- to access left neighboring reference 
        *                          cells
        */
-      void getInSeqOffsets(int32_t v, std::vector<int32_t> &vec) const
+      void getInSeqOffsets(int32_t v, std::vector<int64_t> &vec) const
       {
         assert(vec.size() == 0);
         assert(v >= 0 && v < this->numVertices);
@@ -472,13 +672,13 @@ namespace psgl
        * @details                 useful during reverse DP execution- to access right neighboring reference 
        *                          cells
        */
-      void getOutSeqOffsets(int32_t v, std::vector<int32_t> &vec) const
+      void getOutSeqOffsets(int32_t v, std::vector<int64_t> &vec) const
       {
         assert(vec.size() == 0);
         assert(v >= 0 && v < this->numVertices);
 
         for(auto i = offsets_out[v]; i < offsets_out[v+1]; i++)
-          vec.push_back( cumulativeSeqLength[adjcny_out[i]] - vertex_metadata[adjcny_out[i]].length() );
+          vec.push_back( vertexSeqStart[adjcny_out[i]] );
       }
 
     private:
@@ -530,6 +730,114 @@ namespace psgl
             if (--deg[ adjcny_out[j] ] == 0)
               Q.emplace_back (adjcny_out[j]);     //add to Q
         }
+
+        //vertices on a cycle are never added to Q
+        if (currentOrder != this->numVertices)
+        {
+          std::cerr << "ERROR, psgl::CSR_container::topologicalSort, graph is not acyclic, " 
+            << this->numVertices - currentOrder << " vertices are on or after a cycle" << std::endl;
+          exit(1);
+        }
+      }
+
+      /**
+       * @brief                   compute weakly connected components of the graph
+       * @param[out]  componentId component id of each vertex, size = numVertices
+       * @return                  count of components
+       */
+      int32_t weaklyConnectedComponents(std::vector<int32_t> &componentId) const
+      {
+        componentId.assign(this->numVertices, -1);
+
+        int32_t count = 0;
+        std::vector<int32_t> stack;
+
+        for (int32_t i = 0; i < this->numVertices; i++)
+        {
+          if (componentId[i] != -1)
+            continue;
+
+          //iterative DFS ignoring edge directions
+          componentId[i] = count;
+          stack.push_back(i);
+
+          while (!stack.empty())
+          {
+            int32_t v = stack.back();
+            stack.pop_back();
+
+            for(auto j = offsets_out[v]; j < offsets_out[v+1]; j++)
+              if (componentId[ adjcny_out[j] ] == -1)
+              {
+                componentId[ adjcny_out[j] ] = count;
+                stack.push_back( adjcny_out[j] );
+              }
+
+            for(auto j = offsets_in[v]; j < offsets_in[v+1]; j++)
+              if (componentId[ adjcny_in[j] ] == -1)
+              {
+                componentId[ adjcny_in[j] ] = count;
+                stack.push_back( adjcny_in[j] );
+              }
+          }
+
+          count++;
+        }
+
+        return count;
+      }
+
+      /**
+       * @brief                   modify a topological order such that vertices of each weakly 
+       *                          connected component form a contiguous range, and record 
+       *                          these ranges in componentOffsets
+       * @param[in/out] finalOrder  vertex ordering (vertex [0 - n-1] to position [0 - n-1] 
+       *                          mapping)
+       * @details                 relative order of vertices within a component is preserved,
+       *                          so the modified order remains topologically sorted. Components 
+       *                          are placed in the order of their first vertex in the input order
+       */
+      void groupComponents(std::vector<int32_t> &finalOrder)
+      {
+        assert(finalOrder.size() == this->numVertices);
+
+        std::vector<int32_t> componentId;
+        int32_t countComponents = weaklyConnectedComponents(componentId);
+
+        //Sorted position to vertex mapping (reverse order)
+        std::vector<int32_t> reverseOrder(this->numVertices);
+        for(int32_t i = 0; i < this->numVertices; i++)
+          reverseOrder[ finalOrder[i] ] = i;
+
+        //rank components by their first appearance in the order
+        std::vector<int32_t> componentRank(countComponents, -1);
+        std::vector<int32_t> componentSize(countComponents, 0);
+        int32_t rank = 0;
+
+        for(int32_t i = 0; i < this->numVertices; i++)
+        {
+          auto c = componentId[ reverseOrder[i] ];
+
+          if (componentRank[c] == -1)
+            componentRank[c] = rank++;
+
+          componentSize[ componentRank[c] ]++;
+        }
+
+        //counting sort by component rank
+        componentOffsets.assign(countComponents + 1, 0);
+        for(int32_t c = 0; c < countComponents; c++)
+          componentOffsets[c + 1] = componentOffsets[c] + componentSize[c];
+
+        std::vector<int32_t> nextPosition (componentOffsets.begin(), componentOffsets.end() - 1);
+
+        for(int32_t i = 0; i < this->numVertices; i++)
+        {
+          auto v = reverseOrder[i];
+          finalOrder[v] = nextPosition[ componentRank[ componentId[v] ] ]++;
+        }
+
+        std::cout << "INFO, psgl::CSR_container::groupComponents, count of weakly connected components = " << countComponents << std::endl;
       }
 
       /**
@@ -572,7 +880,7 @@ namespace psgl
             std::size_t tmp_bandwidth = to_pos - from_pos;
 
             for(auto k = from_pos + 1; k < to_pos; k++)
-              tmp_bandwidth += vertex_metadata[reverseOrder[k]].length() - 1;
+              tmp_bandwidth += vertexSeqLength[reverseOrder[k]] - 1;
 
             if(tmp_bandwidth > bandwidth)
             {
@@ -10,6 +10,7 @@
 
 #include <cassert>
 #include <iostream>
+#include <tuple>
 
 //Own includes
 #include "csr.hpp"
@@ -26,33 +27,64 @@ namespace psgl
    *            - Adjacency list (incoming edges) of vertex i is stored in 
    *              array 'adjcny_in' starting at index offsets_in[i] and 
    *              ending at (but not including) index offsets_in[i+1]
+   *            - Adjacency lists save hop distances rather than vertex ids, 
+   *              i.e., j-th in-neighbor of vertex i is (i - adjcny_in[j]), and 
+   *              j-th out-neighbor is (i + adjcny_out[j])
    *            - CSR_char_container should be built using existing 
    *              CSR_container (see class constructor)
    *
-   *            - Assumption: count of vertices and edges < 2B because we are
-   *              using int32_t type everywhere
+   *            - Assumption: vertices (characters) and edges are counted with 
+   *              int64_t type, whereas hop distances and width of each weakly 
+   *              connected component should be < 2B. This way, DP kernels 
+   *              use int32_t column offsets within a component
    */
   class CSR_char_container
   {
     public:
 
       //Count of edges and vertices in the graph
-      int32_t numVertices;
-      int32_t numEdges;
+      int64_t numVertices;
+      int64_t numEdges;
 
-      //contiguous adjacency list of all vertices, size = numEdges
+      //contiguous adjacency list of all vertices as hop distances, size = numEdges
       std::vector<int32_t> adjcny_in;  
       std::vector<int32_t> adjcny_out;  
 
       //offsets in adjacency list for each vertex, size = numVertices + 1
-      std::vector<int32_t> offsets_in;
-      std::vector<int32_t> offsets_out;
+      std::vector<int64_t> offsets_in;
+      std::vector<int64_t> offsets_out;
 
       //Container to hold character label of all vertices in graph
       std::vector<char> vertex_label;
 
-      //Container to hold original vertexi, and character offset (0-based)  
-      std::vector< std::pair<int32_t, int32_t> > originalVertexId;
+      //column where each vertex of the sequence graph begins, in topological order, 
+      //followed by count of columns. Size = count of sequence graph vertices + 1
+      std::vector<int64_t> vertexStart;
+
+      //original id of each vertex of the sequence graph, in topological order
+      std::vector<int32_t> vertexOriginalId;
+
+      //count of vertices per strand of a bi-directed input graph, 0 for directed graphs,
+      //see CSR_container::strandVertices
+      int32_t strandVertices = 0;
+
+      //segment names of GFA input, name of input vertex i is the substring 
+      //[segmentNameStart[i], segmentNameStart[i+1]) of segment_names, empty for other formats
+      std::string segment_names;
+      std::vector<int64_t> segmentNameStart;
+
+      //weakly connected components occupy contiguous column ranges,
+      //component i spans columns [componentOffsets[i], componentOffsets[i+1])
+      std::vector<int64_t> componentOffsets;
+
+      //k-mer length used to index components, 0 if index is not built
+      int32_t componentKmerLength = 0;
+
+      //sorted and unique pairs of <k-mer, component id>
+      std::vector< std::pair<uint32_t, int32_t> > componentKmers;
+
+      //components with too many k-mers to enumerate, these are never filtered
+      std::vector<bool> componentUnfiltered;
 
       /**
        * @brief             build complete CSR_char graph
@@ -61,9 +93,11 @@ namespace psgl
       void build (CSR_container &csr)
       {
         this->numVertices = csr.totalRefLength();
+        this->strandVertices = csr.strandVertices;
 
         vertex_label.reserve (csr.totalRefLength());
-        originalVertexId.reserve (csr.totalRefLength());
+        vertexStart.reserve (csr.numVertices + 1);
+        vertexOriginalId.reserve (csr.numVertices);
 
         adjcny_in.reserve (csr.totalRefLength() + csr.numEdges - csr.numVertices);
         adjcny_out.reserve (csr.totalRefLength() + csr.numEdges - csr.numVertices);
@@ -75,12 +109,13 @@ namespace psgl
         {
           for(int32_t i = 0; i < csr.numVertices; i++)
           {
-            for(int32_t j = 0; j < csr.vertex_metadata[i].length(); j++)
-            {
-              vertex_label.push_back ( csr.vertex_metadata[i].at(j) );
-              originalVertexId.emplace_back (csr.originalVertexId[i],j);
-            }
+            vertexStart.push_back (vertex_label.size());
+            vertexOriginalId.push_back (csr.originalVertexId[i]);
+
+            vertex_label.insert (vertex_label.end(), csr.vertexSeq(i), csr.vertexSeq(i) + csr.vertexSeqLength[i]);
           }
+
+          vertexStart.push_back (vertex_label.size());
         }
 
         //Init edges:
@@ -88,7 +123,7 @@ namespace psgl
           // in edges
           {
             offsets_in.push_back(0);
-            std::vector<int32_t> inNeighbors;
+            std::vector<int64_t> inNeighbors;
 
             for (graphIterFwd g(csr); !g.end(); g.next())
             {
@@ -97,7 +132,16 @@ namespace psgl
               g.getInNeighborOffsets(inNeighbors);
 
               for(auto &e : inNeighbors)
-                adjcny_in.push_back(e);
+              {
+                //edge hops are saved as int32_t
+                if (g.getGlobalOffset() - e > INT32_MAX)
+                {
+                  std::cerr << "ERROR, psgl::CSR_char_container::build, edge hop exceeds int32_t range" << std::endl;
+                  exit(1);
+                }
+
+                adjcny_in.push_back(g.getGlobalOffset() - e);
+              }
 
               offsets_in.push_back (adjcny_in.size());
             }
@@ -106,7 +150,7 @@ namespace psgl
           // out edges
           {
             offsets_out.push_back(0);
-            std::vector<int32_t> outNeighbors;
+            std::vector<int64_t> outNeighbors;
 
             for (graphIterFwd g(csr); !g.end(); g.next())
             {
@@ -115,7 +159,16 @@ namespace psgl
               g.getOutNeighborOffsets(outNeighbors);
 
               for(auto &e : outNeighbors)
-                adjcny_out.push_back(e);
+              {
+                //edge hops are saved as int32_t
+                if (e - g.getGlobalOffset() > INT32_MAX)
+                {
+                  std::cerr << "ERROR, psgl::CSR_char_container::build, edge hop exceeds int32_t range" << std::endl;
+                  exit(1);
+                }
+
+                adjcny_out.push_back(e - g.getGlobalOffset());
+              }
 
               offsets_out.push_back (adjcny_out.size());
             }
@@ -124,8 +177,17 @@ namespace psgl
 
         this->numEdges = adjcny_in.size();
 
+        //Save component ranges in terms of columns
+        {
+          componentOffsets.clear();
+
+          for(auto v : csr.componentOffsets)
+            componentOffsets.push_back (v == 0 ? 0 : csr.cumulativeSeqLength[v - 1]);
+        }
+
         assert(vertex_label.size() == this->numVertices);
-        assert(originalVertexId.size() == this->numVertices);
+        assert(vertexStart.size() == csr.numVertices + 1);
+        assert(vertexOriginalId.size() == csr.numVertices);
 
         assert(adjcny_in.size() == csr.totalRefLength() + csr.numEdges - csr.numVertices);
         assert(adjcny_out.size() == csr.totalRefLength() + csr.numEdges - csr.numVertices);
@@ -133,35 +195,267 @@ namespace psgl
         assert(offsets_in.size() ==  csr.totalRefLength() + 1);
         assert(offsets_out.size() ==  csr.totalRefLength() + 1);
 
-#ifndef NDEBUG
-        this->verify();
-#endif
-
         std::cout << "INFO, psgl::CSR_char_container::build, graph converted to CSR format with character labels, n = " << this->numVertices << ", m = " << this->numEdges << std::endl;
       }
 
       /**
-       * @brief             compute and print histogram of degree values
+       * @brief             find original vertex of a column
+       * @param[in]   col
+       * @return            original vertex id, and character offset (0-based) in its label
        */
-      void printDegreeHistogram () const
+      std::pair<int32_t, int32_t> originalVertexId (int64_t col) const
       {
-        std::cout << "Printing degree distribution ..." << "\n"; 
+        assert(col >= 0 && col < this->numVertices);
+
+        auto v = std::upper_bound (vertexStart.begin(), vertexStart.end(), col) - vertexStart.begin() - 1;
+        return std::make_pair (vertexOriginalId[v], col - vertexStart[v]);
+      }
+
+      /**
+       * @brief             find oriented vertex of the input graph of a column
+       * @param[in]   col
+       * @return            vertex, offset and orientation reported in the output
+       */
+      VertexOffset outputVertexId (int64_t col) const
+      {
+        auto v = originalVertexId (col);
+
+        if (strandVertices == 0)
+          return VertexOffset {v.first, v.second, 0};
+        else if (v.first < strandVertices)
+          return VertexOffset {v.first, v.second, '+'};
+        else
+          return VertexOffset {v.first - strandVertices, v.second, '-'};
+      }
+
+      /**
+       * @brief             name of an input vertex reported in the output, i.e., 
+       *                    its segment name for GFA input, or its id otherwise
+       * @param[in]   id    input vertex id, see outputVertexId()
+       */
+      std::string outputVertexName (int32_t id) const
+      {
+        if (segmentNameStart.empty())
+          return std::to_string (id);
+
+        assert(id >= 0 && id + 1 < segmentNameStart.size());
+        return segment_names.substr (segmentNameStart[id], segmentNameStart[id+1] - segmentNameStart[id]);
+      }
+
+      /**
+       * @brief             count of weakly connected components
+       */
+      std::size_t numComponents() const
+      {
+        return componentOffsets.size() - 1;
+      }
+
+      /**
+       * @brief             find the component containing a column
+       * @param[in]   col
+       * @return            component id
+       */
+      int32_t componentOf (int64_t col) const
+      {
+        assert(col >= 0 && col < this->numVertices);
+
+        return std::upper_bound (componentOffsets.begin(), componentOffsets.end(), col) - componentOffsets.begin() - 1;
+      }
+
+      /**
+       * @brief             maximum count of columns in a component
+       */
+      int64_t maxComponentWidth() const
+      {
+        int64_t width = 0;
+
+        for(std::size_t c = 0; c < numComponents(); c++)
+          width = std::max (width, componentOffsets[c+1] - componentOffsets[c]);
+
+        return width;
+      }
+
+      /**
+       * @brief             index k-mers spelled along paths of each component
+       * @param[in]   k     k-mer length, should be <= 16
+       * @details           used to skip components which share no exact k-mer with 
+       *                    a batch of reads. k-mers ending at each column are enumerated
+       *                    by a backward DFS; a component where a column ends too many 
+       *                    distinct paths is marked as unfiltered instead
+       */
+      void indexComponentKmers (int32_t k)
+      {
+        assert(k > 0 && k <= 16);
+
+        //cap on count of distinct paths of length k ending at a column
+        constexpr std::size_t maxPathsPerColumn = 256;
+
+        this->componentKmerLength = k;
+        this->componentKmers.clear();
+        this->componentUnfiltered.assign (numComponents(), false);
+
+        //per-thread k-mer lists and unfiltered components, merged later
+        std::vector< std::vector< std::pair<uint32_t, int32_t> > > threadKmers (omp_get_max_threads());
+        std::vector< std::vector<int32_t> > threadUnfiltered (omp_get_max_threads());
+
+#pragma omp parallel
+        {
+          auto &kmers = threadKmers[omp_get_thread_num()];
+
+          //DFS stack of <column, depth, partial k-mer>
+          std::vector< std::tuple<int64_t, int32_t, uint32_t> > stack;
+
+#pragma omp for schedule(dynamic)
+          for(std::size_t c = 0; c < numComponents(); c++)
+          {
+            std::size_t kmersBefore = kmers.size();
+            bool unfiltered = false;
+
+            for(int64_t i = componentOffsets[c]; i < componentOffsets[c+1] && !unfiltered; i++)
+            {
+              std::size_t pathCount = 0;
+
+              //k-mers with ambiguous characters are not indexed, so such characters are
+              //never pushed. All 2^32 codes are valid k-mers at k = 16, leaving no sentinel
+              auto first = seqUtils::encodeBase (vertex_label[i]);
+
+              if (first == UINT32_MAX)
+                continue;
+
+              stack.clear();
+              stack.emplace_back (i, 1, first);
+
+              while (!stack.empty())
+              {
+                int64_t v; int32_t depth; uint32_t code;
+                std::tie (v, depth, code) = stack.back();
+                stack.pop_back();
+
+                if (depth == k)
+                {
+                  kmers.emplace_back (code, c);
+
+                  if (++pathCount > maxPathsPerColumn)
+                  {
+                    unfiltered = true;
+                    break;
+                  }
+
+                  continue;
+                }
+
+                for(auto j = offsets_in[v]; j < offsets_in[v+1]; j++)
+                {
+                  auto u = v - adjcny_in[j];
+                  auto b = seqUtils::encodeBase (vertex_label[u]);
+
+                  if (b != UINT32_MAX)
+                    stack.emplace_back (u, depth + 1, code | (b << (2 * depth)));
+                }
+              }
+            }
+
+            //k-mers of an unfiltered component are not needed
+            if (unfiltered)
+            {
+              kmers.resize (kmersBefore);
+              threadUnfiltered[omp_get_thread_num()].push_back (c);
+            }
+          }
+        }
+
+        for(auto &e : threadKmers)
+          componentKmers.insert (componentKmers.end(), e.begin(), e.end());
+
+        for(auto &e : threadUnfiltered)
+          for(auto c : e)
+            componentUnfiltered[c] = true;
+
+        std::sort (componentKmers.begin(), componentKmers.end());
+        componentKmers.erase (std::unique (componentKmers.begin(), componentKmers.end()), componentKmers.end());
+
+        std::cout << "INFO, psgl::CSR_char_container::indexComponentKmers, k = " << k 
+          << ", indexed k-mers = " << componentKmers.size() 
+          << ", unfiltered components = " << std::count (componentUnfiltered.begin(), componentUnfiltered.end(), true) << std::endl;
+      }
+
+      /**
+       * @brief                 mark components that share an exact k-mer with a sequence
+       * @param[in]     seq     query sequence
+       * @param[in/out] hits    boolean flag per component, set to true for components 
+       *                        with a k-mer hit or which can not be filtered
+       * @note                  k-mers are encoded in the same (right to left) orientation 
+       *                        as in indexComponentKmers()
+       */
+      void markComponentKmerHits (const std::string &seq, std::vector<bool> &hits) const
+      {
+        assert(hits.size() == numComponents());
+        assert(componentKmerLength > 0);
+
+        const int32_t k = componentKmerLength;
+        const uint32_t mask = (k == 16) ? UINT32_MAX : (1u << (2 * k)) - 1;
+
+        for(std::size_t c = 0; c < numComponents(); c++)
+          if (componentUnfiltered[c])
+            hits[c] = true;
+
+        uint32_t code = 0;
+        int32_t validLength = 0;
 
-        int32_t maxDegree = 0;
+        for(std::size_t i = 0; i < seq.length(); i++)
+        {
+          auto b = seqUtils::encodeBase (seq[i]);
+
+          if (b == UINT32_MAX)
+          {
+            validLength = 0; code = 0;
+            continue;
+          }
+
+          //latest character occupies the least significant bits
+          code = ((code << 2) | b) & mask;
+
+          if (++validLength >= k)
+          {
+            auto it = std::lower_bound (componentKmers.begin(), componentKmers.end(), std::make_pair (code, (int32_t) 0));
+
+            for(; it != componentKmers.end() && it->first == code; it++)
+              hits[it->second] = true;
+          }
+        }
+      }
+
+      /**
+       * @brief             compute histogram of in-degree values
+       * @return            count of vertices with each in-degree
+       */
+      std::vector<int64_t> degreeHistogram () const
+      {
+        int64_t maxDegree = 0;
 
         //compute maximum degree in the graph
-        for(int32_t i = 0; i < this->numVertices; i++)
-          for(auto j = offsets_in[i]; j < offsets_in[i+1]; j++)
-            maxDegree = std::max (maxDegree, offsets_in[i+1] - offsets_in[i]);
+        for(int64_t i = 0; i < this->numVertices; i++)
+          maxDegree = std::max (maxDegree, offsets_in[i+1] - offsets_in[i]);
 
-        std::vector<int32_t> degreeHist (maxDegree + 1, 0);
+        std::vector<int64_t> degreeHist (maxDegree + 1, 0);
 
         //compute histogram
-        for(int32_t i = 0; i < this->numVertices; i++)
-          for(auto j = offsets_in[i]; j < offsets_in[i+1]; j++)
-            degreeHist [offsets_in[i+1] - offsets_in[i] ]++; 
+        for(int64_t i = 0; i < this->numVertices; i++)
+          degreeHist [offsets_in[i+1] - offsets_in[i] ]++; 
 
-        for(int32_t i = 0; i <= maxDegree; i++)
+        return degreeHist;
+      }
+
+      /**
+       * @brief             compute and print histogram of degree values
+       */
+      void printDegreeHistogram () const
+      {
+        std::cout << "Printing degree distribution ..." << "\n"; 
+
+        auto degreeHist = this->degreeHistogram();
+
+        for(std::size_t i = 0; i < degreeHist.size(); i++)
           if (degreeHist[i] > 0)
             std::cout << i << " : " << degreeHist[i] << "\n"; 
 
@@ -169,114 +463,128 @@ namespace psgl
       }
 
       /**
-       * @brief             compute and print histogram of hop distances in 
+       * @brief             compute histogram of hop distances in 
        *                    the sorted order
+       * @return            count of edges with each hop distance
        */
-      void printHopLengthHistogram() const
+      std::vector<int64_t> hopLengthHistogram() const
       {
-        std::cout << "Printing hop length distribution  ..." << "\n"; 
-
         //get maximum hop length
         int32_t maxHopLength = this->directedBandwidth();
 
-        std::vector<int32_t> hopLengthHist (maxHopLength + 1, 0);
+        std::vector<int64_t> hopLengthHist (maxHopLength + 1, 0);
 
         //compute histogram
-        for(int32_t i = 0; i < this->numVertices; i++)
+        for(int64_t i = 0; i < this->numVertices; i++)
           for(auto j = offsets_in[i]; j < offsets_in[i+1]; j++)
-            hopLengthHist [ i - adjcny_in[j] ] ++;
+            hopLengthHist [ adjcny_in[j] ] ++;
 
-        for(int32_t i = 0; i <= maxHopLength; i++)
-          if (hopLengthHist[i] > 0)
-            std::cout << i << " : " << hopLengthHist[i] << "\n"; 
-
-        std::cout.flush();
+        return hopLengthHist;
       }
 
-    private:
-
       /**
-       * @brief                   compute maximum distance between connected vertices in the graph (a.k.a. 
-       *                          directed bandwidth)
-       * @return                  directed graph bandwidth
+       * @brief             compute and print histogram of hop distances in 
+       *                    the sorted order
        */
-      std::size_t directedBandwidth() const
+      void printHopLengthHistogram() const
       {
-        std::size_t bandwidth = 0;   //temporary value 
-
-        //iterate over all vertices in graph to compute bandwidth
-        for(int32_t i = 0; i < this->numVertices; i++)
-        {
-          for(auto j = offsets_in[i]; j < offsets_in[i+1]; j++)
-          {
-            auto from_pos = adjcny_in[j];
-            auto to_pos = i;
+        std::cout << "Printing hop length distribution  ..." << "\n"; 
 
-            assert(to_pos > from_pos);
+        auto hopLengthHist = this->hopLengthHistogram();
 
-            if (to_pos - from_pos > bandwidth)
-              bandwidth = to_pos - from_pos;
-          }
-        }
+        for(std::size_t i = 0; i < hopLengthHist.size(); i++)
+          if (hopLengthHist[i] > 0)
+            std::cout << i << " : " << hopLengthHist[i] << "\n"; 
 
-        return bandwidth;
+        std::cout.flush();
       }
 
       /**
        * @brief     sanity check for correctness of graph storage in CSR format
+       * @return    false if a check fails, the failed check is reported
        */
-      void verify() const
+      bool verify() const
       {
-        assert(this->numVertices > 0);
-        assert(this->numEdges > 0);
+        const char *caller = "psgl::CSR_char_container::verify";
+
+        psgl_verify (this->numVertices > 0, caller);
+        psgl_verify (this->numEdges > 0, caller);
 
         //labels
         {
-          assert(vertex_label.size() == this->numVertices);
+          psgl_verify (vertex_label.size() == this->numVertices, caller);
 
           for(auto &c : vertex_label)
           {
-            assert(std::isupper(c));
-            assert(c == 'A' || c == 'T' || c == 'G' || c == 'C' || c == 'N');
+            psgl_verify (std::isupper(c), caller);
+            psgl_verify (c == 'A' || c == 'T' || c == 'G' || c == 'C' || c == 'N', caller);
           }
         }
 
         //adjacency list
         {
-          assert(adjcny_in.size() == this->numEdges);
-          assert(adjcny_out.size() == this->numEdges);
+          psgl_verify (adjcny_in.size() == this->numEdges, caller);
+          psgl_verify (adjcny_out.size() == this->numEdges, caller);
 
-          for(auto vId : adjcny_in)
-            assert(vId >=0 && vId < this->numVertices);
+          for(int64_t i = 0; i < this->numVertices; i++)
+            for(auto j = offsets_in[i]; j < offsets_in[i+1]; j++)
+              psgl_verify (i - adjcny_in[j] >= 0, caller);
 
-          for(auto vId : adjcny_out)
-            assert(vId >=0 && vId < this->numVertices);
+          for(int64_t i = 0; i < this->numVertices; i++)
+            for(auto j = offsets_out[i]; j < offsets_out[i+1]; j++)
+              psgl_verify (i + adjcny_out[j] < this->numVertices, caller);
         }
 
         //offset array
         {
-          assert(offsets_in.size() == this->numVertices + 1);
-          assert(std::is_sorted(offsets_in.begin(), offsets_in.end()));
-          assert(offsets_in.front() == 0 && offsets_in.back() == this->numEdges);
+          psgl_verify (offsets_in.size() == this->numVertices + 1, caller);
+          psgl_verify (std::is_sorted(offsets_in.begin(), offsets_in.end()), caller);
+          psgl_verify (offsets_in.front() == 0 && offsets_in.back() == this->numEdges, caller);
 
-          assert(offsets_out.size() == this->numVertices + 1);
-          assert(std::is_sorted(offsets_out.begin(), offsets_out.end()));
-          assert(offsets_out.front() == 0 && offsets_out.back() == this->numEdges);
+          psgl_verify (offsets_out.size() == this->numVertices + 1, caller);
+          psgl_verify (std::is_sorted(offsets_out.begin(), offsets_out.end()), caller);
+          psgl_verify (offsets_out.front() == 0 && offsets_out.back() == this->numEdges, caller);
 
           for(auto off : offsets_out)
-            assert(off >=0 && off <= this->numEdges); 
+            psgl_verify (off >=0 && off <= this->numEdges, caller); 
         }
 
         //topologically sorted order
         {
-          for(int32_t i = 0; i < this->numVertices; i++)
-            for(auto j = offsets_in[i]; j < offsets_in[i+1]; j++)
-              assert( adjcny_in[j] < i);
+          for(auto hop : adjcny_in)
+            psgl_verify (hop > 0, caller);
 
-          for(int32_t i = 0; i < this->numVertices; i++)
-            for(auto j = offsets_out[i]; j < offsets_out[i+1]; j++)
-              assert( adjcny_out[j] > i);
+          for(auto hop : adjcny_out)
+            psgl_verify (hop > 0, caller);
+        }
+
+        return true;
+      }
+
+    private:
+
+      /**
+       * @brief                   compute maximum distance between connected vertices in the graph (a.k.a. 
+       *                          directed bandwidth)
+       * @return                  directed graph bandwidth
+       */
+      std::size_t directedBandwidth() const
+      {
+        std::size_t bandwidth = 0;   //temporary value 
+
+        //iterate over all vertices in graph to compute bandwidth
+        for(int64_t i = 0; i < this->numVertices; i++)
+        {
+          for(auto j = offsets_in[i]; j < offsets_in[i+1]; j++)
+          {
+            assert(adjcny_in[j] > 0);
+
+            if ((std::size_t) adjcny_in[j] > bandwidth)
+              bandwidth = adjcny_in[j];
+          }
         }
+
+        return bandwidth;
       }
   };
 }
@@ -0,0 +1,470 @@
+/**
+ * @file    csr_stream.hpp
+ * @brief   routines to save a character labeled CSR graph to a file,
+ *          and to stream its columns from a memory-mapped file
+ * @author  Chirag Jain <cjain7@gatech.edu>
+ */
+
+#ifndef CSR_CHAR_STREAM_HPP
+#define CSR_CHAR_STREAM_HPP
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+//Own includes
+#include "csr_char.hpp"
+
+namespace psgl
+{
+
+  /**
+   * @brief     read-only view of a character labeled CSR graph, backed by
+   *            a memory-mapped file
+   * @details   arrays have same layout and names as in CSR_char_container,
+   *            so routines which only read the graph can use either of them.
+   *            Additionally, slots for long hop columns are precomputed such
+   *            that a slot is reused once its last consumer column has been
+   *            swept. As a result, count of slots is bounded by the maximum
+   *            count of long hops crossing any column, rather than graph size
+   */
+  class CSR_char_stream
+  {
+    public:
+
+      //long hop distance threshold used to assign slots
+      static constexpr int32_t hopThreshold = 8;
+
+      //Count of edges and vertices in the graph
+      int64_t numVertices;
+      int64_t numEdges;
+
+      //arrays mapped from file, see CSR_char_container
+      const int32_t *adjcny_in;
+      const int32_t *adjcny_out;
+      const int64_t *offsets_in;
+      const int64_t *offsets_out;
+      const char *vertex_label;
+      const int64_t *vertexStart;
+      const int32_t *vertexOriginalId;
+
+      //count of sequence graph vertices
+      int32_t numSeqVertices;
+
+      //segment names of GFA input, see CSR_char_container
+      const char *segment_names;
+      const int64_t *segmentNameStart;
+      int64_t numSegmentNames;
+
+      //count of vertices per strand of a bi-directed input graph, 0 for directed graphs
+      int32_t strandVertices;
+
+      //slot of each column in long hop buffer for forward and reverse sweeps,
+      //-1 if not required
+      const int32_t *fwdLongHopSlot;
+      const int32_t *revLongHopSlot;
+
+      //count of slots required for forward and reverse sweeps
+      int32_t fwdLongHopSlots;
+      int32_t revLongHopSlots;
+
+      //weakly connected components occupy contiguous column ranges
+      std::vector<int64_t> componentOffsets;
+
+    private:
+
+      //file header
+      struct Header
+      {
+        char magic[8];
+        int64_t version;
+        int64_t numVertices;
+        int64_t numEdges;
+        int64_t numComponents;
+        int64_t numSeqVertices;
+        int64_t fwdLongHopSlots;
+        int64_t revLongHopSlots;
+        int64_t strandVertices;
+
+        //hash of the reference graph file the stream was created from
+        uint64_t sourceHash;
+
+        //count of GFA segment names, 0 for other formats
+        int64_t numSegmentNames;
+        int64_t segmentNameBytes;
+
+        //byte offsets of the arrays in file
+        int64_t sections[12];
+      };
+
+      //layout version of file, files of other versions should be re-created
+      static constexpr int64_t formatVersion = 6;
+
+      //count of arrays saved in file
+      static constexpr int sectionCount = 12;
+
+      //mapped memory
+      char *base = nullptr;
+      std::size_t mappedBytes = 0;
+
+      //byte offset and size of each array in file
+      int64_t sectionBegin[sectionCount];
+      int64_t sectionBytes[sectionCount];
+
+    public:
+
+      CSR_char_stream() = default;
+      CSR_char_stream(const CSR_char_stream&) = delete;
+      CSR_char_stream& operator=(const CSR_char_stream&) = delete;
+
+      ~CSR_char_stream()
+      {
+        if (base != nullptr)
+          munmap (base, mappedBytes);
+      }
+
+      /**
+       * @brief                 compute slots of long hop columns with reuse
+       * @param[in]   g
+       * @param[in]   forward   sweep direction
+       * @param[out]  slots     slot of each column, -1 if none
+       * @return                count of slots required
+       */
+      static int32_t assignLongHopSlots (const CSR_char_container &g, bool forward, std::vector<int32_t> &slots)
+      {
+        slots.assign (g.numVertices, -1);
+
+        //last column (in sweep order) which reads a column through a long hop
+        std::vector<int64_t> lastUse (g.numVertices, -1);
+
+        for (int64_t v = 0; v < g.numVertices; v++)
+        {
+          for (auto j = g.offsets_in[v]; j < g.offsets_in[v+1]; j++)
+          {
+            auto u = v - g.adjcny_in[j];
+
+            if (g.adjcny_in[j] >= hopThreshold)
+            {
+              //forward sweep reads u while computing v, reverse sweep reads v while computing u
+              if (forward)
+                lastUse[u] = std::max (lastUse[u], v);
+              else
+                lastUse[v] = (lastUse[v] == -1) ? u : std::min (lastUse[v], u);
+            }
+          }
+        }
+
+        //slots released at each column, in sweep order
+        std::vector< std::vector<int32_t> > release (g.numVertices);
+        std::vector<int32_t> freeSlots;
+        int32_t slotCount = 0;
+
+        for (int64_t i = 0; i < g.numVertices; i++)
+        {
+          int64_t k = forward ? i : g.numVertices - 1 - i;
+
+          if (lastUse[k] != -1)
+          {
+            if (freeSlots.empty())
+              freeSlots.push_back (slotCount++);
+
+            slots[k] = freeSlots.back();
+            freeSlots.pop_back();
+            release[lastUse[k]].push_back (slots[k]);
+          }
+
+          //slots whose last consumer is column k become available after k
+          for (auto s : release[k])
+            freeSlots.push_back (s);
+        }
+
+        return slotCount;
+      }
+
+      /**
+       * @brief                 save graph to file in streaming format
+       * @param[in]   g
+       * @param[in]   filename
+       * @param[in]   sourceHash  hash of the reference graph file
+       */
+      static void write (const CSR_char_container &g, const std::string &filename, uint64_t sourceHash)
+      {
+        std::vector<int32_t> fwdSlots, revSlots;
+
+        Header h;
+        std::memset (&h, 0, sizeof(Header));
+        std::memcpy (h.magic, "PSGLSTRM", 8);
+        h.version = formatVersion;
+        h.numVertices = g.numVertices;
+        h.numEdges = g.numEdges;
+        h.numComponents = g.numComponents();
+        h.numSeqVertices = g.vertexOriginalId.size();
+        h.strandVertices = g.strandVertices;
+        h.sourceHash = sourceHash;
+        h.numSegmentNames = g.segmentNameStart.empty() ? 0 : g.segmentNameStart.size() - 1;
+        h.segmentNameBytes = g.segment_names.size();
+        h.fwdLongHopSlots = assignLongHopSlots (g, true, fwdSlots);
+        h.revLongHopSlots = assignLongHopSlots (g, false, revSlots);
+
+        std::vector< std::pair<const void *, std::size_t> > arrays =
+        {
+          {g.adjcny_in.data(),        g.adjcny_in.size() * sizeof(int32_t)},
+          {g.adjcny_out.data(),       g.adjcny_out.size() * sizeof(int32_t)},
+          {g.offsets_in.data(),       g.offsets_in.size() * sizeof(int64_t)},
+          {g.offsets_out.data(),      g.offsets_out.size() * sizeof(int64_t)},
+          {g.vertex_label.data(),     g.vertex_label.size() * sizeof(char)},
+          {g.vertexStart.data(),      g.vertexStart.size() * sizeof(int64_t)},
+          {fwdSlots.data(),           fwdSlots.size() * sizeof(int32_t)},
+          {revSlots.data(),           revSlots.size() * sizeof(int32_t)},
+          {g.componentOffsets.data(), g.componentOffsets.size() * sizeof(int64_t)},
+          {g.vertexOriginalId.data(), g.vertexOriginalId.size() * sizeof(int32_t)},
+          {g.segment_names.data(),    g.segment_names.size() * sizeof(char)},
+          {g.segmentNameStart.data(), g.segmentNameStart.size() * sizeof(int64_t)}
+        };
+
+        //arrays begin at page boundaries
+        const int64_t pageSize = sysconf (_SC_PAGESIZE);
+        int64_t offset = pageSize;
+
+        for (int i = 0; i < sectionCount; i++)
+        {
+          h.sections[i] = offset;
+          offset += (arrays[i].second + pageSize - 1) / pageSize * pageSize;
+        }
+
+        std::ofstream outstrm (filename, std::ios::binary);
+        outstrm.write ((const char *) &h, sizeof(Header));
+
+        for (int i = 0; i < sectionCount; i++)
+        {
+          outstrm.seekp (h.sections[i]);
+          outstrm.write ((const char *) arrays[i].first, arrays[i].second);
+        }
+
+        outstrm.close();
+
+        //file spans all sections, including empty ones at the end
+        if (!outstrm.good() || truncate (filename.c_str(), offset) != 0)
+        {
+          std::cerr << "ERROR, psgl::CSR_char_stream::write, failed to write " << filename << std::endl;
+          exit(1);
+        }
+
+        std::cout << "INFO, psgl::CSR_char_stream::write, graph saved to " << filename
+          << ", long hop slots (fwd, rev) = " << h.fwdLongHopSlots << ", " << h.revLongHopSlots << std::endl;
+      }
+
+      /**
+       * @brief                 check if a file was saved using write() in the current
+       *                        format from the same reference graph
+       * @param[in]   filename
+       * @param[in]   sourceHash  hash of the reference graph file
+       * @return                false if file is missing, of another format, or
+       *                        created from a different graph
+       */
+      static bool current (const std::string &filename, uint64_t sourceHash)
+      {
+        std::ifstream instrm (filename, std::ios::binary);
+
+        Header h;
+        instrm.read ((char *) &h, sizeof(Header));
+
+        return instrm.good() &&
+          std::memcmp (h.magic, "PSGLSTRM", 8) == 0 &&
+          h.version == formatVersion &&
+          h.sourceHash == sourceHash;
+      }
+
+      /**
+       * @brief                 memory-map graph saved using write()
+       * @param[in]   filename
+       */
+      void open (const std::string &filename)
+      {
+        assert (base == nullptr);
+
+        int fd = ::open (filename.c_str(), O_RDONLY);
+        struct stat st;
+
+        if (fd < 0 || fstat (fd, &st) != 0 || st.st_size < sizeof(Header))
+        {
+          std::cerr << "ERROR, psgl::CSR_char_stream::open, " << filename << " not accessible" << std::endl;
+          exit(1);
+        }
+
+        mappedBytes = st.st_size;
+        base = (char *) mmap (nullptr, mappedBytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        close (fd);
+
+        if (base == MAP_FAILED)
+        {
+          std::cerr << "ERROR, psgl::CSR_char_stream::open, mmap failed for " << filename << std::endl;
+          exit(1);
+        }
+
+        //columns are swept in topological order
+        madvise (base, mappedBytes, MADV_SEQUENTIAL);
+
+        Header h;
+        std::memcpy (&h, base, sizeof(Header));
+
+        if (std::memcmp (h.magic, "PSGLSTRM", 8) != 0)
+        {
+          std::cerr << "ERROR, psgl::CSR_char_stream::open, " << filename << " is not a PaSGAL graph stream" << std::endl;
+          exit(1);
+        }
+
+        if (h.version != formatVersion)
+        {
+          std::cerr << "ERROR, psgl::CSR_char_stream::open, " << filename << " was saved in an older format, remove it to re-create" << std::endl;
+          exit(1);
+        }
+
+        numVertices = h.numVertices;
+        numEdges = h.numEdges;
+        fwdLongHopSlots = h.fwdLongHopSlots;
+        revLongHopSlots = h.revLongHopSlots;
+
+        for (int i = 0; i < sectionCount; i++)
+          sectionBegin[i] = h.sections[i];
+
+        sectionBytes[0] = sectionBytes[1] = numEdges * sizeof(int32_t);
+        sectionBytes[2] = sectionBytes[3] = (numVertices + 1) * sizeof(int64_t);
+        sectionBytes[4] = numVertices * sizeof(char);
+        sectionBytes[5] = (h.numSeqVertices + 1) * sizeof(int64_t);
+        sectionBytes[6] = sectionBytes[7] = numVertices * sizeof(int32_t);
+        sectionBytes[8] = (h.numComponents + 1) * sizeof(int64_t);
+        sectionBytes[9] = h.numSeqVertices * sizeof(int32_t);
+        sectionBytes[10] = h.segmentNameBytes * sizeof(char);
+        sectionBytes[11] = (h.numSegmentNames > 0 ? h.numSegmentNames + 1 : 0) * sizeof(int64_t);
+
+        if (sectionBegin[11] + sectionBytes[11] > mappedBytes)
+        {
+          std::cerr << "ERROR, psgl::CSR_char_stream::open, " << filename << " is truncated" << std::endl;
+          exit(1);
+        }
+
+        adjcny_in         = (const int32_t *) (base + sectionBegin[0]);
+        adjcny_out        = (const int32_t *) (base + sectionBegin[1]);
+        offsets_in        = (const int64_t *) (base + sectionBegin[2]);
+        offsets_out       = (const int64_t *) (base + sectionBegin[3]);
+        vertex_label      = (const char *)    (base + sectionBegin[4]);
+        vertexStart       = (const int64_t *) (base + sectionBegin[5]);
+        vertexOriginalId  = (const int32_t *) (base + sectionBegin[9]);
+        segment_names     = (const char *)    (base + sectionBegin[10]);
+        segmentNameStart  = (const int64_t *) (base + sectionBegin[11]);
+        numSegmentNames   = h.numSegmentNames;
+        numSeqVertices    = h.numSeqVertices;
+        strandVertices    = h.strandVertices;
+        fwdLongHopSlot    = (const int32_t *) (base + sectionBegin[6]);
+        revLongHopSlot    = (const int32_t *) (base + sectionBegin[7]);
+
+        //component offsets are small, keep a copy
+        auto components = (const int64_t *) (base + sectionBegin[8]);
+        componentOffsets.assign (components, components + h.numComponents + 1);
+
+        std::cout << "INFO, psgl::CSR_char_stream::open, graph mapped from " << filename
+          << ", n = " << numVertices << ", m = " << numEdges << ", file size = " << mappedBytes << " bytes" << std::endl;
+      }
+
+      /**
+       * @brief                 hint the kernel to read column records in range [begin, end) ahead of use
+       * @param[in]   begin
+       * @param[in]   end
+       */
+      void readahead (int64_t begin, int64_t end) const
+      {
+        begin = std::max (begin, (int64_t) 0);
+        end = std::min (end, numVertices);
+
+        if (begin >= end)
+          return;
+
+        const std::size_t pageSize = sysconf (_SC_PAGESIZE);
+
+        auto advise = [&](int section, std::size_t from, std::size_t to) {
+          std::size_t first = (sectionBegin[section] + from) / pageSize * pageSize;
+          std::size_t last = sectionBegin[section] + to;
+          madvise (base + first, last - first, MADV_WILLNEED);
+        };
+
+        advise (2, begin * sizeof(int64_t), (end + 1) * sizeof(int64_t));
+        advise (3, begin * sizeof(int64_t), (end + 1) * sizeof(int64_t));
+        advise (0, offsets_in[begin] * sizeof(int32_t), offsets_in[end] * sizeof(int32_t));
+        advise (1, offsets_out[begin] * sizeof(int32_t), offsets_out[end] * sizeof(int32_t));
+        advise (4, begin, end);
+        advise (6, begin * sizeof(int32_t), end * sizeof(int32_t));
+        advise (7, begin * sizeof(int32_t), end * sizeof(int32_t));
+      }
+
+      /**
+       * @brief             find original vertex of a column
+       * @param[in]   col
+       * @return            original vertex id, and character offset (0-based) in its label
+       */
+      std::pair<int32_t, int32_t> originalVertexId (int64_t col) const
+      {
+        assert(col >= 0 && col < this->numVertices);
+
+        auto v = std::upper_bound (vertexStart, vertexStart + numSeqVertices + 1, col) - vertexStart - 1;
+        return std::make_pair (vertexOriginalId[v], col - vertexStart[v]);
+      }
+
+      /**
+       * @brief             find oriented vertex of the input graph of a column
+       * @param[in]   col
+       * @return            vertex, offset and orientation reported in the output
+       */
+      VertexOffset outputVertexId (int64_t col) const
+      {
+        auto v = originalVertexId (col);
+
+        if (strandVertices == 0)
+          return VertexOffset {v.first, v.second, 0};
+        else if (v.first < strandVertices)
+          return VertexOffset {v.first, v.second, '+'};
+        else
+          return VertexOffset {v.first - strandVertices, v.second, '-'};
+      }
+
+      /**
+       * @brief             name of an input vertex reported in the output, see CSR_char_container
+       * @param[in]   id    input vertex id, see outputVertexId()
+       */
+      std::string outputVertexName (int32_t id) const
+      {
+        if (numSegmentNames == 0)
+          return std::to_string (id);
+
+        assert(id >= 0 && id < numSegmentNames);
+        return std::string (segment_names + segmentNameStart[id], segmentNameStart[id+1] - segmentNameStart[id]);
+      }
+
+      /**
+       * @brief             count of weakly connected components
+       */
+      std::size_t numComponents() const
+      {
+        return componentOffsets.size() - 1;
+      }
+
+      /**
+       * @brief             find the component containing a column
+       * @param[in]   col
+       * @return            component id
+       */
+      int32_t componentOf (int64_t col) const
+      {
+        assert(col >= 0 && col < this->numVertices);
+
+        return std::upper_bound (componentOffsets.begin(), componentOffsets.end(), col) - componentOffsets.begin() - 1;
+      }
+  };
+}
+
+#endif
@@ -7,9 +7,21 @@
 #ifndef GRAPH_LOADER_HPP
 #define GRAPH_LOADER_HPP
 
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <cassert>
+#include <cstring>
 #include <iostream>
 #include <sstream>
+#include <array>
+#include <unordered_map>
+#include <map>
+#include <tuple>
+#include <atomic>
+#include <algorithm>
+#include <zlib.h>
 
 
 //Own includes
@@ -24,22 +36,70 @@ namespace psgl
 {
 
   /**
-   * @brief                       supports loading of sequence graphs from VG file format
+   * @brief     path through the graph, read from P lines of GFA input or paths of VG input
+   * @details   vertex ids are the ids before topological sorting, i.e.,
+   *            as reported by CSR_char_container::originalVertexId()
+   */
+  struct GraphPath
+  {
+    std::string name;
+    std::vector<int32_t> vertices;
+    std::vector<bool> reverse;      //orientation of each step
+  };
+
+  /**
+   * @brief                       supports loading of sequence graphs from VG, GFA and txt file formats
    */
   class graphLoader
   {
     public:
 
-      //initialize an empty sequence labeled di-graph 
-      CSR_container diGraph;
-
       //initialize an empty character labeled di-graph
+      //the sequence labeled di-graph is only kept while loading
       CSR_char_container diCharGraph;
 
+      //paths of GFA and VG input, saved for projecting alignments to path coordinates
+      std::vector<GraphPath> paths;
+
+      //run O(V+E) correctness checks of the loaded graph
+      bool verifyGraph;
+
+      //bytes of a .vg stream decompressed before its chunks are parsed
+      std::size_t vgWindowBytes = 1 << 26;
+
+      /**
+       * @brief                 constructor
+       */
+      graphLoader() : verifyGraph (false) {}
+
+      /**
+       * @brief                 load graph from file
+       * @param[in]  format     vg, gfa or txt
+       * @param[in]  filename
+       */
+      void load(const std::string &format, const std::string &filename)
+      {
+        if (format.compare("vg") == 0)
+          loadFromVG(filename);
+        else if(format.compare("gfa") == 0)
+          loadFromGFA(filename);
+        else if(format.compare("txt") == 0)
+          loadFromTxt(filename);
+        else 
+        {
+          std::cerr << "Invalid format " << format << std::endl;
+          exit(1);
+        }
+      }
+
       /**
        * @brief                 load graph from VG graph format
        * @param[in]  filename
-       * @details               VG tool (https://github.com/vgteam/vg) uses .vg format to save graphs
+       * @details               VG tool (https://github.com/vgteam/vg) uses .vg format to save graphs,
+       *                        as a compressed stream of groups of serialized vg::Graph chunks.
+       *                        The stream is decompressed in windows of 'vgWindowBytes', in parallel
+       *                        if it is made of BGZF blocks, and the chunks completed within each 
+       *                        window are parsed in parallel before the next window is decompressed
        */
       void loadFromVG(const std::string &filename)
       {
@@ -49,57 +109,152 @@ namespace psgl
           exit(1);
         }
 
-        //Read vertices in the graph 
+        std::vector<vg::Graph> chunks;
+        decodeVG (filename, chunks);
+
+        //first vertex id and sequence offset of each chunk
+        std::vector<int64_t> firstVertex (chunks.size() + 1, 0);
+        std::vector<int64_t> firstSeq (chunks.size() + 1, 0);
+        std::vector<int64_t> firstEdge (chunks.size() + 1, 0);
+
+        for (std::size_t i = 0; i < chunks.size(); i++)
         {
-          vg::Graph g = vg::io::inputStream(filename);
+          firstVertex[i+1] = firstVertex[i] + chunks[i].node_size();
+          firstEdge[i+1] = firstEdge[i] + chunks[i].edge_size();
+          firstSeq[i+1] = firstSeq[i];
+
+          for (auto &vg_vertex : chunks[i].node())
+            firstSeq[i+1] += vg_vertex.sequence().length();
+        }
+
+        if (firstVertex.back() == 0 || firstVertex.back() >= INT32_MAX || firstEdge.back() > INT32_MAX)
+        {
+          std::cerr << "ERROR, psgl::graphLoader::loadFromVG, unsupported count of vertices or edges in " << filename << std::endl;
+          exit(1);
+        }
+
+        //sequence labeled di-graph
+        CSR_container diGraph;
 
-          //vertex numbering in vg starts from 1, so adding a dummy vertex with id '0'
-          //we are assuming that vg's vertex ids are contiguous 1,2,...g.node_size()
-          diGraph.addVertexCount(1);
-          diGraph.initVertexSequence(0, "N");
+        //vertex numbering in vg starts from 1, so adding a dummy vertex with id '0'
+        //we are assuming that vg's vertex ids are contiguous 1,2,...total node count
+        diGraph.addVertexCount(1 + firstVertex.back());
+        diGraph.allocVertexSequences(1 + firstSeq.back());
+        diGraph.setVertexSequence(0, 0, "N", 1);
 
-          //Get total count of vertices
-          diGraph.addVertexCount(g.node_size());
+        std::vector <OrientedEdge> edgeVector (firstEdge.back());
+        int32_t invalidIds = 0, overlaps = 0;
 
-          for (int i = 0; i < g.node_size(); i++)
+        //vertex ids seen so far, to detect duplicates
+        std::vector< std::atomic<bool> > seenIds (1 + firstVertex.back());
+        for (auto &b : seenIds)
+          b = false;
+
+        //path steps of each chunk as (path name, rank, vertex, orientation), 
+        //a path may be split across chunks
+        std::vector< std::vector< std::tuple<std::string, int64_t, int32_t, bool> > > chunkSteps (chunks.size());
+
+#pragma omp parallel for schedule(dynamic) reduction(+:invalidIds,overlaps)
+        for (std::size_t i = 0; i < chunks.size(); i++)
+        {
+          int64_t seqOffset = 1 + firstSeq[i];
+
+          for (auto &vg_path : chunks[i].path())
           {
-            auto vg_vertex = g.node(i);
+            for (auto &m : vg_path.mapping())
+            {
+              if (m.position().node_id() < 1 || m.position().node_id() > firstVertex.back())
+                invalidIds++;
 
-            assert(vg_vertex.id() <= g.node_size());
+              chunkSteps[i].emplace_back (vg_path.name(), m.rank(), (int32_t) m.position().node_id(), m.position().is_reverse());
+            }
+          }
+
+          for (auto &vg_vertex : chunks[i].node())
+          {
+            if (vg_vertex.id() < 1 || vg_vertex.id() > firstVertex.back() || seenIds[vg_vertex.id()].exchange (true))
+            {
+              invalidIds++;
+              continue;
+            }
 
             //add vertex to diGraph
-            diGraph.initVertexSequence(vg_vertex.id(), vg_vertex.sequence());
+            diGraph.setVertexSequence(vg_vertex.id(), seqOffset, vg_vertex.sequence().data(), vg_vertex.sequence().length());
+            seqOffset += vg_vertex.sequence().length();
+          }
+
+          int64_t edgeOffset = firstEdge[i];
+
+          for (auto &vg_edge : chunks[i].edge())
+          {
+            if (vg_edge.overlap() != 0)
+              overlaps++;
+
+            if (vg_edge.from() < 1 || vg_edge.from() > firstVertex.back() || vg_edge.to() < 1 || vg_edge.to() > firstVertex.back())
+              invalidIds++;
+
+            //edge leaves the start of 'from' if from_start is set, 
+            //and enters the end of 'to' if to_end is set
+            edgeVector[edgeOffset++] = OrientedEdge {(int32_t) vg_edge.from(), (int32_t) vg_edge.to(), vg_edge.from_start(), vg_edge.to_end()};
           }
 
+          vg::Graph().Swap (&chunks[i]);
         }
 
-        //Read edges in the graph 
+        if (invalidIds > 0)
         {
-          vg::Graph g = vg::io::inputStream(filename);
+          std::cerr << "ERROR, psgl::graphLoader::loadFromVG, vertex ids should be unique and contiguous 1, 2, ..., " << firstVertex.back() << std::endl;
+          exit(1);
+        }
 
-          std::vector <std::pair <int32_t, int32_t> > edgeVector;
+        if (overlaps > 0)
+        {
+          std::cerr << "ERROR, psgl::graphLoader::loadFromVG, " << overlaps << " edges with overlaps, which are not supported" << std::endl;
+          exit(1);
+        }
 
-          for (int i = 0; i < g.edge_size(); i++)
+        //gather steps of each path in order of rank, and of appearance if ranks are not set
+        {
+          std::map<std::string, std::size_t> pathIndex;
+          std::vector< std::vector< std::tuple<int64_t, std::size_t, int32_t, bool> > > steps;
+
+          for (auto &c : chunkSteps)
           {
-            auto vg_edge = g.edge(i);
+            for (auto &t : c)
+            {
+              auto it = pathIndex.emplace (std::get<0>(t), steps.size()).first;
 
-            //todo: add support for bi-directed graphs
-            assert(("Bi-directed graph not supported yet", vg_edge.from_start() == false));
-            assert(("Bi-directed graph not supported yet", vg_edge.to_end() == false));
-            assert(("Graph overlaps not supported yet", vg_edge.overlap() == 0));
+              if (it->second == steps.size())
+              {
+                steps.emplace_back();
+                paths.emplace_back();
+                paths.back().name = std::get<0>(t);
+              }
 
-            //add edge to diGraph
-            edgeVector.emplace_back(vg_edge.from(), vg_edge.to());
+              auto &v = steps[it->second];
+              v.emplace_back (std::get<1>(t), v.size(), std::get<2>(t), std::get<3>(t));
+            }
           }
 
-          diGraph.initEdges(edgeVector);
+          for (std::size_t i = 0; i < steps.size(); i++)
+          {
+            std::sort (steps[i].begin(), steps[i].end());
+
+            for (auto &t : steps[i])
+            {
+              paths[i].vertices.push_back (std::get<2>(t));
+              paths[i].reverse.push_back (std::get<3>(t));
+            }
+          }
+
+          if (!paths.empty())
+            std::cout << "INFO, psgl::graphLoader::loadFromVG, paths = " << paths.size() << std::endl;
         }
 
-        //topological sort
-        this->sortAndVerify();
+        initOrientedEdges(diGraph, edgeVector);
 
-        //build character-labeled graph 
-        diCharGraph.build(this->diGraph);
+        //topological sort, and build character-labeled graph 
+        this->sortAndBuild(diGraph);
       }
 
       /**
@@ -108,7 +263,13 @@ namespace psgl
        *  @details                file format: 
        *                          first line specifies count of vertices
        *                          following lines specify out-neighbors and label 
-       *                          for each vertex delimited by spaces (one vertex per line)
+       *                          for each vertex delimited by spaces (one vertex per line),
+       *                          blank lines, and comment lines starting with '#' before
+       *                          the first line, are ignored.
+       *                          The file is memory-mapped and split into chunks at line
+       *                          boundaries. Chunks are parsed in parallel twice, first to
+       *                          count vertices, edges and sequence lengths, and then to 
+       *                          save them directly at offsets given by prefix sums of the counts
        */
       void loadFromTxt(const std::string &filename)
       {
@@ -118,77 +279,1027 @@ namespace psgl
           exit(1);
         }
 
-        std::string line;
-        std::ifstream infile(filename);
+        std::size_t mappedBytes;
+        const char *base = mapFile (filename, "loadFromTxt", mappedBytes);
+        const char *end = base + mappedBytes;
 
-        int32_t totalVertices;
-        std::vector <std::pair <int32_t, int32_t> > edgeVector;
+        //get count of vertices from header row
+        int64_t totalVertices = 0;
+        const char *body;
+        {
+          const char *p = base;
+
+          //skip comment lines starting with '#', e.g., header of repro files
+          while (p < end && *p == '#')
+          {
+            p = (const char *) std::memchr (p, '\n', end - p);
+            p = p ? p + 1 : end;
+          }
+
+          skipBlanks (p, end);
+
+          if (!parseInteger (p, end, totalVertices) || totalVertices <= 0 || totalVertices > INT32_MAX)
+          {
+            std::cerr << "ERROR, psgl::graphLoader::loadFromTxt, invalid count of vertices in the first line" << std::endl;
+            exit(1);
+          }
+
+          body = (const char *) std::memchr (p, '\n', end - p);
+          body = body ? body + 1 : end;
+        }
+
+        const int chunkCount = 4 * omp_get_max_threads();
+        auto chunkBegin = splitLines (body, end, chunkCount);
+
+        std::vector<TxtChunk> chunks (chunkCount);
 
-        int32_t currentRow = 0;
+        //count vertices, edges and sequence length in each chunk
+#pragma omp parallel for schedule(dynamic)
+        for (int i = 0; i < chunkCount; i++)
+          parseTxtChunk (chunkBegin[i], chunkBegin[i+1], chunks[i], totalVertices, nullptr, nullptr, nullptr);
 
-        while (std::getline(infile, line))
+        checkChunkErrors (chunks, "loadFromTxt");
+
+        //first vertex, edge and sequence offset of each chunk
+        for (int i = 1; i < chunkCount; i++)
+        {
+          chunks[i].firstVertex = chunks[i-1].firstVertex + chunks[i-1].vertices;
+          chunks[i].firstEdge = chunks[i-1].firstEdge + chunks[i-1].edges;
+          chunks[i].firstSeq = chunks[i-1].firstSeq + chunks[i-1].seqLength;
+        }
+
+        const int64_t vertexCount = chunks.back().firstVertex + chunks.back().vertices;
+        const int64_t edgeCount = chunks.back().firstEdge + chunks.back().edges;
+        const int64_t seqLength = chunks.back().firstSeq + chunks.back().seqLength;
+
+        if (vertexCount != totalVertices)
         {
-          std::istringstream inputString(line);
+          std::cerr << "ERROR, psgl::graphLoader::loadFromTxt, expected " << totalVertices << " vertices, found " << vertexCount << std::endl;
+          exit(1);
+        }
+
+        if (edgeCount > INT32_MAX)
+        {
+          std::cerr << "ERROR, psgl::graphLoader::loadFromTxt, count of edges exceeds " << INT32_MAX << std::endl;
+          exit(1);
+        }
+
+        //sequence labeled di-graph
+        CSR_container diGraph;
+        diGraph.addVertexCount(totalVertices);
+        diGraph.allocVertexSequences(seqLength);
+
+        std::vector<int32_t> offsets (totalVertices + 1);
+        std::vector<int32_t> adjcny (edgeCount);
+        offsets.back() = edgeCount;
+
+        //save vertex sequences and out-neighbors
+#pragma omp parallel for schedule(dynamic)
+        for (int i = 0; i < chunkCount; i++)
+          parseTxtChunk (chunkBegin[i], chunkBegin[i+1], chunks[i], totalVertices, &diGraph, offsets.data(), adjcny.data());
+
+        munmap ((void *) base, mappedBytes);
 
-          //get count of vertices from header row
-          if (currentRow == 0)
+        diGraph.initEdges(std::move (offsets), std::move (adjcny));
+
+        //topological sort, and build character-labeled graph 
+        this->sortAndBuild(diGraph);
+      }
+
+      /**
+       * @brief                 load graph from GFA (version 1) format
+       * @param[in]  filename
+       * @details               segments (S lines) become vertices, numbered in the order of 
+       *                        appearance, links (L lines) become edges, and paths (P lines) 
+       *                        are saved in 'paths'. Other record types are ignored.
+       *                        The file is memory-mapped and split into chunks at line 
+       *                        boundaries, which are parsed in parallel, and vertex 
+       *                        sequences are copied directly into the CSR container
+       */
+      void loadFromGFA(const std::string &filename)
+      {
+        if( !fileExists(filename) )
+        {
+          std::cerr << filename << " not accessible." << std::endl;
+          exit(1);
+        }
+
+        std::size_t mappedBytes;
+        const char *base = mapFile (filename, "loadFromGFA", mappedBytes);
+
+        const int chunkCount = 4 * omp_get_max_threads();
+        auto chunkBegin = splitLines (base, base + mappedBytes, chunkCount);
+
+        std::vector<GFAChunk> chunks (chunkCount);
+
+#pragma omp parallel for schedule(dynamic)
+        for (int i = 0; i < chunkCount; i++)
+          parseGFAChunk (chunkBegin[i], chunkBegin[i+1], chunks[i]);
+
+        checkChunkErrors (chunks, "loadFromGFA");
+
+        //segments are numbered in the order of appearance
+        std::vector<int32_t> firstId (chunkCount + 1, 0);
+        std::vector<int64_t> firstSeq (chunkCount + 1, 0);
+        std::vector<int64_t> firstName (chunkCount + 1, 0);
+
+        {
+          int64_t totalSegments = 0;
+
+          for (int i = 0; i < chunkCount; i++)
           {
-            inputString >> totalVertices;
-            diGraph.addVertexCount(totalVertices);
+            totalSegments += chunks[i].segments.size();
+
+            if (totalSegments > INT32_MAX)
+            {
+              std::cerr << "ERROR, psgl::graphLoader::loadFromGFA, count of segments exceeds " << INT32_MAX << std::endl;
+              exit(1);
+            }
+
+            firstId[i+1] = totalSegments;
+            firstSeq[i+1] = firstSeq[i];
+            firstName[i+1] = firstName[i];
+
+            for (auto &e : chunks[i].segments)
+            {
+              firstSeq[i+1] += e.second.len;
+              firstName[i+1] += e.first.len;
+            }
           }
-          else //get out-neighbor vertex ids and vertex label
+
+          if (totalSegments == 0)
           {
-            assert(currentRow <= totalVertices);
+            std::cerr << "ERROR, psgl::graphLoader::loadFromGFA, no segments found in " << filename << std::endl;
+            exit(1);
+          }
+        }
 
-            //Parse the input line
-            std::vector<std::string> tokens (std::istream_iterator<std::string>{inputString}, std::istream_iterator<std::string>());
-            assert(tokens.size() > 0);
+        std::unordered_map<GFAField, int32_t, GFAFieldHash> segmentId;
+        segmentId.reserve (firstId.back());
 
-            diGraph.initVertexSequence (currentRow - 1, tokens.back());
+        for (int i = 0; i < chunkCount; i++)
+          for (std::size_t k = 0; k < chunks[i].segments.size(); k++)
+          {
+            auto &name = chunks[i].segments[k].first;
 
-            for (auto it = tokens.begin(); it != tokens.end() && std::next(it) != tokens.end(); it++)
+            if (!segmentId.emplace (name, firstId[i] + k).second)
             {
-              edgeVector.emplace_back (currentRow - 1, stoi(*it));
+              std::cerr << "ERROR, psgl::graphLoader::loadFromGFA, duplicate segment " << std::string (name.p, name.len) << std::endl;
+              exit(1);
             }
           }
 
-          currentRow++;
+        //sequence labeled di-graph
+        CSR_container diGraph;
+
+        //vertices
+        {
+          diGraph.addVertexCount (firstId.back());
+          diGraph.allocVertexSequences (firstSeq.back());
+
+          //segment names are kept with the graph for output
+          auto &segment_names = diCharGraph.segment_names;
+          auto &segmentNameStart = diCharGraph.segmentNameStart;
+
+          segment_names.resize (firstName.back());
+          segmentNameStart.resize (firstId.back() + 1);
+          segmentNameStart.back() = firstName.back();
+
+#pragma omp parallel for schedule(dynamic)
+          for (int i = 0; i < chunkCount; i++)
+          {
+            int64_t seqOffset = firstSeq[i];
+            int64_t nameOffset = firstName[i];
+
+            for (std::size_t k = 0; k < chunks[i].segments.size(); k++)
+            {
+              auto &name = chunks[i].segments[k].first;
+              auto &seq = chunks[i].segments[k].second;
+
+              diGraph.setVertexSequence (firstId[i] + k, seqOffset, seq.p, seq.len);
+              seqOffset += seq.len;
+
+              segmentNameStart[firstId[i] + k] = nameOffset;
+              std::memcpy (&segment_names[nameOffset], name.p, name.len);
+              nameOffset += name.len;
+            }
+          }
         }
 
-        diGraph.initEdges(edgeVector);
+        //edges and paths
+        {
+          std::vector< std::vector <OrientedEdge> > chunkEdges (chunkCount);
+          std::vector< std::vector <GraphPath> > chunkPaths (chunkCount);
+
+#pragma omp parallel for schedule(dynamic)
+          for (int i = 0; i < chunkCount; i++)
+            resolveGFAChunk (chunks[i], segmentId, chunkEdges[i], chunkPaths[i]);
+
+          checkChunkErrors (chunks, "loadFromGFA");
 
-        assert (diGraph.numVertices > 0);
-        assert (diGraph.numEdges > 0);
+          std::size_t edgeCount = 0;
+          for (auto &e : chunkEdges)
+            edgeCount += e.size();
 
-        //topological sort
-        this->sortAndVerify();
+          std::vector <OrientedEdge> edgeVector;
+          edgeVector.reserve (edgeCount);
+
+          for (int i = 0; i < chunkCount; i++)
+          {
+            edgeVector.insert (edgeVector.end(), chunkEdges[i].begin(), chunkEdges[i].end());
+            std::vector <OrientedEdge>().swap (chunkEdges[i]);
+
+            for (auto &path : chunkPaths[i])
+              paths.push_back (std::move (path));
+          }
 
-        //build character-labeled graph 
-        diCharGraph.build(this->diGraph);
+          std::cout << "INFO, psgl::graphLoader::loadFromGFA, segments = " << diGraph.numVertices 
+            << ", links = " << edgeVector.size() << ", paths = " << paths.size() << std::endl;
+
+          initOrientedEdges(diGraph, edgeVector);
+        }
+
+        munmap ((void *) base, mappedBytes);
+
+        //topological sort, and build character-labeled graph 
+        this->sortAndBuild(diGraph);
       }
 
       /**
-       * @brief     print the loaded directed graph to stderr 
+       * @brief             name of a GFA segment
+       * @param[in]   id    vertex id before sorting, see CSR_char_container::originalVertexId()
        */
-      void printGraph() const
+      std::string segmentName(int32_t id) const
       {
-        diGraph.printGraph();
+        assert(!diCharGraph.segmentNameStart.empty());
+
+        return diCharGraph.outputVertexName (id);
       }
 
     private:
 
       /**
-       * @brief   topologically sort the graph and verify correctness
+       * @brief   edge of a bi-directed graph, from vertex 'from' in reverse complement
+       *          orientation if fromReverse is set, to vertex 'to' in reverse complement 
+       *          orientation if toReverse is set
+       */
+      struct OrientedEdge
+      {
+        int32_t from;
+        int32_t to;
+        bool fromReverse;
+        bool toReverse;
+      };
+
+      /**
+       * @brief                   add edges of a possibly bi-directed graph
+       * @param[in/out] diGraph   graph with vertices and sequences, but without edges
+       * @param[in]   edges
+       * @details                 an edge joining reverse orientations of both vertices is the
+       *                          same as the forward edge from 'to' to 'from'. If any edge joins 
+       *                          vertices in different orientations, both strands are saved in a 
+       *                          directed graph (see CSR_container::addReverseStrand()), 
+       *                          where each edge appears once in each strand
+       */
+      void initOrientedEdges(CSR_container &diGraph, const std::vector<OrientedEdge> &edges) const
+      {
+        int64_t inversions = 0;
+
+#pragma omp parallel for reduction(+:inversions)
+        for (std::size_t i = 0; i < edges.size(); i++)
+          inversions += (edges[i].fromReverse != edges[i].toReverse);
+
+        std::vector <std::pair <int32_t, int32_t> > edgeVector;
+
+        if (inversions == 0)
+        {
+          edgeVector.reserve (edges.size());
+
+          for (auto &e : edges)
+          {
+            if (e.fromReverse)
+              edgeVector.emplace_back (e.to, e.from);
+            else
+              edgeVector.emplace_back (e.from, e.to);
+          }
+        }
+        else
+        {
+          std::cout << "INFO, psgl::graphLoader::initOrientedEdges, bi-directed graph with " << inversions 
+            << " edges between opposite orientations, adding reverse complement strand" << std::endl;
+
+          diGraph.addReverseStrand();
+
+          const int32_t n = diGraph.strandVertices;
+          edgeVector.reserve (2 * edges.size());
+
+          for (auto &e : edges)
+          {
+            edgeVector.emplace_back (e.from + (e.fromReverse ? n : 0), e.to + (e.toReverse ? n : 0));
+            edgeVector.emplace_back (e.to + (e.toReverse ? 0 : n), e.from + (e.fromReverse ? 0 : n));
+          }
+        }
+
+        if (edgeVector.size() > INT32_MAX)
+        {
+          std::cerr << "ERROR, psgl::graphLoader::initOrientedEdges, count of edges exceeds " << INT32_MAX << std::endl;
+          exit(1);
+        }
+
+        diGraph.initEdges(edgeVector);
+      }
+
+      /**
+       * @brief   tab-separated field of a GFA line, pointing into the mapped file
+       */
+      struct GFAField
+      {
+        const char *p;
+        int32_t len;
+
+        bool operator == (const GFAField &other) const
+        {
+          return len == other.len && std::memcmp (p, other.p, len) == 0;
+        }
+
+        bool equals (const char *s) const
+        {
+          return len == std::strlen(s) && std::memcmp (p, s, len) == 0;
+        }
+      };
+
+      /**
+       * @brief   FNV-1a hash of segment names
+       */
+      struct GFAFieldHash
+      {
+        std::size_t operator() (const GFAField &f) const
+        {
+          uint64_t h = 14695981039346656037ULL;
+
+          for (int32_t i = 0; i < f.len; i++)
+            h = (h ^ (unsigned char) f.p[i]) * 1099511628211ULL;
+
+          return h;
+        }
+      };
+
+      /**
+       * @brief   records of GFA lines in a chunk of the file
+       */
+      struct GFAChunk
+      {
+        std::vector< std::pair<GFAField, GFAField> > segments;     //(name, sequence)
+        std::vector< std::array<GFAField, 4> > links;             //(from, orientation, to, orientation)
+        std::vector< std::pair<GFAField, GFAField> > pathLines;    //(name, segment names)
+        std::string error;
+      };
+
+      /**
+       * @brief                   parse S, L and P lines in a chunk of GFA file
+       * @param[in]   begin       first character of the chunk, at a line start
+       * @param[in]   end         end of the chunk
+       * @param[out]  chunk
+       * @details                 only field boundaries are saved, no characters are copied
+       */
+      void parseGFAChunk(const char *begin, const char *end, GFAChunk &chunk) const
+      {
+        GFAField f[6];
+
+        for (const char *line = begin; line < end; )
+        {
+          const char *eol = (const char *) std::memchr (line, '\n', end - line);
+          if (eol == nullptr)
+            eol = end;
+
+          const char *next = eol < end ? eol + 1 : end;
+
+          if (eol > line && eol[-1] == '\r')
+            eol--;
+
+          //split up to 6 fields, optional tags after them are ignored
+          int n = 0;
+          for (const char *p = line; n < 6 && p <= eol; n++)
+          {
+            const char *q = (const char *) std::memchr (p, '\t', eol - p);
+            if (q == nullptr)
+              q = eol;
+
+            f[n].p = p;
+            f[n].len = q - p;
+            p = q + 1;
+          }
+
+          if (f[0].equals ("S"))
+          {
+            if (n < 3 || f[1].len == 0 || f[2].len == 0)
+            {
+              chunk.error = "malformed segment line: " + std::string (line, eol);
+              return;
+            }
+
+            if (f[2].equals ("*"))
+            {
+              chunk.error = "segment " + std::string (f[1].p, f[1].len) + " has no sequence";
+              return;
+            }
+
+            chunk.segments.emplace_back (f[1], f[2]);
+          }
+          else if (f[0].equals ("L"))
+          {
+            if (n < 5 || !(f[2].equals ("+") || f[2].equals ("-")) || !(f[4].equals ("+") || f[4].equals ("-")))
+            {
+              chunk.error = "malformed link line: " + std::string (line, eol);
+              return;
+            }
+
+            if (n == 6 && !(f[5].len == 0 || f[5].equals ("*") || f[5].equals ("0M")))
+            {
+              chunk.error = "overlaps are not supported, link line: " + std::string (line, eol);
+              return;
+            }
+
+            chunk.links.push_back ({{f[1], f[2], f[3], f[4]}});
+          }
+          else if (f[0].equals ("P"))
+          {
+            if (n < 3)
+            {
+              chunk.error = "malformed path line: " + std::string (line, eol);
+              return;
+            }
+
+            chunk.pathLines.emplace_back (f[1], f[2]);
+          }
+
+          line = next;
+        }
+      }
+
+      /**
+       * @brief                   resolve segment names of links and paths in a chunk
+       * @param[in/out] chunk     error is saved in the chunk
+       * @param[in]   segmentId   vertex id of each segment name
+       * @param[out]  edges       edges of links
+       * @param[out]  chunkPaths  paths
        */
-      void sortAndVerify()
+      void resolveGFAChunk(GFAChunk &chunk, 
+                           const std::unordered_map<GFAField, int32_t, GFAFieldHash> &segmentId,
+                           std::vector <OrientedEdge> &edges,
+                           std::vector <GraphPath> &chunkPaths) const
       {
+        edges.reserve (chunk.links.size());
+
+        for (auto &l : chunk.links)
+        {
+          auto from = segmentId.find (l[0]);
+          auto to = segmentId.find (l[2]);
+
+          if (from == segmentId.end() || to == segmentId.end())
+          {
+            chunk.error = "link between unknown segments " + std::string (l[0].p, l[0].len) + " and " + std::string (l[2].p, l[2].len);
+            return;
+          }
+
+          edges.push_back (OrientedEdge {from->second, to->second, l[1].equals ("-"), l[3].equals ("-")});
+        }
+
+        for (auto &e : chunk.pathLines)
+        {
+          GraphPath path;
+          path.name.assign (e.first.p, e.first.len);
+
+          //comma separated segment names, each followed by orientation
+          const char *end = e.second.p + e.second.len;
+
+          for (const char *p = e.second.p; p < end; )
+          {
+            const char *q = (const char *) std::memchr (p, ',', end - p);
+            if (q == nullptr)
+              q = end;
+
+            auto v = q - p > 1 ? segmentId.find ({p, (int32_t) (q - p - 1)}) : segmentId.end();
+
+            if (v == segmentId.end() || (q[-1] != '+' && q[-1] != '-'))
+            {
+              chunk.error = "invalid step " + std::string (p, q) + " in path " + path.name;
+              return;
+            }
+
+            path.vertices.push_back (v->second);
+            path.reverse.push_back (q[-1] == '-');
+
+            p = q + 1;
+          }
+
+          chunkPaths.push_back (std::move (path));
+        }
+
+        std::vector< std::array<GFAField, 4> >().swap (chunk.links);
+      }
+
+      /**
+       * @brief   exit with an error message if parsing of any chunk failed
+       */
+      template <typename Chunk>
+      void checkChunkErrors(const std::vector<Chunk> &chunks, const char *caller) const
+      {
+        for (auto &c : chunks)
+        {
+          if (!c.error.empty())
+          {
+            std::cerr << "ERROR, psgl::graphLoader::" << caller << ", " << c.error << std::endl;
+            exit(1);
+          }
+        }
+      }
+
+      /**
+       * @brief                   map a file read-only
+       * @param[in]   filename
+       * @param[in]   caller      function name for error messages
+       * @param[out]  bytes       size of the file
+       * @return                  first character of the mapped file, to be released with munmap
+       */
+      const char* mapFile(const std::string &filename, const char *caller, std::size_t &bytes) const
+      {
+        int fd = open (filename.c_str(), O_RDONLY);
+        struct stat st;
+
+        if (fd < 0 || fstat (fd, &st) != 0 || st.st_size == 0)
+        {
+          std::cerr << "ERROR, psgl::graphLoader::" << caller << ", can not read " << filename << std::endl;
+          exit(1);
+        }
+
+        bytes = st.st_size;
+        const char *base = (const char *) mmap (nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        close (fd);
+
+        if (base == MAP_FAILED)
+        {
+          std::cerr << "ERROR, psgl::graphLoader::" << caller << ", mmap failed for " << filename << std::endl;
+          exit(1);
+        }
+
+        return base;
+      }
+
+      /**
+       * @brief                   split a text buffer into chunks beginning at line starts
+       * @param[in]   begin       first character, at a line start
+       * @param[in]   end         end of the buffer
+       * @param[in]   chunkCount  count of chunks, more chunks than threads balance the load
+       * @return                  chunk i spans [result[i], result[i+1]), some chunks may be empty
+       */
+      std::vector<const char *> splitLines(const char *begin, const char *end, int chunkCount) const
+      {
+        std::vector<const char *> chunkBegin (chunkCount + 1);
+
+        for (int i = 0; i <= chunkCount; i++)
+        {
+          const char *p = begin + (end - begin) * i / chunkCount;
+
+          if (i > 0 && i < chunkCount)
+          {
+            p = (const char *) std::memchr (p - 1, '\n', end - (p - 1));
+            p = p ? p + 1 : end;
+          }
+
+          chunkBegin[i] = p;
+        }
+
+        return chunkBegin;
+      }
+
+      /**
+       * @brief   skip spaces, tabs and carriage returns within a line
+       */
+      static void skipBlanks(const char *&p, const char *end)
+      {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+          p++;
+      }
+
+      /**
+       * @brief                   parse a non-negative decimal integer
+       * @param[in/out] p         first digit, moved past the last digit
+       * @param[in]   end         end of the buffer
+       * @param[out]  value
+       * @return                  false if no digit is found, or if the value overflows
+       */
+      static bool parseInteger(const char *&p, const char *end, int64_t &value)
+      {
+        const char *first = p;
+        value = 0;
+
+        for (; p < end && *p >= '0' && *p <= '9'; p++)
+        {
+          value = value * 10 + (*p - '0');
+
+          if (value > INT32_MAX)
+            return false;
+        }
+
+        return p > first;
+      }
+
+      /**
+       * @brief   position of the message index within the group of serialized chunks
+       *          being read, carried across decompressed windows
+       */
+      struct VGGroupState
+      {
+        uint64_t remaining = 0;     //count of messages of the group not indexed yet
+        uint64_t next = 0;          //index of the next message within its group
+      };
+
+      /**
+       * @brief                   decompress a .vg file, and parse its graph chunks
+       * @param[in]   filename
+       * @param[out]  chunks      parsed chunks, in file order
+       * @details                 if the file is a series of BGZF blocks, the block sizes 
+       *                          are read from the gzip headers and blocks of a window are 
+       *                          decompressed in parallel, otherwise the window is decompressed
+       *                          serially. Only the bytes of a chunk spanning the window end 
+       *                          are carried over to the next window
+       */
+      void decodeVG(const std::string &filename, std::vector<vg::Graph> &chunks) const
+      {
+        //decompressed bytes not parsed yet
+        std::string stream;
+        VGGroupState group;
+        int32_t parseErrors = 0;
+
+        //parse complete chunks in the decompressed bytes
+        auto parseWindow = [&](bool last) {
+          std::vector< std::pair<std::size_t, std::size_t> > messages;
+          std::size_t consumed = indexVGMessages (stream, group, last, messages);
+
+          std::size_t first = chunks.size();
+          chunks.resize (first + messages.size());
+
+#pragma omp parallel for schedule(dynamic) reduction(+:parseErrors)
+          for (std::size_t i = 0; i < messages.size(); i++)
+          {
+            if (!chunks[first + i].ParseFromArray (stream.data() + messages[i].first, messages[i].second))
+              parseErrors++;
+          }
+
+          stream.erase (0, consumed);
+        };
+
+        std::size_t mappedBytes;
+        const unsigned char *base = (const unsigned char *) mapFile (filename, "loadFromVG", mappedBytes);
+
+        //locate BGZF blocks, using the block size saved in the 'BC' extra subfield
+        std::vector<std::size_t> blockBegin;
+        std::vector<std::size_t> outputSize;
+
+        bool bgzf = true;
+        for (std::size_t off = 0; off < mappedBytes; )
+        {
+          const unsigned char *h = base + off;
+
+          if (mappedBytes - off < 26 || h[0] != 0x1f || h[1] != 0x8b || !(h[3] & 4) ||
+              h[12] != 'B' || h[13] != 'C' || (h[14] | h[15] << 8) != 2)
+          {
+            bgzf = false;
+            break;
+          }
+
+          std::size_t blockSize = (h[16] | h[17] << 8) + 1;
+
+          if (off + blockSize > mappedBytes)
+          {
+            bgzf = false;
+            break;
+          }
+
+          //uncompressed size is saved in the last 4 bytes of a block
+          const unsigned char *t = h + blockSize - 4;
+          uint32_t isize = t[0] | t[1] << 8 | t[2] << 16 | (uint32_t) t[3] << 24;
+
+          blockBegin.push_back (off);
+          outputSize.push_back (isize);
+          off += blockSize;
+        }
+
+        if (bgzf)
+        {
+          const int64_t blockCount = blockBegin.size();
+          blockBegin.push_back (mappedBytes);
+
+          int32_t failedBlocks = 0;
+
+          for (int64_t windowBegin = 0; windowBegin < blockCount; )
+          {
+            //blocks of the window, and their offsets in the stream
+            std::vector<std::size_t> outputBegin (1, stream.size());
+            int64_t windowEnd = windowBegin;
+
+            do
+            {
+              outputBegin.push_back (outputBegin.back() + outputSize[windowEnd++]);
+            } while (windowEnd < blockCount && outputBegin.back() - outputBegin.front() < vgWindowBytes);
+
+            stream.resize (outputBegin.back());
+
+#pragma omp parallel for schedule(dynamic) reduction(+:failedBlocks)
+            for (int64_t i = windowBegin; i < windowEnd; i++)
+            {
+              z_stream zs;
+              std::memset (&zs, 0, sizeof(zs));
+
+              if (inflateInit2 (&zs, 15 + 16) != Z_OK)
+              {
+                failedBlocks++;
+                continue;
+              }
+
+              zs.next_in = (Bytef *) base + blockBegin[i];
+              zs.avail_in = blockBegin[i+1] - blockBegin[i];
+              zs.next_out = (Bytef *) &stream[outputBegin[i - windowBegin]];
+              zs.avail_out = outputSize[i];
+
+              if (inflate (&zs, Z_FINISH) != Z_STREAM_END || zs.avail_out != 0)
+                failedBlocks++;
+
+              inflateEnd (&zs);
+            }
+
+            if (failedBlocks > 0)
+            {
+              std::cerr << "ERROR, psgl::graphLoader::loadFromVG, failed to decompress " << failedBlocks << " blocks of " << filename << std::endl;
+              exit(1);
+            }
+
+            windowBegin = windowEnd;
+            parseWindow (windowBegin == blockCount);
+          }
+
+          if (blockCount == 0)
+            parseWindow (true);
+        }
+
+        munmap ((void *) base, mappedBytes);
+
+        if (!bgzf)
+        {
+          //gzip members are concatenated, boundaries are only known after decompression
+          gzFile fp = gzopen (filename.c_str(), "r");
+
+          if (fp == nullptr || gzbuffer (fp, 1 << 20) != 0)
+          {
+            std::cerr << "ERROR, psgl::graphLoader::loadFromVG, failed to open " << filename << std::endl;
+            exit(1);
+          }
+
+          std::vector<char> buffer (1 << 20);
+          int n;
+
+          do
+          {
+            std::size_t windowEnd = stream.size() + vgWindowBytes;
+
+            while (stream.size() < windowEnd && (n = gzread (fp, buffer.data(), buffer.size())) > 0)
+              stream.append (buffer.data(), n);
+
+            if (n < 0)
+            {
+              std::cerr << "ERROR, psgl::graphLoader::loadFromVG, failed to decompress " << filename << std::endl;
+              exit(1);
+            }
+
+            parseWindow (n == 0);
+          } while (n > 0);
+
+          gzclose (fp);
+        }
+
+        if (parseErrors > 0)
+        {
+          std::cerr << "ERROR, psgl::graphLoader::loadFromVG, failed to parse " << parseErrors << " graph chunks of " << filename << std::endl;
+          exit(1);
+        }
+      }
+
+      /**
+       * @brief                   index serialized graph chunks in decompressed bytes of a .vg stream
+       * @param[in]   stream
+       * @param[in/out] group     position within the group being read
+       * @param[in]   last        true if no more bytes follow
+       * @param[out]  messages    (offset, length) of each complete chunk
+       * @return                  count of bytes indexed, i.e., bytes before the first incomplete
+       *                          varint or chunk
+       * @details                 stream is a sequence of groups, a group begins with varint
+       *                          count of messages, each message begins with varint length.
+       *                          Type tag messages of newer vg versions are skipped
+       */
+      std::size_t indexVGMessages(const std::string &stream, VGGroupState &group, bool last, 
+                                  std::vector< std::pair<std::size_t, std::size_t> > &messages) const
+      {
+        std::size_t i = 0;
+        bool valid = true, complete = true;
+
+        auto varint = [&]() {
+          uint64_t value = 0;
+          for (int shift = 0; shift < 64; shift += 7)
+          {
+            if (i >= stream.size())
+            {
+              complete = false;
+              return value;
+            }
+
+            unsigned char c = stream[i++];
+            value |= (uint64_t) (c & 0x7f) << shift;
+
+            if (c < 0x80)
+              return value;
+          }
+
+          valid = false;
+          return value;
+        };
+
+        std::size_t indexed = 0;
+
+        while (valid && complete && (group.remaining > 0 || i < stream.size()))
+        {
+          if (group.remaining == 0)
+          {
+            uint64_t count = varint();
+
+            if (!complete)
+              break;
+
+            group.remaining = count;
+            group.next = 0;
+            indexed = i;
+          }
+
+          while (valid && group.remaining > 0)
+          {
+            uint64_t length = varint();
+
+            if (!complete || (valid && length > stream.size() - i))
+            {
+              complete = false;
+              break;
+            }
+
+            //"VG" is not a valid serialized graph, it is the type tag of graph groups
+            if (!(group.next == 0 && length == 2 && stream.compare (i, 2, "VG") == 0))
+              messages.emplace_back (i, length);
+
+            i += length;
+            indexed = i;
+            group.remaining--;
+            group.next++;
+          }
+        }
+
+        if (!valid || (last && (!complete || group.remaining > 0)))
+        {
+          std::cerr << "ERROR, psgl::graphLoader::loadFromVG, truncated or corrupted graph stream" << std::endl;
+          exit(1);
+        }
+
+        return indexed;
+      }
+
+      /**
+       * @brief   counts and offsets of vertices, edges and sequences in a chunk of txt file
+       */
+      struct TxtChunk
+      {
+        int64_t vertices = 0, edges = 0, seqLength = 0;
+        int64_t firstVertex = 0, firstEdge = 0, firstSeq = 0;
+        std::string error;
+      };
+
+      /**
+       * @brief                   parse vertex lines in a chunk of txt file
+       * @param[in]   begin       first character of the chunk, at a line start
+       * @param[in]   end         end of the chunk
+       * @param[in/out] chunk     counts are saved in the first pass, offsets are used in the second
+       * @param[in]   totalVertices
+       * @param[out]  diGraph     vertex sequences are saved if not null (second pass)
+       * @param[out]  offsets     offsets of out-neighbors of each vertex
+       * @param[out]  adjcny      out-neighbors of all vertices
+       */
+      void parseTxtChunk(const char *begin, const char *end, TxtChunk &chunk, int64_t totalVertices,
+                         CSR_container *diGraph, int32_t *offsets, int32_t *adjcny) const
+      {
+        int64_t v = chunk.firstVertex;
+        int64_t edgeOffset = chunk.firstEdge;
+        int64_t seqOffset = chunk.firstSeq;
+
+        for (const char *line = begin; line < end; )
+        {
+          const char *eol = (const char *) std::memchr (line, '\n', end - line);
+          if (eol == nullptr)
+            eol = end;
+
+          const char *p = line;
+          line = eol < end ? eol + 1 : end;
+
+          skipBlanks (p, eol);
+          if (p == eol)
+            continue;
+
+          if (diGraph)
+            offsets[v] = edgeOffset;
+
+          //tokens are out-neighbor ids, followed by the label
+          while (true)
+          {
+            const char *token = p;
+            while (p < eol && *p != ' ' && *p != '\t' && *p != '\r')
+              p++;
+
+            const char *tokenEnd = p;
+            skipBlanks (p, eol);
+
+            if (p == eol)
+            {
+              //last token is the label
+              if (diGraph)
+                diGraph->setVertexSequence (v, seqOffset, token, tokenEnd - token);
+
+              seqOffset += tokenEnd - token;
+              break;
+            }
+
+            int64_t u;
+            const char *q = token;
+
+            if (!parseInteger (q, tokenEnd, u) || q != tokenEnd || u >= totalVertices)
+            {
+              chunk.error = "invalid out-neighbor " + std::string (token, tokenEnd) + " of vertex " + std::to_string (v);
+              return;
+            }
+
+            if (diGraph)
+              adjcny[edgeOffset] = u;
+
+            edgeOffset++;
+          }
+
+          v++;
+        }
+
+        if (!diGraph)
+        {
+          chunk.vertices = v;
+          chunk.edges = edgeOffset;
+          chunk.seqLength = seqOffset;
+        }
+      }
+
+      /**
+       * @brief   topologically sort the graph, and build diCharGraph from it
+       * @param[in/out] diGraph
+       * @details both graphs are verified if verifyGraph is set
+       */
+      void sortAndBuild(CSR_container &diGraph)
+      {
+        if (diGraph.numVertices == 0 || diGraph.numEdges == 0)
+        {
+          std::cerr << "ERROR, psgl::graphLoader::sortAndBuild, graph has " << diGraph.numVertices
+            << " vertices and " << diGraph.numEdges << " edges, expected at least one of each" << std::endl;
+          exit(1);
+        }
+
+        {
+          auto emptyVertices = std::count (diGraph.vertexSeqLength.begin(), diGraph.vertexSeqLength.end(), 0);
+
+          if (emptyVertices > 0)
+          {
+            std::cerr << "ERROR, psgl::graphLoader::sortAndBuild, " << emptyVertices
+              << " vertices have an empty sequence" << std::endl;
+            exit(1);
+          }
+        }
+
         //Topological sort
         diGraph.sort();
 
-#ifndef NDEBUG
-        //verify correctness of CSR container
-        diGraph.verify();
-#endif
+        if (verifyGraph && !diGraph.verify())
+        {
+          std::cerr << "ERROR, psgl::graphLoader::sortAndBuild, verification of sequence labeled graph failed" << std::endl;
+          exit(1);
+        }
+
+        diCharGraph.build(diGraph);
+
+        if (verifyGraph && !diCharGraph.verify())
+        {
+          std::cerr << "ERROR, psgl::graphLoader::sortAndBuild, verification of character labeled graph failed" << std::endl;
+          exit(1);
+        }
       }
 
   };
@@ -75,9 +75,9 @@ namespace psgl
       {
         assert(this->currentVid >= 0 && this->currentVid < graph.numVertices);
         assert(this->seqOffset >= 0);
-        assert(this->seqOffset < graph.vertex_metadata[currentVid].length());
+        assert(this->seqOffset < graph.vertexSeqLength[currentVid]);
 
-        return graph.vertex_metadata[currentVid].at(seqOffset);
+        return graph.vertex_seq[this->globalOffset];
       }
 
       /**
@@ -85,7 +85,7 @@ namespace psgl
        */
       void next()
       {
-        if (this->seqOffset < graph.vertex_metadata[currentVid].length() - 1)
+        if (this->seqOffset < graph.vertexSeqLength[currentVid] - 1)
         {
           this->seqOffset++;
         }
@@ -102,7 +102,7 @@ namespace psgl
        * @param[out]    offsets   
        * @details                 offsets start from 0 to total reference sequence length
        */
-      void getInNeighborOffsets(std::vector<int32_t> &offsets) const
+      void getInNeighborOffsets(std::vector<int64_t> &offsets) const
       {
         assert(offsets.size() == 0);
 
@@ -121,11 +121,11 @@ namespace psgl
        * @param[out]    offsets   
        * @details                 offsets start from 0 to total reference sequence length
        */
-      void getOutNeighborOffsets(std::vector<int32_t> &offsets) const
+      void getOutNeighborOffsets(std::vector<int64_t> &offsets) const
       {
         assert(offsets.size() == 0);
 
-        if (this->seqOffset == graph.vertex_metadata[currentVid].length() - 1 )
+        if (this->seqOffset == graph.vertexSeqLength[currentVid] - 1 )
         {
           graph.getOutSeqOffsets(currentVid, offsets);
         }
@@ -0,0 +1,159 @@
+/**
+ * @file    paired.hpp
+ * @brief   insert size of paired reads, and column windows to rescue
+ *          a mate within, along the topological order of the graph
+ * @author  Chirag Jain <cjain7@gatech.edu>
+ */
+
+#ifndef PSGL_PAIRED_HPP
+#define PSGL_PAIRED_HPP
+
+#include <cmath>
+#include <algorithm>
+
+#include "base_types.hpp"
+
+namespace psgl
+{
+  //span of a pair is assumed to lie within these many standard deviations above the mean
+  constexpr double insertStdDevs = 4;
+
+  //count of first pairs of the first batch used to estimate insert size, if not given
+  constexpr std::size_t insertSamplePairs = 1000;
+
+  //minimum count of pairs for an estimate
+  constexpr std::size_t insertMinPairs = 10;
+
+  /**
+   * @brief     distribution of the span of a pair in graph columns, i.e., from the
+   *            start of its forward mate to the end of its reverse complemented mate
+   * @details   columns are in topological order, so the span of a pair which crosses
+   *            bubbles includes the columns of their alternative alleles as well
+   */
+  struct InsertSize
+  {
+    double mean = 0;
+    double stdDev = 0;
+
+    //count of pairs the distribution was estimated from
+    std::size_t pairs = 0;
+
+    /**
+     * @brief   whether distribution is known, otherwise mates are not rescued
+     */
+    bool known() const
+    {
+      return mean > 0;
+    }
+
+    /**
+     * @brief   widest span of a pair expected
+     */
+    int64_t maxSpan() const
+    {
+      return std::ceil (mean + insertStdDevs * stdDev);
+    }
+  };
+
+  /**
+   * @brief                   span of a pair in forward-reverse orientation
+   * @param[in]   parameters
+   * @param[in]   e1          alignment of first mate
+   * @param[in]   len1        length of first mate
+   * @param[in]   e2          alignment of second mate
+   * @param[in]   len2        length of second mate
+   * @return                  span in columns, -1 if either mate is not aligned confidently,
+   *                          or the mates do not face each other
+   */
+  int64_t pairSpan (const Parameters &parameters,
+      const BestScoreInfo &e1, std::size_t len1,
+      const BestScoreInfo &e2, std::size_t len2)
+  {
+    if (!parameters.confidentScore (e1.score, len1) || !parameters.confidentScore (e2.score, len2))
+      return -1;
+
+    if (e1.refColumnStart < 0 || e2.refColumnStart < 0 || e1.strand == e2.strand)
+      return -1;
+
+    auto &fwd = e1.strand == '+' ? e1 : e2;
+    auto &rev = e1.strand == '+' ? e2 : e1;
+
+    auto span = rev.refColumnEnd - fwd.refColumnStart + 1;
+    return span > 0 ? span : -1;
+  }
+
+  /**
+   * @brief                   whether mates align confidently, facing each other within
+   *                          the widest span expected
+   * @param[in]   parameters
+   * @param[in]   insert
+   * @param[in]   e1          alignment of first mate
+   * @param[in]   len1        length of first mate
+   * @param[in]   e2          alignment of second mate
+   * @param[in]   len2        length of second mate
+   */
+  bool concordant (const Parameters &parameters,
+      const InsertSize &insert,
+      const BestScoreInfo &e1, std::size_t len1,
+      const BestScoreInfo &e2, std::size_t len2)
+  {
+    auto span = pairSpan (parameters, e1, len1, e2, len2);
+    return span > 0 && span <= insert.maxSpan();
+  }
+
+  /**
+   * @brief                   estimate insert size from spans of pairs
+   * @details                 median and scaled median absolute deviation are used,
+   *                          so that few discordant pairs do not widen the windows
+   * @param[in]   spans       spans of concordant pairs, see pairSpan
+   */
+  InsertSize estimateInsertSize (std::vector<int64_t> spans)
+  {
+    InsertSize insert;
+
+    if (spans.size() < insertMinPairs)
+      return insert;
+
+    auto median = [](std::vector<int64_t> &v) {
+      std::nth_element (v.begin(), v.begin() + v.size() / 2, v.end());
+      return v[v.size() / 2];
+    };
+
+    auto m = median (spans);
+
+    for (auto &s : spans)
+      s = std::abs (s - m);
+
+    insert.mean = m;
+    insert.stdDev = std::max (1.0, 1.4826 * median (spans));
+    insert.pairs = spans.size();
+
+    return insert;
+  }
+
+  /**
+   * @brief                   columns [begin, end) where the mate of an aligned read is expected
+   * @details                 mates face each other, so the mate of a '+' read ends within the widest
+   *                          span after the read's start, and the mate of a '-' read begins within
+   *                          the widest span before the read's end. The window is widened by a
+   *                          mate length to allow for its local alignment ends
+   * @param[in]   e           confident alignment of a read
+   * @param[in]   mateLength
+   * @param[in]   insert
+   * @param[in]   numVertices count of graph columns
+   */
+  std::pair<int64_t, int64_t> mateWindow (const BestScoreInfo &e,
+      std::size_t mateLength,
+      const InsertSize &insert,
+      int64_t numVertices)
+  {
+    int64_t span = insert.maxSpan() + mateLength;
+
+    if (e.strand == '+')
+      return std::make_pair (e.refColumnStart, std::min (numVertices, e.refColumnStart + span));
+    else
+      return std::make_pair (std::max<int64_t> (0, e.refColumnEnd + 1 - span), e.refColumnEnd + 1);
+  }
+}
+
+#endif
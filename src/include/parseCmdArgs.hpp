@@ -7,12 +7,57 @@
 #ifndef PARSE_CMD_HPP 
 #define PARSE_CMD_HPP
 
+#include <sstream>
+
 #include "base_types.hpp"
 #include "utils.hpp"
 #include "clipp.h"
 
 namespace psgl
 {
+  /**
+   * @brief                   parse the manifest of samples
+   * @details                 each non-empty line contains a query file and 
+   *                          an output file, separated by whitespace. Lines 
+   *                          beginning with '#' are ignored
+   * @param[in]   filename
+   * @param[out]  samples     (query file, output file) pairs
+   **/
+  void parseManifest(const std::string &filename, std::vector< std::pair<std::string, std::string> > &samples)
+  {
+    if( !fileExists(filename) )
+    {
+      std::cerr << filename << " not accessible." << std::endl;
+      exit(1);
+    }
+
+    std::ifstream infile(filename);
+    std::string line;
+
+    while (std::getline(infile, line))
+    {
+      std::istringstream inputString(line);
+      std::vector<std::string> tokens (std::istream_iterator<std::string>{inputString}, std::istream_iterator<std::string>());
+
+      if (tokens.empty() || tokens[0][0] == '#')
+        continue;
+
+      if (tokens.size() != 2)
+      {
+        std::cerr << "ERROR, psgl::parseManifest, expected query and output file in line: " << line << std::endl;
+        exit(1);
+      }
+
+      samples.emplace_back (tokens[0], tokens[1]);
+    }
+
+    if (samples.empty())
+    {
+      std::cerr << "ERROR, psgl::parseManifest, no samples found in " << filename << std::endl;
+      exit(1);
+    }
+  }
+
   /**
    * @brief                   parse the cmd line options
    * @param[in]   argc
@@ -21,23 +66,69 @@ namespace psgl
    **/
   void parseandSave(int argc, char** argv, psgl::Parameters &param)
   {
-    //set the default scoring scheme if not modified later
-    param.match = param.mismatch = param.ins = param.del = 1;
-    param.threads = 1;
+    //default scoring scheme and optional parameters, if not modified later
+    param = psgl::Parameters();
+
+    std::string shard;
 
     //define all arguments
     auto cli = 
       (
         clipp::required("-m") & 
-          (clipp::required("vg").set(param.mode) | clipp::required("txt").set(param.mode)).doc("reference graph format"),
+          (clipp::required("vg").set(param.mode) | clipp::required("gfa").set(param.mode) | clipp::required("txt").set(param.mode)).doc("reference graph format"),
         clipp::required("-r") & clipp::value("ref", param.rfile).doc("reference graph file"),
-        clipp::required("-q") & clipp::value("query", param.qfile).doc("query file (fasta/fastq)[.gz]"),
-        clipp::required("-o") & clipp::value("output", param.ofile).doc("output file"),
+        (
+          (
+            clipp::required("-q") & clipp::value("query", param.qfile).doc("query file (fasta/fastq)[.gz]"),
+            clipp::required("-o") & clipp::value("output", param.ofile).doc("output file")
+          ) |
+          (
+            clipp::required("-Q") & clipp::value("manifest", param.manifest).doc("file with a query file and output file per line, one line per sample")
+          )
+        ),
         clipp::required("-t") & clipp::value("threads", param.threads).doc("thread count for parallel execution"),
         clipp::option("-match") & clipp::value("N1", param.match).doc("match score (default 1)"),
         clipp::option("-mismatch") & clipp::value("N2", param.mismatch).doc("mismatch penalty (default 1)"),
         clipp::option("-ins") & clipp::value("N3", param.ins).doc("insertion penalty (default 1)"),
-        clipp::option("-del") & clipp::value("N4", param.del).doc("deletion penalty (default 1)")
+        clipp::option("-del") & clipp::value("N4", param.del).doc("deletion penalty (default 1)"),
+        clipp::option("-ckmer") & clipp::value("K", param.componentKmer).doc("skip graph components sharing no k-mer of length K (<= 16) with a read batch (default 0, disabled)"),
+        clipp::option("-shard") & clipp::value("i/N", shard).doc("align only reads (or pairs) with 0-based index j such that j % N == i, see merge subcommand"),
+        clipp::option("-metrics") & clipp::value("json", param.metricsFile).doc("save run metrics in JSON format"),
+        clipp::option("-partitions") & clipp::value("P", param.partitions).doc("split graph columns across P processes during phase 1, sharing the thread count (default 1)"),
+        clipp::option("-ooc") & clipp::value("file", param.streamFile).doc("out-of-core mode, stream graph columns from file during phase 1 (file is created from the reference graph if missing)"),
+        clipp::option("-cstate").set(param.compressRowState).doc("save DP state across row blocks as int8 differences to reduce memory, in int16/int32 precision and if penalties are small"),
+        clipp::option("-prefetch") & clipp::value("D", param.prefetchDistance).doc("prefetch DP scores of predecessors of the column D columns ahead during phase 1 (default 0, disabled)"),
+        clipp::option("-validate") & 
+          (clipp::required("off").set(param.validation, VALIDATE_OFF) | clipp::required("sampled").set(param.validation, VALIDATE_SAMPLED) | clipp::required("full").set(param.validation, VALIDATE_FULL)).doc("runtime checks of alignments, of 1 in N reads if sampled, and of the loaded graph if full (default sampled)"),
+        clipp::option("-vsample") & clipp::value("N", param.validationSample).doc("validate 1 in N reads in sampled validation (default 100)"),
+        clipp::option("-costs").set(param.printCosts).doc("append DP cells and time (s) of phase 1, 1-R and 2 of each read to the output"),
+        clipp::option("-slowlog") & clipp::value("file", param.slowLog).doc("save costs of the slowest reads"),
+        clipp::option("-slowk") & clipp::value("K", param.slowReads).doc("count of slowest reads to log or save (default 10)"),
+        clipp::option("-repro") & clipp::value("prefix", param.reproPrefix).doc("save each of the slowest reads with its graph window as prefix.<rank>.txt, see replay subcommand"),
+        clipp::option("-plan").set(param.dryRun).doc("dry run, predict peak memory and time in each score precision and recommend thread count without aligning"),
+        clipp::option("-maxmem") & clipp::value("GB", param.maxMemory).doc("lower thread count to keep predicted peak memory within limit (default 0, disabled)"),
+        clipp::option("-budget") & clipp::value("cells", param.cellBudget).doc("DP cells of phase 1-R and 2 allowed per read (default 0, disabled)"),
+        clipp::option("-deadline") & clipp::value("s", param.readDeadline).doc("time (s) of phase 1-R and 2 allowed per read (default 0, disabled)"),
+        clipp::option("-overrun") & 
+          (clipp::required("score").set(param.overrun, OVERRUN_SCORE) | clipp::required("timeout").set(param.overrun, OVERRUN_TIMEOUT)).doc("report reads exceeding budget or deadline with score and locations found so far, or as timed out (default score)"),
+        clipp::option("-checkpoint") & clipp::value("journal", param.journalFile).doc("append results per batch of reads and log progress in journal file, a restarted run with the same arguments skips completed batches"),
+        clipp::option("-batch") & clipp::value("N", param.batchReads).doc("count of reads per checkpointed or concurrent batch, or of alignments per rescored batch (default 100000)"),
+        clipp::option("-workers") & clipp::value("W", param.batchWorkers).doc("align W batches of reads concurrently, each with an equal share of threads (default 1)"),
+        clipp::option("-window") & clipp::value("B", param.reorderWindow).doc("maximum count of concurrent batches being aligned or waiting for output in input order (default 2 * W)"),
+        clipp::option("-unordered").set(param.unorderedOutput).doc("print concurrent batches as they complete, rather than in input order"),
+        clipp::option("-sort").set(param.sortOutput).doc("sort output by graph vertex and offset of alignment start, unaligned reads last"),
+        clipp::option("-sortmem") & clipp::value("MB", param.sortMemory).doc("memory to buffer output records in, beyond which sorted runs are spilled to temporary files (default 1024)"),
+        clipp::option("-coverage") & clipp::value("file", param.coverageFile).doc("save aligned bases and mean depth of each graph vertex, counted during traceback"),
+        clipp::option("-covformat") & 
+          (clipp::required("tsv").set(param.coverageBinary, false) | clipp::required("bin").set(param.coverageBinary, true)).doc("coverage file format (default tsv)"),
+        clipp::option("-perbase").set(param.coveragePerBase).doc("save depth at each vertex offset in coverage file"),
+        clipp::option("-sam") & clipp::value("file", param.samFile).doc("save alignments projected onto a reference path of the graph in SAM format, or BAM if file ends with .bam"),
+        clipp::option("-refpath") & clipp::value("name", param.referencePath).doc("reference path for SAM/BAM output (default first path of the graph)"),
+        clipp::option("-q2") & clipp::value("query", param.mateFile).doc("query file of second mates, paired with reads of the query file in order"),
+        clipp::option("-interleaved").set(param.interleaved).doc("query file holds mates of each pair one after another"),
+        clipp::option("-insert") & clipp::value("mean", param.insertMean) & clipp::value("sd", param.insertStdDev).doc("span of a pair in graph columns (default estimated from the first pairs)"),
+        clipp::option("-rescuemin") & clipp::value("F", param.mateMinScore).doc("fraction of maximum score for an alignment to anchor its mate, or be kept after rescue (default 0.5)"),
+        clipp::option("-g") & clipp::value("gaf", param.gafFile).doc("alignments to rescore in GAF format, with cigar in cg:Z: tag (rescore subcommand only)")
       );
 
     if(!clipp::parse(argc, argv, cli)) 
@@ -47,6 +138,177 @@ namespace psgl
       exit(1);
     }
 
+    if(param.componentKmer < 0 || param.componentKmer > 16)
+    {
+      std::cerr << "ERROR, psgl::parseandSave, component k-mer length should be in range [0, 16]" << std::endl;
+      exit(1);
+    }
+
+    if (param.prefetchDistance < 0)
+    {
+      std::cerr << "ERROR, psgl::parseandSave, prefetch distance should be non-negative" << std::endl;
+      exit(1);
+    }
+
+    if (param.slowReads < 1)
+    {
+      std::cerr << "ERROR, psgl::parseandSave, count of slowest reads should be positive" << std::endl;
+      exit(1);
+    }
+
+    if (param.validationSample < 1)
+    {
+      std::cerr << "ERROR, psgl::parseandSave, validation sample size should be positive" << std::endl;
+      exit(1);
+    }
+
+    if (param.partitions < 1)
+    {
+      std::cerr << "ERROR, psgl::parseandSave, partition count should be positive" << std::endl;
+      exit(1);
+    }
+
+#if !defined(PASGAL_ENABLE_AVX512) && !defined(PASGAL_ENABLE_AVX2)
+    if (param.partitions > 1)
+    {
+      std::cerr << "ERROR, psgl::parseandSave, graph partitioning requires SIMD support" << std::endl;
+      exit(1);
+    }
+
+    if (!param.streamFile.empty())
+    {
+      std::cerr << "ERROR, psgl::parseandSave, out-of-core mode requires SIMD support" << std::endl;
+      exit(1);
+    }
+#endif
+
+    if (!param.streamFile.empty() && param.partitions > 1)
+    {
+      std::cerr << "ERROR, psgl::parseandSave, out-of-core mode can not be combined with graph partitions" << std::endl;
+      exit(1);
+    }
+
+    if (!param.streamFile.empty() && param.componentKmer > 0)
+    {
+      std::cerr << "ERROR, psgl::parseandSave, out-of-core mode does not filter graph components, and can not be combined with -ckmer" << std::endl;
+      exit(1);
+    }
+
+    if (param.cellBudget < 0 || param.readDeadline < 0)
+    {
+      std::cerr << "ERROR, psgl::parseandSave, cell budget and deadline should be non-negative" << std::endl;
+      exit(1);
+    }
+
+    if ((param.cellBudget > 0 || param.readDeadline > 0) && param.partitions > 1)
+    {
+      std::cerr << "ERROR, psgl::parseandSave, cell budget and deadline can not be combined with graph partitions" << std::endl;
+      exit(1);
+    }
+
+    if (param.maxMemory < 0)
+    {
+      std::cerr << "ERROR, psgl::parseandSave, memory limit should be non-negative" << std::endl;
+      exit(1);
+    }
+
+    if ((param.dryRun || param.maxMemory > 0) && (!param.streamFile.empty() || param.partitions > 1))
+    {
+      std::cerr << "ERROR, psgl::parseandSave, run planner models in-memory runs, and can not be combined with out-of-core mode or graph partitions" << std::endl;
+      exit(1);
+    }
+
+    if (param.batchReads < 1)
+    {
+      std::cerr << "ERROR, psgl::parseandSave, batch size should be positive" << std::endl;
+      exit(1);
+    }
+
+    if (param.batchWorkers < 1 || param.reorderWindow < 0)
+    {
+      std::cerr << "ERROR, psgl::parseandSave, count of batch workers should be positive, and reorder window non-negative" << std::endl;
+      exit(1);
+    }
+
+    if (param.batchWorkers > 1 && param.partitions > 1)
+    {
+      std::cerr << "ERROR, psgl::parseandSave, concurrent batches can not be combined with graph partitions" << std::endl;
+      exit(1);
+    }
+
+    if (param.unorderedOutput && !param.journalFile.empty())
+    {
+      std::cerr << "ERROR, psgl::parseandSave, checkpoints require output in input order, and can not be combined with -unordered" << std::endl;
+      exit(1);
+    }
+
+    if (param.sortMemory < 1)
+    {
+      std::cerr << "ERROR, psgl::parseandSave, sort memory should be positive" << std::endl;
+      exit(1);
+    }
+
+    if (param.sortOutput && !param.journalFile.empty())
+    {
+      std::cerr << "ERROR, psgl::parseandSave, sorted output is written at the end of the run, and can not be combined with checkpoints" << std::endl;
+      exit(1);
+    }
+
+    if (!param.coverageFile.empty() && !param.journalFile.empty())
+    {
+      std::cerr << "ERROR, psgl::parseandSave, coverage counts are not saved in checkpoints, and can not be combined with -checkpoint" << std::endl;
+      exit(1);
+    }
+
+    if (!param.samFile.empty() && (!param.streamFile.empty() || !param.journalFile.empty()))
+    {
+      std::cerr << "ERROR, psgl::parseandSave, SAM/BAM output can not be combined with out-of-core mode or checkpoints" << std::endl;
+      exit(1);
+    }
+
+    if (!param.mateFile.empty() && param.interleaved)
+    {
+      std::cerr << "ERROR, psgl::parseandSave, second mates should be given either with -q2 or interleaved, not both" << std::endl;
+      exit(1);
+    }
+
+    if (param.insertMean < 0 || param.insertStdDev < 0 || param.mateMinScore <= 0 || param.mateMinScore > 1)
+    {
+      std::cerr << "ERROR, psgl::parseandSave, insert size should be non-negative, and rescue score fraction in range (0, 1]" << std::endl;
+      exit(1);
+    }
+
+    if (param.pairedInput() && (!param.manifest.empty() || !param.samFile.empty()))
+    {
+      std::cerr << "ERROR, psgl::parseandSave, paired reads can not be combined with a manifest or SAM/BAM output" << std::endl;
+      exit(1);
+    }
+
+    if (param.pairedInput() && param.batchReads % 2 != 0)
+    {
+      std::cerr << "ERROR, psgl::parseandSave, batch size should be even for paired reads" << std::endl;
+      exit(1);
+    }
+
+    if (!shard.empty())
+    {
+      char sep;
+      std::istringstream inputString(shard);
+
+      if (!(inputString >> param.shardIndex >> sep >> param.shardCount) || sep != '/' || 
+          param.shardCount < 1 || param.shardIndex < 0 || param.shardIndex >= param.shardCount)
+      {
+        std::cerr << "ERROR, psgl::parseandSave, shard should be specified as i/N, with 0 <= i < N" << std::endl;
+        exit(1);
+      }
+    }
+
+    //list of samples to align, see Parameters::sampleFiles
+    param.samples.clear();
+
+    if (!param.manifest.empty())
+      parseManifest (param.manifest, param.samples);
+
     omp_set_num_threads(param.threads);
 
     // print execution environment based on which MACROs are set
@@ -54,13 +316,152 @@ namespace psgl
 
     //print all input parameters
     std::cout << "INFO, psgl::parseandSave, reference file = " << param.rfile << " (in " << param.mode  << " format) " << std::endl;
-    std::cout << "INFO, psgl::parseandSave, query file = " << param.qfile << std::endl;
-    std::cout << "INFO, psgl::parseandSave, output file = " << param.ofile << std::endl;
+    if (param.manifest.empty())
+    {
+      std::cout << "INFO, psgl::parseandSave, query file = " << param.qfile << std::endl;
+      std::cout << "INFO, psgl::parseandSave, output file = " << param.ofile << std::endl;
+    }
+    else
+    {
+      std::cout << "INFO, psgl::parseandSave, manifest file = " << param.manifest << ", sample count = " << param.samples.size() << std::endl;
+    }
     std::cout << "INFO, psgl::parseandSave, thread count = " << param.threads << std::endl;
     std::cout << "INFO, psgl::parseandSave, scoring scheme = " << "[ match:" << param.match 
                                                                << " mismatch:" << param.mismatch 
                                                                << " ins:" << param.ins 
                                                                << " del:" << param.del << " ]" << std::endl;
+
+    if (param.componentKmer > 0)
+      std::cout << "INFO, psgl::parseandSave, component k-mer length = " << param.componentKmer << std::endl;
+
+    if (param.shardCount > 1)
+      std::cout << "INFO, psgl::parseandSave, shard = " << param.shardIndex << "/" << param.shardCount << std::endl;
+
+    if (param.partitions > 1)
+      std::cout << "INFO, psgl::parseandSave, graph partitions = " << param.partitions << std::endl;
+
+    if (!param.streamFile.empty())
+      std::cout << "INFO, psgl::parseandSave, out-of-core graph file = " << param.streamFile << std::endl;
+
+    if (param.compressRowState)
+      std::cout << "INFO, psgl::parseandSave, compressed row state = ON" << std::endl;
+
+    if (param.prefetchDistance > 0)
+      std::cout << "INFO, psgl::parseandSave, prefetch distance = " << param.prefetchDistance << std::endl;
+
+    if (!param.slowLog.empty())
+      std::cout << "INFO, psgl::parseandSave, slow read log = " << param.slowLog << ", reads = " << param.slowReads << std::endl;
+
+    if (!param.reproPrefix.empty())
+      std::cout << "INFO, psgl::parseandSave, repro file prefix = " << param.reproPrefix << ", reads = " << param.slowReads << std::endl;
+
+    if (param.cellBudget > 0 || param.readDeadline > 0)
+      std::cout << "INFO, psgl::parseandSave, per-read cell budget = " << param.cellBudget << ", deadline (s) = " << param.readDeadline 
+        << ", overrun reads are " << (param.overrun == OVERRUN_SCORE ? "reported score-only" : "reported as timed out") << std::endl;
+
+    if (!param.journalFile.empty())
+      std::cout << "INFO, psgl::parseandSave, checkpoint journal = " << param.journalFile << ", reads per batch = " << param.batchReads << std::endl;
+
+    if (param.batchWorkers > 1)
+      std::cout << "INFO, psgl::parseandSave, concurrent batches = " << param.batchWorkers << ", reads per batch = " << param.batchReads 
+        << ", output order = " << (param.unorderedOutput ? "unordered" : "input") << std::endl;
+
+    if (param.sortOutput)
+      std::cout << "INFO, psgl::parseandSave, output sorted by graph position, memory (MB) = " << param.sortMemory << std::endl;
+
+    if (!param.coverageFile.empty())
+      std::cout << "INFO, psgl::parseandSave, coverage file = " << param.coverageFile << " (in " << (param.coverageBinary ? "bin" : "tsv") 
+        << " format" << (param.coveragePerBase ? ", per-base" : "") << ")" << std::endl;
+
+    if (!param.samFile.empty())
+      std::cout << "INFO, psgl::parseandSave, SAM/BAM file = " << param.samFile << ", reference path = " 
+        << (param.referencePath.empty() ? "first path" : param.referencePath) << std::endl;
+
+    if (param.pairedInput())
+    {
+      std::cout << "INFO, psgl::parseandSave, paired reads, second mates = " << (param.interleaved ? "interleaved" : param.mateFile) 
+        << ", rescue score fraction = " << param.mateMinScore << std::endl;
+
+      if (param.insertMean > 0)
+        std::cout << "INFO, psgl::parseandSave, insert size mean = " << param.insertMean << ", std. dev. = " << param.insertStdDev << std::endl;
+    }
+
+    if (!param.gafFile.empty())
+      std::cout << "INFO, psgl::parseandSave, alignment file = " << param.gafFile << ", alignments per batch = " << param.batchReads << std::endl;
+
+    if (param.dryRun)
+      std::cout << "INFO, psgl::parseandSave, dry run = ON" << std::endl;
+
+    if (param.maxMemory > 0)
+      std::cout << "INFO, psgl::parseandSave, memory limit (GB) = " << param.maxMemory << std::endl;
+
+    if (param.validation == VALIDATE_OFF)
+      std::cout << "INFO, psgl::parseandSave, validation = off" << std::endl;
+    else if (param.validation == VALIDATE_SAMPLED)
+      std::cout << "INFO, psgl::parseandSave, validation = 1 in " << param.validationSample << " reads" << std::endl;
+    else
+      std::cout << "INFO, psgl::parseandSave, validation = full" << std::endl;
+  }
+
+  /**
+   * @brief                   parse the cmd line options of merge subcommand
+   * @param[in]   argc
+   * @param[in]   argv
+   * @param[out]  param       parameters are saved here
+   **/
+  void parseMergeArgs(int argc, char** argv, psgl::MergeParameters &param)
+  {
+    param.groupSize = 0;
+
+    //define all arguments
+    auto cli = 
+      (
+        clipp::command("merge"),
+        clipp::required("-i") & clipp::values("shards", param.shardFiles).doc("shard output files, in shard order 0..N-1"),
+        clipp::required("-o") & clipp::value("output", param.ofile).doc("merged output file"),
+        clipp::option("-j") & clipp::values("json", param.metricsFiles).doc("shard metrics files, in shard order 0..N-1"),
+        clipp::option("-metrics") & clipp::value("json", param.metricsFile).doc("save merged metrics in JSON format"),
+        clipp::option("-group") & clipp::value("N", param.groupSize).doc("count of consecutive lines kept in the same shard, i.e., 2 for paired reads (default from metrics files, else 1)")
+      );
+
+    if(!clipp::parse(argc, argv, cli) || param.groupSize < 0) 
+    {
+      //print help page
+      clipp::operator<<(std::cout, clipp::make_man_page(cli, argv[0])) << std::endl;
+      exit(1);
+    }
+
+    std::cout << "INFO, psgl::parseMergeArgs, shard count = " << param.shardFiles.size() << std::endl;
+    std::cout << "INFO, psgl::parseMergeArgs, output file = " << param.ofile << std::endl;
+  }
+
+  /**
+   * @brief                   parse the cmd line options of replay subcommand
+   * @param[in]   argc
+   * @param[in]   argv
+   * @param[out]  param       parameters are saved here
+   **/
+  void parseReplayArgs(int argc, char** argv, psgl::ReplayParameters &param)
+  {
+    param.repeats = 1;
+
+    //define all arguments
+    auto cli = 
+      (
+        clipp::command("replay"),
+        clipp::required("-i") & clipp::value("repro", param.reproFile).doc("repro file saved using -repro option"),
+        clipp::option("-n") & clipp::value("N", param.repeats).doc("count of times to align the read (default 1)")
+      );
+
+    if(!clipp::parse(argc, argv, cli) || param.repeats < 1) 
+    {
+      //print help page
+      clipp::operator<<(std::cout, clipp::make_man_page(cli, argv[0])) << std::endl;
+      exit(1);
+    }
+
+    std::cout << "INFO, psgl::parseReplayArgs, repro file = " << param.reproFile << std::endl;
+    std::cout << "INFO, psgl::parseReplayArgs, repeats = " << param.repeats << std::endl;
   }
 }
 
@@ -0,0 +1,794 @@
+/**
+ * @file    partition.hpp
+ * @brief   routines to split phase 1 DP across worker processes,
+ *          each handling a contiguous range of graph columns
+ * @author  Chirag Jain <cjain7@gatech.edu>
+ */
+
+#ifndef PSGL_PARTITION_HPP
+#define PSGL_PARTITION_HPP
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <map>
+#include <array>
+#include <tuple>
+
+#include "csr_char.hpp"
+#include "utils.hpp"
+
+namespace psgl
+{
+  /**
+   * @brief                   write complete buffer to a file descriptor
+   * @param[in]   fd
+   * @param[in]   data
+   * @param[in]   bytes
+   */
+  void writeFully(int fd, const void *data, std::size_t bytes)
+  {
+    const char *ptr = (const char *) data;
+
+    while (bytes > 0)
+    {
+      auto n = write (fd, ptr, bytes);
+
+      if (n < 0 && errno == EINTR)
+        continue;
+
+      if (n <= 0)
+      {
+        std::cerr << "ERROR, psgl::writeFully, write to partition pipe failed" << std::endl;
+        exit(1);
+      }
+
+      ptr += n;
+      bytes -= n;
+    }
+  }
+
+  /**
+   * @brief                   read complete buffer from a file descriptor
+   * @param[in]   fd
+   * @param[out]  data
+   * @param[in]   bytes
+   */
+  void readFully(int fd, void *data, std::size_t bytes)
+  {
+    char *ptr = (char *) data;
+
+    while (bytes > 0)
+    {
+      auto n = read (fd, ptr, bytes);
+
+      if (n < 0 && errno == EINTR)
+        continue;
+
+      if (n <= 0)
+      {
+        std::cerr << "ERROR, psgl::readFully, partition pipe closed unexpectedly" << std::endl;
+        exit(1);
+      }
+
+      ptr += n;
+      bytes -= n;
+    }
+  }
+
+  /**
+   * @brief     DP boundary state of a graph partition
+   * @details   graph columns are split into contiguous ranges handled by separate
+   *            processes, which form a pipeline along the DP sweep direction.
+   *            A partition receives scores of 'halo' columns, i.e., columns of
+   *            preceding partitions with edges into or beyond its range, and
+   *            forwards scores of all columns with edges beyond its range.
+   *            Scores are exchanged as strips which cover all rows of a work item
+   */
+  class PartitionBoundary
+  {
+    public:
+
+      //sweep direction of the DP
+      bool forward;
+
+      //partition id, and count of partitions
+      int32_t id;
+      int32_t count;
+
+      //range of global columns [globalBegin, globalEnd) computed by this partition
+      int64_t globalBegin;
+      int64_t globalEnd;
+
+      //count of halo columns, these are the first (forward) or last (reverse)
+      //columns of the local graph
+      int32_t haloCount;
+
+      //slot of each local column in outgoing strips, -1 if not forwarded
+      std::vector<int32_t> sendSlot;
+
+      //count of columns in outgoing strips
+      int32_t sendCount;
+
+      //pipes from previous and to next partition along the sweep, -1 if none
+      int recvFd;
+      int sendFd;
+
+      //pipe to send best scores to partition 0 (non-zero partitions)
+      int resultFd;
+
+      //pipes to receive best scores from other partitions (partition 0)
+      std::vector<int> resultFds;
+
+    private:
+
+      //strips received ahead of their use, indexed by work item
+      std::map< std::size_t, std::vector<char> > mailbox;
+
+    public:
+
+      /**
+       * @brief                 convert local column of a partition to global column
+       */
+      int64_t toGlobal (int32_t local) const
+      {
+        return forward ? local - haloCount + globalBegin : local + globalBegin;
+      }
+
+      /**
+       * @brief                 convert global column to local column
+       * @return                -1 if the column is not computed by this partition
+       */
+      int32_t toLocal (int64_t global) const
+      {
+        if (global < globalBegin || global >= globalEnd)
+          return -1;
+
+        return forward ? global - globalBegin + haloCount : global - globalBegin;
+      }
+
+      /**
+       * @brief                 receive strip of halo columns for a work item
+       * @details               strips may arrive in a different order than requested
+       *                        when the previous partition uses multiple threads
+       * @param[in]   item      work item id
+       * @param[out]  data
+       * @param[in]   bytes
+       */
+      void receiveStrip (std::size_t item, void *data, std::size_t bytes)
+      {
+#pragma omp critical (psglPartitionRecv)
+        {
+          while (mailbox.find (item) == mailbox.end())
+          {
+            uint64_t header[2];
+            readFully (recvFd, header, sizeof(header));
+
+            auto &buffer = mailbox[header[0]];
+            buffer.resize (header[1]);
+            readFully (recvFd, buffer.data(), header[1]);
+          }
+
+          assert (mailbox[item].size() == bytes);
+          std::copy (mailbox[item].begin(), mailbox[item].end(), (char *) data);
+          mailbox.erase (item);
+        }
+      }
+
+      /**
+       * @brief                 send strip of boundary columns for a work item
+       * @param[in]   item      work item id
+       * @param[in]   data
+       * @param[in]   bytes
+       */
+      void sendStrip (std::size_t item, const void *data, std::size_t bytes)
+      {
+        uint64_t header[2] = {item, bytes};
+
+#pragma omp critical (psglPartitionSend)
+        {
+          writeFully (sendFd, header, sizeof(header));
+          writeFully (sendFd, data, bytes);
+        }
+      }
+
+      /**
+       * @brief                     reduce best scores of vector lanes across partitions
+       * @details                   ties are broken in favor of the cell visited later during
+       *                            a sweep over the complete graph, same as the DP kernels
+       * @param[in/out] bestScores
+       * @param[in/out] bestCols    global columns
+       * @param[in/out] bestRows
+       * @param[in]     blockHeight row block height used by the DP kernel
+       * @return                    true at partition 0, which holds the reduced values
+       */
+      bool gatherBestScores (std::vector<int32_t> &bestScores,
+                             std::vector<int64_t> &bestCols,
+                             std::vector<int32_t> &bestRows,
+                             int32_t blockHeight)
+      {
+        auto bytes = bestScores.size() * sizeof(int32_t);
+        auto colBytes = bestCols.size() * sizeof(int64_t);
+
+        if (id != 0)
+        {
+          writeFully (resultFd, bestScores.data(), bytes);
+          writeFully (resultFd, bestCols.data(), colBytes);
+          writeFully (resultFd, bestRows.data(), bytes);
+          return false;
+        }
+
+        std::vector<int32_t> scores (bestScores.size()), rows (bestScores.size());
+        std::vector<int64_t> cols (bestScores.size());
+
+        for (std::size_t p = 1; p < count; p++)
+        {
+          readFully (resultFds[p], scores.data(), bytes);
+          readFully (resultFds[p], cols.data(), colBytes);
+          readFully (resultFds[p], rows.data(), bytes);
+
+          for (std::size_t i = 0; i < bestScores.size(); i++)
+          {
+            //columns are visited in increasing order during forward DP,
+            //and in decreasing order during reverse DP
+            auto key = [&](int32_t row, int64_t col) {
+              return std::make_tuple (row / blockHeight, forward ? col : -col, row);
+            };
+
+            if (scores[i] > bestScores[i] ||
+                (scores[i] == bestScores[i] && key (rows[i], cols[i]) > key (bestRows[i], bestCols[i])))
+            {
+              bestScores[i] = scores[i];
+              bestCols[i] = cols[i];
+              bestRows[i] = rows[i];
+            }
+          }
+        }
+
+        return true;
+      }
+  };
+
+  /**
+   * @brief                   choose column ranges of graph partitions
+   * @details                 each cut is placed near an even split, at the column with the fewest
+   *                          halo columns in either sweep direction within a quarter partition width,
+   *                          so that cuts avoid long edge hops. The halo of a partition is bounded
+   *                          by its own width, otherwise the graph can not be split into as many
+   *                          partitions usefully
+   * @param[in]   graph       complete graph
+   * @param[in]   count       count of partitions
+   * @return                  partition i computes columns [cuts[i], cuts[i+1])
+   */
+  std::vector<int64_t> partitionCuts(const CSR_char_container &graph, int32_t count)
+  {
+    const int64_t n = graph.numVertices;
+
+    if (count < 1 || count > n)
+    {
+      std::cerr << "ERROR, psgl::partitionCuts, partition count should be within [1, " << n << "]" << std::endl;
+      exit(1);
+    }
+
+    //halo[c] = count of columns before cut c with out-edges beyond it (forward sweep),
+    //plus count of columns after cut c with in-edges from before it (reverse sweep)
+    std::vector<int64_t> halo (n + 1, 0);
+
+    for (int64_t v = 0; v < n; v++)
+    {
+      int64_t farthest = v, nearest = v;
+
+      for (auto j = graph.offsets_out[v]; j < graph.offsets_out[v+1]; j++)
+        farthest = std::max (farthest, v + graph.adjcny_out[j]);
+
+      for (auto j = graph.offsets_in[v]; j < graph.offsets_in[v+1]; j++)
+        nearest = std::min (nearest, v - graph.adjcny_in[j]);
+
+      //v is a halo column of cuts in (v, farthest], and of cuts in (nearest, v]
+      halo[v + 1]++;
+      halo[farthest + 1]--;
+      halo[nearest + 1]++;
+      halo[v + 1]--;
+    }
+
+    for (int64_t c = 1; c <= n; c++)
+      halo[c] += halo[c - 1];
+
+    std::vector<int64_t> cuts (count + 1, n);
+    cuts[0] = 0;
+
+    for (int32_t i = 1; i < count; i++)
+    {
+      int64_t even = n * i / count;
+      int64_t radius = n / count / 4;
+
+      int64_t best = even;
+      for (int64_t c = std::max (cuts[i-1] + 1, even - radius); c <= std::min (n - (count - i), even + radius); c++)
+        if (halo[c] < halo[best] || (halo[c] == halo[best] && std::abs (c - even) < std::abs (best - even)))
+          best = c;
+
+      cuts[i] = best;
+    }
+
+    for (int32_t i = 0; i < count; i++)
+    {
+      auto width = cuts[i+1] - cuts[i];
+
+      if ((i > 0 && halo[cuts[i]] > width) || (i + 1 < count && halo[cuts[i+1]] > width))
+      {
+        std::cerr << "ERROR, psgl::partitionCuts, halo columns of partition " << i << "/" << count 
+          << " exceed its width " << width << ", use fewer partitions" << std::endl;
+        exit(1);
+      }
+    }
+
+    return cuts;
+  }
+
+  /**
+   * @brief                   extract local graph and boundary state of a partition
+   * @details                 local graph contains the partition's column range and its
+   *                          halo columns, in increasing order of global column ids. Only
+   *                          edges used by the DP in the given direction are kept, i.e.,
+   *                          edges into (forward) or out of (reverse) the column range
+   * @param[in]   graph       complete graph
+   * @param[in]   cuts        column ranges of partitions, see partitionCuts
+   * @param[in]   b           partition boundary with direction, id and count set
+   * @param[out]  local       local graph
+   */
+  void buildPartition(const CSR_char_container &graph, const std::vector<int64_t> &cuts, PartitionBoundary &b, CSR_char_container &local)
+  {
+    const int64_t n = graph.numVertices;
+    assert (cuts.size() == b.count + 1);
+
+    b.globalBegin = cuts[b.id];
+    b.globalEnd = cuts[b.id + 1];
+
+    //columns outside [begin, end) with edges crossing 'cut', in the sweep direction
+    auto crossingColumns = [&](int64_t cut, std::vector<int64_t> &columns) {
+      columns.clear();
+
+      if (b.forward)
+      {
+        //columns before cut, with out-edges to columns after cut
+        for (int64_t v = cut; v < n; v++)
+          for (auto j = graph.offsets_in[v]; j < graph.offsets_in[v+1]; j++)
+            if (v - graph.adjcny_in[j] < cut)
+              columns.push_back (v - graph.adjcny_in[j]);
+      }
+      else
+      {
+        //columns after cut, with in-edges from columns before cut
+        for (int64_t u = 0; u < cut; u++)
+          for (auto j = graph.offsets_out[u]; j < graph.offsets_out[u+1]; j++)
+            if (u + graph.adjcny_out[j] >= cut)
+              columns.push_back (u + graph.adjcny_out[j]);
+      }
+
+      std::sort (columns.begin(), columns.end());
+      columns.erase (std::unique (columns.begin(), columns.end()), columns.end());
+    };
+
+    std::vector<int64_t> halo, outgoing;
+    crossingColumns (b.forward ? b.globalBegin : b.globalEnd, halo);
+    crossingColumns (b.forward ? b.globalEnd : b.globalBegin, outgoing);
+
+    //local columns in increasing order of global ids
+    std::vector<int64_t> columns;
+    {
+      if (!b.forward)
+        for (int64_t v = b.globalBegin; v < b.globalEnd; v++)
+          columns.push_back (v);
+
+      columns.insert (columns.end(), halo.begin(), halo.end());
+
+      if (b.forward)
+        for (int64_t v = b.globalBegin; v < b.globalEnd; v++)
+          columns.push_back (v);
+    }
+
+    //local columns are addressed with int32_t type by the DP kernels
+    if (columns.size() > INT32_MAX)
+    {
+      std::cerr << "ERROR, psgl::buildPartition, partition " << b.id << " has " << columns.size() << " columns, exceeding int32_t range, use more partitions" << std::endl;
+      exit(1);
+    }
+
+    auto toLocal = [&](int64_t global) {
+      auto it = std::lower_bound (columns.begin(), columns.end(), global);
+      return (it != columns.end() && *it == global) ? (int32_t) (it - columns.begin()) : -1;
+    };
+
+    b.haloCount = halo.size();
+
+    //boundary columns forwarded to next partition
+    {
+      b.sendCount = outgoing.size();
+      b.sendSlot.assign (columns.size(), -1);
+
+      for (std::size_t i = 0; i < outgoing.size(); i++)
+      {
+        assert (toLocal (outgoing[i]) >= 0);
+        b.sendSlot[toLocal (outgoing[i])] = i;
+      }
+    }
+
+    //local edges (from, to)
+    std::vector< std::pair<int32_t, int32_t> > edges;
+
+    for (int64_t v = b.globalBegin; v < b.globalEnd; v++)
+    {
+      if (b.forward)
+      {
+        for (auto j = graph.offsets_in[v]; j < graph.offsets_in[v+1]; j++)
+        {
+          assert (toLocal (v - graph.adjcny_in[j]) >= 0);
+          edges.emplace_back (toLocal (v - graph.adjcny_in[j]), toLocal (v));
+        }
+      }
+      else
+      {
+        for (auto j = graph.offsets_out[v]; j < graph.offsets_out[v+1]; j++)
+        {
+          assert (toLocal (v + graph.adjcny_out[j]) >= 0);
+          edges.emplace_back (toLocal (v), toLocal (v + graph.adjcny_out[j]));
+        }
+      }
+    }
+
+    //build local CSR graph
+    {
+      local.numVertices = columns.size();
+      local.numEdges = edges.size();
+
+      local.vertex_label.clear();
+      for (auto v : columns)
+        local.vertex_label.push_back (graph.vertex_label[v]);
+
+      //adjacency lists save hop distances
+      auto buildCSR = [&](bool in, std::vector<int64_t> &offsets, std::vector<int32_t> &adjcny) {
+        offsets.assign (local.numVertices + 1, 0);
+        adjcny.resize (edges.size());
+
+        for (auto &e : edges)
+          offsets[(in ? e.second : e.first) + 1]++;
+
+        for (int64_t i = 0; i < local.numVertices; i++)
+          offsets[i+1] += offsets[i];
+
+        std::vector<int64_t> fill (offsets.begin(), offsets.end() - 1);
+
+        for (auto &e : edges)
+          adjcny[fill[in ? e.second : e.first]++] = e.second - e.first;
+      };
+
+      buildCSR (true, local.offsets_in, local.adjcny_in);
+      buildCSR (false, local.offsets_out, local.adjcny_out);
+
+      //partition is aligned as a single component
+      local.componentOffsets = {0, local.numVertices};
+    }
+
+    std::cout << "INFO, psgl::buildPartition, " << (b.forward ? "forward" : "reverse") << " partition " << b.id << "/" << b.count
+      << ", columns = [" << b.globalBegin << ", " << b.globalEnd << ")"
+      << ", halo columns = " << b.haloCount << ", boundary columns = " << b.sendCount << std::endl;
+  }
+
+  /**
+   * @brief                   write a vector to a file descriptor, preceded by its size
+   */
+  template <typename T>
+    void writeVector(int fd, const std::vector<T> &v)
+    {
+      uint64_t size = v.size();
+      writeFully (fd, &size, sizeof(size));
+      writeFully (fd, v.data(), size * sizeof(T));
+    }
+
+  /**
+   * @brief                   read a vector written by writeVector
+   */
+  template <typename T>
+    void readVector(int fd, std::vector<T> &v)
+    {
+      uint64_t size;
+      readFully (fd, &size, sizeof(size));
+      v.resize (size);
+      readFully (fd, v.data(), size * sizeof(T));
+    }
+
+  /**
+   * @brief                   send local graph and boundary of a partition to its worker
+   * @param[in]   fd
+   * @param[in]   b
+   * @param[in]   local
+   */
+  void writePartition(int fd, const PartitionBoundary &b, const CSR_char_container &local)
+  {
+    int64_t header[] = {b.forward, b.id, b.count, b.globalBegin, b.globalEnd, b.haloCount, b.sendCount, local.numVertices, local.numEdges};
+    writeFully (fd, header, sizeof(header));
+
+    writeVector (fd, b.sendSlot);
+    writeVector (fd, local.vertex_label);
+    writeVector (fd, local.offsets_in);
+    writeVector (fd, local.adjcny_in);
+    writeVector (fd, local.offsets_out);
+    writeVector (fd, local.adjcny_out);
+    writeVector (fd, local.componentOffsets);
+  }
+
+  /**
+   * @brief                   receive local graph and boundary of a partition, see writePartition
+   * @param[in]   fd
+   * @param[out]  b
+   * @param[out]  local
+   */
+  void readPartition(int fd, PartitionBoundary &b, CSR_char_container &local)
+  {
+    int64_t header[9];
+    readFully (fd, header, sizeof(header));
+
+    b.forward = header[0];
+    b.id = header[1];
+    b.count = header[2];
+    b.globalBegin = header[3];
+    b.globalEnd = header[4];
+    b.haloCount = header[5];
+    b.sendCount = header[6];
+    local.numVertices = header[7];
+    local.numEdges = header[8];
+
+    readVector (fd, b.sendSlot);
+    readVector (fd, local.vertex_label);
+    readVector (fd, local.offsets_in);
+    readVector (fd, local.adjcny_in);
+    readVector (fd, local.offsets_out);
+    readVector (fd, local.adjcny_out);
+    readVector (fd, local.componentOffsets);
+  }
+
+  //environment variable holding the pipes of a partition worker, see runGraphPartitions
+  constexpr const char *partitionWorkerEnv = "PSGL_PARTITION_WORKER";
+
+  /**
+   * @brief                     run DP over graph partitions in separate processes
+   * @details                   partition 0 runs in the calling process. Other partitions run in
+   *                            worker processes which start the same executable again, so that
+   *                            they get an OpenMP runtime of their own (the runtime of the parent
+   *                            can not be used after fork) and do not inherit the complete graph.
+   *                            Each worker receives only the columns of its partition and their
+   *                            halo, followed by the job of the caller, through a pipe. Threads
+   *                            are split evenly among partitions, partition 0 takes the remainder.
+   *                            Workers are served by partitionWorker before main() is reached
+   * @param[in]   graph         complete graph
+   * @param[in]   count         count of partitions
+   * @param[in]   forward       DP sweep direction
+   * @param[in]   threads       thread count of all partitions together
+   * @param[in]   writeJob      function to send the job of a worker after its partition, 
+   *                            called with the pipe and the worker's thread count
+   * @param[in]   alignLocal    function to run DP over a local graph and its boundary
+   */
+  template <typename W, typename F>
+    void runGraphPartitions(const CSR_char_container &graph, int32_t count, bool forward, int threads, W writeJob, F alignLocal)
+    {
+      assert (count > 1);
+
+      auto cuts = partitionCuts (graph, count);
+
+      //pipes are not inherited by workers, except the ends each worker uses
+      auto openPipe = [](std::array<int, 2> &fds) {
+        if (pipe2 (fds.data(), O_CLOEXEC) != 0) 
+        { 
+          std::cerr << "ERROR, psgl::runGraphPartitions, pipe() failed" << std::endl; 
+          exit(1); 
+        }
+      };
+
+      //pipe i connects partitions i and i+1
+      std::vector< std::array<int, 2> > dataPipes (count - 1);
+
+      //pipe i sends best scores of partition i to partition 0
+      std::vector< std::array<int, 2> > resultPipes (count);
+
+      //pipe i sends partition and job to worker i
+      std::vector< std::array<int, 2> > jobPipes (count);
+
+      for (int32_t i = 0; i < count - 1; i++)
+        openPipe (dataPipes[i]);
+
+      for (int32_t i = 1; i < count; i++)
+      {
+        openPipe (resultPipes[i]);
+        openPipe (jobPipes[i]);
+      }
+
+      //pipe ends used by partition i: job, data from previous, data to next, result
+      auto partitionFds = [&](int32_t id) {
+        std::array<int, 4> fds = {id > 0 ? jobPipes[id][0] : -1, -1, -1, id > 0 ? resultPipes[id][1] : -1};
+
+        //previous and next partition along the sweep
+        int32_t prev = forward ? id - 1 : id + 1;
+        int32_t next = forward ? id + 1 : id - 1;
+
+        for (int32_t i = 0; i < count - 1; i++)
+        {
+          //pipe i carries data from partition i to i+1 (forward), or reverse
+          int32_t from = forward ? i : i + 1;
+          int32_t to = forward ? i + 1 : i;
+
+          if (from == prev && to == id)
+            fds[1] = dataPipes[i][0];
+
+          if (from == id && to == next)
+            fds[2] = dataPipes[i][1];
+        }
+
+        return fds;
+      };
+
+      //a worker which fails to start is reported by writeFully, rather than by SIGPIPE
+      signal (SIGPIPE, SIG_IGN);
+
+      //avoid duplicate output from buffers copied to workers
+      std::cout.flush();
+      fflush (stdout);
+
+      std::vector<pid_t> workers;
+
+      for (int32_t i = 1; i < count; i++)
+      {
+        auto fds = partitionFds (i);
+
+        //prepare arguments before fork, only exec related calls are made in the child
+        std::string var = std::string (partitionWorkerEnv) + "=" + std::to_string (fds[0]) + "," + 
+          std::to_string (fds[1]) + "," + std::to_string (fds[2]) + "," + std::to_string (fds[3]);
+
+        std::vector<char*> envp;
+        for (char **e = environ; *e != nullptr; e++)
+          if (std::strncmp (*e, partitionWorkerEnv, std::strlen (partitionWorkerEnv)) != 0)
+            envp.push_back (*e);
+        envp.push_back (&var[0]);
+        envp.push_back (nullptr);
+
+        char name[] = "PaSGAL-partition";
+        char *argv[] = {name, nullptr};
+
+        pid_t pid = fork();
+
+        if (pid < 0)
+        {
+          std::cerr << "ERROR, psgl::runGraphPartitions, fork() failed" << std::endl;
+          exit(1);
+        }
+
+        if (pid == 0)
+        {
+          for (auto fd : fds)
+            if (fd >= 0)
+              fcntl (fd, F_SETFD, 0);
+
+          execve ("/proc/self/exe", argv, envp.data());
+          _exit(127);
+        }
+
+        workers.push_back (pid);
+      }
+
+      //keep only the pipe ends used by partition 0
+      PartitionBoundary b;
+      b.forward = forward;
+      b.id = 0;
+      b.count = count;
+
+      {
+        auto fds = partitionFds (0);
+        b.recvFd = fds[1];
+        b.sendFd = fds[2];
+        b.resultFd = -1;
+
+        for (auto &p : dataPipes)
+          for (auto fd : p)
+            if (fd != b.recvFd && fd != b.sendFd)
+              close (fd);
+
+        b.resultFds.assign (count, -1);
+
+        for (int32_t i = 1; i < count; i++)
+        {
+          b.resultFds[i] = resultPipes[i][0];
+          close (resultPipes[i][1]);
+          close (jobPipes[i][0]);
+        }
+      }
+
+      //thread share of each partition
+      const int share = std::max (1, threads / count);
+
+      //send each worker its partition and job, one local graph is held at a time
+      for (int32_t i = 1; i < count; i++)
+      {
+        PartitionBoundary wb;
+        wb.forward = forward;
+        wb.id = i;
+        wb.count = count;
+
+        {
+          CSR_char_container local;
+          buildPartition (graph, cuts, wb, local);
+          writePartition (jobPipes[i][1], wb, local);
+        }
+
+        writeJob (jobPipes[i][1], share);
+        close (jobPipes[i][1]);
+      }
+
+      {
+        CSR_char_container local;
+        buildPartition (graph, cuts, b, local);
+
+        int maxThreads = omp_get_max_threads();
+        omp_set_num_threads (std::max (share, threads - share * (count - 1)));
+
+        alignLocal (local, b);
+
+        omp_set_num_threads (maxThreads);
+      }
+
+      //wait for all workers to finish
+      for (auto pid : workers)
+      {
+        int status;
+        waitpid (pid, &status, 0);
+
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        {
+          std::cerr << "ERROR, psgl::runGraphPartitions, partition process failed" << std::endl;
+          exit(1);
+        }
+      }
+
+      for (auto fd : b.resultFds)
+        if (fd >= 0)
+          close (fd);
+
+      if (b.recvFd >= 0) close (b.recvFd);
+      if (b.sendFd >= 0) close (b.sendFd);
+    }
+
+  /**
+   * @brief                     check if this process is a partition worker started by 
+   *                            runGraphPartitions, and receive its partition
+   * @param[out]  b             partition boundary, with its pipes
+   * @param[out]  local         local graph
+   * @return                    pipe to receive the job from, after the partition, 
+   *                            -1 if this process is not a partition worker
+   */
+  int partitionWorker(PartitionBoundary &b, CSR_char_container &local)
+  {
+    const char *var = std::getenv (partitionWorkerEnv);
+
+    if (var == nullptr)
+      return -1;
+
+    int jobFd;
+    char sep;
+    std::istringstream inputString (var);
+
+    if (!(inputString >> jobFd >> sep >> b.recvFd >> sep >> b.sendFd >> sep >> b.resultFd))
+    {
+      std::cerr << "ERROR, psgl::partitionWorker, invalid " << partitionWorkerEnv << " = " << var << std::endl;
+      exit(1);
+    }
+
+    readPartition (jobFd, b, local);
+    return jobFd;
+  }
+}
+
+#endif
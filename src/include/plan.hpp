@@ -0,0 +1,444 @@
+/**
+ * @file    plan.hpp
+ * @brief   cost model to predict peak memory and run time of an alignment run
+ *          before aligning, and to choose thread count under a memory limit
+ * @author  Chirag Jain <cjain7@gatech.edu>
+ */
+
+#ifndef PSGL_PLAN_HPP
+#define PSGL_PLAN_HPP
+
+#include <sys/resource.h>
+
+#include "csr_char.hpp"
+#include "base_types.hpp"
+#include "utils.hpp"
+
+namespace psgl
+{
+  /**
+   * @brief     read lengths of the query files, and first few reads
+   *            used to calibrate the cost model
+   */
+  struct ReadSample
+  {
+    std::vector<int32_t> lengths;       //lengths of all reads
+    std::vector<std::string> reads;     //first reads of the query files
+  };
+
+  /**
+   * @brief     DP cells computed per second by a single thread
+   * @details   phase 1 cells are counted for all SIMD lanes, including
+   *            padded lanes and padded rows
+   */
+  struct CellRates
+  {
+    double p1[3];     //phase 1 rate in int8, int16 and int32 precision (scalar, int32 only)
+    double p1r;       //phase 1-R rate in the precision used by calibration reads
+    double p2;        //phase 2 rate
+
+    CellRates() : p1{0, 0, 0}, p1r(0), p2(0) {}
+  };
+
+  /**
+   * @brief     graph properties which determine per-thread memory of phase 1
+   */
+  struct PlanGraphStats
+  {
+    int64_t numVertices;
+    int64_t numEdges;
+    std::size_t numComponents;
+    int64_t maxComponentWidth;
+    int64_t maxComponentLongHops;   //columns with out-edges of hop >= 'blockWidth', maximum over components
+    int64_t maxDegree;
+    int64_t maxHopLength;
+    int64_t longHopEdges;           //edges with hop >= 'blockWidth'
+    std::size_t graphBytes;         //size of graph arrays
+  };
+
+  /**
+   * @brief     predicted peak memory and time of a run in a score precision
+   */
+  struct PlanEstimate
+  {
+    int precision;          //score width in bytes
+    bool usable;            //maximum score of the reads fits in this precision
+    int threads;
+    double peakBytes;
+    double p1Time;          //predicted wall time (s) of phase 1, 1-R and 2
+    double p1rTime;
+    double p2Time;
+
+    double wallTime() const { return p1Time + p1rTime + p2Time; }
+  };
+
+  /**
+   * @brief     predicted costs in each precision, and recommended settings
+   */
+  struct RunPlan
+  {
+    std::vector<PlanEstimate> estimates;
+    std::size_t selected;           //index of estimate in the precision used by alignment
+    int threads;                    //recommended thread count
+    int shards;                     //recommended count of read shards, see -shard
+    std::size_t readsPerShard;
+  };
+
+  //DP block dimensions of vectorized phase 1, see Phase1_Vectorized
+  constexpr int planBlockWidth = 8;
+  constexpr int planBlockHeight = 16;
+
+  //bytes per vector register, a single int32 score in scalar mode
+#if defined(PASGAL_ENABLE_AVX512)
+  constexpr int planRegBytes = 64;
+#elif defined(PASGAL_ENABLE_AVX2)
+  constexpr int planRegBytes = 32;
+#else
+  constexpr int planRegBytes = 4;
+#endif
+
+  //bytes per read base held during alignment: input read, both strands of
+  //phase 1 and their SIMD layout, reversed read of phase 1-R and its SIMD
+  //layout, read of phase 2 and its cigar string
+  constexpr double planBytesPerBase = 9;
+
+  /**
+   * @brief                   peak resident memory of this process so far
+   * @return                  bytes
+   */
+  std::size_t peakRSS()
+  {
+    struct rusage usage;
+    getrusage (RUSAGE_SELF, &usage);
+
+    //ru_maxrss is in kilobytes on linux
+    return (std::size_t) usage.ru_maxrss * 1024;
+  }
+
+  /**
+   * @brief                   compute graph properties used by the cost model
+   * @param[in]   graph
+   */
+  PlanGraphStats graphStats (const CSR_char_container &graph)
+  {
+    PlanGraphStats s;
+
+    s.numVertices = graph.numVertices;
+    s.numEdges = graph.numEdges;
+    s.numComponents = graph.numComponents();
+    s.maxComponentWidth = graph.maxComponentWidth();
+
+    auto degreeHist = graph.degreeHistogram();
+    auto hopLengthHist = graph.hopLengthHistogram();
+
+    s.maxDegree = degreeHist.size() - 1;
+    s.maxHopLength = hopLengthHist.size() - 1;
+    s.longHopEdges = 0;
+
+    for (std::size_t i = planBlockWidth; i < hopLengthHist.size(); i++)
+      s.longHopEdges += hopLengthHist[i];
+
+    //count columns saved in long hop buffer, same as Phase1_Vectorized::computeLongHops
+    {
+      std::vector<bool> longHopSource (graph.numVertices, false);
+
+      for (int64_t i = 0; i < graph.numVertices; i++)
+        for (auto j = graph.offsets_in[i]; j < graph.offsets_in[i+1]; j++)
+          if (graph.adjcny_in[j] >= planBlockWidth)
+            longHopSource[i - graph.adjcny_in[j]] = true;
+
+      s.maxComponentLongHops = 0;
+
+      for (std::size_t c = 0; c < s.numComponents; c++)
+        s.maxComponentLongHops = std::max (s.maxComponentLongHops,
+            (int64_t) std::count (longHopSource.begin() + graph.componentOffsets[c], longHopSource.begin() + graph.componentOffsets[c+1], true));
+    }
+
+    s.graphBytes = graph.vertex_label.size()
+      + (graph.offsets_in.size() + graph.offsets_out.size()) * sizeof(int64_t)
+      + (graph.adjcny_in.size() + graph.adjcny_out.size()) * sizeof(int32_t)
+      + graph.componentOffsets.size() * sizeof(int64_t);
+
+    return s;
+  }
+
+  /**
+   * @brief                   build graph of the first columns, used to calibrate
+   *                          cell rates on a small graph with the same structure
+   * @param[in]   graph
+   * @param[in]   width       count of columns
+   * @param[out]  local
+   */
+  void windowGraph (const CSR_char_container &graph, int64_t width, CSR_char_container &local)
+  {
+    width = std::min (width, graph.numVertices);
+
+    local.numVertices = width;
+    local.vertex_label.assign (graph.vertex_label.begin(), graph.vertex_label.begin() + width);
+
+    //in-edges of the first columns begin within the window
+    local.offsets_in.assign (graph.offsets_in.begin(), graph.offsets_in.begin() + width + 1);
+    local.adjcny_in.assign (graph.adjcny_in.begin(), graph.adjcny_in.begin() + local.offsets_in.back());
+    local.numEdges = local.adjcny_in.size();
+
+    //out-edges are kept if they end within the window
+    local.offsets_out.assign (1, 0);
+    local.adjcny_out.clear();
+
+    for (int64_t i = 0; i < width; i++)
+    {
+      for (auto j = graph.offsets_out[i]; j < graph.offsets_out[i+1]; j++)
+        if (i + graph.adjcny_out[j] < width)
+          local.adjcny_out.push_back (graph.adjcny_out[j]);
+
+      local.offsets_out.push_back (local.adjcny_out.size());
+    }
+
+    local.componentOffsets = {0, width};
+  }
+
+  /**
+   * @brief                   predict peak memory and time of alignment in a precision
+   * @details                 reads are aligned in SIMD batches of similar lengths during phase 1,
+   *                          and each batch sweeps all graph columns. Phase 1-R is bounded likewise
+   *                          for a single strand. Phase 2 fills a matrix of read length squared int8
+   *                          cells per read, i.e., its graph window is assumed as wide as the read.
+   *                          Phases run one after another, so peak memory is the graph and reads,
+   *                          plus the larger of per-thread buffers of phase 1 and phase 2
+   * @param[in]   s           graph properties
+   * @param[in]   parameters
+   * @param[in]   lengths     read lengths, sorted in decreasing order
+   * @param[in]   rates       calibrated cell rates, time is not predicted if zero
+   * @param[in]   precision   score width in bytes
+   * @param[in]   threads
+   * @param[in]   baseBytes   memory before reads are loaded
+   */
+  PlanEstimate estimateRun (const PlanGraphStats &s,
+      const Parameters &parameters,
+      const std::vector<int32_t> &lengths,
+      const CellRates &rates,
+      int precision,
+      int threads,
+      double baseBytes)
+  {
+    PlanEstimate e;
+    e.precision = precision;
+    e.threads = threads;
+
+    const int lanes = planRegBytes / precision;
+
+    //maximum score should fit, see alignToDAGLocal
+    {
+      int64_t maxLength = lengths.empty() ? 0 : lengths.front();
+      maxLength += planBlockHeight - 1 - (maxLength - 1) % planBlockHeight;
+
+      int64_t maxScore = maxLength * parameters.match;
+      e.usable = precision == 4 || (precision == 2 && maxScore <= INT16_MAX) || (precision == 1 && maxScore <= INT8_MAX);
+    }
+
+    //reads and their results
+    double readBytes = 0;
+    for (auto len : lengths)
+      readBytes += len * planBytesPerBase + 6 * sizeof(std::string) + 3 * sizeof(BestScoreInfo) + sizeof(ContigInfo);
+
+    //phase 1 per-thread buffers
+    double p1ThreadBytes;
+    {
+#if defined(PASGAL_ENABLE_AVX512) || defined(PASGAL_ENABLE_AVX2)
+      const bool compressed = parameters.compressRowState && precision > 1 &&
+        planBlockHeight * (parameters.match + parameters.del) + 1 <= INT8_MAX && planBlockHeight * parameters.ins <= -INT8_MIN;
+
+      //last row of previous row block, long hop columns and recent columns
+      p1ThreadBytes = planRegBytes * ((compressed ? 1.0 : 2.0) * s.maxComponentWidth
+          + s.maxComponentLongHops * (compressed ? 1.0 : planBlockHeight) + planBlockWidth * planBlockHeight);
+
+      //int8 differences from the saved rows
+      if (compressed)
+        p1ThreadBytes += 1.0 * lanes * (s.maxComponentWidth + s.maxComponentLongHops * planBlockHeight);
+#else
+      //two rows of DP matrix
+      p1ThreadBytes = 2.0 * s.numVertices * sizeof(int32_t);
+#endif
+    }
+
+    //phase 2 per-thread buffers, for the longest reads running concurrently
+    double p2Bytes = 0;
+    for (std::size_t i = 0; i < lengths.size() && i < (std::size_t) threads; i++)
+      p2Bytes += (double) lengths[i] * (lengths[i] + sizeof(std::vector<int8_t>)) + 4.0 * sizeof(int32_t) * lengths[i];
+
+    //per-thread buffers of phase 1, and the slot index of long hop columns shared by threads
+    double p1Bytes = threads * p1ThreadBytes;
+#if defined(PASGAL_ENABLE_AVX512) || defined(PASGAL_ENABLE_AVX2)
+    p1Bytes += s.numVertices * sizeof(int32_t);
+#endif
+
+    e.peakBytes = baseBytes + readBytes + std::max (p1Bytes, p2Bytes);
+
+    //DP cells of each phase
+    double p1Cells = 0, p1rCells = 0, p2Cells = 0;
+    std::size_t p1Batches = 0, p1rBatches = 0;
+    {
+      //batches of similar lengths, both strands of a read are in the same batch in phase 1
+      auto batchCells = [&](int strands, std::size_t &batches) {
+        double cells = 0;
+
+        for (std::size_t i = 0; i < lengths.size() * strands; i += lanes, batches++)
+        {
+          int64_t len = lengths[i / strands];
+          len += planBlockHeight - 1 - (len - 1) % planBlockHeight;
+          cells += (double) lanes * len * s.numVertices;
+        }
+
+        return cells;
+      };
+
+      p1Cells = batchCells (2, p1Batches);
+      p1rCells = batchCells (1, p1rBatches);
+
+      for (auto len : lengths)
+        p2Cells += (double) len * len;
+    }
+
+    //work is divided among threads as (batch, component) pairs in phase 1, and reads in phase 2
+    auto phaseTime = [&](double cells, double rate, std::size_t workItems) {
+      return rate > 0 ? cells / (rate * std::max ((std::size_t) 1, std::min ((std::size_t) threads, workItems))) : 0;
+    };
+
+    const int rateIndex = precision == 1 ? 0 : (precision == 2 ? 1 : 2);
+
+    e.p1Time = phaseTime (p1Cells, rates.p1[rateIndex], p1Batches * s.numComponents);
+    e.p1rTime = phaseTime (p1rCells, rates.p1r * rates.p1[rateIndex] / std::max (rates.p1[0], 1.0), p1rBatches);
+    e.p2Time = phaseTime (p2Cells, rates.p2, lengths.size());
+
+    return e;
+  }
+
+  /**
+   * @brief                   predict costs in each precision, and recommend thread
+   *                          count and read shards to stay within memory limit
+   * @param[in]   parameters
+   * @param[in]   graph
+   * @param[in]   sample      read lengths
+   * @param[in]   rates       calibrated cell rates, time is not predicted if zero
+   * @param[in]   baseBytes   memory before reads are loaded
+   * @return                  predicted costs and recommended settings
+   */
+  RunPlan planRun (const Parameters &parameters,
+      const CSR_char_container &graph,
+      const ReadSample &sample,
+      const CellRates &rates,
+      double baseBytes)
+  {
+    auto s = graphStats (graph);
+
+    std::cout << "INFO, psgl::planRun, graph vertices = " << s.numVertices << ", edges = " << s.numEdges
+      << ", components = " << s.numComponents << ", max. component width = " << s.maxComponentWidth
+      << ", size (MB) = " << s.graphBytes / (1 << 20) << std::endl;
+    std::cout << "INFO, psgl::planRun, max. in-degree = " << s.maxDegree << ", max. hop length = " << s.maxHopLength
+      << ", long hop edges = " << s.longHopEdges << ", max. long hop columns per component = " << s.maxComponentLongHops << std::endl;
+
+    std::vector<int32_t> lengths (sample.lengths);
+    std::sort (lengths.begin(), lengths.end(), std::greater<int32_t>());
+
+    if (!lengths.empty())
+    {
+      double bases = std::accumulate (lengths.begin(), lengths.end(), 0.0);
+
+      std::cout << "INFO, psgl::planRun, reads = " << lengths.size() << ", bases = " << (int64_t) bases
+        << ", length min/median/max = " << lengths.back() << "/" << lengths[lengths.size() / 2] << "/" << lengths.front() << std::endl;
+    }
+
+    RunPlan plan;
+
+    //useful threads are bounded by phase 1 work items of the chosen precision
+    auto maxThreads = [&](const PlanEstimate &e) {
+      std::size_t batches = std::ceil (2.0 * lengths.size() * e.precision / planRegBytes);
+      return (int) std::max ((std::size_t) 1, std::min ((std::size_t) omp_get_num_procs(), batches * s.numComponents));
+    };
+
+#if defined(PASGAL_ENABLE_AVX512) || defined(PASGAL_ENABLE_AVX2)
+    std::vector<int> precisions {1, 2, 4};
+#else
+    std::vector<int> precisions {4};
+#endif
+
+    plan.selected = 0;
+
+    for (auto p : precisions)
+    {
+      plan.estimates.push_back (estimateRun (s, parameters, lengths, rates, p, parameters.threads, baseBytes));
+
+      //alignment uses the narrowest usable precision
+      if (!plan.estimates[plan.selected].usable)
+        plan.selected = plan.estimates.size() - 1;
+    }
+
+    auto precision = std::cout.precision (3);
+
+    for (auto &e : plan.estimates)
+    {
+      std::cout << "INFO, psgl::planRun, precision = int" << 8 * e.precision << (e.usable ? "" : " (score overflow)")
+        << ", threads = " << e.threads << ", predicted peak memory (GB) = " << e.peakBytes / (1 << 30);
+
+      if (rates.p2 > 0)
+        std::cout << ", predicted time (s) = " << e.wallTime() << " [phase 1 = " << e.p1Time
+          << ", phase 1-R = " << e.p1rTime << ", phase 2 = " << e.p2Time << "]";
+
+      std::cout << std::endl;
+    }
+
+    //recommend thread count, and lower it to fit in memory limit
+    {
+      auto &chosen = plan.estimates[plan.selected];
+      const double limit = parameters.maxMemory * (1 << 30);
+
+      //dry run recommends threads for this machine, otherwise given thread count is only lowered
+      plan.threads = parameters.dryRun ? maxThreads (chosen) : parameters.threads;
+      plan.shards = 1;
+
+      auto peak = [&](int threads, const std::vector<int32_t> &l) {
+        return estimateRun (s, parameters, l, rates, chosen.precision, threads, baseBytes).peakBytes;
+      };
+
+      if (limit > 0)
+      {
+        while (plan.threads > 1 && peak (plan.threads, lengths) > limit)
+          plan.threads--;
+
+        //split reads into shards, which hold fewer reads each
+        std::vector<int32_t> shard (lengths);
+
+        while (shard.size() > 1 && peak (plan.threads, shard) > limit)
+        {
+          plan.shards *= 2;
+
+          shard.clear();
+          for (std::size_t i = 0; i < lengths.size(); i += plan.shards)
+            shard.push_back (lengths[i]);
+        }
+
+        if (peak (1, std::vector<int32_t> (lengths.begin(), lengths.begin() + std::min (lengths.size(), (std::size_t) 1))) > limit)
+          std::cerr << "WARNING, psgl::planRun, graph and buffers of a single read exceed memory limit, consider -ooc or -cstate" << std::endl;
+      }
+
+      plan.readsPerShard = std::ceil (lengths.size() * 1.0 / plan.shards);
+
+      auto recommended = estimateRun (s, parameters, lengths, rates, chosen.precision, plan.threads, baseBytes);
+
+      std::cout << "INFO, psgl::planRun, recommended threads = " << plan.threads
+        << ", read shards = " << plan.shards << ", reads per shard = " << plan.readsPerShard
+        << ", SIMD batch = " << std::max (1, planRegBytes / chosen.precision) << " reads";
+
+      if (rates.p2 > 0)
+        std::cout << ", predicted time (s) = " << recommended.wallTime();
+
+      std::cout << std::endl;
+    }
+
+    std::cout.precision (precision);
+
+    return plan;
+  }
+}
+
+#endif
@@ -0,0 +1,134 @@
+/**
+ * @file    profile.hpp
+ * @brief   routines to log per-read alignment costs, and to save the
+ *          slowest reads as repro files (see replay.hpp)
+ * @author  Chirag Jain <cjain7@gatech.edu>
+ */
+
+#ifndef PSGL_PROFILE_HPP
+#define PSGL_PROFILE_HPP
+
+#include <fstream>
+#include <numeric>
+
+#include "base_types.hpp"
+#include "utils.hpp"
+
+namespace psgl
+{
+  /**
+   * @brief                   print cost of a read as tab-delimited columns
+   * @details                 DP cells and time (s) of phase 1, 1-R and 2
+   */
+  std::ostream& operator<<(std::ostream& os, const ReadCost &c)
+  {
+    os << c.p1Cells << "\t" << c.p1Time << "\t"
+      << c.p1rCells << "\t" << c.p1rTime << "\t"
+      << c.p2Cells << "\t" << c.p2Time;
+    return os;
+  }
+
+  /**
+   * @brief                           find the reads with maximum total alignment time
+   * @param[in]   outputBestScoreVector
+   * @param[in]   k
+   * @return                          indices of at most k slowest reads, slowest first
+   */
+  std::vector<std::size_t> slowestReads (const std::vector<BestScoreInfo> &outputBestScoreVector, std::size_t k)
+  {
+    std::vector<std::size_t> order (outputBestScoreVector.size());
+    std::iota (order.begin(), order.end(), 0);
+
+    k = std::min (k, order.size());
+
+    std::partial_sort (order.begin(), order.begin() + k, order.end(), [&](std::size_t a, std::size_t b) {
+        return outputBestScoreVector[a].cost.totalTime() > outputBestScoreVector[b].cost.totalTime();
+        });
+
+    order.resize (k);
+    return order;
+  }
+
+  /**
+   * @brief                           save costs of the slowest reads
+   * @details                         each line lists query id, query length, score,
+   *                                  total time (s) and the cost columns of the read
+   * @param[in]   filename
+   * @param[in]   slowest             indices of the slowest reads
+   * @param[in]   qmetadata           query sequence names and lengths
+   * @param[in]   outputBestScoreVector
+   */
+  void writeSlowReadLog (const std::string &filename,
+      const std::vector<std::size_t> &slowest,
+      const std::vector<ContigInfo> &qmetadata,
+      const std::vector<BestScoreInfo> &outputBestScoreVector)
+  {
+    std::ofstream outstrm(filename);
+
+    for (auto i : slowest)
+    {
+      auto &e = outputBestScoreVector[i];
+
+      outstrm << qmetadata[e.qryId].name << "\t"
+        << qmetadata[e.qryId].len << "\t"
+        << e.score << "\t"
+        << e.cost.totalTime() << "\t"
+        << e.cost << "\n";
+    }
+  }
+
+  /**
+   * @brief                           save a read with the graph window of its alignment,
+   *                                  to re-run its alignment in isolation
+   * @details                         file starts with header lines beginning with '#', which
+   *                                  save the read, scoring scheme and alignment. It is followed by
+   *                                  the window of graph columns [refColumnStart, refColumnEnd]
+   *                                  in .txt graph format, with one vertex per column
+   * @param[in]   filename
+   * @param[in]   parameters          input parameters
+   * @param[in]   info                query name and length
+   * @param[in]   read                query sequence, as given in the input
+   * @param[in]   e                   alignment of the read
+   * @param[in]   graph
+   */
+  template <typename Graph>
+    void writeReproFile (const std::string &filename,
+        const Parameters &parameters,
+        const ContigInfo &info,
+        const std::string &read,
+        const BestScoreInfo &e,
+        const Graph &graph)
+    {
+      std::ofstream outstrm(filename);
+
+      outstrm << "#PaSGAL repro\n"
+        << "#read\t" << info.name << "\n"
+        << "#sequence\t" << read << "\n"
+        << "#scoring\t" << parameters.match << " " << parameters.mismatch << " " << parameters.ins << " " << parameters.del << "\n"
+        << "#alignment\t" << e.score << " " << e.strand << " " << e.cigar << "\n"
+        << "#window\t" << e.refColumnStart << " " << e.refColumnEnd << "\n";
+
+      const int64_t j0 = e.refColumnStart;
+      const int64_t width = e.refColumnEnd - e.refColumnStart + 1;
+
+      //out-neighbors of columns within window
+      std::vector< std::vector<int64_t> > outNeighbors (width);
+
+      for (int64_t j = 0; j < width; j++)
+        for (auto k = graph.offsets_in[j + j0]; k < graph.offsets_in[j + j0 + 1]; k++)
+          if (graph.adjcny_in[k] <= j)
+            outNeighbors[j - graph.adjcny_in[k]].push_back (j);
+
+      outstrm << width << "\n";
+
+      for (int64_t j = 0; j < width; j++)
+      {
+        for (auto v : outNeighbors[j])
+          outstrm << v << " ";
+
+        outstrm << graph.vertex_label[j + j0] << "\n";
+      }
+    }
+}
+
+#endif
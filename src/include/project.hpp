@@ -0,0 +1,380 @@
+/**
+ * @file    project.hpp
+ * @brief   projection of graph alignments onto a linear reference path,
+ *          and SAM/BAM output through htslib
+ * @author  Chirag Jain <cjain7@gatech.edu>
+ */
+
+#ifndef PSGL_PROJECT_HPP
+#define PSGL_PROJECT_HPP
+
+#include <sstream>
+#include <algorithm>
+
+#include "base_types.hpp"
+#include "utils.hpp"
+#include "graphLoad.hpp"
+
+//External includes
+#include "htslib/sam.h"
+
+namespace psgl
+{
+  /**
+   * @brief     index from graph columns to positions on a reference path
+   */
+  class PathIndex
+  {
+    public:
+
+      std::string name;
+
+      //count of path positions
+      int64_t length;
+
+      //0-based path position of each graph column, -1 if the column is not on the path
+      std::vector<int64_t> columnPosition;
+
+      //0-based path position of each graph column holding the reverse complement 
+      //of a path base, -1 if none
+      std::vector<int64_t> reversePosition;
+
+      /**
+       * @brief                 build index of a path
+       * @details               step lengths are prefix summed, and steps are mapped
+       *                        in parallel. In a bi-directed graph, a '-' step maps
+       *                        to the reverse complemented vertex, and the vertex of the
+       *                        opposite strand maps to mirrored positions in reversePosition. 
+       *                        Graphs without both strands only hold forward labels, so 
+       *                        '-' steps are only mapped in reversePosition
+       * @param[in]   graph
+       * @param[in]   path
+       */
+      template <typename Graph>
+        void build (const Graph &graph, const GraphPath &path)
+        {
+          name = path.name;
+          columnPosition.assign (graph.numVertices, -1);
+          reversePosition.assign (graph.numVertices, -1);
+
+          //sequence graph vertex of each original id
+          std::vector<int64_t> vertexOf;
+
+          for (int64_t v = 0; graph.vertexStart[v] < graph.numVertices; v++)
+          {
+            auto id = graph.vertexOriginalId[v];
+
+            if (id >= (int64_t) vertexOf.size())
+              vertexOf.resize (id + 1, -1);
+
+            vertexOf[id] = v;
+          }
+
+          auto vertex = [&](int64_t id) { return id >= 0 && id < (int64_t) vertexOf.size() ? vertexOf[id] : -1; };
+
+          //vertices holding each step in path orientation, and in opposite orientation
+          const std::size_t steps = path.vertices.size();
+          std::vector<int64_t> stepVertex (steps, -1), oppositeVertex (steps, -1), stepStart (steps + 1, 0);
+
+          for (std::size_t i = 0; i < steps; i++)
+          {
+            int64_t id = path.vertices[i];
+
+            if (graph.strandVertices > 0)
+            {
+              stepVertex[i] = vertex (path.reverse[i] ? id + graph.strandVertices : id);
+              oppositeVertex[i] = vertex (path.reverse[i] ? id : id + graph.strandVertices);
+            }
+            else if (path.reverse[i])
+              oppositeVertex[i] = vertex (id);
+            else
+              stepVertex[i] = vertex (id);
+
+            auto v = std::max (stepVertex[i], oppositeVertex[i]);
+
+            if (v < 0)
+            {
+              std::cerr << "ERROR, psgl::PathIndex::build, step " << i << " of path " << name << " is not a graph vertex" << std::endl;
+              exit(1);
+            }
+
+            stepStart[i + 1] = stepStart[i] + graph.vertexStart[v + 1] - graph.vertexStart[v];
+          }
+
+          length = stepStart[steps];
+
+#pragma omp parallel for schedule(dynamic, 1024)
+          for (std::size_t i = 0; i < steps; i++)
+          {
+            if (stepVertex[i] >= 0)
+              for (auto j = graph.vertexStart[stepVertex[i]]; j < graph.vertexStart[stepVertex[i] + 1]; j++)
+                columnPosition[j] = stepStart[i] + j - graph.vertexStart[stepVertex[i]];
+
+            if (oppositeVertex[i] >= 0)
+              for (auto j = graph.vertexStart[oppositeVertex[i]]; j < graph.vertexStart[oppositeVertex[i] + 1]; j++)
+                reversePosition[j] = stepStart[i + 1] - 1 - (j - graph.vertexStart[oppositeVertex[i]]);
+          }
+
+          std::cout << "INFO, psgl::PathIndex::build, path = " << name << ", steps = " << steps << ", length = " << length << std::endl;
+        }
+  };
+
+  /**
+   * @brief     alignment projected onto a reference path, see projectAlignment()
+   */
+  struct SamRecord
+  {
+    std::string name;
+    uint16_t flag;
+    int64_t pos;                    //0-based leftmost path position, -1 if unmapped
+    std::vector<uint32_t> cigar;    //operations encoded by bam_cigar_gen
+    std::string seq;                //read sequence along the path strand
+    int32_t score;
+  };
+
+  /**
+   * @brief                   project an alignment onto a reference path as a SAM record
+   * @details                 the alignment is projected onto the path strand holding most
+   *                          of its matches and mismatches. On the reverse strand, operations
+   *                          are reversed and the read reverse complemented, so that positions
+   *                          increase along the path. Matches and mismatches at columns on
+   *                          the path keep their operation, and path positions skipped between 
+   *                          them become deletions. Read bases aligned off the path become 
+   *                          insertions, or soft clips at the ends. Reads without any base on 
+   *                          the path are reported as unmapped
+   * @param[in]   index
+   * @param[in]   info        query name and length
+   * @param[in]   read        query sequence, as given in the input
+   * @param[in]   e           alignment of the read, with graph columns of its operations
+   */
+  SamRecord projectAlignment (const PathIndex &index,
+      const ContigInfo &info,
+      const std::string &read,
+      const BestScoreInfo &e)
+  {
+    SamRecord record;
+    record.name = info.name;
+    record.flag = 4;
+    record.pos = -1;
+    record.seq = read;
+    record.score = e.score;
+
+    //read as aligned in phase 2
+    std::string seq (read);
+    if (e.strand == '-')
+      psgl::seqUtils::reverseComplement (read, seq);
+
+    //expand cigar string into one operation per column
+    std::string ops;
+    {
+      std::size_t count = 0;
+
+      for (auto c : e.cigar)
+      {
+        if (isdigit(c))
+          count = count * 10 + (c - '0');
+        else
+        {
+          ops.append (count, c);
+          count = 0;
+        }
+      }
+    }
+
+    if (e.score <= 0 || e.overrun || ops.size() != e.columns.size())
+      return record;
+
+    //path strand of the alignment, by its bases on either strand
+    int64_t forwardBases = 0, reverseBases = 0;
+
+    for (std::size_t k = 0; k < ops.size(); k++)
+    {
+      if (ops[k] == '=' || ops[k] == 'X')
+      {
+        forwardBases += index.columnPosition[ e.columns[k] ] >= 0;
+        reverseBases += index.reversePosition[ e.columns[k] ] >= 0;
+      }
+    }
+
+    bool reverse = reverseBases > forwardBases;
+    const auto &position = reverse ? index.reversePosition : index.columnPosition;
+
+    //alignment ends at qryRowEnd, and begins where its operations consuming the read do
+    int64_t consumed = std::count_if (ops.begin(), ops.end(), [](char c) { return c != 'D'; });
+    int64_t rowBegin = e.qryRowEnd + 1 - consumed;
+
+    std::vector<int64_t> columns (e.columns);
+
+    if (reverse)
+    {
+      std::reverse (ops.begin(), ops.end());
+      std::reverse (columns.begin(), columns.end());
+      std::string aligned (seq);
+      psgl::seqUtils::reverseComplement (aligned, seq);
+      rowBegin = seq.length() - 1 - e.qryRowEnd;
+    }
+
+    //linear operations, and path positions of first and last aligned base
+    std::string linear;
+    int64_t first = -1, last = -1;
+
+    for (std::size_t k = 0; k < ops.size(); k++)
+    {
+      auto pos = position[ columns[k] ];
+
+      //positions along the path should increase, as columns do
+      if (pos >= 0 && pos <= last)
+        pos = -1;
+
+      switch (ops[k])
+      {
+        case '=' : case 'X' :
+          if (pos < 0)
+            linear.push_back ('I');
+          else
+          {
+            if (last >= 0)
+              linear.append (pos - last - 1, 'D');
+            else
+              first = pos;
+
+            linear.push_back (ops[k]);
+            last = pos;
+          }
+          break;
+
+        case 'D' :
+          if (pos >= 0 && last >= 0)
+          {
+            linear.append (pos - last, 'D');
+            last = pos;
+          }
+          break;
+
+        default :
+          linear.push_back ('I');
+      }
+    }
+
+    if (first < 0)
+      return record;
+
+    //insertions at the ends are clipped, and deletions after the last aligned base dropped
+    int64_t lead = linear.find_first_not_of ('I'), trail = 0;
+
+    while (linear.back() == 'I' || linear.back() == 'D')
+    {
+      trail += linear.back() == 'I';
+      linear.pop_back();
+    }
+
+    linear.erase (0, lead);
+
+    int64_t clipStart = rowBegin + lead;
+    int64_t clipEnd = seq.length() - (rowBegin + consumed) + trail;
+
+    if (clipStart > 0)
+      record.cigar.push_back (bam_cigar_gen (clipStart, BAM_CSOFT_CLIP));
+
+    for (std::size_t k = 0; k < linear.size(); )
+    {
+      auto l = linear.find_first_not_of (linear[k], k);
+      l = (l == std::string::npos ? linear.size() : l);
+
+      int op = linear[k] == '=' ? BAM_CEQUAL : linear[k] == 'X' ? BAM_CDIFF : linear[k] == 'D' ? BAM_CDEL : BAM_CINS;
+      record.cigar.push_back (bam_cigar_gen (l - k, op));
+      k = l;
+    }
+
+    if (clipEnd > 0)
+      record.cigar.push_back (bam_cigar_gen (clipEnd, BAM_CSOFT_CLIP));
+
+    record.flag = ((e.strand == '-') != reverse) ? 16 : 0;
+    record.pos = first;
+    record.seq = seq;
+
+    return record;
+  }
+
+  /**
+   * @brief     writes SAM/BAM records through htslib
+   */
+  class SamWriter
+  {
+    private:
+
+      samFile *fp;
+      sam_hdr_t *hdr;
+      bam1_t *b;
+
+    public:
+
+      /**
+       * @brief                   open output file, and write its header
+       * @param[in]   filename    BAM output if name ends with ".bam", SAM otherwise
+       * @param[in]   index       reference path
+       * @param[in]   threads     threads for BAM compression
+       */
+      SamWriter (const std::string &filename, const PathIndex &index, int threads)
+      {
+        bool bam = filename.size() >= 4 && filename.compare (filename.size() - 4, 4, ".bam") == 0;
+
+        fp = sam_open (filename.c_str(), bam ? "wb" : "w");
+
+        if (fp == nullptr)
+        {
+          std::cerr << "ERROR, psgl::SamWriter, failed to open " << filename << std::endl;
+          exit(1);
+        }
+
+        if (bam && threads > 1)
+          hts_set_threads (fp, threads);
+
+        std::ostringstream header;
+        header << "@HD\tVN:1.6\tSO:unknown\n"
+          << "@SQ\tSN:" << index.name << "\tLN:" << index.length << "\n"
+          << "@PG\tID:PaSGAL\tPN:PaSGAL\n";
+
+        hdr = sam_hdr_init();
+        b = bam_init1();
+
+        auto text = header.str();
+
+        if (sam_hdr_add_lines (hdr, text.c_str(), text.size()) < 0 || sam_hdr_write (fp, hdr) < 0)
+        {
+          std::cerr << "ERROR, psgl::SamWriter, failed to write header of " << filename << std::endl;
+          exit(1);
+        }
+      }
+
+      /**
+       * @brief                   write records, unmapped records without alignment score
+       * @param[in]   records
+       */
+      void write (const std::vector<SamRecord> &records)
+      {
+        for (auto &r : records)
+        {
+          bool mapped = r.pos >= 0;
+
+          if (bam_set1 (b, r.name.size(), r.name.c_str(), r.flag, mapped ? 0 : -1, r.pos, mapped ? 255 : 0,
+                r.cigar.size(), r.cigar.data(), -1, -1, 0, r.seq.size(), r.seq.c_str(), NULL, mapped ? 7 : 0) < 0
+              || (mapped && bam_aux_append (b, "AS", 'i', 4, (const uint8_t *) &r.score) < 0)
+              || sam_write1 (fp, hdr, b) < 0)
+          {
+            std::cerr << "ERROR, psgl::SamWriter, failed to write record of read " << r.name << std::endl;
+            exit(1);
+          }
+        }
+      }
+
+      ~SamWriter ()
+      {
+        bam_destroy1 (b);
+        sam_hdr_destroy (hdr);
+        sam_close (fp);
+      }
+  };
+}
+
+#endif
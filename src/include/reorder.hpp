@@ -0,0 +1,113 @@
+/**
+ * @file    reorder.hpp
+ * @brief   reorder buffer which collects batches completed in any order,
+ *          and releases them to the output stage in input order
+ * @author  Chirag Jain <cjain7@gatech.edu>
+ */
+
+#ifndef PSGL_REORDER_HPP
+#define PSGL_REORDER_HPP
+
+#include <map>
+#include <mutex>
+#include <condition_variable>
+
+namespace psgl
+{
+
+  /**
+   * @brief     reorder buffer of batches, identified by consecutive sequence ids
+   * @details   producers wait before starting a batch which is a window (or more)
+   *            ahead of the count of released batches, so that at most window batches
+   *            are being aligned or held at a time. In unordered mode, batches are
+   *            released as soon as they complete, and the same window applies, as
+   *            sequence ids are handed to producers in increasing order
+   */
+  template <typename T>
+    class ReorderBuffer
+    {
+      private:
+
+        std::mutex mtx;
+        std::condition_variable cv;
+
+        //completed batches not yet released
+        std::map<std::size_t, T> pending;
+
+        //sequence id of next batch to release in ordered mode, i.e.,
+        //first sequence id plus the count of released batches
+        std::size_t next;
+
+        //first sequence id after the last batch
+        std::size_t end;
+
+        std::size_t window;
+        bool ordered;
+
+      public:
+
+        /**
+         * @param[in]   first     sequence id of first batch
+         * @param[in]   end       sequence id after the last batch
+         * @param[in]   window    maximum count of batches in flight
+         * @param[in]   ordered   release batches in input order
+         */
+        ReorderBuffer (std::size_t first, std::size_t end, std::size_t window, bool ordered) :
+          next (first), end (end), window (std::max<std::size_t> (window, 1)), ordered (ordered)
+        {}
+
+        /**
+         * @brief                 wait until a batch can be started within window
+         * @param[in]   seq
+         */
+        void acquire (std::size_t seq)
+        {
+          std::unique_lock<std::mutex> lock (mtx);
+          cv.wait (lock, [&]{ return seq < next + window; });
+        }
+
+        /**
+         * @brief                 save a completed batch
+         * @param[in]   seq
+         * @param[in]   item
+         */
+        void push (std::size_t seq, T &&item)
+        {
+          {
+            std::lock_guard<std::mutex> lock (mtx);
+            pending.emplace (seq, std::move (item));
+          }
+
+          cv.notify_all();
+        }
+
+        /**
+         * @brief                 wait for the next batch to release
+         * @param[out]  seq
+         * @param[out]  item
+         * @return                false if all batches have been released
+         */
+        bool pop (std::size_t &seq, T &item)
+        {
+          std::unique_lock<std::mutex> lock (mtx);
+
+          if (next == end)
+            return false;
+
+          cv.wait (lock, [&]{ return !pending.empty() && (!ordered || pending.begin()->first == next); });
+
+          auto it = pending.begin();
+          seq = it->first;
+          item = std::move (it->second);
+          pending.erase (it);
+          next++;
+
+          lock.unlock();
+          cv.notify_all();
+
+          return true;
+        }
+    };
+}
+
+#endif
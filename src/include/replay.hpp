@@ -0,0 +1,114 @@
+/**
+ * @file    replay.hpp
+ * @brief   routines to re-run the alignment of a read saved in a repro file
+ * @author  Chirag Jain <cjain7@gatech.edu>
+ */
+
+#ifndef PSGL_REPLAY_HPP
+#define PSGL_REPLAY_HPP
+
+#include <fstream>
+#include <sstream>
+
+#include "base_types.hpp"
+#include "utils.hpp"
+#include "graphLoad.hpp"
+#include "align.hpp"
+#include "profile.hpp"
+
+namespace psgl
+{
+  /**
+   * @brief                   align the read of a repro file (see writeReproFile)
+   *                          against its graph window, and report costs of each run
+   * @param[in]   param
+   * @return                  alignments of all runs
+   **/
+  std::vector<BestScoreInfo> replayRead(const ReplayParameters &param)
+  {
+    if( !fileExists(param.reproFile) )
+    {
+      std::cerr << param.reproFile << " not accessible." << std::endl;
+      exit(1);
+    }
+
+    ContigInfo info;
+    std::string read, alignment;
+
+    Parameters parameters;
+    parameters.validation = VALIDATE_FULL;
+
+    //parse header lines
+    {
+      std::ifstream infile(param.reproFile);
+      std::string line;
+
+      while (std::getline (infile, line) && !line.empty() && line[0] == '#')
+      {
+        auto tab = line.find('\t');
+
+        if (tab == std::string::npos)
+          continue;
+
+        auto key = line.substr(1, tab - 1);
+        std::istringstream inputString (line.substr(tab + 1));
+
+        if (key == "read")
+          inputString >> info.name;
+        else if (key == "sequence")
+          inputString >> read;
+        else if (key == "scoring")
+          inputString >> parameters.match >> parameters.mismatch >> parameters.ins >> parameters.del;
+        else if (key == "alignment")
+          alignment = line.substr(tab + 1);
+      }
+    }
+
+    if (read.empty())
+    {
+      std::cerr << "ERROR, psgl::replayRead, no read sequence found in " << param.reproFile << std::endl;
+      exit(1);
+    }
+
+    info.len = read.length();
+
+    std::cout << "INFO, psgl::replayRead, read = " << info.name << ", length = " << info.len << std::endl;
+    std::cout << "INFO, psgl::replayRead, saved alignment (score, strand, cigar) = " << alignment << std::endl;
+
+    //single read is aligned, thread count of the caller is restored on return
+    int maxThreads = omp_get_max_threads();
+    omp_set_num_threads(1);
+
+    psgl::graphLoader g;
+    g.verifyGraph = true;
+    g.loadFromTxt (param.reproFile);
+
+    std::vector<BestScoreInfo> runs;
+
+    for (int r = 0; r < param.repeats; r++)
+    {
+      std::vector<BestScoreInfo> outputBestScoreVector;
+      alignToDAGLocal (std::vector<std::string> (1, read), g.diCharGraph, parameters, outputBestScoreVector);
+
+      auto &e = outputBestScoreVector[0];
+
+      std::cout << "INFO, psgl::replayRead, run " << r + 1 << ", score = " << e.score << ", strand = " << e.strand
+        << ", cigar = " << e.cigar << ", costs (cells, s) = " << e.cost << std::endl;
+
+      if (e.invalid)
+        std::cerr << "WARNING, psgl::replayRead, validation failed, " << e.invalid << std::endl;
+
+      runs.push_back (e);
+    }
+
+    //the window contains the saved alignment, so the best score should be reproduced
+    if (!alignment.empty() && std::stoi (alignment) != runs[0].score)
+      std::cerr << "WARNING, psgl::replayRead, score differs from the saved alignment" << std::endl;
+
+    omp_set_num_threads(maxThreads);
+
+    return runs;
+  }
+}
+
+#endif
@@ -0,0 +1,631 @@
+/**
+ * @file    rescore.hpp
+ * @brief   routines to rescore given graph alignments without dynamic programming
+ * @author  Chirag Jain <cjain7@gatech.edu>
+ */
+
+#ifndef PSGL_RESCORE_HPP
+#define PSGL_RESCORE_HPP
+
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+
+#include "base_types.hpp"
+#include "utils.hpp"
+#include "graphLoad.hpp"
+#include "align.hpp"
+
+namespace psgl
+{
+  /**
+   * @brief     spells sequences of paths given as oriented vertex names
+   *            (GAF format) over a character labeled graph
+   * @details   vertex names are GFA segment names, or vertex ids for .vg
+   *            and .txt graphs. Reverse oriented vertices are read from the
+   *            reverse complement strand if the graph has one, and are
+   *            reverse complemented on the fly otherwise
+   */
+  class gafPathWalker
+  {
+    private:
+
+      const CSR_char_container &graph;
+
+      //first column and label length of each input graph vertex (both strands),
+      //indexed by original vertex id
+      std::vector<int64_t> vertexColumn;
+      std::vector<int32_t> vertexLength;
+
+      //count of vertices in the input graph
+      int32_t inputVertices;
+
+      //vertex id of each GFA segment name, empty for other formats
+      std::unordered_map<std::string, int32_t> segmentId;
+
+      /**
+       * @brief   path step resolved to graph columns
+       */
+      struct Step
+      {
+        int64_t firstColumn;
+        int32_t length;
+        bool complemented;    //columns are read backwards and complemented
+      };
+
+    public:
+
+      /**
+       * @brief             constructor
+       * @param[in]   g     loaded graph
+       */
+      gafPathWalker(const graphLoader &g) : graph (g.diCharGraph)
+      {
+        auto n = graph.vertexOriginalId.size();
+
+        vertexColumn.resize (n);
+        vertexLength.resize (n);
+
+        for (std::size_t k = 0; k < n; k++)
+        {
+          vertexColumn[graph.vertexOriginalId[k]] = graph.vertexStart[k];
+          vertexLength[graph.vertexOriginalId[k]] = graph.vertexStart[k+1] - graph.vertexStart[k];
+        }
+
+        inputVertices = graph.strandVertices > 0 ? graph.strandVertices : n;
+
+        for (int32_t i = 0; i + 1 < (int32_t) graph.segmentNameStart.size(); i++)
+          segmentId.emplace (g.segmentName(i), i);
+      }
+
+      /**
+       * @brief                   spell the sequence of a path
+       * @param[in]   path        path in GAF format, e.g., ">s1<s2", or a single vertex name
+       * @param[in]   pathLength  expected length of the path sequence
+       * @param[in]   begin       0-based start offset in the path sequence
+       * @param[in]   end         end offset (exclusive)
+       * @param[out]  seq         path sequence in [begin, end)
+       * @param[out]  error       reason if the path is invalid
+       * @return                  false if the path is invalid
+       * @details                 consecutive steps are checked to be connected by edges
+       */
+      bool pathSequence(const std::string &path, int64_t pathLength, int64_t begin, int64_t end,
+                        std::string &seq, std::string &error) const
+      {
+        std::vector<Step> steps;
+
+        if (!parseSteps (path, steps, error))
+          return false;
+
+        //edges between consecutive steps
+        for (std::size_t i = 0; i + 1 < steps.size(); i++)
+        {
+          auto &a = steps[i];
+          auto &b = steps[i+1];
+
+          bool connected;
+
+          if (a.complemented != b.complemented)
+            connected = false;
+          else if (!a.complemented)
+            connected = edgeExists (a.firstColumn + a.length - 1, b.firstColumn);
+          else  //(a-, b-) is the edge from b+ to a+
+            connected = edgeExists (b.firstColumn + b.length - 1, a.firstColumn);
+
+          if (!connected)
+          {
+            error = "no edge between steps " + std::to_string(i) + " and " + std::to_string(i+1) + " of path " + path;
+            return false;
+          }
+        }
+
+        int64_t totalLength = 0;
+        for (auto &s : steps)
+          totalLength += s.length;
+
+        if (totalLength != pathLength || begin < 0 || begin > end || end > pathLength)
+        {
+          error = "path length or offsets do not match path " + path;
+          return false;
+        }
+
+        seq.clear();
+        seq.reserve (end - begin);
+
+        //offset of current step in path sequence
+        int64_t offset = 0;
+
+        for (auto &s : steps)
+        {
+          int64_t from = std::max (begin - offset, (int64_t) 0);
+          int64_t to = std::min (end - offset, (int64_t) s.length);
+
+          for (int64_t k = from; k < to; k++)
+          {
+            if (s.complemented)
+              seq.push_back (seqUtils::complement (graph.vertex_label[s.firstColumn + s.length - 1 - k]));
+            else
+              seq.push_back (graph.vertex_label[s.firstColumn + k]);
+          }
+
+          offset += s.length;
+        }
+
+        return true;
+      }
+
+    private:
+
+      /**
+       * @brief                   resolve oriented vertex names of a path
+       * @return                  false if a vertex is unknown
+       */
+      bool parseSteps(const std::string &path, std::vector<Step> &steps, std::string &error) const
+      {
+        //a single vertex name without orientation is a forward step
+        bool oriented = !path.empty() && (path[0] == '>' || path[0] == '<');
+
+        for (std::size_t i = 0; i < path.length(); )
+        {
+          bool reverse = oriented && path[i] == '<';
+          std::size_t nameBegin = oriented ? i + 1 : i;
+          std::size_t nameEnd = oriented ? path.find_first_of ("<>", nameBegin) : path.length();
+
+          if (nameEnd == std::string::npos)
+            nameEnd = path.length();
+
+          int32_t v;
+          if (!vertexId (path.substr (nameBegin, nameEnd - nameBegin), v))
+          {
+            error = "unknown vertex " + path.substr (nameBegin, nameEnd - nameBegin) + " in path " + path;
+            return false;
+          }
+
+          if (reverse && graph.strandVertices > 0)
+            steps.push_back (Step {vertexColumn[v + graph.strandVertices], vertexLength[v + graph.strandVertices], false});
+          else
+            steps.push_back (Step {vertexColumn[v], vertexLength[v], reverse});
+
+          i = nameEnd;
+        }
+
+        if (steps.empty())
+        {
+          error = "empty path";
+          return false;
+        }
+
+        return true;
+      }
+
+      /**
+       * @brief                   find vertex id of a name
+       * @return                  false if the vertex is unknown
+       */
+      bool vertexId(const std::string &name, int32_t &v) const
+      {
+        if (!segmentId.empty())
+        {
+          auto it = segmentId.find (name);
+
+          if (it == segmentId.end())
+            return false;
+
+          v = it->second;
+          return true;
+        }
+
+        if (name.empty() || name.length() > 10 || name.find_first_not_of ("0123456789") != std::string::npos)
+          return false;
+
+        int64_t id = std::strtoll (name.c_str(), nullptr, 10);
+
+        if (id >= inputVertices)
+          return false;
+
+        v = id;
+        return true;
+      }
+
+      /**
+       * @brief                   check existence of edge between two columns
+       */
+      bool edgeExists(int64_t from, int64_t to) const
+      {
+        for (auto j = graph.offsets_out[from]; j < graph.offsets_out[from + 1]; j++)
+          if (from + graph.adjcny_out[j] == to)
+            return true;
+
+        return false;
+      }
+  };
+
+  /**
+   * @brief                   score an alignment by walking its cigar over read and path sequences
+   * @param[in]   cigar       operations M, =, X, I and D
+   * @param[in]   read        aligned read sequence, in path orientation
+   * @param[in]   ref         aligned path sequence
+   * @param[in]   param       scoring scheme
+   * @param[out]  score
+   * @param[out]  eqxCigar    cigar where matches and mismatches are distinguished (=/X)
+   * @return                  false if the cigar does not span both sequences exactly, or if
+   *                          an operation has no length
+   */
+  bool rescoreCigar(const std::string &cigar, const std::string &read, const std::string &ref,
+                    const Parameters &param, int32_t &score, std::string &eqxCigar)
+  {
+    score = 0;
+    eqxCigar.clear();
+
+    std::size_t i = 0, j = 0;   //offsets in read and ref
+    int64_t count = 0;
+    bool digits = false;        //length of current operation is given
+
+    //run of the last operation in eqxCigar
+    char runOp = 0;
+    int64_t runLength = 0;
+
+    auto extend = [&](char op, int64_t len) {
+      if (op != runOp && runLength > 0)
+      {
+        eqxCigar += std::to_string(runLength) + runOp;
+        runLength = 0;
+      }
+
+      runOp = op;
+      runLength += len;
+    };
+
+    for (char c : cigar)
+    {
+      if (c >= '0' && c <= '9')
+      {
+        count = count * 10 + (c - '0');
+        digits = true;
+
+        //operation can not be longer than the aligned sequences
+        if (count > (int64_t) (read.length() + ref.length()))
+          return false;
+
+        continue;
+      }
+
+      if (!digits)
+        return false;
+
+      if (c == 'M' || c == '=' || c == 'X')
+      {
+        if (i + count > read.length() || j + count > ref.length())
+          return false;
+
+        for (int64_t k = 0; k < count; k++, i++, j++)
+        {
+          bool match = read[i] == ref[j];
+          score += match ? param.match : -param.mismatch;
+          extend (match ? '=' : 'X', 1);
+        }
+      }
+      else if (c == 'I')
+      {
+        if (i + count > read.length())
+          return false;
+
+        score -= param.ins * count;
+        extend ('I', count);
+        i += count;
+      }
+      else if (c == 'D')
+      {
+        if (j + count > ref.length())
+          return false;
+
+        score -= param.del * count;
+        extend ('D', count);
+        j += count;
+      }
+      else
+        return false;
+
+      count = 0;
+      digits = false;
+    }
+
+    if (runLength > 0)
+      eqxCigar += std::to_string(runLength) + runOp;
+
+    return i == read.length() && j == ref.length() && !digits;
+  }
+
+  /**
+   * @brief     reads of a query file, loaded one batch at a time and looked up by name
+   * @details   aligners write GAF records in the order of reads in the query file, so
+   *            the next batch replaces the current one when a record refers to a later
+   *            read. If a read is not found before the end of file, the file is read
+   *            again from its beginning, so records in any order are supported, at the
+   *            cost of another pass over the query file
+   */
+  class queryWindow
+  {
+    private:
+
+      std::string qfile;
+      std::size_t batchReads;
+
+      FILE *file = nullptr;
+      gzFile fp;
+      kseq_t *seq = nullptr;
+
+      //reads of the current batch by name, first read is kept if names repeat
+      std::unordered_map<std::string, std::string> reads;
+
+      void open()
+      {
+        file = fopen (qfile.c_str(), "r");
+
+        if (file == nullptr)
+        {
+          std::cerr << qfile << " not accessible." << std::endl;
+          exit(1);
+        }
+
+        fp = gzdopen (fileno(file), "r");
+        seq = kseq_init(fp);
+      }
+
+      void close()
+      {
+        if (seq != nullptr)
+        {
+          kseq_destroy(seq);  
+          gzclose(fp);
+          fclose(file);
+          seq = nullptr;
+        }
+      }
+
+      /**
+       * @brief             replace current batch with the next reads of the file
+       * @return            false if the end of file is reached before any read
+       */
+      bool nextBatch()
+      {
+        reads.clear();
+
+        int len;
+        while (reads.size() < batchReads && (len = kseq_read(seq)) >= 0)
+        {
+          psgl::seqUtils::makeUpperCase(seq->seq.s, len);
+          reads.emplace (seq->name.s, seq->seq.s);
+        }
+
+        return !reads.empty();
+      }
+
+    public:
+
+      /**
+       * @brief                   constructor
+       * @param[in]   qfile       query file
+       * @param[in]   batchReads  count of reads per batch
+       */
+      queryWindow(const std::string &qfile, std::size_t batchReads) : qfile (qfile), batchReads (batchReads)
+      {
+        open();
+        nextBatch();
+      }
+
+      ~queryWindow()
+      {
+        close();
+      }
+
+      /**
+       * @brief                   find a read, loading later batches if needed
+       * @param[in]   name
+       * @return                  read sequence, valid until next call, nullptr if not in file
+       */
+      const std::string *find(const std::string &name)
+      {
+        bool rewound = false;
+
+        while (true)
+        {
+          auto it = reads.find (name);
+
+          if (it != reads.end())
+            return &it->second;
+
+          if (!nextBatch())
+          {
+            //read is not in the file
+            if (rewound)
+              return nullptr;
+
+            close();
+            open();
+            nextBatch();
+            rewound = true;
+          }
+        }
+      }
+  };
+
+  /**
+   * @brief                   rescore graph alignments in GAF format under a new scoring scheme
+   * @details                 for each alignment, its path is spelled over the graph and its
+   *                          cigar (cg:Z: tag) is walked over the read and path sequences, in
+   *                          time linear in alignment length. GAF lines are read in batches of
+   *                          'batchReads' lines, whose reads are looked up sequentially in a
+   *                          window of the query file, and whose alignments are then processed 
+   *                          in parallel. Output is tab-delimited with each line consisting of
+   *                          query id, query length, 0-based start offset, end offset, strand, 
+   *                          path, path start, path end, alignment score and cigar string with 
+   *                          =/X operations, in input order. Score and cigar of invalid alignments 
+   *                          are reported as '*'
+   * @param[in]   param
+   */
+  void rescoreAlignments(const Parameters &param)
+  {
+    if (param.gafFile.empty())
+    {
+      std::cerr << "ERROR, psgl::rescoreAlignments, alignment file (-g) is required" << std::endl;
+      exit(1);
+    }
+
+    if( !fileExists(param.gafFile) )
+    {
+      std::cerr << param.gafFile << " not accessible." << std::endl;
+      exit(1);
+    }
+
+    if( !fileExists(param.qfile) )
+    {
+      std::cerr << param.qfile << " not accessible." << std::endl;
+      exit(1);
+    }
+
+    psgl::graphLoader g;
+    g.load (param.mode, param.rfile);
+
+    gafPathWalker walker (g);
+    queryWindow window (param.qfile, param.batchReads);
+
+    std::ifstream infile (param.gafFile);
+    std::ofstream outstrm (param.ofile);
+
+    double time = 0;
+    int64_t total = 0, invalid = 0;
+
+    //first invalid alignment, and its line number
+    std::string firstError;
+    int64_t firstErrorLine = 0;
+
+    std::vector<std::string> lines, reads, results, errors;
+    int64_t lineNumber = 0;
+
+    while (infile)
+    {
+      //next batch of GAF lines, with the read of each line
+      lines.clear();
+      reads.clear();
+      std::vector<int64_t> lineNumbers;
+
+      for (std::string line; lines.size() < (std::size_t) param.batchReads && std::getline (infile, line); )
+      {
+        lineNumber++;
+
+        if (line.empty())
+          continue;
+
+        auto read = window.find (line.substr (0, line.find ('\t')));
+        reads.push_back (read ? *read : std::string());
+        lines.push_back (std::move (line));
+        lineNumbers.push_back (lineNumber);
+      }
+
+      auto time1 = omp_get_wtime();
+
+      results.assign (lines.size(), std::string());
+      errors.assign (lines.size(), std::string());
+
+#pragma omp parallel for schedule(dynamic, 1024) reduction(+:invalid)
+      for (std::size_t i = 0; i < lines.size(); i++)
+      {
+        std::vector<std::string> fields;
+        {
+          std::istringstream inputString (lines[i]);
+          std::string field;
+
+          while (std::getline (inputString, field, '\t'))
+            fields.push_back (field);
+        }
+
+        std::string &error = errors[i];
+        std::string cigar, readSeq, refSeq, eqxCigar;
+        int32_t score = 0;
+
+        //numeric fields: query length, start, end, and path length, start, end
+        int64_t qlen, qstart, qend, plen, pstart, pend;
+
+        auto toInteger = [&](std::size_t k, int64_t &value) {
+          char *end;
+          value = std::strtoll (fields[k].c_str(), &end, 10);
+          return !fields[k].empty() && *end == '\0';
+        };
+
+        if (fields.size() < 12)
+          error = "expected at least 12 fields";
+        else if (!toInteger (1, qlen) || !toInteger (2, qstart) || !toInteger (3, qend) ||
+                 !toInteger (6, plen) || !toInteger (7, pstart) || !toInteger (8, pend))
+          error = "invalid numeric field";
+        else
+        {
+          for (std::size_t k = 12; k < fields.size(); k++)
+            if (fields[k].compare (0, 5, "cg:Z:") == 0)
+              cigar = fields[k].substr (5);
+
+          if (cigar.empty())
+            error = "missing cg:Z: tag";
+          else if (reads[i].empty())
+            error = "read " + fields[0] + " not found in query file";
+          else if (qlen != reads[i].length() || qstart < 0 || qstart > qend || qend > qlen)
+            error = "read length or offsets do not match read " + fields[0];
+          else
+          {
+            //read in path orientation
+            readSeq = reads[i].substr (qstart, qend - qstart);
+
+            if (fields[4] == "-")
+            {
+              std::string rc (readSeq.length(), 'N');
+              seqUtils::reverseComplement (readSeq, rc);
+              readSeq.swap (rc);
+            }
+
+            if (walker.pathSequence (fields[5], plen, pstart, pend, refSeq, error))
+            {
+              if (!rescoreCigar (cigar, readSeq, refSeq, param, score, eqxCigar))
+                error = "cigar does not match aligned read and path lengths";
+            }
+          }
+        }
+
+        std::string &r = results[i];
+
+        for (std::size_t k = 0; k < 9 && k < fields.size(); k++)
+          r.append (fields[k]).append ("\t");
+
+        if (error.empty())
+          r.append (std::to_string (score)).append ("\t").append (eqxCigar);
+        else
+        {
+          r.append ("*\t*");
+          invalid++;
+        }
+      }
+
+      time += omp_get_wtime() - time1;
+
+      for (std::size_t i = 0; i < lines.size(); i++)
+      {
+        outstrm << results[i] << "\n";
+
+        if (firstError.empty() && !errors[i].empty())
+        {
+          firstError = errors[i];
+          firstErrorLine = lineNumbers[i];
+        }
+      }
+
+      total += lines.size();
+    }
+
+    std::cout << "INFO, psgl::rescoreAlignments, rescored " << total << " alignments, time (s) = " << time << std::endl;
+
+    if (invalid > 0)
+      std::cout << "INFO, psgl::rescoreAlignments, " << invalid << " invalid alignments, e.g., line "
+        << firstErrorLine << ": " << firstError << std::endl;
+  }
+}
+
+#endif
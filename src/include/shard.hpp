@@ -0,0 +1,206 @@
+/**
+ * @file    shard.hpp
+ * @brief   routines to save run metrics and merge outputs of read shards
+ * @author  Chirag Jain <cjain7@gatech.edu>
+ */
+
+#ifndef PSGL_SHARD_HPP
+#define PSGL_SHARD_HPP
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <map>
+
+#include "base_types.hpp"
+#include "utils.hpp"
+
+namespace psgl
+{
+  /**
+   * @brief                   save run metrics as a flat JSON object
+   * @param[in]   filename
+   * @param[in]   m
+   **/
+  void writeMetricsJSON(const std::string &filename, const RunMetrics &m)
+  {
+    std::ofstream outstrm(filename);
+
+    outstrm << std::setprecision(6) << std::fixed;
+    outstrm << "{\n"
+      << "  \"shard_index\": " << m.shardIndex << ",\n"
+      << "  \"shard_count\": " << m.shardCount << ",\n"
+      << "  \"shard_group\": " << m.shardGroup << ",\n"
+      << "  \"reads\": " << m.reads << ",\n"
+      << "  \"aligned_reads\": " << m.alignedReads << ",\n"
+      << "  \"total_score\": " << m.totalScore << ",\n"
+      << "  \"load_time_s\": " << m.loadTime << ",\n"
+      << "  \"align_time_s\": " << m.alignTime << "\n"
+      << "}\n";
+  }
+
+  /**
+   * @brief                   parse run metrics saved by writeMetricsJSON
+   * @param[in]   filename
+   * @param[out]  m
+   **/
+  void readMetricsJSON(const std::string &filename, RunMetrics &m)
+  {
+    if( !fileExists(filename) )
+    {
+      std::cerr << filename << " not accessible." << std::endl;
+      exit(1);
+    }
+
+    std::ifstream infile(filename);
+    std::string content ((std::istreambuf_iterator<char>(infile)), std::istreambuf_iterator<char>());
+
+    //parse "key": value pairs, values are expected to be numbers
+    std::map<std::string, std::string> values;
+
+    for (std::size_t pos = content.find('"'); pos != std::string::npos; pos = content.find('"', pos))
+    {
+      auto keyEnd = content.find('"', pos + 1);
+      auto colon = content.find(':', keyEnd);
+
+      if (keyEnd == std::string::npos || colon == std::string::npos)
+        break;
+
+      auto valueEnd = content.find_first_of(",}", colon + 1);
+      values[content.substr(pos + 1, keyEnd - pos - 1)] = content.substr(colon + 1, valueEnd - colon - 1);
+      pos = colon + 1;
+    }
+
+    //counts are parsed as integers, so that large totals are not rounded through double
+    auto parseValue = [&](const std::string &key, auto &value) {
+      auto it = values.find(key);
+      std::istringstream inputString (it == values.end() ? "" : it->second);
+
+      if (!(inputString >> value) || !(inputString >> std::ws).eof())
+      {
+        std::cerr << "ERROR, psgl::readMetricsJSON, missing or invalid value of key " << key << " in " << filename << std::endl;
+        exit(1);
+      }
+    };
+
+    parseValue ("shard_index",   m.shardIndex);
+    parseValue ("shard_count",   m.shardCount);
+
+    //optional, a group of one read if missing
+    if (values.count ("shard_group"))
+      parseValue ("shard_group", m.shardGroup);
+
+    parseValue ("reads",         m.reads);
+    parseValue ("aligned_reads", m.alignedReads);
+    parseValue ("total_score",   m.totalScore);
+    parseValue ("load_time_s",   m.loadTime);
+    parseValue ("align_time_s",  m.alignTime);
+  }
+
+  /**
+   * @brief                   merge outputs of read shards back into input order
+   * @details                 read i is aligned in shard (i / G % N) for groups of G
+   *                          consecutive reads, i.e., G = 2 for paired reads, so merged
+   *                          output is a round-robin interleave of G lines of each shard
+   *                          output. G is given, or saved in the shard metrics. Timings
+   *                          of merged metrics are the maximum over shards, i.e.,
+   *                          wall time of a parallel run
+   * @param[in]   param
+   **/
+  void mergeShards(const MergeParameters &param)
+  {
+    auto shardCount = param.shardFiles.size();
+    assert (shardCount > 0);
+
+    //lines of a shard output per turn
+    std::size_t groupSize = param.groupSize;
+
+    //merge metrics
+    if (param.metricsFiles.size() > 0)
+    {
+      if (param.metricsFiles.size() != shardCount)
+      {
+        std::cerr << "ERROR, psgl::mergeShards, count of metrics files should match count of shard outputs" << std::endl;
+        exit(1);
+      }
+
+      RunMetrics merged;
+      merged.shardCount = 1;
+
+      for (std::size_t i = 0; i < shardCount; i++)
+      {
+        RunMetrics m;
+        readMetricsJSON (param.metricsFiles[i], m);
+
+        if (m.shardIndex != (int) i || m.shardCount != (int) shardCount)
+        {
+          std::cerr << "ERROR, psgl::mergeShards, " << param.metricsFiles[i] << " belongs to shard "
+            << m.shardIndex << "/" << m.shardCount << ", expected " << i << "/" << shardCount << std::endl;
+          exit(1);
+        }
+
+        if (groupSize == 0)
+          groupSize = m.shardGroup;
+        else if (m.shardGroup != (int) groupSize)
+        {
+          std::cerr << "ERROR, psgl::mergeShards, " << param.metricsFiles[i] << " keeps groups of "
+            << m.shardGroup << " reads in a shard, expected " << groupSize << std::endl;
+          exit(1);
+        }
+
+        merged.reads        += m.reads;
+        merged.alignedReads += m.alignedReads;
+        merged.totalScore   += m.totalScore;
+        merged.loadTime     = std::max (merged.loadTime, m.loadTime);
+        merged.alignTime    = std::max (merged.alignTime, m.alignTime);
+      }
+
+      if (!param.metricsFile.empty())
+        writeMetricsJSON (param.metricsFile, merged);
+
+      std::cout << "INFO, psgl::mergeShards, merged metrics of " << merged.reads << " reads" << std::endl;
+    }
+
+    //merge alignment outputs
+    std::vector<std::ifstream> instrms;
+
+    for (auto &f : param.shardFiles)
+    {
+      if( !fileExists(f) )
+      {
+        std::cerr << f << " not accessible." << std::endl;
+        exit(1);
+      }
+
+      instrms.emplace_back (f);
+    }
+
+    groupSize = std::max<std::size_t> (groupSize, 1);
+
+    std::ofstream outstrm(param.ofile);
+    std::string line;
+    std::size_t lineCount = 0;
+
+    //once a shard runs out of lines, all shards should be exhausted
+    while (std::getline (instrms[lineCount / groupSize % shardCount], line))
+    {
+      outstrm << line << "\n";
+      lineCount++;
+    }
+
+    //all shards should be exhausted, each after a complete group
+    for (std::size_t i = 0; i < shardCount; i++)
+    {
+      if ((lineCount % groupSize != 0 && i == lineCount / groupSize % shardCount) || std::getline (instrms[i], line))
+      {
+        std::cerr << "ERROR, psgl::mergeShards, unexpected line count in " << param.shardFiles[i]
+          << ", shard outputs should be listed in shard order" << std::endl;
+        exit(1);
+      }
+    }
+
+    std::cout << "INFO, psgl::mergeShards, merged " << lineCount << " lines from " << shardCount << " shards" << std::endl;
+  }
+}
+
+#endif
@@ -0,0 +1,333 @@
+/**
+ * @file    sort.hpp
+ * @brief   external memory sort of output records by graph position
+ * @author  Chirag Jain <cjain7@gatech.edu>
+ */
+
+#ifndef PSGL_SORT_HPP
+#define PSGL_SORT_HPP
+
+#include <fstream>
+#include <queue>
+#include <tuple>
+#include <cstdio>
+#include <limits>
+#include <set>
+#include <mutex>
+
+#include "base_types.hpp"
+#include "utils.hpp"
+
+namespace psgl
+{
+  /**
+   * @brief   sort key of an output record
+   * @details input graph vertex and offset of the alignment start, then
+   *          orientation, and the read index to break ties in input order.
+   *          Reads without a start location are placed last
+   */
+  struct PositionKey
+  {
+    int32_t id;
+    int32_t offset;
+    char orientation;
+    int64_t readId;
+
+    bool operator< (const PositionKey &k) const
+    {
+      return std::tie (id, offset, orientation, readId) < std::tie (k.id, k.offset, k.orientation, k.readId);
+    }
+  };
+
+  /**
+   * @brief                   sort key of an alignment
+   * @param[in]   graph
+   * @param[in]   e
+   */
+  template <typename Graph>
+    PositionKey positionKey (const Graph &graph, const BestScoreInfo &e)
+    {
+      if (e.refColumnStart < 0 || e.score <= 0)
+        return PositionKey {std::numeric_limits<int32_t>::max(), 0, 0, e.qryId};
+
+      auto v = graph.outputVertexId (e.refColumnStart);
+      return PositionKey {v.id, v.offset, v.orientation, e.qryId};
+    }
+
+  /**
+   * @brief     temporary run files of all sorters which are not merged yet,
+   *            removed at program exit, e.g., after an error ends the run
+   */
+  class SortRunFiles
+  {
+    private:
+
+      std::mutex mtx;
+      std::set<std::string> files;
+
+    public:
+
+      static SortRunFiles &instance ()
+      {
+        static SortRunFiles r;
+        return r;
+      }
+
+      void add (const std::string &f)
+      {
+        std::lock_guard<std::mutex> lock (mtx);
+        files.insert (f);
+      }
+
+      void remove (const std::string &f)
+      {
+        std::lock_guard<std::mutex> lock (mtx);
+        std::remove (f.c_str());
+        files.erase (f);
+      }
+
+      ~SortRunFiles ()
+      {
+        for (auto &f : files)
+          std::remove (f.c_str());
+      }
+  };
+
+  /**
+   * @brief     sorts output records of a file by graph position
+   * @details   records are buffered in memory up to a limit, beyond which the
+   *            buffer is sorted and spilled as a run into a temporary file.
+   *            Runs and the last buffer are merged into the output file at
+   *            the end, at most maxFanIn runs at a time, so that open files
+   *            stay bounded; more runs are first merged into longer runs.
+   *            Records of a run are saved as key fields and length-prefixed
+   *            text, so merging needs no parsing of the output format
+   */
+  class PositionSorter
+  {
+    public:
+
+      //maximum count of runs merged in a single pass
+      static constexpr std::size_t maxFanIn = 64;
+
+    private:
+
+      typedef std::pair<PositionKey, std::string> Record;
+
+      std::string ofile;
+      std::size_t memoryLimit;
+
+      std::vector<Record> buffer;
+      std::size_t bufferedBytes;
+
+      //temporary files of spilled runs, not merged yet
+      std::vector<std::string> runs;
+
+      //count of run files created, to name the next one
+      std::size_t runsCreated;
+
+      static void writeRecord (std::ofstream &out, const Record &r)
+      {
+        uint32_t len = r.second.size();
+
+        out.write ((const char*) &r.first.id, sizeof(r.first.id));
+        out.write ((const char*) &r.first.offset, sizeof(r.first.offset));
+        out.write (&r.first.orientation, sizeof(r.first.orientation));
+        out.write ((const char*) &r.first.readId, sizeof(r.first.readId));
+        out.write ((const char*) &len, sizeof(len));
+        out.write (r.second.data(), len);
+      }
+
+      /**
+       * @brief   read next record of a run, false at its end
+       */
+      static bool readRecord (std::ifstream &in, Record &r)
+      {
+        uint32_t len;
+
+        if (!in.read ((char*) &r.first.id, sizeof(r.first.id)) || 
+            !in.read ((char*) &r.first.offset, sizeof(r.first.offset)) ||
+            !in.read (&r.first.orientation, sizeof(r.first.orientation)) ||
+            !in.read ((char*) &r.first.readId, sizeof(r.first.readId)) ||
+            !in.read ((char*) &len, sizeof(len)))
+          return false;
+
+        r.second.resize (len);
+        return (bool) in.read (&r.second[0], len);
+      }
+
+      std::string newRun ()
+      {
+        auto f = ofile + ".run" + std::to_string (runsCreated++) + ".tmp";
+        SortRunFiles::instance().add (f);
+        return f;
+      }
+
+      void removeRuns ()
+      {
+        for (auto &f : runs)
+          SortRunFiles::instance().remove (f);
+
+        runs.clear();
+      }
+
+      /**
+       * @brief                 k-way merge of runs, as records of a new run or as text
+       * @param[in]   inputs    run files, removed after merging
+       * @param[out]  out
+       * @param[in]   keyed     save keys along with records, i.e., as a run
+       */
+      static void merge (const std::vector<std::string> &inputs, std::ofstream &out, bool keyed)
+      {
+        std::vector<std::ifstream> in;
+        std::vector<Record> head (inputs.size());
+
+        for (auto &f : inputs)
+          in.emplace_back (f, std::ios::binary);
+
+        //min-heap of run indices by key of their head record
+        auto later = [&](std::size_t a, std::size_t b) { return head[b].first < head[a].first; };
+        std::priority_queue<std::size_t, std::vector<std::size_t>, decltype(later)> heap (later);
+
+        for (std::size_t i = 0; i < inputs.size(); i++)
+          if (readRecord (in[i], head[i]))
+            heap.push (i);
+
+        while (!heap.empty())
+        {
+          auto i = heap.top();
+          heap.pop();
+
+          if (keyed)
+            writeRecord (out, head[i]);
+          else
+            out << head[i].second;
+
+          if (readRecord (in[i], head[i]))
+            heap.push (i);
+        }
+
+        for (auto &f : inputs)
+          SortRunFiles::instance().remove (f);
+      }
+
+    public:
+
+      /**
+       * @param[in]   ofile         output file
+       * @param[in]   memoryLimit   bytes of records to buffer before spilling a run
+       */
+      PositionSorter (const std::string &ofile, std::size_t memoryLimit) :
+        ofile (ofile), memoryLimit (memoryLimit), bufferedBytes (0), runsCreated (0)
+      {}
+
+      PositionSorter (PositionSorter &&) = default;
+      PositionSorter (const PositionSorter &) = delete;
+
+      /**
+       * @brief                 runs of a sorter which did not finish are removed
+       */
+      ~PositionSorter ()
+      {
+        removeRuns();
+      }
+
+      /**
+       * @brief                 add a record, spill buffer if over limit
+       * @param[in]   key
+       * @param[in]   record    output line(s)
+       */
+      void add (const PositionKey &key, std::string &&record)
+      {
+        bufferedBytes += record.size() + sizeof(Record);
+        buffer.emplace_back (key, std::move (record));
+
+        if (bufferedBytes > memoryLimit)
+          spill();
+      }
+
+      /**
+       * @brief                 sort buffered records, and save them as a run
+       */
+      void spill ()
+      {
+        std::sort (buffer.begin(), buffer.end(),
+            [](const Record &a, const Record &b) { return a.first < b.first; });
+
+        runs.push_back (newRun());
+
+        std::ofstream outstrm (runs.back(), std::ios::binary);
+
+        for (auto &r : buffer)
+          writeRecord (outstrm, r);
+
+        if (!outstrm)
+        {
+          //runs are removed at exit, see SortRunFiles
+          std::cerr << "ERROR, psgl::PositionSorter::spill, failed to write " << runs.back() << std::endl;
+          exit(1);
+        }
+
+        buffer.clear();
+        buffer.shrink_to_fit();
+        bufferedBytes = 0;
+      }
+
+      /**
+       * @brief                 merge runs and buffered records into output file
+       * @return                count of spilled runs
+       */
+      std::size_t finish ()
+      {
+        std::ofstream outstrm (ofile);
+
+        if (runs.empty())
+        {
+          std::sort (buffer.begin(), buffer.end(),
+              [](const Record &a, const Record &b) { return a.first < b.first; });
+
+          for (auto &r : buffer)
+            outstrm << r.second;
+
+          buffer.clear();
+          return 0;
+        }
+
+        if (!buffer.empty())
+          spill();
+
+        const std::size_t spilled = runs.size();
+
+        //merge groups of runs into longer runs, until a single pass remains
+        while (runs.size() > maxFanIn)
+        {
+          std::vector<std::string> merged;
+
+          for (std::size_t i = 0; i < runs.size(); i += maxFanIn)
+          {
+            std::vector<std::string> group (runs.begin() + i, runs.begin() + std::min (i + maxFanIn, runs.size()));
+
+            merged.push_back (newRun());
+            std::ofstream runstrm (merged.back(), std::ios::binary);
+            merge (group, runstrm, true);
+
+            if (!runstrm)
+            {
+              //remaining runs are removed at exit, see SortRunFiles
+              std::cerr << "ERROR, psgl::PositionSorter::finish, failed to write " << merged.back() << std::endl;
+              exit(1);
+            }
+          }
+
+          runs.swap (merged);
+        }
+
+        merge (runs, outstrm, false);
+        runs.clear();
+
+        return spilled;
+      }
+  };
+}
+
+#endif
@@ -16,10 +16,15 @@
 #include <omp.h>
 #include <immintrin.h>
 #include <cassert>
+#include <iostream>
 #include <stddef.h>
 
 #include "base_types.hpp"
 
+//report a failed check of a verify() routine and return false from it
+#define psgl_verify(cond, caller) \
+  do { if (!(cond)) { std::cerr << "ERROR, " << caller << ", check failed: " << #cond << std::endl; return false; } } while (0)
+
 namespace psgl
 {
   namespace random
@@ -80,6 +85,21 @@ namespace psgl
       }    
     }
 
+    /**
+     * @brief   complement of a DNA character, other characters are unchanged
+     */
+    char complement(char base)
+    {
+      switch ( base )
+      {
+        case 'A': return 'T';
+        case 'C': return 'G';
+        case 'G': return 'C';
+        case 'T': return 'A';
+        default: return base;
+      }
+    }
+
     /**
      * @brief   reverse string
      * @note    assumes dest is pre-allocated
@@ -92,6 +112,22 @@ namespace psgl
         dest[src.length() - i - 1] = src.at(i);
     }
 
+    /**
+     * @brief               2-bit encoding of a DNA character
+     * @return              code in [0, 3], or UINT32_MAX for a non-ACGT character
+     */
+    uint32_t encodeBase(char base)
+    {
+      switch ( base )
+      {
+        case 'A': return 0;
+        case 'C': return 1;
+        case 'G': return 2;
+        case 'T': return 3;
+        default: return UINT32_MAX;
+      }
+    }
+
     /**
      * @brief               convert DNA or AA alphabets to upper case
      * @param[in]   seq     pointer to input sequence
@@ -480,6 +516,18 @@ namespace psgl
         << v.second << ")"; 
       return os; 
     } 
+
+  /**
+   * @brief                   overloading << operator to print vertex and offset
+   */
+  std::ostream& operator<<(std::ostream& os, const VertexOffset& v) 
+  { 
+    os << "(" << v.id;
+    if (v.orientation)
+      os << v.orientation;
+    os << ", " << v.offset << ")"; 
+    return os; 
+  } 
 }
 
 #endif
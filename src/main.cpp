@@ -14,6 +14,9 @@
 #include "align.hpp"
 #include "utils.hpp"
 #include "base_types.hpp"
+#include "shard.hpp"
+#include "rescore.hpp"
+#include "replay.hpp"
 
 int main(int argc, char **argv)
 {
@@ -21,10 +24,52 @@ int main(int argc, char **argv)
   __itt_pause();
 #endif
 
+  //merge outputs of read shards
+  if (argc > 1 && std::string(argv[1]) == "merge")
+  {
+    psgl::MergeParameters mergeParameters;
+    psgl::parseMergeArgs(argc, argv, mergeParameters);
+    psgl::mergeShards(mergeParameters);
+
+    std::cout << "INFO, psgl::main, merge finished" << std::endl;
+    return 0;
+  }
+
+  //rescore given alignments without realignment, options are same as of an alignment run
+  if (argc > 1 && std::string(argv[1]) == "rescore")
+  {
+    psgl::Parameters rescoreParameters;
+    psgl::parseandSave(argc - 1, argv + 1, rescoreParameters);
+    psgl::rescoreAlignments(rescoreParameters);
+
+    std::cout << "INFO, psgl::main, rescore finished" << std::endl;
+    return 0;
+  }
+
+  //re-run alignment of a read saved by -repro option
+  if (argc > 1 && std::string(argv[1]) == "replay")
+  {
+    psgl::ReplayParameters replayParameters;
+    psgl::parseReplayArgs(argc, argv, replayParameters);
+    psgl::replayRead(replayParameters);
+
+    std::cout << "INFO, psgl::main, replay finished" << std::endl;
+    return 0;
+  }
+
   //parse command line arguments   
   psgl::Parameters parameters;        
   psgl::parseandSave(argc, argv, parameters);   
 
+  if (!parameters.gafFile.empty())
+  {
+    std::cerr << "ERROR, psgl::main, -g option is used by rescore subcommand" << std::endl;
+    exit(1);
+  }
+
+  //results are written to the output files, and not needed afterwards
+  parameters.keepResults = false;
+
   //buffer for results
   std::vector< psgl::BestScoreInfo > bestScoreVector;
 
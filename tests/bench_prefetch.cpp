@@ -0,0 +1,135 @@
+/**
+ * @file    bench_prefetch.cpp
+ * @brief   measure phase 1 DP time with different prefetch distances on a
+ *          large synthetic graph with many long edge hops
+ * @details usage: bench-prefetch [vertices] [reads] [read length] [threads] [distances...]
+ * @author  Chirag Jain <cjain7@gatech.edu>
+ */
+
+#include <random>
+
+#include "graphLoad.hpp"
+#include "align.hpp"
+#include "base_types.hpp"
+#include "parseCmdArgs.hpp"
+
+int main(int argc, char **argv)
+{
+#if defined(PASGAL_ENABLE_AVX512) || defined(PASGAL_ENABLE_AVX2)
+  int32_t vertices  = argc > 1 ? std::stoi (argv[1]) : 1000000;
+  int32_t readCount = argc > 2 ? std::stoi (argv[2]) : 64;
+  int32_t readLen   = argc > 3 ? std::stoi (argv[3]) : 1000;
+  int threads       = argc > 4 ? std::stoi (argv[4]) : 1;
+
+  std::vector<int> distances;
+  for (int i = 5; i < argc; i++)
+    distances.push_back (std::stoi (argv[i]));
+
+  if (distances.empty())
+    distances = {0, 2, 4, 8, 16, 32};
+
+  omp_set_num_threads (threads);
+
+  std::mt19937 gen (1);
+  const char bases[] = "ACGT";
+
+  //variation graph like DAG: a backbone of short vertices with alternative
+  //branches and deletions, where few edges skip far ahead
+  psgl::CSR_char_container graph;
+  {
+    psgl::CSR_container diGraph;
+    diGraph.addVertexCount (vertices);
+
+    std::vector <std::pair <int32_t, int32_t> > edgeVector;
+
+    for (int32_t i = 0; i < vertices; i++)
+    {
+      std::string label (1 + gen() % 4, 'A');
+      for (auto &c : label)
+        c = bases[gen() % 4];
+
+      diGraph.initVertexSequence (i, label);
+
+      if (i + 1 < vertices)
+        edgeVector.emplace_back (i, i + 1);
+
+      if (i + 2 < vertices && gen() % 4 == 0)
+        edgeVector.emplace_back (i, i + 2);
+
+      if (gen() % 16 == 0)
+      {
+        int32_t to = i + 2 + gen() % 100000;
+        if (to < vertices)
+          edgeVector.emplace_back (i, to);
+      }
+    }
+
+    diGraph.initEdges (edgeVector);
+    diGraph.sort();
+    graph.build (diGraph);
+  }
+
+  //reads are sampled from graph labels, with 5% substitutions
+  std::vector<std::string> reads;
+  std::vector<psgl::BestScoreInfo> bestScores (readCount);
+  {
+    for (int32_t i = 0; i < readCount; i++)
+    {
+      int32_t begin = gen() % (graph.numVertices - readLen);
+      std::string read (graph.vertex_label.begin() + begin, graph.vertex_label.begin() + begin + readLen);
+
+      for (auto &c : read)
+        if (gen() % 20 == 0)
+          c = bases[gen() % 4];
+
+      reads.push_back (read);
+    }
+  }
+
+  std::cout << "INFO, bench_prefetch, graph width = " << graph.numVertices << ", edges = " << graph.numEdges
+    << ", reads = " << readCount << " x " << readLen << ", threads = " << threads << std::endl;
+
+  std::vector<int32_t> expected;
+  double baseTime = 0;
+
+  for (auto d : distances)
+  {
+    //parameters are parsed as on the command line, graph and reads are generated above
+    std::string t = std::to_string (threads), D = std::to_string (d);
+    std::vector<char*> args = {"bench-prefetch", "-m", "txt", "-r", "synthetic", "-q", "synthetic", "-o", "/dev/null",
+                               "-t", &t[0], "-validate", "off", "-prefetch", &D[0]};
+
+    psgl::Parameters parameters;
+    psgl::parseandSave (args.size(), args.data(), parameters);
+
+    auto time = omp_get_wtime();
+    psgl::alignToDAGLocal_Phase1_vectorized< psgl::SimdInst<int16_t> > (reads, graph, parameters, bestScores);
+    time = omp_get_wtime() - time;
+
+    //results should not depend on prefetching
+    std::vector<int32_t> scores;
+    for (auto &e : bestScores)
+      scores.push_back (e.score);
+
+    if (expected.empty())
+    {
+      expected = scores;
+      baseTime = time;
+    }
+
+    if (scores != expected)
+    {
+      std::cerr << "ERROR, bench_prefetch, scores with prefetch distance " << d << " differ from distance " << distances[0] << std::endl;
+      return 1;
+    }
+
+    std::cout << "RESULT, bench_prefetch, distance = " << d << ", time (s) = " << time
+      << ", speedup over distance " << distances[0] << " = " << baseTime / time << std::endl;
+  }
+#else
+  std::cerr << "ERROR, bench_prefetch, requires SIMD support" << std::endl;
+  return 1;
+#endif
+
+  return 0;
+}
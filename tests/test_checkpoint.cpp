@@ -0,0 +1,131 @@
+/**
+ * @file    test_checkpoint.cpp
+ * @author  Chirag Jain <cjain7@gatech.edu>
+ */
+
+#include "graphLoad.hpp"
+#include "align.hpp"
+#include "base_types.hpp"
+#include "parseCmdArgs.hpp"
+#include "checkpoint.hpp"
+#include "test_utils.hpp"
+#include "gtest/googletest/include/gtest/gtest.h"
+
+/**
+ * @brief   builds a graph from BRCA1 sequence and aligns
+ *          5 query sequences to it, first without checkpoints,
+ *          and then in batches of 2 reads with a journal.
+ *          This routine checks that a run resumed after an
+ *          interruption skips completed batches, and that its
+ *          output matches the uninterrupted run
+ **/
+TEST(checkpoint, resume_vg)
+{
+  psgl_test::TempDir tmp;
+  auto journalFile = tmp.file ("test_checkpoint.journal");
+  auto allFile = tmp.file ("test_checkpoint_all.txt");
+  auto outFile = tmp.file ("test_checkpoint_out.txt");
+
+  auto run = [&](const std::string &ofile, std::vector< psgl::BestScoreInfo > &bestScoreVector, bool checkpoint) {
+    auto args = psgl_test::brca1Args ("vg", "BRCA1_5_reads.fastq", "4", ofile);
+
+    if (checkpoint)
+      args.add ({"-checkpoint", journalFile, "-batch", "2"});
+
+    psgl::Parameters parameters;
+    psgl_test::parse (args, parameters);
+    psgl::alignToDAG (parameters, psgl::MODE::LOCAL, bestScoreVector);
+  };
+
+  using psgl_test::fileContent;
+
+  //single batch
+  std::vector< psgl::BestScoreInfo > allBestScoreVector;
+  run (allFile, allBestScoreVector, false);
+
+  //batches of 2 reads
+  std::vector< psgl::BestScoreInfo > bestScoreVector;
+  run (outFile, bestScoreVector, true);
+
+  ASSERT_EQ(bestScoreVector.size(), 5);
+  ASSERT_FALSE(fileContent (allFile).empty());
+  ASSERT_EQ(fileContent (allFile), fileContent (outFile));
+
+  psgl::Journal j;
+  ASSERT_TRUE(psgl::readJournal (journalFile, 1, j));
+  ASSERT_EQ(j.batches, 3);
+  ASSERT_EQ(j.readsDone, 5);
+  ASSERT_EQ(j.outputSizes[0], psgl::fileSize (outFile));
+
+  //interrupt after first batch, while writing second batch
+  {
+    std::ifstream infile (journalFile);
+    std::string line, header;
+
+    //header lines, and record of first batch
+    while (std::getline (infile, line))
+    {
+      header += line + "\n";
+
+      if (line[0] != '#')
+        break;
+    }
+
+    std::ofstream outstrm (journalFile);
+    outstrm << header << "1\t4";
+  }
+  {
+    std::ofstream outstrm (outFile, std::ios::app);
+    outstrm << "S1_3\t";
+  }
+
+  bestScoreVector.clear();
+  run (outFile, bestScoreVector, true);
+
+  ASSERT_EQ(bestScoreVector.size(), 3);
+  ASSERT_EQ(bestScoreVector[0].qryId, 2);
+  ASSERT_EQ(fileContent (allFile), fileContent (outFile));
+
+  //journal was replaced through a temporary file
+  ASSERT_EQ(psgl::fileSize (journalFile + ".tmp"), -1);
+
+  //completed run is not repeated
+  bestScoreVector.clear();
+  run (outFile, bestScoreVector, true);
+
+  ASSERT_TRUE(bestScoreVector.empty());
+  ASSERT_EQ(fileContent (allFile), fileContent (outFile));
+
+  //estimated insert size is saved exactly
+  {
+    j.insertMean = 301;
+    j.insertStdDev = 1.4826 * 7;
+    psgl::writeJournal (journalFile, j);
+
+    psgl::Journal saved;
+    ASSERT_TRUE(psgl::readJournal (journalFile, 1, saved));
+    ASSERT_EQ(saved.batches, 3);
+    ASSERT_EQ(saved.outputSizes, j.outputSizes);
+    ASSERT_EQ(saved.insertMean, j.insertMean);
+    ASSERT_EQ(saved.insertStdDev, j.insertStdDev);
+  }
+
+  //an edit anywhere in the graph changes its hash
+  {
+    auto graphFile = tmp.file ("graph.txt");
+    auto graph = fileContent (std::string (FOLDER) + "/BRCA1_seq_graph.txt");
+
+    std::ofstream (graphFile, std::ios::binary) << graph;
+    auto h = psgl::graphHash (graphFile);
+
+    ASSERT_EQ(h, psgl::graphHash (graphFile));
+
+    //a single base in the middle of the file
+    auto pos = graph.find_first_of ("ACGT", graph.size() / 2 + 1000);
+    ASSERT_NE(pos, std::string::npos);
+    graph[pos] = graph[pos] == 'A' ? 'C' : 'A';
+
+    std::ofstream (graphFile, std::ios::binary) << graph;
+    ASSERT_NE(h, psgl::graphHash (graphFile));
+  }
+}
@@ -0,0 +1,190 @@
+/**
+ * @file    test_coverage.cpp
+ * @author  Chirag Jain <cjain7@gatech.edu>
+ */
+
+#include "graphLoad.hpp"
+#include "align.hpp"
+#include "base_types.hpp"
+#include "parseCmdArgs.hpp"
+#include "coverage.hpp"
+#include "test_utils.hpp"
+#include "gtest/googletest/include/gtest/gtest.h"
+
+/**
+ * @brief   builds a graph from BRCA1 sequence and aligns
+ *          5 query sequences to it, saving per-base coverage.
+ *          This routine checks that aligned bases of all vertices
+ *          match the matches and mismatches of the cigar strings,
+ *          that binary and tsv coverage agree, and that concurrent
+ *          batches count into the same coverage
+ **/
+TEST(coverage, perBase_vg)
+{
+  psgl_test::TempDir tmp;
+  auto tsvFile = tmp.file ("test_coverage.tsv");
+  auto binFile = tmp.file ("test_coverage.bin");
+  auto batchFile = tmp.file ("test_coverage_batches.tsv");
+
+  std::vector< psgl::BestScoreInfo > bestScoreVector;
+
+  for (auto file : {tsvFile, binFile, batchFile})
+  {
+    auto args = psgl_test::brca1Args ("vg", "BRCA1_5_reads.fastq", "4", tmp.file ("test_coverage_out.txt"));
+    args.add ({"-coverage", file, "-covformat", file == binFile ? "bin" : "tsv", "-perbase"});
+
+    if (file == batchFile)
+      args.add ({"-batch", "2", "-workers", "2"});
+
+    psgl::Parameters parameters;
+    psgl_test::parse (args, parameters);
+
+    bestScoreVector.clear();
+    psgl::alignToDAG (parameters, psgl::MODE::LOCAL, bestScoreVector);
+  }
+
+  ASSERT_EQ(psgl_test::fileContent (tsvFile), psgl_test::fileContent (batchFile));
+
+  ASSERT_EQ(bestScoreVector.size(), 5);
+
+  //matches and mismatches of all cigar strings
+  uint64_t cigarBases = 0;
+
+  for (auto &e : bestScoreVector)
+  {
+    int64_t count = 0;
+
+    for (auto c : e.cigar)
+    {
+      if (isdigit(c))
+        count = count * 10 + (c - '0');
+      else
+      {
+        if (c == '=' || c == 'X')
+          cigarBases += count;
+        count = 0;
+      }
+    }
+  }
+
+  ASSERT_GT(cigarBases, 0);
+
+  //tsv coverage
+  std::map<std::string, std::pair<uint64_t, uint64_t> > tsv;    //name -> (bases, sum of depths)
+  {
+    std::ifstream infile (tsvFile);
+    std::string line;
+    uint64_t total = 0;
+
+    while (std::getline (infile, line))
+    {
+      if (line[0] == '#')
+        continue;
+
+      std::istringstream inputString (line);
+      std::string name;
+      int32_t len;
+      uint64_t bases, depthSum = 0;
+      double mean;
+      std::string depths;
+
+      inputString >> name >> len >> bases >> mean >> depths;
+
+      std::istringstream depthString (depths);
+      for (std::string d; std::getline (depthString, d, ','); )
+        depthSum += std::stoull (d);
+
+      tsv[name] = std::make_pair (bases, depthSum);
+      ASSERT_EQ(bases, depthSum);
+      total += bases;
+    }
+
+    ASSERT_EQ(total, cigarBases);
+  }
+
+  //binary coverage
+  {
+    std::ifstream infile (binFile, std::ios::binary);
+
+    char magic[7];
+    int8_t perBase;
+    int64_t count;
+
+    infile.read (magic, 7);
+    infile.read ((char*) &perBase, sizeof(perBase));
+    infile.read ((char*) &count, sizeof(count));
+
+    ASSERT_EQ(std::string (magic, 7), "PSGLCOV");
+    ASSERT_EQ(perBase, 1);
+    ASSERT_EQ(count, tsv.size());
+
+    std::vector<uint64_t> bases (count);
+
+    for (int64_t i = 0; i < count; i++)
+    {
+      int32_t id, len;
+
+      infile.read ((char*) &id, sizeof(id));
+      infile.read ((char*) &len, sizeof(len));
+      infile.read ((char*) &bases[i], sizeof(uint64_t));
+
+      std::vector<uint32_t> depths (len);
+      infile.read ((char*) depths.data(), len * sizeof(uint32_t));
+
+      ASSERT_TRUE(infile.good());
+      ASSERT_EQ(std::accumulate (depths.begin(), depths.end(), (uint64_t) 0), bases[i]);
+    }
+
+    //name table, in the order of vertex records
+    for (int64_t i = 0; i < count; i++)
+    {
+      int32_t len;
+      infile.read ((char*) &len, sizeof(len));
+
+      std::string name (len, ' ');
+      infile.read (&name[0], len);
+
+      ASSERT_TRUE(infile.good());
+      ASSERT_EQ(bases[i], tsv[name].first);
+    }
+
+    ASSERT_EQ(infile.peek(), EOF);
+  }
+}
+
+/**
+ * @brief   aligns a read along the path s1, s2, s4 of a GFA bubble graph.
+ *          This routine checks that tsv coverage reports vertices
+ *          by their segment names
+ **/
+TEST(coverage, segmentNames_gfa)
+{
+  psgl_test::TempDir tmp;
+  std::string dir = FOLDER;
+  std::string qfile = tmp.file ("test_coverage_read.fa");
+  std::string covFile = tmp.file ("test_coverage_gfa.tsv");
+
+  {
+    std::ofstream outstrm(qfile);
+    outstrm << ">read\nACGTGACCA\n";
+  }
+
+  psgl_test::CmdArgs args {"PaSGAL", "-m", "gfa", "-q", qfile, "-r", dir + "/bubble_graph.gfa",
+                           "-t", "1", "-o", tmp.file ("test_coverage_gfa_out.txt"), "-coverage", covFile};
+
+  psgl::Parameters parameters;
+  psgl_test::parse (args, parameters);
+
+  std::vector< psgl::BestScoreInfo > bestScoreVector;
+  psgl::alignToDAG (parameters, psgl::MODE::LOCAL, bestScoreVector);
+
+  ASSERT_EQ(bestScoreVector.size(), 1);
+  ASSERT_EQ(bestScoreVector[0].cigar, "9=");
+
+  auto lines = psgl_test::fileLines (covFile);
+  ASSERT_EQ(lines.size(), 5);
+  ASSERT_EQ(lines[1], "s1\t4\t4\t1");
+  ASSERT_EQ(lines[2], "s2\t1\t1\t1");
+  ASSERT_EQ(lines[3], "s3\t1\t0\t0");
+  ASSERT_EQ(lines[4], "s4\t4\t4\t1");
+}
@@ -4,6 +4,7 @@
  */
 
 #include "graphLoad.hpp"
+#include "test_utils.hpp"
 #include "gtest/googletest/include/gtest/gtest.h"
 
 #define QUOTE(name) #name
@@ -45,6 +46,7 @@ TEST(graphLoad, graphLoadVG)
   //load graph
 
   psgl::graphLoader g;
+  g.verifyGraph = true;
   g.loadFromVG(file);
   auto &graph = g.diCharGraph;
 
@@ -55,4 +57,419 @@ TEST(graphLoad, graphLoadVG)
   ASSERT_EQ(graph.numVertices - 1, 81189); 
 
   ASSERT_EQ(graph.numEdges, 81188); 
+  ASSERT_TRUE(graph.verify()); 
+}
+
+/**
+ * @brief   builds a graph from BRCA1 sequence
+ *          This routine checks that a .vg file, recompressed 
+ *          into BGZF blocks, is decompressed in parallel 
+ *          into the same graph
+ **/
+TEST(graphLoad, graphLoadVGBlocks) 
+{
+  //get file name
+  std::string file = FOLDER;
+  file = file + "/BRCA1_seq_graph.vg";
+
+  psgl_test::TempDir tmp;
+  std::string bgzfFile = tmp.file ("test_graph_bgzf.vg");
+
+  //recompress the stream into small BGZF blocks, followed by an empty block
+  {
+    std::string stream;
+    gzFile fp = gzopen (file.c_str(), "r");
+    char buffer[4096];
+    int n;
+    while ((n = gzread (fp, buffer, sizeof(buffer))) > 0)
+      stream.append (buffer, n);
+    gzclose (fp);
+
+    std::ofstream outstrm(bgzfFile, std::ios::binary);
+
+    for (std::size_t off = 0; off <= stream.size(); off += 4096)
+    {
+      uInt len = std::min<std::size_t> (4096, stream.size() - off);
+      std::vector<unsigned char> data (compressBound (len) + 64);
+
+      z_stream zs;
+      std::memset (&zs, 0, sizeof(zs));
+      deflateInit2 (&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+      zs.next_in = (Bytef *) stream.data() + off;
+      zs.avail_in = len;
+      zs.next_out = data.data();
+      zs.avail_out = data.size();
+      ASSERT_EQ(deflate (&zs, Z_FINISH), Z_STREAM_END);
+      deflateEnd (&zs);
+
+      uint32_t blockSize = 18 + zs.total_out + 8 - 1;
+      uint32_t crc = crc32 (0, (const Bytef *) stream.data() + off, len);
+
+      unsigned char header[18] = {0x1f, 0x8b, 8, 4, 0, 0, 0, 0, 0, 0xff, 6, 0, 'B', 'C', 2, 0, 
+                                  (unsigned char) (blockSize & 0xff), (unsigned char) (blockSize >> 8)};
+      unsigned char footer[8] = {(unsigned char) crc, (unsigned char) (crc >> 8), (unsigned char) (crc >> 16), (unsigned char) (crc >> 24),
+                                 (unsigned char) len, (unsigned char) (len >> 8), (unsigned char) (len >> 16), (unsigned char) (len >> 24)};
+
+      outstrm.write ((char *) header, 18);
+      outstrm.write ((char *) data.data(), zs.total_out);
+      outstrm.write ((char *) footer, 8);
+    }
+  }
+
+  psgl::graphLoader g1, g2, g3;
+  g1.loadFromVG(file);
+
+  //small windows, so that graph chunks span decompressed windows
+  g2.vgWindowBytes = g3.vgWindowBytes = 10000;
+
+  int threads = omp_get_max_threads();
+  omp_set_num_threads(4);
+  g2.loadFromVG(bgzfFile);
+  g3.loadFromVG(file);
+  omp_set_num_threads(threads);
+
+  for (auto g : {&g2, &g3})
+  {
+    ASSERT_EQ(g1.diCharGraph.numVertices, g->diCharGraph.numVertices); 
+    ASSERT_EQ(g1.diCharGraph.numEdges, g->diCharGraph.numEdges); 
+    ASSERT_TRUE(g1.diCharGraph.vertex_label == g->diCharGraph.vertex_label); 
+  }
+}
+
+/**
+ * @brief   writes small .vg graphs with duplicate vertex ids
+ *          and with edge overlaps
+ *          This routine checks that both are rejected
+ **/
+TEST(graphLoad, graphLoadVGInvalid) 
+{
+  psgl_test::TempDir tmp;
+
+  //save a graph of two vertices and an edge as a single group of one chunk
+  auto writeVG = [](const std::string &filename, int64_t secondId, int64_t overlap) {
+    vg::Graph graph;
+
+    auto v = graph.add_node();
+    v->set_id (1);
+    v->set_sequence ("ACGT");
+
+    v = graph.add_node();
+    v->set_id (secondId);
+    v->set_sequence ("GGC");
+
+    auto e = graph.add_edge();
+    e->set_from (1);
+    e->set_to (2);
+    e->set_overlap (overlap);
+
+    std::string message = graph.SerializeAsString();
+    std::string stream (1, (char) 1);
+    stream += (char) message.size();
+    stream += message;
+
+    gzFile fp = gzopen (filename.c_str(), "w");
+    gzwrite (fp, stream.data(), stream.size());
+    gzclose (fp);
+  };
+
+  writeVG (tmp.file ("valid.vg"), 2, 0);
+  writeVG (tmp.file ("duplicate.vg"), 1, 0);
+  writeVG (tmp.file ("overlap.vg"), 2, 1);
+
+  psgl::graphLoader g;
+  g.loadFromVG (tmp.file ("valid.vg"));
+  ASSERT_EQ(g.diCharGraph.numVertices, 8); 
+
+  ASSERT_EXIT(psgl::graphLoader().loadFromVG (tmp.file ("duplicate.vg")), ::testing::ExitedWithCode(1), "unique and contiguous");
+  ASSERT_EXIT(psgl::graphLoader().loadFromVG (tmp.file ("overlap.vg")), ::testing::ExitedWithCode(1), "overlaps");
+}
+
+/**
+ * @brief   builds a graph from BRCA1 sequence
+ *          This routine checks for the correctness
+ *          of weakly connected component ranges
+ **/
+TEST(graphLoad, graphComponentsVG) 
+{
+  //get file name
+  std::string file = FOLDER;
+  file = file + "/BRCA1_seq_graph.vg";
+
+  //load graph
+
+  psgl::graphLoader g;
+  g.loadFromVG(file);
+  auto &graph = g.diCharGraph;
+
+  //dummy vertex added by PaSGAL is disconnected from the chain
+  ASSERT_EQ(graph.numComponents(), 2); 
+  ASSERT_EQ(graph.componentOffsets.front(), 0); 
+  ASSERT_EQ(graph.componentOffsets.back(), graph.numVertices); 
+  ASSERT_EQ(graph.maxComponentWidth(), 81189); 
+}
+
+/**
+ * @brief   builds a graph from BRCA1 sequence
+ *          This routine checks that original vertex ids
+ *          and offsets are recovered for all columns
+ **/
+TEST(graphLoad, originalVertexIdTxt) 
+{
+  //get file name
+  std::string file = FOLDER;
+  file = file + "/BRCA1_seq_graph.txt";
+
+  //load graph
+
+  psgl::graphLoader g;
+  g.loadFromTxt(file);
+  auto &graph = g.diCharGraph;
+
+  ASSERT_EQ(graph.vertexStart.size(), graph.vertexOriginalId.size() + 1); 
+  ASSERT_EQ(graph.vertexStart.back(), graph.numVertices); 
+
+  //columns of a vertex are contiguous, with offsets 0, 1, ...
+  std::vector<bool> seen (graph.vertexOriginalId.size(), false);
+
+  for (int64_t i = 0; i < graph.numVertices; i++)
+  {
+    auto id = graph.originalVertexId(i);
+
+    if (id.second == 0)
+    {
+      ASSERT_FALSE(seen[id.first]);
+      seen[id.first] = true;
+    }
+    else
+    {
+      ASSERT_EQ(graph.originalVertexId(i-1).first, id.first);
+      ASSERT_EQ(graph.originalVertexId(i-1).second + 1, id.second);
+    }
+  }
+
+  ASSERT_EQ(std::count(seen.begin(), seen.end(), true), seen.size()); 
+}
+
+/**
+ * @brief   builds a graph from BRCA1 sequence
+ *          This routine checks that in-edges and out-edges,
+ *          saved as hop distances, describe the same edges
+ **/
+TEST(graphLoad, adjacencyHopsTxt) 
+{
+  //get file name
+  std::string file = FOLDER;
+  file = file + "/BRCA1_seq_graph.txt";
+
+  //load graph
+
+  psgl::graphLoader g;
+  g.loadFromTxt(file);
+  auto &graph = g.diCharGraph;
+
+  std::vector< std::pair<int64_t, int64_t> > inEdges, outEdges;
+
+  for (int64_t i = 0; i < graph.numVertices; i++)
+  {
+    for (auto j = graph.offsets_in[i]; j < graph.offsets_in[i+1]; j++)
+    {
+      ASSERT_GT(graph.adjcny_in[j], 0);
+      inEdges.emplace_back (i - graph.adjcny_in[j], i);
+    }
+
+    for (auto j = graph.offsets_out[i]; j < graph.offsets_out[i+1]; j++)
+    {
+      ASSERT_GT(graph.adjcny_out[j], 0);
+      outEdges.emplace_back (i, i + graph.adjcny_out[j]);
+    }
+  }
+
+  std::sort (inEdges.begin(), inEdges.end());
+  std::sort (outEdges.begin(), outEdges.end());
+
+  ASSERT_EQ(inEdges.size(), graph.numEdges); 
+  ASSERT_TRUE(inEdges == outEdges); 
+}
+
+/**
+ * @brief   builds a small bubble graph
+ *          This routine checks for the correctness
+ *          of graph loading (format = .gfa), including
+ *          links in reverse orientation and paths
+ **/
+TEST(graphLoad, graphLoadGFA) 
+{
+  //get file name
+  std::string file = FOLDER;
+  file = file + "/bubble_graph.gfa";
+
+  //load graph
+
+  psgl::graphLoader g;
+  g.loadFromGFA(file);
+  auto &graph = g.diCharGraph;
+
+  //10 characters, 6 edges within segments and 4 links
+  ASSERT_EQ(graph.numVertices, 10); 
+  ASSERT_EQ(graph.numEdges, 10); 
+
+  //lower case sequence is saved in upper case
+  ASSERT_EQ(std::count(graph.vertex_label.begin(), graph.vertex_label.end(), 'G'), 2); 
+  ASSERT_EQ(std::count(graph.vertex_label.begin(), graph.vertex_label.end(), 'g'), 0); 
+
+  ASSERT_EQ(g.segmentName(2), "s3"); 
+
+  ASSERT_EQ(g.paths.size(), 2); 
+  ASSERT_EQ(g.paths[0].name, "p1"); 
+  ASSERT_TRUE(g.paths[0].vertices == std::vector<int32_t>({0, 1, 3})); 
+  ASSERT_TRUE(g.paths[1].vertices == std::vector<int32_t>({0, 2, 3})); 
+  ASSERT_EQ(std::count(g.paths[1].reverse.begin(), g.paths[1].reverse.end(), true), 0); 
+}
+
+/**
+ * @brief   builds a graph from BRCA1 sequence
+ *          This routine checks that a GFA file, written from the 
+ *          .txt graph, is parsed in parallel chunks into the same graph
+ **/
+TEST(graphLoad, graphLoadGFAConvertedTxt) 
+{
+  //get file name
+  std::string file = FOLDER;
+  file = file + "/BRCA1_seq_graph.txt";
+
+  psgl_test::TempDir tmp;
+  std::string gfaFile = tmp.file ("test_graph.gfa");
+
+  //write the graph in GFA format, segment i is named i+1
+  {
+    std::ifstream infile(file);
+    std::ofstream outstrm(gfaFile);
+    std::string line, links;
+
+    std::getline(infile, line);
+
+    for (int32_t i = 0; std::getline(infile, line); i++)
+    {
+      std::istringstream inputString(line);
+      std::vector<std::string> tokens (std::istream_iterator<std::string>{inputString}, std::istream_iterator<std::string>());
+
+      outstrm << "S\t" << i + 1 << "\t" << tokens.back() << "\n";
+
+      for (std::size_t j = 0; j + 1 < tokens.size(); j++)
+        links += "L\t" + std::to_string(i + 1) + "\t+\t" + std::to_string(std::stoi(tokens[j]) + 1) + "\t+\t0M\n";
+    }
+
+    outstrm << links;
+  }
+
+  psgl::graphLoader g1, g2;
+  g1.loadFromTxt(file);
+
+  int threads = omp_get_max_threads();
+  omp_set_num_threads(4);
+  g2.loadFromGFA(gfaFile);
+  omp_set_num_threads(threads);
+
+  //topological order is randomized, so compare labels and edges
+  //using original vertex ids and offsets
+  typedef std::pair<int32_t, int32_t> vertexOffset;
+
+  auto labels = [](const psgl::CSR_char_container &graph) {
+    std::vector< std::pair<vertexOffset, char> > v;
+    for (int64_t i = 0; i < graph.numVertices; i++)
+      v.emplace_back (graph.originalVertexId(i), graph.vertex_label[i]);
+    std::sort (v.begin(), v.end());
+    return v;
+  };
+
+  auto edges = [](const psgl::CSR_char_container &graph) {
+    std::vector< std::pair<vertexOffset, vertexOffset> > v;
+    for (int64_t i = 0; i < graph.numVertices; i++)
+      for (auto j = graph.offsets_out[i]; j < graph.offsets_out[i+1]; j++)
+        v.emplace_back (graph.originalVertexId(i), graph.originalVertexId(i + graph.adjcny_out[j]));
+    std::sort (v.begin(), v.end());
+    return v;
+  };
+
+  ASSERT_EQ(g1.diCharGraph.numVertices, g2.diCharGraph.numVertices); 
+  ASSERT_EQ(g1.diCharGraph.numEdges, g2.diCharGraph.numEdges); 
+  ASSERT_TRUE(labels(g1.diCharGraph) == labels(g2.diCharGraph)); 
+  ASSERT_TRUE(edges(g1.diCharGraph) == edges(g2.diCharGraph)); 
+  ASSERT_EQ(g2.segmentName(0), "1"); 
+}
+
+/**
+ * @brief   builds a bi-directed graph with an inversion
+ *          This routine checks that both strands are
+ *          saved, and that columns are mapped back to
+ *          oriented vertices
+ **/
+TEST(graphLoad, graphLoadBidirectedGFA) 
+{
+  //get file name
+  std::string file = FOLDER;
+  file = file + "/inversion_graph.gfa";
+
+  //load graph
+
+  psgl::graphLoader g;
+  g.loadFromGFA(file);
+  auto &graph = g.diCharGraph;
+
+  //both strands of 9 characters, 6 edges within segments and 4 links per strand
+  ASSERT_EQ(graph.strandVertices, 3); 
+  ASSERT_EQ(graph.numVertices, 18); 
+  ASSERT_EQ(graph.numEdges, 20); 
+
+  //strands are connected through the inversion
+  ASSERT_EQ(graph.numComponents(), 1); 
+
+  int32_t reverseColumns = 0;
+
+  for (int64_t i = 0; i < graph.numVertices; i++)
+  {
+    auto v = graph.outputVertexId(i);
+    ASSERT_TRUE(v.id >= 0 && v.id < 3); 
+    ASSERT_TRUE(v.orientation == '+' || v.orientation == '-'); 
+
+    reverseColumns += (v.orientation == '-');
+
+    //label of '-' vertex is reverse complemented
+    if (v.id == 1)
+      ASSERT_EQ(graph.vertex_label[i], v.orientation == '+' ? "TTGA"[v.offset] : "TCAA"[v.offset]); 
+  }
+
+  ASSERT_EQ(reverseColumns, 9); 
+}
+
+/**
+ * @brief   builds a graph with a poly-T component and a 
+ *          mixed sequence component, and indexes its 16-mers.
+ *          This routine checks that the poly-T 16-mer, whose 
+ *          code uses all 32 bits, is indexed
+ **/
+TEST(graphLoad, componentKmersPolyT) 
+{
+  psgl_test::TempDir tmp;
+  std::string gfaFile = tmp.file ("test_graph_polyt.gfa");
+
+  {
+    std::ofstream outstrm(gfaFile);
+    outstrm << "S\t1\tTTTTTTTTTTTT\nS\t2\tTTTTTTTTTTTT\nS\t3\tACGTACGGTCAG\nS\t4\tGATTACAGATCC\n"
+      << "L\t1\t+\t2\t+\t0M\nL\t3\t+\t4\t+\t0M\n";
+  }
+
+  psgl::graphLoader g;
+  g.loadFromGFA(gfaFile);
+  auto &graph = g.diCharGraph;
+
+  ASSERT_EQ(graph.numComponents(), 2); 
+
+  graph.indexComponentKmers(16);
+
+  std::vector<bool> hits (graph.numComponents(), false);
+  graph.markComponentKmerHits(std::string(20, 'T'), hits);
+
+  for (std::size_t c = 0; c < graph.numComponents(); c++)
+    ASSERT_EQ(hits[c], graph.vertex_label[graph.componentOffsets[c]] == 'T'); 
 }
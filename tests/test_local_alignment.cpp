@@ -7,12 +7,33 @@
 #include "align.hpp"
 #include "base_types.hpp"
 #include "parseCmdArgs.hpp"
+#include "test_utils.hpp"
 #include "gtest/googletest/include/gtest/gtest.h"
 
 #define QUOTE(name) #name
 #define STR(macro) QUOTE(macro)
 #define FOLDER STR(PROJECT_TEST_DATA_DIR)
 
+/**
+ * @brief   checks strands, scores and cigars of the 5 BRCA1 
+ *          query sequences aligned to the .txt graph
+ **/
+void checkBRCA1TxtAlignments (const std::vector< psgl::BestScoreInfo > &bestScoreVector, const psgl::Parameters &parameters)
+{
+  //NOTE: Ground truth calculated using unit scoring system
+  std::vector<int32_t> scores = {482, 122, 441, 90, 259};
+  std::vector<char> strands = {'+', '-', '+', '-', '+'};
+
+  ASSERT_EQ(bestScoreVector.size(), 5); 
+
+  for (int i = 0; i < 5; i++)
+  {
+    ASSERT_EQ(bestScoreVector[i].score, scores[i]);       
+    ASSERT_EQ(bestScoreVector[i].strand, strands[i]);    
+    ASSERT_EQ(psgl::seqUtils::cigarScore (bestScoreVector[i].cigar, parameters), scores[i]);
+  }
+}
+
 /**
  * @brief   builds a graph from BRCA1 sequence and aligns
  *          single query sequence to it.
@@ -180,3 +201,388 @@ TEST(localAlignment, multipleQueryParallelScore_txt)
   ASSERT_EQ(bestScoreVector[4].score, 259);       
   ASSERT_EQ(bestScoreVector[4].strand, '+');    
 }
+
+/**
+ * @brief   builds a graph from BRCA1 sequence and aligns
+ *          5 query sequences to it in parallel, while
+ *          skipping graph components using k-mers.
+ *          This routine checks for alignment strands and 
+ *          scores
+ **/
+TEST(localAlignment, multipleQueryParallelScore_componentKmer) 
+{
+  //get file name
+  std::string dir = FOLDER;
+  auto rfile = dir + "/BRCA1_seq_graph.vg";
+  auto qfile = dir + "/BRCA1_5_reads.fastq";
+
+  std::vector<char> QFILE(qfile.c_str(), qfile.c_str() + qfile.size() + 1u);
+  std::vector<char> RFILE(rfile.c_str(), rfile.c_str() + rfile.size() + 1u);
+  char *mode = "vg";
+  char *threads = "8"; 
+  char *kmer = "12"; 
+
+  char *argv[] = {"PaSGAL", "-m", mode, "-q", QFILE.data(), "-r", RFILE.data(),
+                  "-t", threads, "-o", "/dev/null" , "-ckmer", kmer, nullptr};
+  int argc = 13;
+
+  psgl::Parameters parameters;        
+  psgl::parseandSave(argc, argv, parameters);
+
+  std::vector< psgl::BestScoreInfo > bestScoreVector;
+  psgl::alignToDAG (parameters, psgl::MODE::LOCAL, bestScoreVector);
+
+  //NOTE: Ground truth calculated using unit scoring system
+
+  ASSERT_EQ(bestScoreVector.size(), 5); 
+
+  ASSERT_EQ(bestScoreVector[0].score, 482);       
+  ASSERT_EQ(bestScoreVector[0].strand, '-');    
+
+  ASSERT_EQ(bestScoreVector[1].score, 122);       
+  ASSERT_EQ(bestScoreVector[1].strand, '+');    
+
+  ASSERT_EQ(bestScoreVector[2].score, 441);       
+  ASSERT_EQ(bestScoreVector[2].strand, '-');    
+
+  ASSERT_EQ(bestScoreVector[3].score, 90);       
+  ASSERT_EQ(bestScoreVector[3].strand, '+');    
+
+  ASSERT_EQ(bestScoreVector[4].score, 259);       
+  ASSERT_EQ(bestScoreVector[4].strand, '-');    
+}
+
+/**
+ * @brief   builds a graph from BRCA1 sequence and aligns
+ *          query sequences of two samples listed in a 
+ *          manifest file.
+ *          This routine checks for alignment scores
+ *          of both samples in input order
+ **/
+TEST(localAlignment, multipleSampleManifest_txt) 
+{
+  //get file name
+  std::string dir = FOLDER;
+  auto rfile = dir + "/BRCA1_seq_graph.txt";
+
+  psgl_test::TempDir tmp;
+  auto mfile = tmp.file ("manifest.txt");
+
+  //write manifest
+  {
+    std::ofstream outstrm(mfile);
+    outstrm << dir + "/BRCA1_1_read.fastq" << "\t" << "/dev/null" << "\n";
+    outstrm << dir + "/BRCA1_5_reads.fastq" << "\t" << "/dev/null" << "\n";
+  }
+
+  psgl_test::CmdArgs args {"PaSGAL", "-m", "txt", "-Q", mfile, "-r", rfile, "-t", "4"};
+
+  psgl::Parameters parameters;        
+  psgl_test::parse (args, parameters);
+
+  ASSERT_EQ(parameters.samples.size(), 2); 
+
+  std::vector< psgl::BestScoreInfo > bestScoreVector;
+  psgl::alignToDAG (parameters, psgl::MODE::LOCAL, bestScoreVector);
+
+  //NOTE: Ground truth calculated using unit scoring system
+
+  ASSERT_EQ(bestScoreVector.size(), 6); 
+
+  ASSERT_EQ(bestScoreVector[0].score, 482);       
+  ASSERT_EQ(bestScoreVector[1].score, 482);       
+  ASSERT_EQ(bestScoreVector[2].score, 122);       
+  ASSERT_EQ(bestScoreVector[3].score, 441);       
+  ASSERT_EQ(bestScoreVector[4].score, 90);       
+  ASSERT_EQ(bestScoreVector[5].score, 259);       
+}
+
+/**
+ * @brief   builds a graph from BRCA1 sequence and aligns
+ *          5 query sequences to it, while splitting graph
+ *          columns across 3 processes.
+ *          This routine checks for alignment strands, 
+ *          scores and cigars
+ **/
+TEST(localAlignment, multipleQueryPartitionedScore_txt) 
+{
+  //get file name
+  std::string dir = FOLDER;
+  auto rfile = dir + "/BRCA1_seq_graph.txt";
+  auto qfile = dir + "/BRCA1_5_reads.fastq";
+
+  std::vector<char> QFILE(qfile.c_str(), qfile.c_str() + qfile.size() + 1u);
+  std::vector<char> RFILE(rfile.c_str(), rfile.c_str() + rfile.size() + 1u);
+  char *mode = "txt";
+  char *threads = "4"; 
+  char *partitions = "3"; 
+
+  char *argv[] = {"PaSGAL", "-m", mode, "-q", QFILE.data(), "-r", RFILE.data(),
+                  "-t", threads, "-o", "/dev/null" , "-partitions", partitions, nullptr};
+  int argc = 13;
+
+  psgl::Parameters parameters;        
+  psgl::parseandSave(argc, argv, parameters);
+
+  std::vector< psgl::BestScoreInfo > bestScoreVector;
+  psgl::alignToDAG (parameters, psgl::MODE::LOCAL, bestScoreVector);
+
+  //NOTE: Ground truth calculated using unit scoring system
+
+  ASSERT_EQ(bestScoreVector.size(), 5); 
+
+  std::vector<int32_t> scores = {482, 122, 441, 90, 259};
+  std::vector<char> strands = {'+', '-', '+', '-', '+'};
+
+  for (int i = 0; i < 5; i++)
+  {
+    ASSERT_EQ(bestScoreVector[i].score, scores[i]);       
+    ASSERT_EQ(bestScoreVector[i].strand, strands[i]);    
+    ASSERT_EQ(psgl::seqUtils::cigarScore (bestScoreVector[i].cigar, parameters), scores[i]);
+  }
+}
+
+/**
+ * @brief   builds a graph from BRCA1 sequence and aligns
+ *          5 query sequences to it, streaming graph columns
+ *          from a file. A stale file is re-created by the first
+ *          run and mapped by the second. This routine checks for 
+ *          alignment strands, scores and cigars of both runs
+ **/
+TEST(localAlignment, multipleQueryOutOfCoreScore_txt) 
+{
+  psgl_test::TempDir tmp;
+  auto streamFile = tmp.file ("test_graph.ooc");
+
+  //a stale file, e.g., saved from another graph, is re-created
+  std::ofstream (streamFile) << "stale";
+
+  auto args = psgl_test::brca1Args ("txt", "BRCA1_5_reads.fastq", "4", "/dev/null").add ({"-ooc", streamFile});
+
+  psgl::Parameters parameters;        
+  psgl_test::parse (args, parameters);
+
+  for (int run = 0; run < 2; run++)
+  {
+    std::vector< psgl::BestScoreInfo > bestScoreVector;
+    psgl::alignToDAG (parameters, psgl::MODE::LOCAL, bestScoreVector);
+
+    ASSERT_NO_FATAL_FAILURE(checkBRCA1TxtAlignments (bestScoreVector, parameters));
+  }
+}
+
+/**
+ * @brief   builds a graph from BRCA1 sequence and aligns
+ *          5 query sequences to it with compressed DP row
+ *          state, software prefetch at several distances,
+ *          and both. This routine checks for alignment strands, 
+ *          scores and cigars of each run
+ **/
+TEST(localAlignment, multipleQueryKernelOptionsScore_txt) 
+{
+  std::vector< std::vector<std::string> > options {{"-cstate"}, {"-prefetch", "1"}, {"-prefetch", "4"}, {"-cstate", "-prefetch", "8"}};
+
+  for (auto &o : options)
+  {
+    auto args = psgl_test::brca1Args ("txt", "BRCA1_5_reads.fastq", "4", "/dev/null");
+
+    for (auto &option : o)
+      args.add ({option});
+
+    psgl::Parameters parameters;        
+    psgl_test::parse (args, parameters);
+
+    std::vector< psgl::BestScoreInfo > bestScoreVector;
+    psgl::alignToDAG (parameters, psgl::MODE::LOCAL, bestScoreVector);
+
+    ASSERT_NO_FATAL_FAILURE(checkBRCA1TxtAlignments (bestScoreVector, parameters));
+  }
+}
+
+/**
+ * @brief   builds a bi-directed graph with an inversion 
+ *          and aligns a read that follows the inversion.
+ *          This routine checks for alignment score and
+ *          oriented vertices reported in the output
+ **/
+TEST(localAlignment, singleQueryInversion_gfa) 
+{
+  psgl_test::TempDir tmp;
+  std::string dir = FOLDER;
+  std::string qfile = tmp.file ("test_inversion_read.fa");
+  std::string ofile = tmp.file ("test_inversion_out.txt");
+
+  //read follows segments 1+, 2- and 3+
+  {
+    std::ofstream outstrm(qfile);
+    outstrm << ">read\nACGTCAACC\n";
+  }
+
+  psgl_test::CmdArgs args {"PaSGAL", "-m", "gfa", "-q", qfile, "-r", dir + "/inversion_graph.gfa",
+                           "-t", "1", "-o", ofile};
+
+  psgl::Parameters parameters;        
+  psgl_test::parse (args, parameters);
+
+  std::vector< psgl::BestScoreInfo > bestScoreVector;
+  psgl::alignToDAG (parameters, psgl::MODE::LOCAL, bestScoreVector);
+
+  ASSERT_EQ(bestScoreVector.size(), 1); 
+  ASSERT_EQ(bestScoreVector[0].score, 9);       
+  ASSERT_EQ(bestScoreVector[0].cigar, "9=");       
+
+  //either the read along 1+, 2-, 3+ or its reverse complement along 3-, 2+, 1-,
+  //segments are reported with their names
+  auto lines = psgl_test::fileLines (ofile);
+  ASSERT_EQ(lines.size(), 1); 
+
+  bool forward = lines[0].find("(1+, 0)\t(3+, 1)") != std::string::npos;
+  bool reverse = lines[0].find("(3-, 0)\t(1-, 2)") != std::string::npos;
+  ASSERT_TRUE(forward || reverse); 
+}
+
+/**
+ * @brief   builds a graph from BRCA1 sequence and aligns
+ *          5 query sequences to it in parallel, with
+ *          all runtime validation checks enabled.
+ *          This routine checks that no alignment fails 
+ *          validation
+ **/
+TEST(localAlignment, multipleQueryValidated_vg) 
+{
+  //get file name
+  std::string dir = FOLDER;
+  auto rfile = dir + "/BRCA1_seq_graph.vg";
+  auto qfile = dir + "/BRCA1_5_reads.fastq";
+
+  std::vector<char> QFILE(qfile.c_str(), qfile.c_str() + qfile.size() + 1u);
+  std::vector<char> RFILE(rfile.c_str(), rfile.c_str() + rfile.size() + 1u);
+  char *mode = "vg";
+  char *threads = "4"; 
+
+  char *argv[] = {"PaSGAL", "-m", mode, "-q", QFILE.data(), "-r", RFILE.data(),
+                  "-t", threads, "-o", "/dev/null", "-validate", "full", nullptr};
+  int argc = 13;
+
+  psgl::Parameters parameters;        
+  psgl::parseandSave(argc, argv, parameters);
+
+  ASSERT_EQ(parameters.validation, psgl::VALIDATE_FULL); 
+
+  std::vector< psgl::BestScoreInfo > bestScoreVector;
+  psgl::alignToDAG (parameters, psgl::MODE::LOCAL, bestScoreVector);
+
+  ASSERT_EQ(bestScoreVector.size(), 5); 
+
+  for (auto &e : bestScoreVector)
+  {
+    ASSERT_TRUE(e.invalid == nullptr); 
+    ASSERT_EQ(psgl::seqUtils::cigarScore (e.cigar, parameters), e.score);
+  }
+}
+
+/**
+ * @brief   builds a graph from BRCA1 sequence and aligns 5 query 
+ *          sequences to it under a per-read cell budget and deadline.
+ *          This routine checks that exactly the reads exceeding their
+ *          budget are reported score-only or as timed out
+ **/
+TEST(localAlignment, multipleQueryBudget_vg) 
+{
+  //get file name
+  std::string dir = FOLDER;
+  auto rfile = dir + "/BRCA1_seq_graph.vg";
+  auto qfile = dir + "/BRCA1_5_reads.fastq";
+
+  psgl::graphLoader g;
+  g.loadFromVG(rfile);
+
+  std::vector<std::string> reads;
+  std::vector<psgl::ContigInfo> qmetadata;
+  psgl::readQueryFile (qfile, reads, qmetadata, 0, 1);
+
+  psgl::Parameters parameters;
+  parameters.threads = 4;
+  omp_set_num_threads(parameters.threads);
+
+  auto time1 = omp_get_wtime();
+
+  std::vector< psgl::BestScoreInfo > baseline;
+  psgl::alignToDAGLocal (reads, g.diCharGraph, parameters, baseline);
+
+  //deadline of phase 1-R and 2 counts from the wall-clock time phase 1-R began
+  for (auto &e : baseline)
+  {
+    if (e.score > 0)
+    {
+      ASSERT_GE(e.cost.p1rStart, time1); 
+      ASSERT_LE(e.cost.p1rStart, omp_get_wtime()); 
+    }
+  }
+
+  //budget which covers phase 1-R of all reads, but not phase 2 of the longest alignment
+  int64_t maxP1r = 0, maxP2 = 0;
+  for (auto &e : baseline)
+  {
+    maxP1r = std::max (maxP1r, e.cost.p1rCells);
+    maxP2 = std::max (maxP2, e.cost.p2Cells);
+  }
+
+  parameters.cellBudget = maxP1r + maxP2 - 1;
+
+  {
+    std::vector< psgl::BestScoreInfo > bestScoreVector;
+    psgl::alignToDAGLocal (reads, g.diCharGraph, parameters, bestScoreVector);
+
+    int overrun = 0;
+
+    for (std::size_t i = 0; i < reads.size(); i++)
+    {
+      auto &e = bestScoreVector[i];
+      auto &b = baseline[i];
+
+      //score and locations are kept in score-only mode
+      ASSERT_EQ(e.score, b.score); 
+      ASSERT_EQ(e.refColumnStart, b.refColumnStart); 
+      ASSERT_EQ(e.refColumnEnd, b.refColumnEnd); 
+
+      if (b.cost.p1rCells + b.cost.p2Cells > parameters.cellBudget)
+      {
+        overrun++;
+        ASSERT_TRUE(e.overrun != nullptr); 
+        ASSERT_TRUE(e.cigar.empty()); 
+      }
+      else
+      {
+        ASSERT_TRUE(e.overrun == nullptr); 
+        ASSERT_EQ(e.cigar, b.cigar); 
+      }
+    }
+
+    ASSERT_GE(overrun, 1); 
+  }
+
+  //deadline passes before any read completes phase 1-R
+  parameters.cellBudget = 0;
+  parameters.readDeadline = 1e-9;
+  parameters.overrun = psgl::OVERRUN_TIMEOUT;
+
+  {
+    std::vector< psgl::BestScoreInfo > bestScoreVector;
+    psgl::alignToDAGLocal (reads, g.diCharGraph, parameters, bestScoreVector);
+
+    for (std::size_t i = 0; i < reads.size(); i++)
+    {
+      auto &e = bestScoreVector[i];
+
+      ASSERT_EQ(e.overrun != nullptr, baseline[i].score > 0); 
+
+      if (e.overrun)
+      {
+        ASSERT_EQ(e.score, 0); 
+        ASSERT_EQ(e.refColumnStart, -1); 
+        ASSERT_EQ(e.qryRowStart, -1); 
+      }
+    }
+  }
+}
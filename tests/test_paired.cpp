@@ -0,0 +1,221 @@
+/**
+ * @file    test_paired.cpp
+ * @author  Chirag Jain <cjain7@gatech.edu>
+ */
+
+#include "graphLoad.hpp"
+#include "align.hpp"
+#include "base_types.hpp"
+#include "parseCmdArgs.hpp"
+#include "paired.hpp"
+#include "test_utils.hpp"
+#include "gtest/googletest/include/gtest/gtest.h"
+
+/**
+ * @brief   insert size is estimated with median and scaled
+ *          median absolute deviation, and needs enough pairs
+ **/
+TEST(paired, estimateInsertSize)
+{
+  std::vector<int64_t> spans {300, 310, 290, 305, 295, 300, 315, 285, 300, 5000};
+
+  auto insert = psgl::estimateInsertSize (spans);
+
+  ASSERT_TRUE(insert.known());
+  ASSERT_EQ(insert.mean, 300);
+  ASSERT_EQ(insert.pairs, 10);
+  ASSERT_LT(insert.maxSpan(), 400);
+
+  spans.resize (psgl::insertMinPairs - 1);
+  ASSERT_FALSE(psgl::estimateInsertSize (spans).known());
+}
+
+/**
+ * @brief   simulates pairs from the path of BRCA1 sequence graph,
+ *          and aligns them as single reads, as pairs with a given
+ *          insert size, and as pairs in two files and interleaved,
+ *          with insert size estimated. This routine checks that all
+ *          second mates are rescued with a given insert size, and 
+ *          that scores and cigars match single read alignments
+ **/
+TEST(paired, mateRescue_vg)
+{
+  psgl_test::TempDir tmp;
+  std::string dir = FOLDER;
+  auto rfile = dir + "/BRCA1_seq_graph.vg";
+
+  psgl::graphLoader g;
+  g.loadFromVG (rfile);
+
+  ASSERT_EQ(g.paths.size(), 1);
+
+  psgl::PathIndex index;
+  index.build (g.diCharGraph, g.paths[0]);
+
+  std::string ref (index.length, 'N');
+  for (int64_t j = 0; j < g.diCharGraph.numVertices; j++)
+    if (index.columnPosition[j] >= 0)
+      ref[ index.columnPosition[j] ] = g.diCharGraph.vertex_label[j];
+
+  //pairs of 100 bp mates from fragments of 280-320 bp
+  const std::size_t pairs = 40, readLength = 100;
+  std::vector<std::string> reads;
+  {
+    std::mt19937 gen (11);
+    std::ofstream mates1 (tmp.file ("test_paired_1.fq")), mates2 (tmp.file ("test_paired_2.fq")), interleaved (tmp.file ("test_paired_12.fq"));
+
+    for (std::size_t k = 0; k < pairs; k++)
+    {
+      int fragment = 280 + gen() % 41;
+      int begin = gen() % (ref.length() - fragment);
+
+      std::string m1 = ref.substr (begin, readLength);
+      std::string m2 = ref.substr (begin + fragment - readLength, readLength);
+      psgl::seqUtils::reverseComplement (ref.substr (begin + fragment - readLength, readLength), m2);
+
+      auto record = [&](const std::string &name, const std::string &seq) {
+        return "@" + name + "\n" + seq + "\n+\n" + std::string (seq.length(), 'I') + "\n";
+      };
+
+      mates1 << record ("p" + std::to_string (k) + "/1", m1);
+      mates2 << record ("p" + std::to_string (k) + "/2", m2);
+      interleaved << record ("p" + std::to_string (k) + "/1", m1) << record ("p" + std::to_string (k) + "/2", m2);
+
+      reads.push_back (m1);
+      reads.push_back (m2);
+    }
+  }
+
+  auto run = [&](std::initializer_list<std::string> options, std::vector< psgl::BestScoreInfo > &bestScoreVector) {
+    psgl_test::CmdArgs args {"PaSGAL", "-m", "vg", "-r", rfile, "-t", "4"};
+    args.add (options);
+
+    psgl::Parameters parameters;
+    psgl_test::parse (args, parameters);
+    psgl::alignToDAG (parameters, psgl::MODE::LOCAL, bestScoreVector);
+
+    return parameters;
+  };
+
+  std::vector< psgl::BestScoreInfo > single, rescued, paired, interleaved;
+
+  auto parameters = run ({"-q", tmp.file ("test_paired_12.fq"), "-o", tmp.file ("test_paired_single.txt")}, single);
+  run ({"-q", tmp.file ("test_paired_1.fq"), "-q2", tmp.file ("test_paired_2.fq"), "-o", tmp.file ("test_paired_out.txt")}, paired);
+  run ({"-q", tmp.file ("test_paired_12.fq"), "-interleaved", "-o", tmp.file ("test_paired_12.txt")}, interleaved);
+
+  //all second mates are rescued with the insert size of the fragments
+  psgl::InsertSize insert;
+  insert.mean = 300;
+  insert.stdDev = 10;
+
+  ASSERT_EQ(psgl::alignPairsToDAG (reads, g.diCharGraph, parameters, psgl::MODE::LOCAL, insert, rescued), pairs);
+
+  ASSERT_EQ(single.size(), 2 * pairs);
+  ASSERT_EQ(rescued.size(), 2 * pairs);
+  ASSERT_EQ(paired.size(), 2 * pairs);
+  ASSERT_EQ(interleaved.size(), 2 * pairs);
+
+  for (std::size_t i = 0; i < 2 * pairs; i++)
+  {
+    ASSERT_EQ(single[i].score, readLength);
+
+    for (auto v : {&rescued, &paired, &interleaved})
+    {
+      ASSERT_EQ((*v)[i].qryId, i);
+      ASSERT_EQ((*v)[i].score, single[i].score);
+      ASSERT_EQ((*v)[i].cigar, single[i].cigar);
+    }
+  }
+
+  //output of both paired inputs is the same
+  ASSERT_EQ(psgl_test::fileLines (tmp.file ("test_paired_out.txt")), psgl_test::fileLines (tmp.file ("test_paired_12.txt")));
+}
+
+/**
+ * @brief   builds a linear graph with two copies of a repeat, and aligns
+ *          pairs whose first mate is the repeat, and whose second mate 
+ *          faces either copy. This routine checks that the first mate is 
+ *          reported at the copy its mate faces, aligned there directly or
+ *          rescued within the window of the second mate, which happens for
+ *          one of the copies. Coverage counts the reported alignments only,
+ *          not the first mate's alignment at the other copy
+ **/
+TEST(paired, symmetricRescue_gfa)
+{
+  psgl_test::TempDir tmp;
+  std::string rfile = tmp.file ("test_paired_repeat.gfa");
+
+  //unique sequences around copies of a 100 bp repeat at 200 and 700
+  std::string ref;
+  {
+    std::mt19937 gen (7);
+    auto random = [&](int length) {
+      std::string s;
+      for (int i = 0; i < length; i++)
+        s.push_back ("ACGT"[gen() % 4]);
+      return s;
+    };
+
+    auto repeat = random (100);
+    std::vector<std::string> segments {random (200), repeat, random (400), repeat, random (300)};
+
+    std::ofstream outstrm (rfile);
+
+    for (std::size_t i = 0; i < segments.size(); i++)
+    {
+      ref += segments[i];
+      outstrm << "S\t" << i << "\t" << segments[i] << "\n";
+
+      if (i > 0)
+        outstrm << "L\t" << i - 1 << "\t+\t" << i << "\t+\t0M\n";
+    }
+  }
+
+  {
+    std::ofstream outstrm (tmp.file ("test_paired_reads.fa"));
+    outstrm << ">p/1\n" << ref.substr (200, 100) << "\n";
+  }
+
+  psgl_test::CmdArgs args {"PaSGAL", "-m", "gfa", "-r", rfile, "-q", tmp.file ("test_paired_reads.fa"), 
+                           "-t", "1", "-o", tmp.file ("test_paired_out.txt")};
+
+  psgl::Parameters parameters;
+  psgl_test::parse (args, parameters);
+
+  psgl::graphLoader g;
+  g.loadFromGFA (rfile);
+
+  psgl::InsertSize insert;
+  insert.mean = 300;
+  insert.stdDev = 10;
+
+  for (int copy : {200, 700})
+  {
+    std::string mate2 (ref.substr (copy + 200, 100));
+    psgl::seqUtils::reverseComplement (ref.substr (copy + 200, 100), mate2);
+
+    std::vector<std::string> reads {ref.substr (copy, 100), mate2};
+    std::vector< psgl::BestScoreInfo > bestScoreVector;
+    psgl::CoverageCounter coverage (g.diCharGraph.numVertices);
+
+    //either mate is rescued
+    ASSERT_EQ(psgl::alignPairsToDAG (reads, g.diCharGraph, parameters, psgl::MODE::LOCAL, insert, bestScoreVector, &coverage), 1);
+    ASSERT_EQ(bestScoreVector.size(), 2);
+
+    for (auto &e : bestScoreVector)
+    {
+      ASSERT_EQ(e.score, 100);
+      ASSERT_EQ(e.cigar, "100=");
+      ASSERT_TRUE(e.columns.empty());
+    }
+
+    auto columnBases = coverage.reduce();
+    for (int64_t j = 0; j < (int64_t) columnBases.size(); j++)
+      ASSERT_EQ(columnBases[j], (j >= copy && j < copy + 100) || (j >= copy + 200 && j < copy + 300));
+
+    ASSERT_EQ(bestScoreVector[0].strand, '+');
+    ASSERT_EQ(bestScoreVector[0].refColumnStart, copy);
+    ASSERT_EQ(bestScoreVector[1].refColumnEnd, copy + 299);
+    ASSERT_TRUE(psgl::concordant (parameters, insert, bestScoreVector[0], 100, bestScoreVector[1], 100));
+  }
+}
@@ -7,6 +7,16 @@
 #include "test_graph_load.cpp" 
 #include "test_local_alignment.cpp"
 #include "test_local_alignment_uniform_len.cpp"
+#include "test_shard.cpp"
+#include "test_rescore.cpp"
+#include "test_replay.cpp"
+#include "test_plan.cpp"
+#include "test_checkpoint.cpp"
+#include "test_reorder.cpp"
+#include "test_sort.cpp"
+#include "test_coverage.cpp"
+#include "test_project.cpp"
+#include "test_paired.cpp"
 
 TEST(printEnv, print) 
 {
@@ -0,0 +1,105 @@
+/**
+ * @file    test_plan.cpp
+ * @author  Chirag Jain <cjain7@gatech.edu>
+ */
+
+#include "graphLoad.hpp"
+#include "align.hpp"
+#include "base_types.hpp"
+#include "parseCmdArgs.hpp"
+#include "plan.hpp"
+#include "gtest/googletest/include/gtest/gtest.h"
+
+#define QUOTE(name) #name
+#define STR(macro) QUOTE(macro)
+#define FOLDER STR(PROJECT_TEST_DATA_DIR)
+
+/**
+ * @brief   builds a graph from BRCA1 sequence and plans alignment
+ *          of 5 query sequences to it. This routine checks that a
+ *          dry run writes no output, and that predicted memory grows
+ *          with thread count and is kept within a memory limit
+ **/
+TEST(plan, dryRun_vg)
+{
+  //get file name
+  std::string dir = FOLDER;
+  auto rfile = dir + "/BRCA1_seq_graph.vg";
+  auto qfile = dir + "/BRCA1_5_reads.fastq";
+
+  std::vector<char> QFILE(qfile.c_str(), qfile.c_str() + qfile.size() + 1u);
+  std::vector<char> RFILE(rfile.c_str(), rfile.c_str() + rfile.size() + 1u);
+  char *mode = "vg";
+  char *threads = "4";
+
+  std::remove ("test_plan_out.txt");
+
+  char *argv[] = {"PaSGAL", "-m", mode, "-q", QFILE.data(), "-r", RFILE.data(), "-t", threads,
+                  "-o", "test_plan_out.txt", "-plan", nullptr};
+  int argc = 12;
+
+  psgl::Parameters parameters;
+  psgl::parseandSave(argc, argv, parameters);
+
+  std::vector< psgl::BestScoreInfo > bestScoreVector;
+  psgl::alignToDAG (parameters, psgl::MODE::LOCAL, bestScoreVector);
+
+  ASSERT_TRUE(bestScoreVector.empty());
+  ASSERT_FALSE(psgl::fileExists("test_plan_out.txt"));
+
+  psgl::graphLoader g;
+  g.loadFromVG(rfile);
+
+  psgl::ReadSample sample;
+  psgl::sampleReads (parameters, sample, 2);
+
+  ASSERT_EQ(sample.lengths.size(), 5);
+  ASSERT_EQ(sample.reads.size(), 2);
+
+  //sample of loaded reads, used with -maxmem, is the same
+  {
+    std::vector<std::string> reads;
+    std::vector<psgl::ContigInfo> qmetadata;
+    std::vector<std::size_t> sampleOffsets;
+    psgl::readSamples (parameters, reads, qmetadata, sampleOffsets);
+
+    psgl::ReadSample loaded;
+    psgl::sampleReads (reads, loaded, 2);
+
+    ASSERT_EQ(loaded.lengths, sample.lengths);
+    ASSERT_EQ(loaded.reads, sample.reads);
+  }
+
+  auto rates = psgl::calibrateCellRates (parameters, g.diCharGraph, sample);
+
+  ASSERT_GT(rates.p1[0], 0);
+  ASSERT_GT(rates.p1r, 0);
+  ASSERT_GT(rates.p2, 0);
+
+  auto plan = psgl::planRun (parameters, g.diCharGraph, sample, rates, 0);
+
+  //reads of BRCA1_5_reads.fastq are longer than 127 bp
+  auto &chosen = plan.estimates[plan.selected];
+  ASSERT_TRUE(chosen.usable);
+  ASSERT_GT(chosen.precision, 1);
+  ASSERT_GT(chosen.wallTime(), 0);
+
+  //per-thread buffers
+  auto s = psgl::graphStats (g.diCharGraph);
+  std::vector<int32_t> lengths (sample.lengths);
+  std::sort (lengths.begin(), lengths.end(), std::greater<int32_t>());
+
+  auto oneThread = psgl::estimateRun (s, parameters, lengths, rates, chosen.precision, 1, 0);
+  auto fourThreads = psgl::estimateRun (s, parameters, lengths, rates, chosen.precision, 4, 0);
+
+  ASSERT_GT(fourThreads.peakBytes, oneThread.peakBytes);
+
+  //thread count is lowered to fit in memory limit
+  parameters.maxMemory = (oneThread.peakBytes + fourThreads.peakBytes) / 2 / (1 << 30);
+  plan = psgl::planRun (parameters, g.diCharGraph, sample, rates, 0);
+
+  ASSERT_GE(plan.threads, 1);
+  ASSERT_LT(plan.threads, 4);
+  ASSERT_EQ(plan.shards, 1);
+  ASSERT_LE(psgl::estimateRun (s, parameters, lengths, rates, chosen.precision, plan.threads, 0).peakBytes, parameters.maxMemory * (1 << 30));
+}
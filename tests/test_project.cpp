@@ -0,0 +1,198 @@
+/**
+ * @file    test_project.cpp
+ * @author  Chirag Jain <cjain7@gatech.edu>
+ */
+
+#include "graphLoad.hpp"
+#include "align.hpp"
+#include "base_types.hpp"
+#include "parseCmdArgs.hpp"
+#include "project.hpp"
+#include "test_utils.hpp"
+#include "gtest/googletest/include/gtest/gtest.h"
+
+/**
+ * @brief   builds a graph from BRCA1 sequence and aligns
+ *          5 query sequences to it, projecting alignments onto
+ *          its path as SAM records. This routine checks the header,
+ *          and that each mapped record spans its read, with matches
+ *          and mismatches agreeing with the path sequence
+ **/
+TEST(project, samOutput_vg)
+{
+  psgl_test::TempDir tmp;
+  std::string samFile = tmp.file ("test_project.sam");
+
+  auto args = psgl_test::brca1Args ("vg", "BRCA1_5_reads.fastq", "4", tmp.file ("test_project_out.txt"));
+  args.add ({"-sam", samFile, "-refpath", "17"});
+
+  psgl::Parameters parameters;
+  psgl_test::parse (args, parameters);
+
+  std::vector< psgl::BestScoreInfo > bestScoreVector;
+  psgl::alignToDAG (parameters, psgl::MODE::LOCAL, bestScoreVector);
+
+  //sequence of the reference path
+  psgl::graphLoader g;
+  g.loadFromVG (parameters.rfile);
+
+  ASSERT_EQ(g.paths.size(), 1);
+
+  psgl::PathIndex index;
+  index.build (g.diCharGraph, g.paths[0]);
+
+  std::string ref (index.length, 'N');
+  for (int64_t j = 0; j < g.diCharGraph.numVertices; j++)
+    if (index.columnPosition[j] >= 0)
+      ref[ index.columnPosition[j] ] = g.diCharGraph.vertex_label[j];
+
+  int headerLines = 0, mapped = 0, records = 0;
+
+  for (auto &line : psgl_test::fileLines (samFile))
+  {
+    if (line[0] == '@')
+    {
+      if (line.compare (0, 3, "@SQ") == 0)
+        ASSERT_EQ(line, "@SQ\tSN:17\tLN:" + std::to_string (index.length));
+      headerLines++;
+      continue;
+    }
+
+    records++;
+
+    std::istringstream inputString (line);
+    std::string name, rname, cigar, rnext, pnext, tlen, seq;
+    int flag, mapq;
+    int64_t pos;
+
+    inputString >> name >> flag >> rname >> pos >> mapq >> cigar >> rnext >> pnext >> tlen >> seq;
+
+    if (flag & 4)
+      continue;
+
+    mapped++;
+    ASSERT_EQ(rname, "17");
+
+    //walk cigar along the read and the path
+    int64_t r = pos - 1, q = 0, count = 0;
+
+    for (auto c : cigar)
+    {
+      if (isdigit(c))
+      {
+        count = count * 10 + (c - '0');
+        continue;
+      }
+
+      for (int64_t i = 0; i < count; i++)
+      {
+        switch (c)
+        {
+          case '=' : ASSERT_EQ(seq[q], ref[r]); q++; r++; break;
+          case 'X' : ASSERT_NE(seq[q], ref[r]); q++; r++; break;
+          case 'D' : r++; break;
+          default  : q++;
+        }
+      }
+
+      count = 0;
+    }
+
+    ASSERT_EQ(q, seq.length());
+    ASSERT_LE(r, index.length);
+  }
+
+  ASSERT_EQ(headerLines, 3);
+  ASSERT_EQ(records, 5);
+  ASSERT_GT(mapped, 0);
+}
+
+/**
+ * @brief   builds a bi-directed graph with an inversion, and a 
+ *          path along segments 1+, 2- and 3+. This routine checks
+ *          that columns of both strands map to the path, and that an
+ *          alignment along the reverse strand of the path is projected
+ *          onto its forward strand with FLAG 16
+ **/
+TEST(project, reverseStrand_gfa)
+{
+  psgl_test::TempDir tmp;
+  std::string rfile = tmp.file ("test_project_path.gfa");
+
+  {
+    std::ofstream outstrm (rfile);
+    outstrm << psgl_test::fileContent (std::string (FOLDER) + "/inversion_graph.gfa") << "P\tref\t1+,2-,3+\t*\n";
+  }
+
+  psgl::graphLoader g;
+  g.loadFromGFA (rfile);
+  auto &graph = g.diCharGraph;
+
+  ASSERT_EQ(g.paths.size(), 1);
+  ASSERT_EQ(graph.strandVertices, 3);
+
+  psgl::PathIndex index;
+  index.build (graph, g.paths[0]);
+
+  //path sequence is ACG TCAA CC
+  const std::string path = "ACGTCAACC";
+  ASSERT_EQ(index.length, path.length());
+
+  //each column is on the path on exactly one strand, and the 9 columns 
+  //of 3-, 2+, 1- spell the reverse complement of the path
+  std::vector<int64_t> columns;
+
+  for (auto id : {2, 1, 0})
+    for (int64_t j = 0; j < graph.numVertices; j++)
+    {
+      ASSERT_NE(index.columnPosition[j] >= 0, index.reversePosition[j] >= 0);
+
+      if (index.columnPosition[j] >= 0)
+        ASSERT_EQ(graph.vertex_label[j], path[ index.columnPosition[j] ]);
+
+      auto v = graph.outputVertexId(j);
+      if (v.id == id && (v.orientation == '+') == (id == 1))
+        columns.push_back (j);
+    }
+
+  ASSERT_EQ(columns.size(), path.length());
+
+  std::string rcPath (path);
+  psgl::seqUtils::reverseComplement (path, rcPath);
+
+  for (std::size_t k = 0; k < columns.size(); k++)
+  {
+    ASSERT_EQ(graph.vertex_label[ columns[k] ], rcPath[k]);
+    ASSERT_EQ(index.reversePosition[ columns[k] ], path.length() - 1 - k);
+  }
+
+  //read aligned along the reverse strand, with one read base clipped at each end
+  psgl::ContigInfo info;
+  info.name = "read";
+
+  psgl::BestScoreInfo e;
+  e.score = 9;
+  e.strand = '+';
+  e.qryRowEnd = 9;
+  e.cigar = "9=";
+  e.columns = columns;
+
+  auto record = psgl::projectAlignment (index, info, "T" + rcPath + "G", e);
+
+  ASSERT_EQ(record.flag, 16);
+  ASSERT_EQ(record.pos, 0);
+  ASSERT_EQ(record.seq, "C" + path + "A");
+  ASSERT_EQ(record.score, 9);
+
+  std::vector<uint32_t> cigar {bam_cigar_gen (1, BAM_CSOFT_CLIP), bam_cigar_gen (9, BAM_CEQUAL), bam_cigar_gen (1, BAM_CSOFT_CLIP)};
+  ASSERT_EQ(record.cigar, cigar);
+
+  //same alignment of the reverse complemented read is on the forward strand of the read
+  e.strand = '-';
+  record = psgl::projectAlignment (index, info, "C" + path + "A", e);
+
+  ASSERT_EQ(record.flag, 0);
+  ASSERT_EQ(record.pos, 0);
+  ASSERT_EQ(record.seq, "C" + path + "A");
+  ASSERT_EQ(record.cigar, cigar);
+}
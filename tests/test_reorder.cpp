@@ -0,0 +1,150 @@
+/**
+ * @file    test_reorder.cpp
+ * @author  Chirag Jain <cjain7@gatech.edu>
+ */
+
+#include "graphLoad.hpp"
+#include "align.hpp"
+#include "base_types.hpp"
+#include "parseCmdArgs.hpp"
+#include "reorder.hpp"
+#include "test_utils.hpp"
+#include "gtest/googletest/include/gtest/gtest.h"
+
+/**
+ * @brief   batches completed in reverse order are released
+ *          in input order, or as they complete if unordered
+ **/
+TEST(reorder, releaseOrder)
+{
+  std::size_t b;
+  int item;
+
+  {
+    psgl::ReorderBuffer<int> buffer (2, 6, 4, true);
+
+    for (std::size_t b = 5; b >= 2; b--)
+      buffer.push (b, b * 10);
+
+    for (std::size_t expected = 2; expected < 6; expected++)
+    {
+      ASSERT_TRUE(buffer.pop (b, item));
+      ASSERT_EQ(b, expected);
+      ASSERT_EQ(item, b * 10);
+    }
+
+    ASSERT_FALSE(buffer.pop (b, item));
+  }
+
+  {
+    psgl::ReorderBuffer<int> buffer (2, 6, 4, false);
+
+    for (std::size_t expected : {5, 3, 2, 4})
+    {
+      buffer.push (expected, expected * 10);
+      ASSERT_TRUE(buffer.pop (b, item));
+      ASSERT_EQ(b, expected);
+      ASSERT_EQ(item, b * 10);
+    }
+
+    ASSERT_FALSE(buffer.pop (b, item));
+  }
+}
+
+/**
+ * @brief   producers wait for a window in unordered mode too
+ **/
+TEST(reorder, unorderedWindow)
+{
+  psgl::ReorderBuffer<int> buffer (0, 4, 2, false);
+
+  buffer.acquire (0);
+  buffer.acquire (1);
+
+  std::atomic<bool> started (false);
+  std::thread producer ([&]() {
+      buffer.acquire (2);
+      started = true;
+  });
+
+  std::this_thread::sleep_for (std::chrono::milliseconds (100));
+  ASSERT_FALSE(started);
+
+  //release of any batch lets the next one start
+  std::size_t b;
+  int item;
+
+  buffer.push (1, 10);
+  ASSERT_TRUE(buffer.pop (b, item));
+  ASSERT_EQ(b, 1);
+
+  producer.join();
+  ASSERT_TRUE(started);
+}
+
+/**
+ * @brief   builds a graph from BRCA1 sequence and aligns
+ *          5 query sequences to it, in a single batch and
+ *          in concurrent batches of 2 reads. This routine checks
+ *          that output of concurrent batches is in input order,
+ *          and holds the same alignments if unordered, or if
+ *          results are not kept after writing
+ **/
+TEST(reorder, concurrentBatches_vg)
+{
+  psgl_test::TempDir tmp;
+  auto allFile = tmp.file ("test_reorder_all.txt");
+  auto outFile = tmp.file ("test_reorder_out.txt");
+
+  std::vector< psgl::BestScoreInfo > allBestScoreVector;
+  {
+    auto args = psgl_test::brca1Args ("vg", "BRCA1_5_reads.fastq", "4", allFile);
+
+    psgl::Parameters parameters;
+    psgl_test::parse (args, parameters);
+    psgl::alignToDAG (parameters, psgl::MODE::LOCAL, allBestScoreVector);
+  }
+
+  for (std::string order : {"-window", "-unordered", "-release"})
+  {
+    auto args = psgl_test::brca1Args ("vg", "BRCA1_5_reads.fastq", "4", outFile);
+    args.add ({"-batch", "2", "-workers", "2"});
+
+    if (order == "-window")
+      args.add ({"-window", "1"});
+    else if (order == "-unordered")
+      args.add ({"-unordered"});
+
+    psgl::Parameters parameters;
+    psgl_test::parse (args, parameters);
+    parameters.keepResults = order != "-release";
+
+    std::vector< psgl::BestScoreInfo > bestScoreVector;
+    psgl::alignToDAG (parameters, psgl::MODE::LOCAL, bestScoreVector);
+
+    if (parameters.keepResults)
+    {
+      ASSERT_EQ(bestScoreVector.size(), 5);
+
+      for (std::size_t i = 0; i < bestScoreVector.size(); i++)
+      {
+        ASSERT_EQ(bestScoreVector[i].qryId, i);
+        ASSERT_EQ(bestScoreVector[i].score, allBestScoreVector[i].score);
+      }
+    }
+    else
+      ASSERT_TRUE(bestScoreVector.empty());
+
+    auto all = psgl_test::fileLines (allFile);
+    auto out = psgl_test::fileLines (outFile);
+
+    if (parameters.unorderedOutput)
+    {
+      std::sort (all.begin(), all.end());
+      std::sort (out.begin(), out.end());
+    }
+
+    ASSERT_EQ(all.size(), 5);
+    ASSERT_EQ(all, out);
+  }
+}
@@ -0,0 +1,137 @@
+/**
+ * @file    test_replay.cpp
+ * @author  Chirag Jain <cjain7@gatech.edu>
+ */
+
+#include "graphLoad.hpp"
+#include "align.hpp"
+#include "base_types.hpp"
+#include "parseCmdArgs.hpp"
+#include "replay.hpp"
+#include "test_utils.hpp"
+#include "gtest/googletest/include/gtest/gtest.h"
+
+/**
+ * @brief   builds a graph from BRCA1 sequence and aligns
+ *          5 query sequences to it, saving per-read costs,
+ *          a log and repro files of the 2 slowest reads.
+ *          This routine checks the cost columns, and that 
+ *          replay of the slowest read reproduces its alignment
+ **/
+TEST(replay, slowReadRepro_vg) 
+{
+  psgl_test::TempDir tmp;
+  auto ofile = tmp.file ("test_replay_out.txt");
+  auto slowlog = tmp.file ("test_replay_slow.txt");
+  auto repro = tmp.file ("test_replay");
+
+  auto args = psgl_test::brca1Args ("vg", "BRCA1_5_reads.fastq", "4", ofile);
+  args.add ({"-costs", "-slowlog", slowlog, "-slowk", "2", "-repro", repro});
+
+  psgl::Parameters parameters;        
+  psgl_test::parse (args, parameters);
+
+  std::vector< psgl::BestScoreInfo > bestScoreVector;
+  psgl::alignToDAG (parameters, psgl::MODE::LOCAL, bestScoreVector);
+
+  ASSERT_EQ(bestScoreVector.size(), 5); 
+
+  //split tab-delimited output lines
+  auto splitLine = [](const std::string &line) {
+    std::vector<std::string> tokens;
+    std::istringstream inputString(line);
+
+    for (std::string token; std::getline(inputString, token, '\t'); )
+      tokens.push_back (token);
+
+    return tokens;
+  };
+
+  //output has 6 cost columns after cigar
+  {
+    std::ifstream infile(ofile);
+    std::string line;
+
+    for (auto &e : bestScoreVector)
+    {
+      ASSERT_TRUE(std::getline(infile, line)); 
+
+      auto tokens = splitLine (line);
+
+      ASSERT_EQ(tokens.size(), 15); 
+      ASSERT_EQ(std::stoll(tokens[9]), e.cost.p1Cells); 
+      ASSERT_EQ(std::stoll(tokens[13]), e.cost.p2Cells); 
+    }
+  }
+
+  //phase 2 recomputes the window of the alignment
+  for (auto &e : bestScoreVector)
+  {
+    ASSERT_GT(e.cost.p1Cells, 0); 
+    ASSERT_GT(e.cost.p1rCells, 0); 
+    ASSERT_EQ(e.cost.p2Cells, (e.refColumnEnd - e.refColumnStart + 1) * (e.qryRowEnd - e.qryRowStart + 1)); 
+  }
+
+  //slow read log lists 2 reads, slowest first
+  std::string slowestRead;
+  {
+    std::ifstream infile(slowlog);
+    std::string line;
+    std::vector<double> times;
+
+    while (std::getline(infile, line))
+    {
+      std::istringstream inputString(line);
+      std::string name, len, score;
+      double time;
+      inputString >> name >> len >> score >> time;
+
+      if (times.empty())
+        slowestRead = name;
+
+      times.push_back (time);
+    }
+
+    ASSERT_EQ(times.size(), 2); 
+    ASSERT_GE(times[0], times[1]); 
+  }
+
+  //replay the slowest read
+  {
+    psgl_test::CmdArgs replayArgs {"PaSGAL", "replay", "-i", repro + ".0.txt", "-n", "2"};
+
+    psgl::ReplayParameters replayParameters;
+    psgl::parseReplayArgs(replayArgs.argc(), replayArgs.argv(), replayParameters);
+    auto runs = psgl::replayRead(replayParameters);
+
+    //thread count of the caller is not changed by replay
+    ASSERT_EQ(omp_get_max_threads(), parameters.threads); 
+
+    ASSERT_EQ(runs.size(), 2); 
+
+    //find alignment of the slowest read in the output
+    std::ifstream infile(ofile);
+    std::string line;
+    bool found = false;
+
+    while (std::getline(infile, line))
+    {
+      auto tokens = splitLine (line);
+
+      if (tokens[0] == slowestRead)
+      {
+        found = true;
+
+        for (auto &e : runs)
+        {
+          ASSERT_EQ(e.score, std::stoi(tokens[7])); 
+          ASSERT_EQ(e.strand, tokens[4][0]); 
+          ASSERT_EQ(psgl::seqUtils::cigarScore (e.cigar, parameters), e.score);
+          ASSERT_TRUE(e.invalid == nullptr); 
+        }
+      }
+    }
+
+    ASSERT_TRUE(found); 
+  }
+}
@@ -0,0 +1,80 @@
+/**
+ * @file    test_rescore.cpp
+ * @author  Chirag Jain <cjain7@gatech.edu>
+ */
+
+#include "graphLoad.hpp"
+#include "base_types.hpp"
+#include "parseCmdArgs.hpp"
+#include "rescore.hpp"
+#include "test_utils.hpp"
+#include "gtest/googletest/include/gtest/gtest.h"
+
+#define QUOTE(name) #name
+#define STR(macro) QUOTE(macro)
+#define FOLDER STR(PROJECT_TEST_DATA_DIR)
+
+/**
+ * @brief   rescores alignments to a small bubble graph 
+ *          under a non-unit scoring scheme.
+ *          This routine checks for scores and cigars of
+ *          alignments on both strands, with partial paths,
+ *          of an alignment along a non-existing path, and
+ *          of a cigar with an operation without length, 
+ *          also with batches of single reads and alignments 
+ *          which refer to earlier reads
+ **/
+TEST(rescore, rescoreGAF_gfa) 
+{
+  psgl_test::TempDir tmp;
+  std::string dir = FOLDER;
+  std::string qfile = tmp.file ("test_rescore_reads.fa");
+  std::string gfile = tmp.file ("test_rescore.gaf");
+
+  //path >s1>s2>s4 spells ACGTGACCA
+  {
+    std::ofstream outstrm(qfile);
+    outstrm << ">r1\nACGTGACCA\n>r2\nACGTTACCA\n>r3\nTGGTCACGT\n>r4\nACGTACCA\n";
+  }
+
+  {
+    std::ofstream outstrm(gfile);
+    outstrm << "r1\t9\t0\t9\t+\t>s1>s2>s4\t9\t0\t9\t9\t9\t60\tcg:Z:9M\n";
+    outstrm << "r2\t9\t0\t9\t+\t>s1>s2>s4\t9\t0\t9\t8\t9\t60\tcg:Z:9M\n";
+    outstrm << "r3\t9\t0\t9\t-\t>s1>s2>s4\t9\t0\t9\t9\t9\t60\tcg:Z:9M\n";
+    outstrm << "r3\t9\t0\t9\t+\t<s4<s2<s1\t9\t0\t9\t9\t9\t60\tcg:Z:9M\n";
+    outstrm << "r4\t8\t0\t8\t+\t>s1>s2>s4\t9\t0\t9\t8\t9\t60\tcg:Z:4M1D4M\n";
+    outstrm << "r1\t9\t0\t9\t+\t>s2>s3\t2\t0\t2\t0\t2\t60\tcg:Z:2M\n";
+    outstrm << "r1\t9\t2\t6\t+\t>s1>s2>s4\t9\t2\t6\t4\t4\t60\tcg:Z:4M\n";
+    outstrm << "r1\t9\t0\t9\t+\t>s1>s2>s4\t9\t0\t9\t9\t9\t60\tcg:Z:M9M\n";
+    outstrm << "r5\t9\t0\t9\t+\t>s1>s2>s4\t9\t0\t9\t9\t9\t60\tcg:Z:9M\n";
+  }
+
+  std::vector< std::pair<std::string, std::string> > expected = 
+    {{"9", "9="}, {"5", "4=1X4="}, {"9", "9="}, {"9", "9="}, {"6", "4=1D4="}, {"*", "*"}, {"4", "4="}, {"*", "*"}, {"*", "*"}};
+
+  for (std::string batch : {"100000", "1"})
+  {
+    std::string ofile = tmp.file ("test_rescore_out_" + batch + ".txt");
+
+    psgl_test::CmdArgs args {"rescore", "-m", "gfa", "-r", dir + "/bubble_graph.gfa", "-q", qfile, 
+                             "-g", gfile, "-o", ofile, "-t", "2", "-mismatch", "3", "-del", "2", "-batch", batch};
+
+    psgl::Parameters parameters;        
+    psgl_test::parse (args, parameters);
+    psgl::rescoreAlignments(parameters);
+
+    auto lines = psgl_test::fileLines (ofile);
+    ASSERT_EQ(lines.size(), expected.size()); 
+
+    for (std::size_t i = 0; i < lines.size(); i++)
+    {
+      std::istringstream inputString(lines[i]);
+      std::vector<std::string> tokens (std::istream_iterator<std::string>{inputString}, std::istream_iterator<std::string>());
+
+      ASSERT_EQ(tokens.size(), 11); 
+      ASSERT_EQ(tokens[9], expected[i].first); 
+      ASSERT_EQ(tokens[10], expected[i].second); 
+    }
+  }
+}
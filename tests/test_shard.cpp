@@ -0,0 +1,166 @@
+/**
+ * @file    test_shard.cpp
+ * @author  Chirag Jain <cjain7@gatech.edu>
+ */
+
+#include "graphLoad.hpp"
+#include "align.hpp"
+#include "base_types.hpp"
+#include "parseCmdArgs.hpp"
+#include "shard.hpp"
+#include "test_utils.hpp"
+#include "gtest/googletest/include/gtest/gtest.h"
+
+#define QUOTE(name) #name
+#define STR(macro) QUOTE(macro)
+#define FOLDER STR(PROJECT_TEST_DATA_DIR)
+
+/**
+ * @brief   builds a graph from BRCA1 sequence and aligns
+ *          5 query sequences to it, first in a single run
+ *          and then in two read shards.
+ *          This routine checks that merged shard output 
+ *          and metrics match the single run
+ **/
+TEST(shard, mergeTwoShards_vg) 
+{
+  psgl_test::TempDir tmp;
+
+  //single run
+  {
+    auto args = psgl_test::brca1Args ("vg", "BRCA1_5_reads.fastq", "4", tmp.file ("all.txt"));
+    args.add ({"-metrics", tmp.file ("all.json")});
+
+    psgl::Parameters parameters;        
+    psgl_test::parse (args, parameters);
+
+    std::vector< psgl::BestScoreInfo > bestScoreVector;
+    psgl::alignToDAG (parameters, psgl::MODE::LOCAL, bestScoreVector);
+  }
+
+  //two shards
+  for (int i = 0; i < 2; i++)
+  {
+    auto args = psgl_test::brca1Args ("vg", "BRCA1_5_reads.fastq", "4", tmp.file ("shard_" + std::to_string(i) + ".txt"));
+    args.add ({"-shard", std::to_string(i) + "/2", "-metrics", tmp.file ("shard_" + std::to_string(i) + ".json")});
+
+    psgl::Parameters parameters;        
+    psgl_test::parse (args, parameters);
+
+    std::vector< psgl::BestScoreInfo > bestScoreVector;
+    psgl::alignToDAG (parameters, psgl::MODE::LOCAL, bestScoreVector);
+
+    ASSERT_EQ(bestScoreVector.size(), i == 0 ? 3 : 2); 
+  }
+
+  //merge
+  {
+    psgl_test::CmdArgs args {"PaSGAL", "merge", "-i", tmp.file ("shard_0.txt"), tmp.file ("shard_1.txt"), 
+                             "-j", tmp.file ("shard_0.json"), tmp.file ("shard_1.json"), 
+                             "-o", tmp.file ("merged.txt"), "-metrics", tmp.file ("merged.json")};
+
+    psgl::MergeParameters parameters;
+    psgl::parseMergeArgs(args.argc(), args.argv(), parameters);
+    psgl::mergeShards(parameters);
+  }
+
+  auto allContent = psgl_test::fileContent (tmp.file ("all.txt"));
+
+  ASSERT_FALSE(allContent.empty()); 
+  ASSERT_EQ(allContent, psgl_test::fileContent (tmp.file ("merged.txt"))); 
+
+  psgl::RunMetrics allMetrics, mergedMetrics;
+  psgl::readMetricsJSON (tmp.file ("all.json"), allMetrics);
+  psgl::readMetricsJSON (tmp.file ("merged.json"), mergedMetrics);
+
+  ASSERT_EQ(mergedMetrics.reads, 5); 
+  ASSERT_EQ(mergedMetrics.reads, allMetrics.reads); 
+  ASSERT_EQ(mergedMetrics.alignedReads, allMetrics.alignedReads); 
+  ASSERT_EQ(mergedMetrics.totalScore, allMetrics.totalScore); 
+}
+
+/**
+ * @brief   parses metrics with counts beyond the precision of
+ *          double, and rejects metrics with a malformed count
+ **/
+TEST(shard, metricsIntegerCounts) 
+{
+  psgl_test::TempDir tmp;
+  auto mfile = tmp.file ("metrics.json");
+
+  psgl::RunMetrics m;
+  m.reads = (int64_t(1) << 53) + 1;
+  m.alignedReads = m.reads - 2;
+  m.totalScore = (int64_t(1) << 60) + 3;
+  psgl::writeMetricsJSON (mfile, m);
+
+  psgl::RunMetrics parsed;
+  psgl::readMetricsJSON (mfile, parsed);
+
+  ASSERT_EQ(parsed.reads, m.reads); 
+  ASSERT_EQ(parsed.alignedReads, m.alignedReads); 
+  ASSERT_EQ(parsed.totalScore, m.totalScore); 
+
+  {
+    std::ofstream outstrm (mfile);
+    outstrm << "{ \"shard_index\": 0, \"shard_count\": 1, \"reads\": 1.5, \"aligned_reads\": 1, "
+      << "\"total_score\": 1, \"load_time_s\": 0, \"align_time_s\": 0 }\n";
+  }
+
+  ASSERT_EXIT(psgl::readMetricsJSON (mfile, parsed), ::testing::ExitedWithCode(1), "invalid value of key reads");
+}
+
+/**
+ * @brief   aligns 8 interleaved pairs of BRCA1 reads in a single
+ *          run and in two read shards, which keep both mates of a pair.
+ *          This routine checks that merged shard output matches the
+ *          single run, with the group size taken from shard metrics
+ *          or given with -group
+ **/
+TEST(shard, mergePairedShards_vg) 
+{
+  psgl_test::TempDir tmp;
+
+  auto run = [&](const std::string &ofile, std::initializer_list<std::string> options) {
+    auto args = psgl_test::brca1Args ("vg", "BRCA1_16_uniform_len.fastq", "4", tmp.file (ofile));
+    args.add ({"-interleaved"});
+    args.add (options);
+
+    psgl::Parameters parameters;        
+    psgl_test::parse (args, parameters);
+
+    std::vector< psgl::BestScoreInfo > bestScoreVector;
+    psgl::alignToDAG (parameters, psgl::MODE::LOCAL, bestScoreVector);
+
+    return bestScoreVector.size();
+  };
+
+  ASSERT_EQ(run ("all.txt", {}), 16);
+  ASSERT_EQ(run ("shard_0.txt", {"-shard", "0/2", "-metrics", tmp.file ("shard_0.json")}), 8);
+  ASSERT_EQ(run ("shard_1.txt", {"-shard", "1/2", "-metrics", tmp.file ("shard_1.json")}), 8);
+
+  psgl::RunMetrics m;
+  psgl::readMetricsJSON (tmp.file ("shard_0.json"), m);
+  ASSERT_EQ(m.shardGroup, 2); 
+
+  auto merge = [&](const std::string &ofile, std::initializer_list<std::string> options) {
+    psgl_test::CmdArgs args {"PaSGAL", "merge", "-i", tmp.file ("shard_0.txt"), tmp.file ("shard_1.txt"), "-o", tmp.file (ofile)};
+    args.add (options);
+
+    psgl::MergeParameters parameters;
+    psgl::parseMergeArgs(args.argc(), args.argv(), parameters);
+    psgl::mergeShards(parameters);
+
+    return psgl_test::fileContent (tmp.file (ofile));
+  };
+
+  auto allContent = psgl_test::fileContent (tmp.file ("all.txt"));
+
+  ASSERT_EQ(psgl_test::fileLines (tmp.file ("all.txt")).size(), 16); 
+  ASSERT_EQ(allContent, merge ("merged_json.txt", {"-j", tmp.file ("shard_0.json"), tmp.file ("shard_1.json")})); 
+  ASSERT_EQ(allContent, merge ("merged_group.txt", {"-group", "2"})); 
+  ASSERT_NE(allContent, merge ("merged_lines.txt", {"-group", "1"})); 
+
+  ASSERT_EXIT(merge ("merged_bad.txt", {"-group", "1", "-j", tmp.file ("shard_0.json"), tmp.file ("shard_1.json")}), 
+      ::testing::ExitedWithCode(1), "keeps groups of 2 reads");
+}
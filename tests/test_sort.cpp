@@ -0,0 +1,134 @@
+/**
+ * @file    test_sort.cpp
+ * @author  Chirag Jain <cjain7@gatech.edu>
+ */
+
+#include "graphLoad.hpp"
+#include "align.hpp"
+#include "base_types.hpp"
+#include "parseCmdArgs.hpp"
+#include "sort.hpp"
+#include "test_utils.hpp"
+#include "gtest/googletest/include/gtest/gtest.h"
+
+/**
+ * @brief   records added in random order with a small memory
+ *          limit are spilled in runs, and merged in key order,
+ *          in a single pass or in several passes of bounded fan-in.
+ *          Run files are removed after merging, or with a sorter
+ *          which did not finish
+ **/
+TEST(sort, mergeRuns)
+{
+  psgl_test::TempDir tmp;
+  auto ofile = tmp.file ("test_sort_runs.txt");
+
+  std::vector<psgl::PositionKey> keys;
+
+  for (int32_t i = 0; i < 1000; i++)
+    keys.push_back (psgl::PositionKey {i % 37, i % 11, (char) (i % 2 ? '-' : '+'), i});
+
+  std::mt19937 gen (7);
+  std::shuffle (keys.begin(), keys.end(), gen);
+
+  auto sortedKeys = keys;
+  std::sort (sortedKeys.begin(), sortedKeys.end());
+
+  //a single merge pass, and more runs than the fan-in
+  for (std::size_t memoryLimit : {4096, 512})
+  {
+    psgl::PositionSorter sorter (ofile, memoryLimit);
+
+    for (auto &k : keys)
+      sorter.add (k, std::to_string (k.id) + "\t" + std::to_string (k.offset) + "\t" + k.orientation + "\t" + std::to_string (k.readId) + "\n");
+
+    auto runs = sorter.finish();
+    ASSERT_GT(runs, 1);
+
+    const std::size_t fanIn = psgl::PositionSorter::maxFanIn;
+
+    if (memoryLimit == 512)
+      ASSERT_GT(runs, fanIn);
+
+    std::ifstream infile (ofile);
+    std::size_t i = 0;
+
+    for (psgl::PositionKey k; infile >> k.id >> k.offset >> k.orientation >> k.readId; i++)
+    {
+      ASSERT_LT(i, sortedKeys.size());
+      ASSERT_EQ(k.id, sortedKeys[i].id);
+      ASSERT_EQ(k.offset, sortedKeys[i].offset);
+      ASSERT_EQ(k.orientation, sortedKeys[i].orientation);
+      ASSERT_EQ(k.readId, sortedKeys[i].readId);
+    }
+
+    ASSERT_EQ(i, sortedKeys.size());
+    ASSERT_FALSE(psgl::fileExists(ofile + ".run0.tmp"));
+  }
+
+  //sorter left before finish
+  {
+    psgl::PositionSorter sorter (tmp.file ("unfinished.txt"), 512);
+
+    for (auto &k : keys)
+      sorter.add (k, std::to_string (k.readId) + "\n");
+
+    ASSERT_TRUE(psgl::fileExists(tmp.file ("unfinished.txt.run0.tmp")));
+  }
+
+  ASSERT_FALSE(psgl::fileExists(tmp.file ("unfinished.txt.run0.tmp")));
+}
+
+/**
+ * @brief   builds a graph from BRCA1 sequence and aligns
+ *          5 query sequences to it, with and without sorted
+ *          output. This routine checks that sorted output holds
+ *          the same records, ordered by start vertex and offset
+ **/
+TEST(sort, sortedOutput_vg)
+{
+  psgl_test::TempDir tmp;
+  auto allFile = tmp.file ("test_sort_all.txt");
+  auto outFile = tmp.file ("test_sort_out.txt");
+
+  for (auto ofile : {allFile, outFile})
+  {
+    auto args = psgl_test::brca1Args ("vg", "BRCA1_5_reads.fastq", "4", ofile);
+
+    if (ofile == outFile)
+      args.add ({"-sort"});
+
+    psgl::Parameters parameters;
+    psgl_test::parse (args, parameters);
+
+    std::vector< psgl::BestScoreInfo > bestScoreVector;
+    psgl::alignToDAG (parameters, psgl::MODE::LOCAL, bestScoreVector);
+  }
+
+  auto all = psgl_test::fileLines (allFile);
+  auto out = psgl_test::fileLines (outFile);
+
+  ASSERT_EQ(out.size(), 5);
+
+  //start (vertex, offset) is the 6th column
+  std::vector< std::pair<int32_t, int32_t> > starts;
+
+  for (auto &line : out)
+  {
+    std::istringstream inputString (line);
+    std::string field;
+
+    for (int i = 0; i < 6; i++)
+      std::getline (inputString, field, '\t');
+
+    int32_t id, offset;
+    ASSERT_EQ(sscanf (field.c_str(), "(%d, %d)", &id, &offset), 2);
+    starts.emplace_back (id, offset);
+  }
+
+  ASSERT_TRUE(std::is_sorted (starts.begin(), starts.end()));
+
+  std::sort (all.begin(), all.end());
+  std::sort (out.begin(), out.end());
+  ASSERT_EQ(all, out);
+}
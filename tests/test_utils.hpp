@@ -0,0 +1,161 @@
+/**
+ * @file    test_utils.hpp
+ * @brief   temporary directories, file readers and command lines
+ *          shared by tests
+ * @author  Chirag Jain <cjain7@gatech.edu>
+ */
+
+#ifndef PSGL_TEST_UTILS_HPP
+#define PSGL_TEST_UTILS_HPP
+
+#include <ftw.h>
+#include <cstdlib>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iterator>
+#include <initializer_list>
+
+#include "base_types.hpp"
+#include "parseCmdArgs.hpp"
+
+#define QUOTE(name) #name
+#define STR(macro) QUOTE(macro)
+#define FOLDER STR(PROJECT_TEST_DATA_DIR)
+
+namespace psgl_test
+{
+  /**
+   * @brief     directory created under $TMPDIR (or /tmp) for output files of
+   *            a test, removed along with its contents when out of scope
+   */
+  class TempDir
+  {
+    private:
+
+      std::string path;
+
+    public:
+
+      TempDir()
+      {
+        const char *tmp = std::getenv ("TMPDIR");
+        std::string pattern = std::string (tmp && *tmp ? tmp : "/tmp") + "/pasgal_test.XXXXXX";
+
+        std::vector<char> name (pattern.begin(), pattern.end());
+        name.push_back ('\0');
+
+        if (mkdtemp (name.data()) == nullptr)
+        {
+          std::cerr << "ERROR, psgl_test::TempDir, could not create " << pattern << std::endl;
+          exit(1);
+        }
+
+        path = name.data();
+      }
+
+      ~TempDir()
+      {
+        nftw (path.c_str(), [](const char *f, const struct stat *, int, struct FTW *) { return std::remove (f); }, 16, FTW_DEPTH | FTW_PHYS);
+      }
+
+      TempDir (const TempDir &) = delete;
+      TempDir &operator= (const TempDir &) = delete;
+
+      /**
+       * @brief               path of a file within the directory
+       */
+      std::string file (const std::string &name) const
+      {
+        return path + "/" + name;
+      }
+  };
+
+  /**
+   * @brief     command line owning its argument strings, so that tests can
+   *            add options without counting argv entries by hand
+   */
+  class CmdArgs
+  {
+    private:
+
+      std::vector<std::string> args;
+      std::vector<char*> ptrs;
+
+    public:
+
+      CmdArgs (std::initializer_list<std::string> a) : args (a) {}
+
+      CmdArgs &add (std::initializer_list<std::string> a)
+      {
+        args.insert (args.end(), a);
+        return *this;
+      }
+
+      int argc() const
+      {
+        return args.size();
+      }
+
+      char **argv()
+      {
+        ptrs.clear();
+        for (auto &s : args)
+          ptrs.push_back (&s[0]);
+        ptrs.push_back (nullptr);
+
+        return ptrs.data();
+      }
+  };
+
+  /**
+   * @brief                   command line aligning a BRCA1 read file of the test data
+   *                          to the BRCA1 graph
+   * @param[in]   mode        graph format, "vg" or "txt"
+   * @param[in]   reads       read file name within the test data folder
+   * @param[in]   threads
+   * @param[in]   ofile       output file
+   */
+  inline CmdArgs brca1Args (const std::string &mode, const std::string &reads,
+      const std::string &threads, const std::string &ofile)
+  {
+    std::string dir = FOLDER;
+
+    return CmdArgs {"PaSGAL", "-m", mode, "-q", dir + "/" + reads, "-r", dir + "/BRCA1_seq_graph." + mode,
+                    "-t", threads, "-o", ofile};
+  }
+
+  /**
+   * @brief                   parse a command line into parameters
+   */
+  inline void parse (CmdArgs &args, psgl::Parameters &parameters)
+  {
+    psgl::parseandSave (args.argc(), args.argv(), parameters);
+  }
+
+  /**
+   * @brief                   lines of a text file
+   */
+  inline std::vector<std::string> fileLines (const std::string &filename)
+  {
+    std::ifstream infile (filename);
+    std::vector<std::string> lines;
+
+    for (std::string line; std::getline (infile, line); )
+      lines.push_back (line);
+
+    return lines;
+  }
+
+  /**
+   * @brief                   content of a file
+   */
+  inline std::string fileContent (const std::string &filename)
+  {
+    std::ifstream infile (filename, std::ios::binary);
+    return std::string ((std::istreambuf_iterator<char>(infile)), std::istreambuf_iterator<char>());
+  }
+}
+
+#endif